@@ -0,0 +1,50 @@
+/**
+ * Test that FETCH stages which read the records of several index keys at once, when
+ * 'internalQueryFetchBatchSize' is greater than 1, examine no more keys than one record at a time
+ * when a limit or a single document write stops the plan early.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const coll = testDb.fetch_batch_limit;
+coll.drop();
+
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 100; ++i) {
+    bulk.insert({_id: i, a: i, b: i % 3});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(coll.createIndex({a: 1}));
+
+function getKeysExamined(cmd) {
+    const explain = assert.commandWorked(testDb.runCommand({explain: cmd}));
+    return explain.executionStats.totalKeysExamined;
+}
+
+const cmds = [
+    {find: coll.getName(), filter: {a: {$gte: 10}}, limit: 5},
+    {find: coll.getName(), filter: {a: {$gte: 10}, b: {$ne: 1}}, limit: 5},
+    {find: coll.getName(), filter: {a: {$gte: 10}, b: {$ne: 1}}, skip: 3, limit: 5},
+    {find: coll.getName(), filter: {a: {$gte: 10}, b: 2}, projection: {_id: 0, b: 1}, limit: 2},
+    {count: coll.getName(), query: {a: {$gte: 10}, b: 2}, limit: 4},
+    {update: coll.getName(), updates: [{q: {a: {$gte: 10}, b: 2}, u: {$inc: {c: 1}}}]},
+    {delete: coll.getName(), deletes: [{q: {a: {$gte: 10}, b: 2}, limit: 1}]},
+];
+
+const expected = cmds.map(getKeysExamined);
+const expectedDocs = coll.find({a: {$gte: 10}, b: {$ne: 1}}).hint({a: 1}).toArray();
+
+assert.commandWorked(testDb.adminCommand({setParameter: 1, internalQueryFetchBatchSize: 16}));
+for (let i = 0; i < cmds.length; ++i) {
+    assert.eq(expected[i], getKeysExamined(cmds[i]), cmds[i]);
+}
+
+// The results are returned in the order of the index, whatever the size of the batches.
+assert.eq(expectedDocs, coll.find({a: {$gte: 10}, b: {$ne: 1}}).hint({a: 1}).toArray());
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,81 @@
+/**
+ * Test that a node started with 'fileCopyInitialSyncSource' and an empty dbpath copies the data
+ * files of its sync source instead of running a logical initial sync, and that it catches up with
+ * the writes done after the copy. Also reports how long it takes to add a node with each kind of
+ * initial sync, for a collection with many indexes.
+ * @tags: [
+ *   requires_persistence,
+ *   requires_replication,
+ *   requires_wiredtiger,
+ * ]
+ */
+(function() {
+"use strict";
+
+const kNumDocs = 20000;
+const kNumIndexes = 10;
+
+const rst = new ReplSetTest({nodes: 1});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const testDb = primary.getDB("test");
+
+const bulk = testDb.coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    const doc = {_id: i};
+    for (let j = 0; j < kNumIndexes; ++j) {
+        doc["f" + j] = (i * (j + 1)) % 1000 + "-" + i;
+    }
+    bulk.insert(doc);
+}
+assert.commandWorked(bulk.execute());
+for (let j = 0; j < kNumIndexes; ++j) {
+    assert.commandWorked(testDb.coll.createIndex({["f" + j]: 1}));
+}
+assert.commandWorked(testDb.other.insert({_id: 0}));
+
+// Adds a node with the given startup parameters and returns how long it took to become secondary.
+function addSecondary(setParameter) {
+    const start = Date.now();
+    const node = rst.add({rsConfig: {votes: 0, priority: 0}, setParameter: setParameter});
+    rst.reInitiate();
+    rst.waitForState(node, ReplSetTest.State.SECONDARY);
+    return {node: node, millis: Date.now() - start};
+}
+
+const fileCopy = addSecondary({
+    fileCopyInitialSyncSource: primary.host,
+    fileCopyInitialSyncParallelism: 2,
+    // Small chunks make the larger files be copied in several requests.
+    fileCopyInitialSyncChunkSizeBytes: 64 * 1024,
+});
+checkLog.containsJson(fileCopy.node, 5190951);
+
+// The backup cursor of the sync source is closed once the files have been copied.
+checkLog.containsJson(primary, 5190942);
+
+// The writes done after the copy are replicated to the node.
+assert.commandWorked(testDb.other.insert({_id: 1}));
+rst.awaitReplication();
+
+fileCopy.node.setSecondaryOk();
+const fileCopyDb = fileCopy.node.getDB("test");
+assert.eq(kNumDocs, fileCopyDb.coll.find().itcount());
+assert.eq(kNumIndexes + 1, fileCopyDb.coll.getIndexes().length);
+assert.eq(kNumDocs, fileCopyDb.coll.find().hint({f3: 1}).itcount());
+assert.eq(2, fileCopyDb.other.find().itcount());
+
+// A node restarted with the same parameter keeps its data, as its dbpath is no longer empty.
+rst.restart(fileCopy.node);
+rst.waitForState(fileCopy.node, ReplSetTest.State.SECONDARY);
+checkLog.containsJson(fileCopy.node, 5190949);
+
+const logical = addSecondary({});
+jsTestLog("Time to add a secondary, in milliseconds: " +
+          tojson({fileCopy: fileCopy.millis, logical: logical.millis}));
+
+// Checks that the data of the secondaries matches the primary's.
+rst.stopSet();
+})();
@@ -0,0 +1,58 @@
+/**
+ * Test that the backup cursor opened for a node copying the data files of this node is closed once
+ * that node stops asking for its files, without waiting for another node to ask for them.
+ * @tags: [
+ *   requires_persistence,
+ *   requires_replication,
+ *   requires_wiredtiger,
+ * ]
+ */
+(function() {
+"use strict";
+
+const rst = new ReplSetTest({nodes: 1});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const adminDb = primary.getDB("admin");
+assert.commandWorked(primary.getDB("test").coll.insert({_id: 0}));
+
+function readFirstFile(backup) {
+    const file = backup.files[0];
+    return adminDb.runCommand({
+        _replReadBackupFile: 1,
+        backupId: backup.backupId,
+        filename: file.filename,
+        offset: NumberLong(0),
+        length: NumberLong(Math.max(file.fileSize, 1)),
+    });
+}
+
+// A backup which is still being read is not closed.
+const backup = assert.commandWorked(adminDb.runCommand({_replOpenBackupFiles: 1}));
+assert.gt(backup.files.length, 0, backup);
+assert.commandWorked(readFirstFile(backup));
+
+// Once the node copying the files is gone, nothing asks for the backup again and the periodic job
+// closes it.
+assert.commandWorked(
+    adminDb.runCommand({setParameter: 1, fileCopyInitialSyncIdleBackupTimeoutSecs: 1}));
+assert.soon(() => {
+    const res = readFirstFile(backup);
+    if (res.ok) {
+        return false;
+    }
+    assert.commandFailedWithCode(res, ErrorCodes.NoSuchSession);
+    return true;
+});
+checkLog.containsJson(primary, 5190959);
+
+// The checkpoint is no longer pinned, so a new backup cursor can be opened right away.
+const newBackup = assert.commandWorked(adminDb.runCommand({_replOpenBackupFiles: 1}));
+assert.commandWorked(readFirstFile(newBackup));
+assert.commandWorked(
+    adminDb.runCommand({_replCloseBackupFiles: 1, backupId: newBackup.backupId}));
+
+rst.stopSet();
+})();
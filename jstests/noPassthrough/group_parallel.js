@@ -0,0 +1,143 @@
+/**
+ * Test that $group spreads its input across several threads when
+ * 'internalDocumentSourceGroupParallelWorkers' is greater than one, and that it returns the same
+ * results as when it runs on a single thread.
+ */
+(function() {
+"use strict";
+
+const kNumDocs = 5000;
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalDocumentSourceGroupParallelWorkers: 4,
+        internalDocumentSourceGroupParallelMinDocs: 100,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const coll = testDb.group_parallel;
+coll.drop();
+
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, a: i % 13, b: i % 7, c: i, sub: {x: i % 5, y: [i % 3, i % 4]}});
+}
+assert.commandWorked(bulk.execute());
+
+function setParameters(params) {
+    assert.commandWorked(testDb.adminCommand(Object.assign({setParameter: 1}, params)));
+}
+
+function sortById(docs) {
+    return docs.sort((x, y) => bsonWoCompare({_id: x._id}, {_id: y._id}));
+}
+
+const simplePipeline = [{
+    $group: {
+        _id: "$a",
+        count: {$sum: 1},
+        sum: {$sum: "$c"},
+        avg: {$avg: "$c"},
+        max: {$max: "$sub"},
+        stdDev: {$stdDevPop: "$c"},
+    }
+}];
+
+// The accumulators depending on the order of the input must see it in the same order.
+const orderedPipeline = [
+    {$sort: {c: -1}},
+    {
+        $group: {
+            _id: {a: "$a", b: "$b"},
+            first: {$first: "$c"},
+            last: {$last: "$sub"},
+            push: {$push: "$c"},
+        }
+    }
+];
+
+const nestedPipeline = [
+    {$unwind: "$sub.y"},
+    {
+        $group: {
+            _id: "$sub.y",
+            set: {$addToSet: "$sub.x"},
+            merged: {$mergeObjects: "$sub"},
+            fields: {$sum: {$size: {$objectToArray: "$$ROOT"}}},
+        }
+    }
+];
+
+function runGroups(options = {}) {
+    return {
+        simple: sortById(coll.aggregate(simplePipeline, options).toArray()),
+        ordered: sortById(coll.aggregate(orderedPipeline, options).toArray()),
+        nested: sortById(coll.aggregate(nestedPipeline, options).toArray()),
+    };
+}
+
+const parallelResults = runGroups();
+assert.eq(13, parallelResults.simple.length);
+assert.eq(kNumDocs, parallelResults.simple.reduce((total, doc) => total + doc.count, 0));
+assert.eq(13 * 7, parallelResults.ordered.length);
+
+// The same holds when the workers run out of memory and the rest of the input is spilled.
+setParameters({internalDocumentSourceGroupMaxMemoryBytes: 64 * 1024});
+assert.eq(runGroups({allowDiskUse: true}), parallelResults);
+setParameters({internalDocumentSourceGroupMaxMemoryBytes: 100 * 1024 * 1024});
+
+// Groups using JavaScript are accumulated on a single thread.
+const jsPipeline = [{
+    $group: {
+        _id: {$function: {body: "function(c) { return c % 2; }", args: ["$c"], lang: "js"}},
+        count: {$sum: 1},
+    }
+}];
+assert.eq([{_id: 0, count: kNumDocs / 2}, {_id: 1, count: kNumDocs / 2}],
+          sortById(coll.aggregate(jsPipeline).toArray()));
+
+// Groups reading variables which hold documents, or using the random generator, are accumulated on
+// a single thread as well.
+assert.eq([{_id: 1, count: kNumDocs}],
+          coll.aggregate([{$group: {_id: "$$obj.k", count: {$sum: 1}}}], {let: {obj: {k: 1}}})
+              .toArray());
+const randPipeline = [{$group: {_id: null, count: {$sum: {$add: [1, {$floor: {$rand: {}}}]}}}}];
+assert.eq([{_id: null, count: kNumDocs}], coll.aggregate(randPipeline).toArray());
+
+// The errors raised by the workers are reported to the client.
+setParameters({internalQueryMaxPushBytes: 1024, internalDocumentSourceGroupParallelMinDocs: 0});
+const pushAll = {$group: {_id: null, all: {$push: "$c"}}};
+assert.commandFailedWithCode(
+    testDb.runCommand({aggregate: coll.getName(), pipeline: [pushAll], cursor: {}}),
+    ErrorCodes.ExceededMemoryLimit);
+setParameters({internalQueryMaxPushBytes: 100 * 1024 * 1024});
+assert.eq(runGroups(), parallelResults);
+
+// Input documents too large to be handed over to the workers as BSON are accumulated on this
+// thread, along with the rest of the input.
+const bigColl = testDb.group_parallel_big;
+bigColl.drop();
+const bigString = "x".repeat(1024 * 1024);
+for (let i = 0; i < 4; ++i) {
+    assert.commandWorked(bigColl.insert({_id: i, a: i % 2, s: bigString}));
+}
+const bigFields = {};
+for (let i = 0; i < 17; ++i) {
+    bigFields["s" + i] = "$s";
+}
+const bigPipeline = [
+    {$addFields: bigFields},
+    {$group: {_id: "$a", count: {$sum: 1}, len: {$max: {$strLenBytes: "$s16"}}}},
+    {$sort: {_id: 1}}
+];
+assert.eq([{_id: 0, count: 2, len: bigString.length}, {_id: 1, count: 2, len: bigString.length}],
+          bigColl.aggregate(bigPipeline).toArray());
+
+// The results are the same when the group runs on a single thread.
+setParameters({internalDocumentSourceGroupParallelWorkers: 1});
+assert.eq(runGroups(), parallelResults);
+
+MongoRunner.stopMongod(conn);
+}());
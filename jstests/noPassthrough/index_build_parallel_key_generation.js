@@ -0,0 +1,100 @@
+/**
+ * Test that index builds which generate the keys of the scanned documents on several threads build
+ * the same indexes as builds which generate them on the thread scanning the collection, that they
+ * fail on the key generation errors of any thread, and that $currentOp reports their throughput.
+ * @tags: [requires_wiredtiger]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage.
+load("jstests/libs/fail_point_util.js");
+load("jstests/libs/parallel_shell_helpers.js");
+
+// Large enough for the keys to be generated on several threads.
+const kNumDocs = 20000;
+
+const conn = MongoRunner.runMongod({setParameter: {indexBuildKeyGenerationThreads: 4}});
+const testDB = conn.getDB("test");
+const coll = testDB.index_build_parallel_key_generation;
+
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    const doc = {_id: i, a: i % 100, b: kNumDocs - i, arr: [i, i + 1]};
+    if (i % 3 === 0) {
+        doc.p = i;
+    }
+    bulk.insert(doc);
+}
+assert.commandWorked(bulk.execute());
+
+const kIndexes = [
+    {key: {a: 1, b: 1}, name: "a_1_b_1"},
+    {key: {arr: 1}, name: "arr_1"},
+    {key: {p: 1}, name: "p_1", partialFilterExpression: {p: {$exists: true}}},
+];
+
+function buildIndexesAndCheck(numThreads) {
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, indexBuildKeyGenerationThreads: numThreads}));
+    assert.commandWorked(testDB.runCommand({createIndexes: coll.getName(), indexes: kIndexes}));
+
+    assert.eq(kNumDocs, coll.find().hint({a: 1, b: 1}).itcount());
+    assert.eq(kNumDocs, coll.find({arr: {$gte: 0}}).hint({arr: 1}).itcount());
+    assert.eq(Math.ceil(kNumDocs / 3), coll.find({p: {$exists: true}}).hint({p: 1}).itcount());
+
+    // The keys of all the threads are in order in the index.
+    const keys = coll.find({}, {_id: 0, a: 1, b: 1}).hint({a: 1, b: 1}).toArray();
+    for (let i = 1; i < keys.length; ++i) {
+        const prev = keys[i - 1];
+        const next = keys[i];
+        assert(prev.a < next.a || (prev.a === next.a && prev.b <= next.b), tojson([prev, next]));
+    }
+
+    const explain = coll.find({arr: 5}).hint({arr: 1}).explain();
+    const ixscan = getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN");
+    assert(ixscan.isMultiKey, tojson(explain));
+
+    const validateRes = assert.commandWorked(coll.validate({full: true}));
+    assert(validateRes.valid, tojson(validateRes));
+
+    assert.commandWorked(coll.dropIndexes(kIndexes.map(index => index.name)));
+}
+
+buildIndexesAndCheck(4);
+buildIndexesAndCheck(1);
+
+// The collection scan is held once most of the documents have been scanned, while the throughput
+// of the build is reported.
+assert.commandWorked(testDB.adminCommand({setParameter: 1, indexBuildKeyGenerationThreads: 4}));
+const hangAfterInsertion = configureFailPoint(
+    conn,
+    "hangIndexBuildDuringCollectionScanPhaseAfterInsertion",
+    {fieldsToMatch: {_id: kNumDocs - 100}});
+const awaitCreateIndex = startParallelShell(
+    funWithArgs(function(collName) {
+        assert.commandWorked(db[collName].createIndex({b: 1}));
+    }, coll.getName()), conn.port);
+hangAfterInsertion.wait();
+
+const ops = testDB.getSiblingDB("admin")
+                .aggregate([
+                    {$currentOp: {}},
+                    {$match: {msg: /^Index Build: scanning collection/}},
+                ])
+                .toArray();
+assert.eq(1, ops.length, ops);
+assert.gt(ops[0].progress.done, 0, ops);
+assert.gt(ops[0].progress.ratePerSec, 0, ops);
+hangAfterInsertion.off();
+awaitCreateIndex();
+assert.eq(kNumDocs, coll.find().hint({b: 1}).itcount());
+
+// A key generation error on any thread fails the index build.
+assert.commandWorked(coll.insert({_id: kNumDocs, loc: {type: "Point", coordinates: "invalid"}}));
+assert.commandFailedWithCode(coll.createIndex({loc: "2dsphere"}), 16755);
+assert.eq(2, coll.getIndexes().length);
+assert.commandWorked(coll.validate({full: true}));
+
+MongoRunner.stopMongod(conn);
+})();
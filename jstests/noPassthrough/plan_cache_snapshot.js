@@ -0,0 +1,117 @@
+/**
+ * Test that the primary snapshots the active plan cache entries to config.planCacheSnapshots, and
+ * that they are loaded back into the plan caches on restart unless their indexes have changed.
+ * Also reports the latency of the first run of each query after a restart, with and without the
+ * snapshots.
+ * @tags: [
+ *   requires_persistence,
+ *   requires_replication,
+ * ]
+ */
+(function() {
+"use strict";
+
+const kNumCollections = 20;
+const kNumDocs = 1000;
+
+const rst = new ReplSetTest({
+    nodes: 1,
+    nodeOptions: {setParameter: {internalQueryPlanCacheSnapshotIntervalSecs: 1}},
+});
+rst.startSet();
+rst.initiate();
+
+let primary = rst.getPrimary();
+let testDb = primary.getDB("test");
+const snapshots = primary.getDB("config").planCacheSnapshots;
+
+function runQuery(coll) {
+    return coll.find({a: 3, b: 13}).itcount();
+}
+
+function getActiveEntries(coll) {
+    return coll.aggregate([{$planCacheStats: {}}, {$match: {isActive: true}}]).toArray();
+}
+
+// Every collection gets an active plan cache entry for the same shape, which has to choose
+// between the indexes on 'a' and 'b'.
+for (let i = 0; i < kNumCollections; ++i) {
+    const coll = testDb["coll" + i];
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let j = 0; j < kNumDocs; ++j) {
+        bulk.insert({a: j % 10, b: j % 100, c: j});
+    }
+    assert.commandWorked(bulk.execute());
+    assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}]));
+    assert.eq(10, runQuery(coll));
+    assert.eq(10, runQuery(coll));
+    assert.eq(1, getActiveEntries(coll).length);
+}
+
+// The entry of this collection uses an index which is dropped once it has been snapshotted.
+const droppedIndexColl = testDb.dropped_index;
+for (let j = 0; j < kNumDocs; ++j) {
+    assert.commandWorked(droppedIndexColl.insert({a: j % 10, c: j}));
+}
+assert.commandWorked(droppedIndexColl.createIndexes([{a: 1}, {c: 1}]));
+for (let i = 0; i < 2; ++i) {
+    assert.eq(1, droppedIndexColl.find({a: 3, c: 13}).itcount());
+}
+
+assert.soon(() => snapshots.count() === kNumCollections + 1,
+            () => tojson(snapshots.find().toArray()));
+
+// Stop the snapshots, so that the entry of the dropped index survives until the restart.
+assert.commandWorked(
+    primary.adminCommand({setParameter: 1, internalQueryPlanCacheSnapshotIntervalSecs: 0}));
+assert.commandWorked(droppedIndexColl.dropIndex({c: 1}));
+assert.eq(kNumCollections + 1, snapshots.count());
+
+function percentile(samples, p) {
+    const sorted = samples.slice().sort((x, y) => x - y);
+    return sorted[Math.min(sorted.length - 1, Math.ceil(p * sorted.length) - 1)];
+}
+
+// Restarts the node and returns the latency of the first run of the query on each collection.
+function restartAndMeasureFirstRuns(expectWarmUp) {
+    rst.restart(0);
+    primary = rst.getPrimary();
+    testDb = primary.getDB("test");
+
+    if (expectWarmUp) {
+        for (let i = 0; i < kNumCollections; ++i) {
+            assert.soon(() => getActiveEntries(testDb["coll" + i]).length === 1);
+        }
+        // The plan of the dropped index no longer matches the catalog and is not loaded.
+        assert.eq(0, testDb.dropped_index.aggregate([{$planCacheStats: {}}]).itcount());
+    } else {
+        for (let i = 0; i < kNumCollections; ++i) {
+            assert.eq(0, getActiveEntries(testDb["coll" + i]).length);
+        }
+    }
+
+    const latencies = [];
+    for (let i = 0; i < kNumCollections; ++i) {
+        const start = Date.now();
+        assert.eq(10, runQuery(testDb["coll" + i]));
+        latencies.push(Date.now() - start);
+    }
+    return latencies;
+}
+
+const warmLatencies = restartAndMeasureFirstRuns(true);
+
+// Without the snapshots the first run of every query has to go through multi-planning again.
+assert.commandWorked(
+    primary.adminCommand({setParameter: 1, internalQueryPlanCacheSnapshotIntervalSecs: 0}));
+assert(primary.getDB("config").planCacheSnapshots.drop());
+const coldLatencies = restartAndMeasureFirstRuns(false);
+
+function summarize(latencies) {
+    return {p50: percentile(latencies, 0.5), p99: percentile(latencies, 0.99)};
+}
+jsTestLog("First run latency after restart, in milliseconds: " +
+          tojson({withWarmUp: summarize(warmLatencies), withoutWarmUp: summarize(coldLatencies)}));
+
+rst.stopSet();
+}());
@@ -0,0 +1,102 @@
+/**
+ * Test that SBE collection scans evaluate the numeric comparisons and the $exists predicates on
+ * top-level fields with a block prefilter when
+ * 'internalQuerySlotBasedExecutionEnableBlockPrefilter' is set, and that they return the same
+ * results as without it, whatever the types of the fields.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const isSBEEnabled = (() => {
+    const getParam = testDb.adminCommand({getParameter: 1, featureFlagSBE: 1});
+    return getParam.hasOwnProperty("featureFlagSBE") && getParam.featureFlagSBE.value;
+})();
+
+if (!isSBEEnabled) {
+    jsTestLog("Skipping test because SBE is not enabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDb.sbe_block_prefilter;
+coll.drop();
+
+// Enough documents to fill several blocks, most of them with numbers of a single type, and some
+// with values the kernels have to leave to the VM.
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 5000; ++i) {
+    bulk.insert({_id: i, a: i % 10, b: NumberLong(i % 7), c: {d: i % 3}});
+}
+const oddValues = [
+    [1, 7, 12],
+    [],
+    "5",
+    null,
+    NumberDecimal("6.5"),
+    NaN,
+    2.5,
+    {x: 1},
+    MinKey,
+    MaxKey,
+];
+oddValues.forEach((value, i) => {
+    assert.commandWorked(coll.insert({_id: "odd" + i, a: value, b: value}));
+});
+assert.commandWorked(coll.insert({_id: "missing"}));
+
+const queries = [
+    {a: {$gt: 5}},
+    {a: {$lte: 3}, b: {$exists: true}},
+    {a: 5},
+    {a: {$gte: 2.5}, b: {$lt: NumberLong(3)}},
+    {$and: [{a: {$lt: 8}}, {a: {$gt: 1}}, {"c.d": 1}]},
+    {a: {$exists: false}},
+    {a: {$gt: 5}, $or: [{b: 1}, {b: 2}]},
+];
+
+function runQueries() {
+    return queries.map(query => coll.find(query).sort({_id: 1}).toArray());
+}
+
+// Returns the stages named 'stageName' in the SBE explain output rooted at 'stage'.
+function getStages(stage, stageName) {
+    let stages = stage.stage === stageName ? [stage] : [];
+    const children = stage.inputStages || (stage.inputStage ? [stage.inputStage] : []);
+    for (let child of children) {
+        stages = stages.concat(getStages(child, stageName));
+    }
+    return stages;
+}
+
+function getBlockStages(query) {
+    return getStages(coll.find(query).explain("executionStats").executionStats.executionStages,
+                     "block");
+}
+
+const expected = runQueries();
+assert.eq(0, getBlockStages(queries[0]).length);
+
+assert.commandWorked(testDb.adminCommand(
+    {setParameter: 1, internalQuerySlotBasedExecutionEnableBlockPrefilter: true}));
+
+const results = runQueries();
+for (let i = 0; i < queries.length; ++i) {
+    assert.eq(expected[i], results[i], queries[i]);
+}
+
+// The blocks made of numbers of a single type are filtered by the kernels.
+const blocks = getBlockStages(queries[0]);
+assert.eq(1, blocks.length, blocks);
+assert.gt(blocks[0].numBlocks, 1, blocks);
+assert.lt(blocks[0].numFallbacks, blocks[0].numBlocks, blocks);
+
+// Filters with none of the predicates the kernels support are left alone.
+assert.eq(0, getBlockStages({"c.d": 1}).length);
+assert.eq(0, getBlockStages({a: "5"}).length);
+
+MongoRunner.stopMongod(conn);
+}());
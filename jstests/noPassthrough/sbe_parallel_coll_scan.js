@@ -0,0 +1,101 @@
+/**
+ * Test that unindexed collection scans in SBE are split across several threads via an exchange
+ * when 'internalQuerySlotBasedExecutionParallelScanDOP' is greater than one, that they return the
+ * same results as a single-threaded scan, and that the explain output reports the stats of every
+ * producer thread. Scans which ask for the natural order or run with a read concern stay
+ * single-threaded.
+ */
+(function() {
+"use strict";
+
+const kNumDocs = 5000;
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQuerySlotBasedExecutionParallelScanDOP: 4,
+        internalQuerySlotBasedExecutionParallelScanMinRecords: kNumDocs,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const isSBEEnabled = (() => {
+    const getParam = testDb.adminCommand({getParameter: 1, featureFlagSBE: 1});
+    return getParam.hasOwnProperty("featureFlagSBE") && getParam.featureFlagSBE.value;
+})();
+
+if (!isSBEEnabled) {
+    jsTestLog("Skipping test because SBE is not enabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDb.sbe_parallel_coll_scan;
+coll.drop();
+
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, a: i % 10, b: i});
+}
+assert.commandWorked(bulk.execute());
+
+function runQueries() {
+    return {
+        count: coll.find({a: {$gte: 5}}).itcount(),
+        sum: coll.aggregate([{$match: {a: {$lt: 3}}}, {$group: {_id: "$a", s: {$sum: "$b"}}}])
+                 .toArray()
+                 .sort((x, y) => x._id - y._id),
+        ids: coll.find({}, {_id: 1}).toArray().map(doc => doc._id).sort((x, y) => x - y),
+    };
+}
+
+// Returns the stages named 'stageName' in the SBE explain output rooted at 'stage'.
+function getStages(stage, stageName) {
+    let stages = stage.stage === stageName ? [stage] : [];
+    const children = stage.inputStages || (stage.inputStage ? [stage.inputStage] : []);
+    for (let child of children) {
+        stages = stages.concat(getStages(child, stageName));
+    }
+    return stages;
+}
+
+function getExchangeStages(cursor) {
+    return getStages(cursor.explain("executionStats").executionStats.executionStages, "exchange");
+}
+
+const exchanges = getExchangeStages(coll.find({a: {$gte: 5}}));
+assert.eq(1, exchanges.length, exchanges);
+const producers = getStages(exchanges[0], "exchangep");
+assert.eq(4, producers.length, exchanges);
+assert.eq(kNumDocs,
+          getStages(exchanges[0], "pscan").reduce((total, scan) => total + scan.advances, 0),
+          exchanges);
+
+// Scans which must return the documents in their natural order, or which run with a read concern
+// the producer threads would not see, are not split.
+assert.eq(0, getExchangeStages(coll.find({a: {$gte: 5}}).sort({$natural: 1})).length);
+assert.eq(0, getExchangeStages(coll.find({a: {$gte: 5}}).hint({$natural: -1})).length);
+assert.eq(0, getExchangeStages(coll.find({a: {$gte: 5}}).readConcern("available")).length);
+
+const parallelResults = runQueries();
+assert.eq(kNumDocs / 2, parallelResults.count);
+assert.eq(kNumDocs, parallelResults.ids.length);
+for (let i = 0; i < kNumDocs; ++i) {
+    assert.eq(i, parallelResults.ids[i]);
+}
+
+// Collections below the size threshold are still scanned by a single thread.
+assert.commandWorked(testDb.adminCommand(
+    {setParameter: 1, internalQuerySlotBasedExecutionParallelScanMinRecords: kNumDocs + 1}));
+const serialResults = runQueries();
+assert.eq(serialResults, parallelResults);
+
+// The same holds when the degree of parallelism is set back to one.
+assert.commandWorked(testDb.adminCommand(
+    {setParameter: 1, internalQuerySlotBasedExecutionParallelScanMinRecords: 0}));
+assert.commandWorked(
+    testDb.adminCommand({setParameter: 1, internalQuerySlotBasedExecutionParallelScanDOP: 1}));
+assert.eq(runQueries(), parallelResults);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,87 @@
+/**
+ * Test that queries hitting an active plan cache entry in SBE reuse the execution tree attached to
+ * the entry when they have the same shape, bound to the values of their parameters, and that the
+ * reuse is reported by $planCacheStats.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const isSBEEnabled = (() => {
+    const getParam = testDb.adminCommand({getParameter: 1, featureFlagSBE: 1});
+    return getParam.hasOwnProperty("featureFlagSBE") && getParam.featureFlagSBE.value;
+})();
+
+if (!isSBEEnabled) {
+    jsTestLog("Skipping test because SBE is not enabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDb.sbe_plan_cache_reuse_tree;
+coll.drop();
+
+for (let i = 0; i < 100; ++i) {
+    assert.commandWorked(coll.insert({a: i, b: i % 10}));
+}
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+function getSbePlanCacheStats() {
+    const entries = coll.aggregate([{$planCacheStats: {}}]).toArray();
+    assert.eq(1, entries.length, entries);
+    return entries[0].sbePlanCacheStats;
+}
+
+function assertSbePlanCacheStats({hits, misses, rebuilds}) {
+    const stats = getSbePlanCacheStats();
+    assert(stats, coll.aggregate([{$planCacheStats: {}}]).toArray());
+    assert.eq(hits, stats.hits, stats);
+    assert.eq(misses, stats.misses, stats);
+    assert.eq(rebuilds, stats.rebuilds, stats);
+    assert(stats.hasCachedPlanStageTree, stats);
+    assert(stats.isParameterized, stats);
+}
+
+function runQuery(value, limit = 0) {
+    return coll.find({a: value, b: value % 10}, {_id: 0}).limit(limit).toArray();
+}
+
+// The first two runs create an inactive cache entry and then activate it.
+assert.eq([{a: 5, b: 5}], runQuery(5));
+assert.eq([{a: 5, b: 5}], runQuery(5));
+assert.eq(undefined, getSbePlanCacheStats());
+
+// The first query to hit the active entry has to build the tree, which it then attaches to it.
+assert.eq([{a: 5, b: 5}], runQuery(5));
+assertSbePlanCacheStats({hits: 0, misses: 1, rebuilds: 0});
+
+// Subsequent queries with the same parameters reuse the attached tree.
+assert.eq([{a: 5, b: 5}], runQuery(5));
+assert.eq([{a: 5, b: 5}], runQuery(5));
+assertSbePlanCacheStats({hits: 2, misses: 1, rebuilds: 0});
+
+// Queries with other parameters reuse it as well, bound to their own index bounds and filter.
+assert.eq([{a: 7, b: 7}], runQuery(7));
+assert.eq([{a: 42, b: 2}], runQuery(42));
+assert.eq([], runQuery(1000));
+assertSbePlanCacheStats({hits: 5, misses: 1, rebuilds: 0});
+
+// The tree gets a copy of the runtime environment per query, so the values bound for one query
+// do not leak into the next one.
+assert.eq([{a: 5, b: 5}], runQuery(5));
+assertSbePlanCacheStats({hits: 6, misses: 1, rebuilds: 0});
+
+// Queries of the same shape whose find command differs otherwise have to rebuild the tree.
+assert.eq([{a: 7, b: 7}], runQuery(7, 1));
+assertSbePlanCacheStats({hits: 6, misses: 1, rebuilds: 1});
+
+// Clearing the plan cache drops the attached tree along with the entry.
+coll.getPlanCache().clear();
+assert.eq(0, coll.aggregate([{$planCacheStats: {}}]).itcount());
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,110 @@
+/**
+ * Tests that time-series buckets are rewritten in the compressed format once they are closed when
+ * 'timeseriesCompressClosedBuckets' is enabled, and that queries return the same measurements from
+ * compressed and uncompressed buckets.
+ * @tags: [
+ *     requires_replication,
+ * ]
+ */
+(function() {
+"use strict";
+
+load("jstests/core/timeseries/libs/timeseries.js");
+
+const conn = MongoRunner.runMongod({setParameter: {timeseriesCompressClosedBuckets: true}});
+
+if (!TimeseriesTest.timeseriesCollectionsEnabled(conn)) {
+    jsTestLog("Skipping test because the time-series collection feature flag is disabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const testDB = conn.getDB(jsTestName());
+assert.commandWorked(testDB.dropDatabase());
+
+const timeFieldName = 'time';
+const metaFieldName = 'meta';
+
+// Enough measurements to fill two buckets, which are closed, and leave a third one open.
+const numMeasurements = 2500;
+const startTime = ISODate("2021-01-01T00:00:00Z").getTime();
+
+const measurements = [];
+for (let i = 0; i < numMeasurements; ++i) {
+    const doc = {_id: i, [timeFieldName]: new Date(startTime + i * 1000), [metaFieldName]: 1};
+    doc.counter = NumberLong(i * 3);
+    doc.gauge = Math.floor(i / 100);
+    if (i % 7 == 0) {
+        doc.sparse = "value" + i;
+    }
+    measurements.push(doc);
+}
+
+function insertAndQuery(collName) {
+    const coll = testDB.getCollection(collName);
+    assert.commandWorked(testDB.createCollection(
+        coll.getName(), {timeseries: {timeField: timeFieldName, metaField: metaFieldName}}));
+    assert.commandWorked(coll.insert(measurements, {ordered: false}));
+    return coll.find().sort({_id: 1}).toArray();
+}
+
+const compressedResults = insertAndQuery('compressed');
+const bucketsColl = testDB.getCollection('system.buckets.compressed');
+const buckets = bucketsColl.find().toArray();
+assert.eq(3, buckets.length, buckets);
+assert.eq(2, bucketsColl.find({'control.version': 2}).itcount(), buckets);
+assert.eq(1, bucketsColl.find({'control.version': 1}).itcount(), buckets);
+for (const bucket of bucketsColl.find({'control.version': 2}).toArray()) {
+    for (const column of Object.values(bucket.data)) {
+        assert(column instanceof BinData, tojson(bucket));
+    }
+}
+
+// Buckets are left uncompressed when the parameter is disabled.
+assert.commandWorked(
+    testDB.adminCommand({setParameter: 1, timeseriesCompressClosedBuckets: false}));
+const uncompressedResults = insertAndQuery('uncompressed');
+assert.eq(
+    0, testDB.getCollection('system.buckets.uncompressed').find({'control.version': 2}).itcount());
+
+assert.eq(numMeasurements, compressedResults.length);
+assert.eq(uncompressedResults, compressedResults);
+for (let i = 0; i < numMeasurements; ++i) {
+    assert.eq(measurements[i].counter, compressedResults[i].counter, compressedResults[i]);
+    assert.eq(measurements[i].sparse, compressedResults[i].sparse, compressedResults[i]);
+}
+
+MongoRunner.stopMongod(conn);
+
+// The buckets closed by retryable writes are compressed as well, outside of their transaction
+// number, and retrying a write does not insert its measurement again.
+const rst = new ReplSetTest(
+    {nodes: 1, nodeOptions: {setParameter: {timeseriesCompressClosedBuckets: true}}});
+rst.startSet();
+rst.initiate();
+
+const session = rst.getPrimary().startSession();
+const sessionDB = session.getDatabase(jsTestName());
+const retryableColl = sessionDB.getCollection('retryable');
+assert.commandWorked(sessionDB.createCollection(
+    retryableColl.getName(), {timeseries: {timeField: timeFieldName, metaField: metaFieldName}}));
+
+// Retryable time-series inserts are limited to one measurement.
+const insertMeasurement = (txnNumber) => sessionDB.runCommand({
+    insert: retryableColl.getName(),
+    documents: [measurements[txnNumber]],
+    lsid: session.getSessionId(),
+    txnNumber: NumberLong(txnNumber),
+});
+for (let i = 0; i < numMeasurements; ++i) {
+    assert.commandWorked(insertMeasurement(i));
+}
+assert.commandWorked(insertMeasurement(numMeasurements - 1));
+
+const retryableBucketsColl = sessionDB.getCollection('system.buckets.retryable');
+assert.eq(2, retryableBucketsColl.find({'control.version': 2}).itcount());
+assert.eq(compressedResults, retryableColl.find().sort({_id: 1}).toArray());
+
+session.endSession();
+rst.stopSet();
+}());
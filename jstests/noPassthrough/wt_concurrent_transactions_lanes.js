@@ -0,0 +1,61 @@
+/**
+ * Test that serverStatus reports the per-lane ticket statistics of WiredTiger, and that the ratio
+ * of tickets available to long-running operations and the adaptive sizing can be set at runtime.
+ * @tags: [
+ *   requires_wiredtiger,
+ * ]
+ */
+(function() {
+'use strict';
+
+const conn = MongoRunner.runMongod(
+    {setParameter: {wiredTigerConcurrentTransactionsLongLaneRatio: 0.25}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDb = conn.getDB("test");
+const coll = testDb.wt_concurrent_transactions_lanes;
+for (let i = 0; i < 10; ++i) {
+    assert.commandWorked(coll.insert({_id: i}));
+}
+assert.eq(10, coll.find().itcount());
+
+const stats = assert.commandWorked(testDb.serverStatus()).wiredTiger.concurrentTransactions;
+for (let kind of ["read", "write"]) {
+    assert.eq(0, stats[kind].queued, stats);
+    for (let lane of ["internal", "short", "long"]) {
+        const laneStats = stats[kind].lanes[lane];
+        assert(laneStats, stats);
+        assert.gte(laneStats.out, 0, stats);
+        assert.gte(laneStats.totalWaits, 0, stats);
+        assert.gte(laneStats.totalTimeQueuedMicros, 0, stats);
+    }
+}
+
+assert.commandFailed(
+    testDb.adminCommand({setParameter: 1, wiredTigerConcurrentTransactionsLongLaneRatio: 0}));
+assert.commandFailed(
+    testDb.adminCommand({setParameter: 1, wiredTigerConcurrentTransactionsLongLaneRatio: 1.5}));
+assert.commandWorked(
+    testDb.adminCommand({setParameter: 1, wiredTigerConcurrentTransactionsLongLaneRatio: 1}));
+
+// The ticket counts are still bounded the way they were when they were backed by semaphores.
+assert.commandFailed(
+    testDb.adminCommand({setParameter: 1, wiredTigerConcurrentReadTransactions: 4}));
+assert.commandFailed(
+    testDb.adminCommand({setParameter: 1, wiredTigerConcurrentTransactionsAdaptiveMin: 4}));
+
+// With adaptive sizing the ticket counts are brought within the configured bounds.
+assert.commandWorked(testDb.adminCommand({
+    setParameter: 1,
+    wiredTigerConcurrentTransactionsAdaptiveMin: 8,
+    wiredTigerConcurrentTransactionsAdaptiveMax: 32,
+}));
+assert.commandWorked(
+    testDb.adminCommand({setParameter: 1, wiredTigerConcurrentTransactionsAdaptiveSizing: true}));
+assert.soon(() => {
+    const stats = testDb.serverStatus().wiredTiger.concurrentTransactions;
+    return stats.read.totalTickets <= 32 && stats.write.totalTickets <= 32;
+});
+
+MongoRunner.stopMongod(conn);
+}());
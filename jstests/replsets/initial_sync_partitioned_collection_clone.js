@@ -0,0 +1,75 @@
+/**
+ * Test that initial sync clones a large collection with concurrent cursors over ranges of its _id
+ * index, that replSetGetStatus reports the progress of the ranges, and that collections which
+ * depend on the order of their documents are still cloned with a single cursor.
+ *
+ * @tags: [requires_fcv_49]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/fail_point_util.js");
+
+const kNumDocs = 5000;
+
+const name = "initial_sync_partitioned_collection_clone";
+const rst = new ReplSetTest({name: name, nodes: 1});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const testDb = primary.getDB("test");
+
+// The _id values are of several types, which the ranges of the _id index must cover.
+let bulk = testDb.large.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i % 3 === 0 ? i : (i % 3 === 1 ? "id" + i : ObjectId()), x: i});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(testDb.large.createIndex({x: 1}));
+
+assert.commandWorked(testDb.createCollection("capped", {capped: true, size: 1024 * 1024}));
+bulk = testDb.capped.initializeOrderedBulkOp();
+for (let i = 0; i < 1000; ++i) {
+    bulk.insert({_id: kNumDocs - i});
+}
+assert.commandWorked(bulk.execute());
+
+const secondary = rst.add({
+    rsConfig: {votes: 0, priority: 0},
+    setParameter: {
+        collectionClonerParallelism: 4,
+        collectionClonerMinBytesToPartition: 0,
+        collectionClonerBatchSize: 100,
+    }
+});
+const failPointBeforeFinish = configureFailPoint(secondary, "initialSyncHangBeforeFinish");
+rst.reInitiate();
+failPointBeforeFinish.wait();
+
+const status = assert.commandWorked(secondary.adminCommand({replSetGetStatus: 1}));
+const dbStatus = status.initialSyncStatus.databases.test;
+jsTestLog("Initial sync status of the test database: " + tojson(dbStatus));
+
+const largeStatus = dbStatus["test.large"];
+assert.eq(kNumDocs, largeStatus.documentsCopied, largeStatus);
+assert.gt(largeStatus.partitions, 1, largeStatus);
+assert.eq(largeStatus.partitions, largeStatus.partitionsCopied, largeStatus);
+
+// Capped collections are cloned in their natural order, with a single cursor.
+const cappedStatus = dbStatus["test.capped"];
+assert.eq(1000, cappedStatus.documentsCopied, cappedStatus);
+assert(!cappedStatus.hasOwnProperty("partitions"), cappedStatus);
+
+failPointBeforeFinish.off();
+rst.waitForState(secondary, ReplSetTest.State.SECONDARY);
+
+secondary.setSecondaryOk();
+const secondaryDb = secondary.getDB("test");
+assert.eq(kNumDocs, secondaryDb.large.find().itcount());
+assert.eq(kNumDocs, secondaryDb.large.find().hint({x: 1}).itcount());
+assert.eq(testDb.capped.find().toArray(), secondaryDb.capped.find().toArray());
+
+// Checks that the data of the secondary matches the primary's.
+rst.stopSet();
+})();
@@ -0,0 +1,83 @@
+/**
+ * Test that a secondary with 'replPrefetchBeforeApply' enabled reads the documents which the
+ * updates and deletes of a batch look up by _id ahead of their application, and that serverStatus
+ * reports how many of them were read before the batch was applied.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/fail_point_util.js");
+
+const kNumDocs = 1000;
+
+const name = "oplog_application_prefetch";
+const rst = new ReplSetTest({
+    name: name,
+    nodes: [{}, {rsConfig: {priority: 0}, setParameter: {replPrefetchBeforeApply: true}}],
+    // Keeps the batch held below from being one of periodic no-op writes.
+    nodeOptions: {setParameter: {writePeriodicNoops: false}},
+});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const secondary = rst.getSecondary();
+const coll = primary.getDB(name).coll;
+
+function getPrefetchMetrics() {
+    return assert.commandWorked(secondary.adminCommand({serverStatus: 1}))
+        .metrics.repl.apply.prefetch;
+}
+
+let bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, x: 0});
+}
+assert.commandWorked(bulk.execute());
+rst.awaitReplication();
+
+// Inserts do not look documents up, so there is nothing to prefetch for them.
+const metricsBefore = getPrefetchMetrics();
+assert.eq(0, metricsBefore.documents, metricsBefore);
+assert.eq(0, metricsBefore.hitRate, metricsBefore);
+
+// Holds the batch of updates after its oplog entries are written, before it is applied, which
+// leaves the prefetch threads time to read all of its documents.
+const pauseBeforeApply =
+    configureFailPoint(secondary, "pauseBatchApplicationAfterWritingOplogEntries");
+bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.find({_id: i}).updateOne({$inc: {x: 1}});
+}
+assert.commandWorked(bulk.execute());
+pauseBeforeApply.wait();
+
+// The updates may be applied in several batches, the first of which is held.
+assert.soon(() => {
+    const metrics = getPrefetchMetrics();
+    return metrics.documents > 0 && metrics.readyBeforeApply === metrics.documents;
+}, () => tojson(getPrefetchMetrics()));
+pauseBeforeApply.off();
+rst.awaitReplication();
+
+const metricsAfter = getPrefetchMetrics();
+jsTestLog("Oplog application prefetch metrics: " + tojson(metricsAfter));
+assert.eq(kNumDocs, metricsAfter.documents, metricsAfter);
+assert.gt(metricsAfter.found, 0, metricsAfter);
+assert.lte(metricsAfter.found + metricsAfter.skipped, kNumDocs, metricsAfter);
+assert.gt(metricsAfter.hitRate, 0, metricsAfter);
+assert.lte(metricsAfter.hitRate, 1, metricsAfter);
+
+// Without prefetching, deletes are applied all the same and no more documents are read ahead.
+assert.commandWorked(secondary.adminCommand({setParameter: 1, replPrefetchBeforeApply: false}));
+assert.commandWorked(coll.remove({_id: {$lt: kNumDocs / 2}}));
+rst.awaitReplication();
+assert.eq(metricsAfter.documents, getPrefetchMetrics().documents);
+
+secondary.setSecondaryOk();
+assert.eq(kNumDocs / 2, secondary.getDB(name).coll.find().itcount());
+assert.eq(kNumDocs / 2, secondary.getDB(name).coll.find({x: 1}).itcount());
+
+// Checks that the data of the secondary matches the primary's.
+rst.stopSet();
+})();
@@ -0,0 +1,74 @@
+/**
+ * Test that serverStatus reports the time spent in each stage of oplog application on a secondary,
+ * and that the secondary applies the same writes whether or not the next batch is prepared while
+ * the current one is applied.
+ */
+(function() {
+"use strict";
+
+const name = "oplog_application_stages";
+const rst = new ReplSetTest({
+    name: name,
+    nodes: [{}, {rsConfig: {priority: 0}}],
+    // Small batches make the secondary go through many batches for the writes below.
+    nodeOptions: {setParameter: {replBatchLimitOperations: 50}},
+});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const secondary = rst.getSecondary();
+const coll = primary.getDB(name).coll;
+
+function getStages() {
+    return assert.commandWorked(secondary.adminCommand({serverStatus: 1}))
+        .metrics.repl.apply.stages;
+}
+
+function runWrites(start, num) {
+    let bulk = coll.initializeUnorderedBulkOp();
+    for (let i = start; i < start + num; ++i) {
+        bulk.insert({_id: i, a: i % 10});
+    }
+    assert.commandWorked(bulk.execute());
+
+    // A command in the middle of the writes is applied in a batch of its own.
+    assert.commandWorked(coll.createIndex({a: 1}));
+
+    bulk = coll.initializeUnorderedBulkOp();
+    for (let i = start; i < start + num; ++i) {
+        bulk.find({_id: i}).updateOne({$inc: {a: 1}});
+    }
+    assert.commandWorked(bulk.execute());
+    assert.commandWorked(coll.dropIndex({a: 1}));
+    rst.awaitReplication();
+}
+
+const stagesBefore = getStages();
+for (let stage of ["prepare", "writeOplog", "apply", "finalize"]) {
+    assert.gte(stagesBefore[stage].num, 0, stagesBefore);
+    assert.gte(stagesBefore[stage].totalMillis, 0, stagesBefore);
+}
+
+runWrites(0, 5000);
+
+const stagesAfter = getStages();
+jsTestLog("Oplog application stages: " + tojson(stagesAfter));
+for (let stage of ["prepare", "writeOplog", "apply", "finalize"]) {
+    assert.gt(stagesAfter[stage].num, stagesBefore[stage].num, stagesAfter);
+    assert.gte(stagesAfter[stage].totalMillis, stagesBefore[stage].totalMillis, stagesAfter);
+}
+assert.gte(stagesAfter.preparedAhead, stagesBefore.preparedAhead, stagesAfter);
+
+// Without preparing the next batch ahead, no more batches are reported as prepared ahead.
+assert.commandWorked(
+    secondary.adminCommand({setParameter: 1, replPrepareNextBatchWhileApplying: false}));
+runWrites(5000, 5000);
+assert.eq(stagesAfter.preparedAhead, getStages().preparedAhead);
+
+secondary.setSecondaryOk();
+assert.eq(10000, secondary.getDB(name).coll.find().itcount());
+
+// Checks that the data of the secondary matches the primary's.
+rst.stopSet();
+})();
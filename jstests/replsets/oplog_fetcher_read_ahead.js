@@ -0,0 +1,62 @@
+/**
+ * Test that the oplog fetcher of a secondary which is behind its sync source receives the next
+ * batch while the current one is processed, and that serverStatus reports the fetch throughput
+ * and the occupancy of the oplog buffer.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/fail_point_util.js");
+
+const name = "oplog_fetcher_read_ahead";
+const rst = new ReplSetTest({
+    name: name,
+    nodes: [{}, {rsConfig: {priority: 0}}],
+    // Small batches make the secondary go through many batches to catch up.
+    nodeOptions: {setParameter: {bgSyncOplogFetcherBatchSize: 20}},
+});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const secondary = rst.getSecondary();
+const coll = primary.getDB(name).coll;
+
+function getNetworkMetrics() {
+    return assert.commandWorked(secondary.adminCommand({serverStatus: 1})).metrics.repl.network;
+}
+
+const metricsBefore = getNetworkMetrics();
+assert.gte(metricsBefore.throughputBytesPerSec, 0, metricsBefore);
+assert.gte(metricsBefore.bufferOccupancy, 0, metricsBefore);
+assert.lte(metricsBefore.bufferOccupancy, 1, metricsBefore);
+
+// Makes the secondary fall behind by the writes of a few seconds, and waits for it to catch up.
+let nextId = 0;
+function lagAndCatchUp() {
+    const stopFetching = configureFailPoint(secondary, "stopReplProducer");
+    const start = Date.now();
+    while (Date.now() - start < 3 * 1000) {
+        assert.commandWorked(coll.insert({_id: nextId++, x: "x".repeat(100)}));
+    }
+    stopFetching.off();
+    rst.awaitReplication();
+}
+
+lagAndCatchUp();
+const metricsAfter = getNetworkMetrics();
+jsTestLog("Oplog fetcher network metrics: " + tojson(metricsAfter));
+assert.gt(metricsAfter.readAheadBatches, metricsBefore.readAheadBatches, metricsAfter);
+assert.gte(metricsAfter.throughputBytesPerSec, 0, metricsAfter);
+
+// Without reading ahead, the secondary catches up all the same.
+assert.commandWorked(secondary.adminCommand({setParameter: 1, oplogFetcherReadAhead: false}));
+lagAndCatchUp();
+assert.eq(metricsAfter.readAheadBatches, getNetworkMetrics().readAheadBatches);
+
+secondary.setSecondaryOk();
+assert.eq(nextId, secondary.getDB(name).coll.find().itcount());
+
+// Checks that the data of the secondary matches the primary's.
+rst.stopSet();
+})();
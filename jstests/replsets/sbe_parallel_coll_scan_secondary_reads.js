@@ -0,0 +1,76 @@
+/**
+ * Tests that collection scans which SBE splits across several threads on a secondary only see the
+ * data at the last applied timestamp, like a single-threaded scan, even while a batch which has
+ * already written newer data is being applied.
+ *
+ * This test uses a failpoint to block right before batch application finishes, while holding the
+ * PBWM lock, and before advancing the last applied timestamp for readers.
+ */
+(function() {
+"use strict";
+
+load('jstests/replsets/libs/secondary_reads_test.js');
+
+const name = "sbeParallelCollScanSecondaryReads";
+const collName = "testColl";
+const kNumDocs = 1000;
+
+let secondaryReadsTest = new SecondaryReadsTest(name);
+
+let primaryDB = secondaryReadsTest.getPrimaryDB();
+let secondaryDB = secondaryReadsTest.getSecondaryDB();
+
+const isSBEEnabled = (() => {
+    const getParam = secondaryDB.adminCommand({getParameter: 1, featureFlagSBE: 1});
+    return getParam.hasOwnProperty("featureFlagSBE") && getParam.featureFlagSBE.value;
+})();
+
+if (!isSBEEnabled || !primaryDB.serverStatus().storageEngine.supportsSnapshotReadConcern) {
+    jsTestLog("Skipping test because SBE or snapshot reads are not supported");
+    secondaryReadsTest.stop();
+    return;
+}
+
+assert.commandWorked(secondaryDB.adminCommand({
+    setParameter: 1,
+    internalQuerySlotBasedExecutionParallelScanDOP: 4,
+    internalQuerySlotBasedExecutionParallelScanMinRecords: kNumDocs,
+}));
+
+let primaryColl = primaryDB.getCollection(collName);
+let secondaryColl = secondaryDB.getCollection(collName);
+
+const bulk = primaryColl.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, x: 0});
+}
+assert.commandWorked(bulk.execute());
+secondaryReadsTest.getReplset().awaitReplication();
+
+// The scan on the secondary is split across the producer threads of an exchange.
+const explain = secondaryColl.find({x: 0}).explain("executionStats");
+assert(JSON.stringify(explain.executionStats.executionStages).includes('"exchange"'), explain);
+assert.eq(kNumDocs, secondaryColl.find({x: 0}).itcount());
+
+// Prevent a batch from completing on the secondary.
+let pauseAwait = secondaryReadsTest.pauseSecondaryBatchApplication();
+
+assert.commandWorked(primaryColl.updateMany({}, {$set: {x: 1}}));
+assert.eq(kNumDocs, primaryColl.find({x: 1}).itcount());
+
+// Wait for the batch application to pause.
+pauseAwait();
+
+// Every producer reads at the last applied timestamp of the query, which the paused batch has not
+// advanced yet, so none of the updates is visible.
+assert.eq(kNumDocs, secondaryColl.find({x: 0}).itcount());
+assert.eq(0, secondaryColl.find({x: 1}).itcount());
+
+secondaryReadsTest.resumeSecondaryBatchApplication();
+secondaryReadsTest.getReplset().awaitReplication();
+
+assert.eq(0, secondaryColl.find({x: 0}).itcount());
+assert.eq(kNumDocs, secondaryColl.find({x: 1}).itcount());
+
+secondaryReadsTest.stop();
+})();
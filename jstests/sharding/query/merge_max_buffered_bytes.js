@@ -0,0 +1,75 @@
+/**
+ * Test that mongos bounds the batch size of the getMores of a sorted merge by
+ * 'mergeMaxBufferedBytesPerRemote' and by the number of results left to return, and that
+ * $currentOp reports the results buffered for an idle cursor.
+ * @tags: [requires_sharding, requires_profiling]
+ */
+(function() {
+"use strict";
+
+const kDocSize = 1024;
+
+const st = new ShardingTest({shards: 2});
+const kDBName = "test";
+const mongosDB = st.s.getDB(kDBName);
+const coll = mongosDB.merge_max_buffered_bytes;
+
+st.shardColl(coll, {_id: 1}, {_id: 0}, {_id: 0}, kDBName, true);
+
+const padding = "x".repeat(kDocSize);
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = -100; i < 100; ++i) {
+    bulk.insert({_id: i, padding: padding});
+}
+assert.commandWorked(bulk.execute());
+
+// No more than about four of the results fit in the buffer of each remote.
+assert.commandWorked(st.s.adminCommand({setParameter: 1, mergeMaxBufferedBytesPerRemote: 4500}));
+
+const shardDBs = [st.shard0.getDB(kDBName), st.shard1.getDB(kDBName)];
+for (let shardDB of shardDBs) {
+    assert.commandWorked(shardDB.setProfilingLevel(2));
+}
+
+function getMoreBatchSizes(comment) {
+    let batchSizes = [];
+    for (let shardDB of shardDBs) {
+        shardDB.system.profile
+            .find({
+                "command.getMore": {$exists: true},
+                $or: [{"command.comment": comment}, {"originatingCommand.comment": comment}]
+            })
+            .forEach(entry => batchSizes.push(entry.command.batchSize));
+    }
+    return batchSizes;
+}
+
+// The cursor is left idle with results of both shards buffered on mongos.
+const res = assert.commandWorked(mongosDB.runCommand(
+    {find: coll.getName(), sort: {_id: 1}, batchSize: 2, comment: "idle_cursor"}));
+const idleCursors = mongosDB.getSiblingDB("admin")
+                        .aggregate([
+                            {$currentOp: {idleCursors: true, localOps: true}},
+                            {$match: {"cursor.originatingCommand.comment": "idle_cursor"}}
+                        ])
+                        .toArray();
+assert.eq(1, idleCursors.length, idleCursors);
+assert.gt(idleCursors[0].cursor.mergeBufferedBytes, 0, idleCursors);
+assert.gte(idleCursors[0].cursor.mergeDocsPerSec, 0, idleCursors);
+assert.commandWorked(mongosDB.runCommand({killCursors: coll.getName(), cursors: [res.cursor.id]}));
+
+assert.eq(200, coll.find().sort({_id: 1}).comment("bounded_by_bytes").itcount());
+let batchSizes = getMoreBatchSizes("bounded_by_bytes");
+assert.gt(batchSizes.length, 0);
+batchSizes.forEach(batchSize => assert.lte(batchSize, 4, batchSizes));
+
+// A shard is never asked for more results than the limit leaves to return.
+assert.commandWorked(
+    st.s.adminCommand({setParameter: 1, mergeMaxBufferedBytesPerRemote: 16 * 1024 * 1024}));
+assert.eq(150, coll.find().sort({_id: 1}).limit(150).comment("bounded_by_limit").itcount());
+batchSizes = getMoreBatchSizes("bounded_by_limit");
+assert.gt(batchSizes.length, 0);
+batchSizes.forEach(batchSize => assert.lte(batchSize, 150, batchSizes));
+
+st.stop();
+})();
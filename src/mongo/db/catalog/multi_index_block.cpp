@@ -36,6 +36,7 @@
 #include <ostream>
 
 #include "mongo/base/error_codes.h"
+#include "mongo/base/init.h"
 #include "mongo/bson/simple_bsonelement_comparator.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/catalog/collection.h"
@@ -45,6 +46,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/multikey_paths.h"
+#include "mongo/db/index/skipped_record_tracker.h"
 #include "mongo/db/multi_key_path_tracker.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context.h"
@@ -59,7 +61,10 @@
 #include "mongo/db/storage/write_unit_of_work.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/future.h"
+#include "mongo/util/producer_consumer_queue.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/quick_exit.h"
 #include "mongo/util/scopeguard.h"
@@ -75,6 +80,270 @@ MONGO_FAIL_POINT_DEFINE(hangIndexBuildDuringCollectionScanPhaseBeforeInsertion);
 MONGO_FAIL_POINT_DEFINE(hangIndexBuildDuringCollectionScanPhaseAfterInsertion);
 MONGO_FAIL_POINT_DEFINE(leaveIndexBuildUnfinishedForShutdown);
 
+namespace {
+
+// The number of documents sent to a key generation thread of an index build at once, and the
+// number of such batches which may be waiting for each thread before the collection scan blocks.
+constexpr size_t kKeyGenerationBatchSize = 128;
+constexpr size_t kKeyGenerationMaxQueuedBatches = 4;
+
+// The keys of smaller collections are generated on the thread scanning the collection, as starting
+// the key generation threads and merging their keys would take about as long.
+constexpr long long kMinRecordsForParallelKeyGeneration = 10000;
+
+std::unique_ptr<ThreadPool> keyGenerationThreadPool;
+MONGO_INITIALIZER(IndexBuildKeyGenerationThreadPool)(InitializerContext* context) {
+    ThreadPool::Options options;
+    options.poolName = "index build key generation pool";
+    options.threadNamePrefix = "IndexBuildKeyGenerator";
+    options.minThreads = 0;
+    // The threads block on their queues until the index build feeding them is done scanning, so
+    // the pool must not make index builds wait for each other's threads.
+    options.maxThreads = ThreadPool::Options::kUnlimited;
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    keyGenerationThreadPool = std::make_unique<ThreadPool>(options);
+    keyGenerationThreadPool->startup();
+}
+
+/**
+ * Generates the keys of the documents scanned by an index build on several threads. Each thread
+ * inserts the keys it generates into BulkBuilders of its own, and these are merged into the
+ * BulkBuilders of the index build once the scan is done.
+ *
+ * The keys held in memory stay within the memory limit of the index build. The BulkBuilders of
+ * the index build receive no keys during the scan, while the threads split the limit between
+ * their BulkBuilders. The keys of these are then written to disk as they are merged, which leaves
+ * the whole limit to the BulkBuilders of the index build.
+ *
+ * The collection is still scanned by the thread running the index build, which holds its locks,
+ * yields and keeps track of the position from which the build may be resumed.
+ */
+class ParallelKeyGenerator {
+public:
+    struct Index {
+        IndexAccessMethod* accessMethod;
+        const MatchExpression* filterExpression;  // might be NULL
+        InsertDeleteOptions options;
+
+        // Receives the keys generated by the threads once the scan is done.
+        IndexAccessMethod::BulkBuilder* bulk;
+
+        // Records the documents whose key generation errors were suppressed. Might be NULL.
+        SkippedRecordTracker* skippedRecordTracker;
+    };
+
+    ParallelKeyGenerator(std::vector<Index> indexes,
+                         size_t numThreads,
+                         size_t maxMemoryUsageBytesPerIndex,
+                         StringData dbName)
+        : _indexes(std::move(indexes)) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            auto worker = std::make_unique<Worker>();
+            for (const auto& index : _indexes) {
+                worker->bulks.push_back(index.accessMethod->initiateBulk(
+                    maxMemoryUsageBytesPerIndex / numThreads, boost::none, dbName));
+            }
+            auto pf = makePromiseFuture<void>();
+            worker->done = std::move(pf.future);
+            keyGenerationThreadPool->schedule(
+                [this, worker = worker.get(), promise = std::move(pf.promise)](
+                    Status status) mutable {
+                    _run(worker, std::move(promise), std::move(status));
+                });
+            _workers.push_back(std::move(worker));
+        }
+    }
+
+    ~ParallelKeyGenerator() {
+        // The threads refer to this object, so they must be done before it is destroyed.
+        if (!_finished) {
+            for (auto&& worker : _workers) {
+                worker->queue.closeConsumerEnd();
+            }
+            for (auto&& worker : _workers) {
+                worker->done.getNoThrow().ignore();
+            }
+        }
+    }
+
+    /**
+     * Hands 'doc', which must be owned, over to the key generation threads, and sets
+     * 'lastRecordIdAdded' to 'loc' as soon as it is. Throws the error of a thread which has failed,
+     * or if 'opCtx' is interrupted, in which case finish() still generates the keys of 'doc'.
+     */
+    void add(OperationContext* opCtx,
+             BSONObj doc,
+             const RecordId& loc,
+             boost::optional<RecordId>* lastRecordIdAdded) {
+        _batch.emplace_back(std::move(doc), loc);
+        *lastRecordIdAdded = loc;
+        if (_batch.size() < kKeyGenerationBatchSize) {
+            return;
+        }
+
+        try {
+            _pushBatch(opCtx);
+        } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+            // A thread has failed and closed its queue.
+            uassertStatusOK(_waitForWorkers());
+            MONGO_UNREACHABLE;
+        }
+    }
+
+    /**
+     * Waits for the keys of all the documents added so far to be generated, and merges them into
+     * the BulkBuilders of the index build. The documents whose key generation errors were
+     * suppressed are recorded using 'opCtx'. Returns the same status if called again.
+     */
+    Status finish(OperationContext* opCtx) {
+        if (_finished) {
+            return _status;
+        }
+
+        // The batch is handed over even if 'opCtx' is interrupted, as the documents it holds
+        // are counted as scanned should the index build be resumed.
+        if (!_batch.empty()) {
+            try {
+                _pushBatch(Interruptible::notInterruptible());
+            } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+                // A thread has failed and closed its queue, its error is returned below.
+            }
+        }
+        if (!_waitForWorkers().isOK()) {
+            return _status;
+        }
+
+        try {
+            for (auto&& worker : _workers) {
+                for (const auto& skippedRecord : worker->skippedRecords) {
+                    auto skippedRecordTracker = _indexes[skippedRecord.first].skippedRecordTracker;
+                    if (skippedRecordTracker) {
+                        skippedRecordTracker->record(opCtx, skippedRecord.second);
+                    }
+                }
+                for (size_t i = 0; i < _indexes.size(); ++i) {
+                    _indexes[i].bulk->merge(std::move(worker->bulks[i]));
+                }
+            }
+        } catch (const DBException& ex) {
+            _status = ex.toStatus();
+        }
+        return _status;
+    }
+
+private:
+    // The documents of a batch, each with its RecordId.
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+    using Queue = SingleProducerSingleConsumerQueue<Batch>;
+
+    struct Worker {
+        Worker()
+            : queue([] {
+                  Queue::Options options;
+                  options.maxQueueDepth = kKeyGenerationMaxQueuedBatches;
+                  return options;
+              }()) {}
+
+        Queue queue;
+
+        // Only accessed by the thread until it is done. The BulkBuilders are in the order of the
+        // indexes, and the skipped records hold the position of their index.
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulks;
+        std::vector<std::pair<size_t, RecordId>> skippedRecords;
+
+        Future<void> done;
+    };
+
+    void _pushBatch(Interruptible* interruptible) {
+        // The batch is only moved from once it is in the queue, so it can be pushed again if this
+        // is interrupted.
+        _workers[_nextWorker]->queue.push(std::move(_batch), interruptible);
+        _batch.clear();
+        _nextWorker = (_nextWorker + 1) % _workers.size();
+    }
+
+    Status _waitForWorkers() {
+        if (_finished) {
+            return _status;
+        }
+        _finished = true;
+
+        for (auto&& worker : _workers) {
+            worker->queue.closeProducerEnd();
+        }
+        for (auto&& worker : _workers) {
+            auto status = worker->done.getNoThrow();
+            if (_status.isOK()) {
+                _status = std::move(status);
+            }
+        }
+        return _status;
+    }
+
+    void _run(Worker* worker, Promise<void> promise, Status status) {
+        if (status.isOK()) {
+            try {
+                _generateKeys(worker);
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+        }
+
+        // Closing the queue unblocks the collection scan if this thread has failed. This has to
+        // happen before the promise is fulfilled, after which 'worker' may be destroyed.
+        worker->queue.closeConsumerEnd();
+        if (status.isOK()) {
+            promise.emplaceValue();
+        } else {
+            promise.setError(status);
+        }
+    }
+
+    void _generateKeys(Worker* worker) {
+        auto opCtx = cc().makeOperationContext();
+
+        std::vector<IndexAccessMethod::BulkBuilder::RecordSkippedFn> onRecordSkipped;
+        for (size_t i = 0; i < _indexes.size(); ++i) {
+            onRecordSkipped.push_back([worker, i](const RecordId& loc) {
+                worker->skippedRecords.emplace_back(i, loc);
+            });
+        }
+
+        for (;;) {
+            Batch batch;
+            try {
+                batch = worker->queue.pop();
+            } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+                return;
+            }
+
+            for (const auto& docAndLoc : batch) {
+                const BSONObj& doc = docAndLoc.first;
+                for (size_t i = 0; i < _indexes.size(); ++i) {
+                    const auto& index = _indexes[i];
+                    if (index.filterExpression && !index.filterExpression->matchesBSON(doc)) {
+                        continue;
+                    }
+                    uassertStatusOK(worker->bulks[i]->insert(
+                        opCtx.get(), doc, docAndLoc.second, index.options, onRecordSkipped[i]));
+                }
+            }
+        }
+    }
+
+    const std::vector<Index> _indexes;
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // The documents which have not yet been handed over, and the thread which gets the next batch.
+    Batch _batch;
+    size_t _nextWorker = 0;
+
+    bool _finished = false;
+    Status _status = Status::OK();
+};
+
+}  // namespace
+
 MultiIndexBlock::~MultiIndexBlock() {
     invariant(_buildIsCleanedUp);
 }
@@ -445,6 +714,30 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
     bool readOnce = useReadOnceCursorsForIndexBuilds.load();
     opCtx->recoveryUnit()->setReadOnce(readOnce);
 
+    // Generate the keys of large collections on several threads, which share the memory of the
+    // index build.
+    std::unique_ptr<ParallelKeyGenerator> keyGenerator;
+    const size_t numKeyGenerationThreads = indexBuildKeyGenerationThreads.load();
+    if (numKeyGenerationThreads > 1 && numRecords >= kMinRecordsForParallelKeyGeneration &&
+        _eachIndexBuildMaxMemoryUsageBytes > 0) {
+        std::vector<ParallelKeyGenerator::Index> indexes;
+        for (const auto& index : _indexes) {
+            auto interceptor = index.block->getEntry(opCtx, collection)->indexBuildInterceptor();
+            indexes.push_back({index.real,
+                               index.filterExpression,
+                               index.options,
+                               index.bulk.get(),
+                               interceptor ? interceptor->getSkippedRecordTracker() : nullptr});
+        }
+        keyGenerator = std::make_unique<ParallelKeyGenerator>(std::move(indexes),
+                                                              numKeyGenerationThreads,
+                                                              _eachIndexBuildMaxMemoryUsageBytes,
+                                                              collection->ns().db());
+    }
+    auto finishKeyGeneration = [&] {
+        return keyGenerator ? keyGenerator->finish(opCtx) : Status::OK();
+    };
+
     try {
         // The phase will be kCollectionScan when resuming an index build from the collection scan
         // phase.
@@ -475,7 +768,11 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
 
             // The external sorter is not part of the storage engine and therefore does not need a
             // WriteUnitOfWork to write keys.
-            uassertStatusOK(_insert(opCtx, objToIndex, loc));
+            if (keyGenerator) {
+                keyGenerator->add(opCtx, objToIndex.getOwned(), loc, &_lastRecordIdInserted);
+            } else {
+                uassertStatusOK(_insert(opCtx, objToIndex, loc));
+            }
 
             _failPointHangDuringBuild(opCtx,
                                       &hangIndexBuildDuringCollectionScanPhaseAfterInsertion,
@@ -488,9 +785,18 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
             progress->hit();
             n++;
         }
+
+        uassertStatusOK(finishKeyGeneration());
     } catch (DBException& ex) {
-        if (ex.isA<ErrorCategory::Interruption>() || ex.isA<ErrorCategory::ShutdownError>() ||
-            ErrorCodes::IndexBuildAborted == ex.code()) {
+        // Resuming the index build requires the keys of all the documents scanned so far to be in
+        // its sorters.
+        auto keyGenerationStatus = finishKeyGeneration();
+        if (!keyGenerationStatus.isOK()) {
+            // Restore pre-collection scan state.
+            _phase = IndexBuildPhaseEnum::kInitialized;
+        } else if (ex.isA<ErrorCategory::Interruption>() ||
+                   ex.isA<ErrorCategory::ShutdownError>() ||
+                   ErrorCodes::IndexBuildAborted == ex.code()) {
             // If the collection scan is stopped because due to an interrupt or shutdown event, we
             // leave the internal state intact to ensure we have the correct information for
             // resuming this index build during startup and rollback.
@@ -516,7 +822,7 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
                       << "; phase: " << IndexBuildPhase_serializer(_phase)
                       << "; collectionScanPosition: " << _lastRecordIdInserted
                       << "; readSource: " << RecoveryUnit::toString(readSource));
-        return ex.toStatus();
+        return keyGenerationStatus.isOK() ? ex.toStatus() : keyGenerationStatus;
     }
 
     if (MONGO_unlikely(leaveIndexBuildUnfinishedForShutdown.shouldFail())) {
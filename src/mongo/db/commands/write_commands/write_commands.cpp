@@ -27,6 +27,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kWrite
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonobjbuilder.h"
@@ -63,9 +65,11 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/storage/duplicate_key_error_info.h"
 #include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/db/timeseries/bucket_compression.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/db/write_concern.h"
+#include "mongo/logv2/log.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/string_map.h"
@@ -116,9 +120,6 @@ bool isTimeseries(OperationContext* opCtx, const NamespaceString& ns) {
     return view->timeseries().has_value();
 }
 
-// Default for control.version in time-series bucket collection.
-const int kTimeseriesControlVersion = 1;
-
 /**
  * Returns $set expressions for the bucket's data field.
  * If 'metadataElem' is not empty, the time-series collection was created with a metadata field.
@@ -236,7 +237,8 @@ BSONArray makeTimeseriesInsertDocument(const OID& bucketId,
         bucketBuilder.append("_id", bucketId);
         {
             BSONObjBuilder bucketControlBuilder(bucketBuilder.subobjStart("control"));
-            bucketControlBuilder.append("version", kTimeseriesControlVersion);
+            bucketControlBuilder.append("version",
+                                        timeseries::kUncompressedBucketControlVersion);
             bucketControlBuilder.append("min", data.bucketMin);
             bucketControlBuilder.append("max", data.bucketMax);
         }
@@ -254,6 +256,105 @@ BSONArray makeTimeseriesInsertDocument(const OID& bucketId,
     return builder.arr();
 }
 
+/**
+ * Makes the batch of updates rewriting the data field of each closed bucket in the compressed
+ * format. Measurements are no longer added to a closed bucket, so this is done once, with an update
+ * replacing the whole data field. The query on the control version skips buckets which are already
+ * compressed.
+ */
+write_ops::Update makeTimeseriesCompressionBatch(
+    const NamespaceString& bucketsNs,
+    const std::vector<BucketCatalog::ClosedBucket>& closedBuckets) {
+    std::vector<write_ops::UpdateOpEntry> updates;
+    for (const auto& closedBucket : closedBuckets) {
+        boost::optional<StringData> metaField;
+        if (auto metadataElem = closedBucket.metadata.firstElement()) {
+            metaField = metadataElem.fieldNameStringData();
+        }
+
+        BSONObjBuilder updateBuilder;
+        {
+            BSONObjBuilder dataBuilder(
+                updateBuilder.subobjStart(doc_diff::kUpdateSectionFieldName));
+            dataBuilder.append(
+                "data", timeseries::compressBucketData(closedBucket.measurements, metaField));
+        }
+        {
+            BSONObjBuilder controlBuilder(updateBuilder.subobjStart(
+                str::stream() << doc_diff::kSubDiffSectionFieldPrefix << "control"));
+            controlBuilder.append(
+                doc_diff::kUpdateSectionFieldName,
+                BSON("version" << timeseries::kCompressedBucketControlVersion));
+        }
+
+        write_ops::UpdateModification u(updateBuilder.obj(),
+                                        write_ops::UpdateModification::DiffTag{});
+        updates.emplace_back(BSON("_id" << closedBucket.bucketId << "control.version"
+                                        << timeseries::kUncompressedBucketControlVersion),
+                             std::move(u));
+    }
+
+    write_ops::Update compressionBatch(bucketsNs, std::move(updates));
+    {
+        write_ops::WriteCommandBase writeCommandBase;
+        // The schema validation configured in the bucket collection is intended for direct
+        // operations by end users and is not applicable here.
+        writeCommandBase.setBypassDocumentValidation(true);
+        writeCommandBase.setOrdered(false);
+        compressionBatch.setWriteCommandBase(std::move(writeCommandBase));
+    }
+    return compressionBatch;
+}
+
+/**
+ * Compresses the closed buckets, see makeTimeseriesCompressionBatch(). This is an optimization
+ * only, which is not part of the user's write. The updates are performed by a separate client, so
+ * they never run under the transaction number of a retryable write, and their failures are logged
+ * rather than reported to the user. Binaries of an older FCV cannot read compressed buckets, so
+ * nothing is compressed until the FCV is fully upgraded.
+ */
+void compressClosedBuckets(OperationContext* opCtx,
+                           const NamespaceString& bucketsNs,
+                           const std::vector<BucketCatalog::ClosedBucket>& closedBuckets) {
+    if (closedBuckets.empty()) {
+        return;
+    }
+
+    if (!serverGlobalParams.featureCompatibility.isVersionInitialized() ||
+        !serverGlobalParams.featureCompatibility.isGreaterThanOrEqualTo(
+            ServerGlobalParams::FeatureCompatibility::Version::kVersion49)) {
+        return;
+    }
+
+    auto client = opCtx->getServiceContext()->makeClient("TimeseriesBucketCompression");
+    {
+        stdx::lock_guard<Client> lk(*client.get());
+        client->setSystemOperationKillableByStepdown(lk);
+    }
+    AlternativeClientRegion acr(client);
+    auto compressionOpCtx = cc().makeOperationContext();
+
+    try {
+        auto reply = write_ops_exec::performUpdates(
+            compressionOpCtx.get(), makeTimeseriesCompressionBatch(bucketsNs, closedBuckets));
+        for (size_t i = 0; i < reply.results.size(); ++i) {
+            if (!reply.results[i].isOK()) {
+                LOGV2_WARNING(5190957,
+                              "Failed to compress a closed time-series bucket",
+                              "namespace"_attr = bucketsNs,
+                              "bucketId"_attr = closedBuckets[i].bucketId,
+                              "error"_attr = reply.results[i].getStatus());
+            }
+        }
+    } catch (const DBException& ex) {
+        LOGV2_WARNING(5190958,
+                      "Failed to compress closed time-series buckets",
+                      "namespace"_attr = bucketsNs,
+                      "numBuckets"_attr = closedBuckets.size(),
+                      "error"_attr = ex.toStatus());
+    }
+}
+
 void appendOpTime(const repl::OpTime& opTime, BSONObjBuilder* out) {
     if (opTime.getTerm() == repl::OpTime::kUninitializedTerm) {
         out->append("opTime", opTime.getTimestamp());
@@ -684,6 +785,12 @@ private:
                 }
             }
 
+            // The buckets closed by a transaction are not visible outside of it until it commits,
+            // so they are left to a later insert.
+            if (!opCtx->inMultiDocumentTransaction()) {
+                compressClosedBuckets(opCtx, bucketsNs, bucketCatalog.takeClosedBuckets(ns));
+            }
+
             result->appendNumber("n", _batch.getDocuments().size() - errors.size());
             if (!errors.empty()) {
                 result->append("writeErrors", errors);
@@ -45,6 +45,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/logv2/log.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/str.h"
 #include "mongo/util/timer.h"
@@ -159,6 +160,8 @@ struct LockHead {
 
         conversionsCount = 0;
         compatibleFirstCount = 0;
+
+        memset(fastPathCounts, 0, sizeof(fastPathCounts));
     }
 
     /**
@@ -239,6 +242,48 @@ struct LockHead {
      */
     void migratePartitionedLockHeads();
 
+    /**
+     * Accounts for 'count' requests granted in the intent 'mode' through the fast path, which has
+     * just been closed.
+     */
+    void addFastPathGrants(LockMode mode, uint32_t count) {
+        invariant(mode == MODE_IS || mode == MODE_IX);
+        if (count == 0) {
+            return;
+        }
+        fastPathCounts[mode] += count;
+        grantedCounts[mode] += count;
+        grantedModes |= modeMask(mode);
+    }
+
+    /**
+     * Releases one of the grants accounted for by addFastPathGrants().
+     */
+    void removeFastPathGrant(LockMode mode) {
+        invariant(fastPathCounts[mode] >= 1);
+        fastPathCounts[mode]--;
+        decGrantedModeCount(mode);
+    }
+
+    /**
+     * Puts a request granted through the fast path on the granted queue, so that it can be
+     * converted. The grant of the request must have been accounted for by addFastPathGrants().
+     */
+    void migrateFastPathRequest(LockRequest* request) {
+        invariant(request->fastPathLock);
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+        invariant(fastPathCounts[request->mode] >= 1);
+        fastPathCounts[request->mode]--;
+
+        request->fastPathLock = nullptr;
+        request->lock = this;
+        grantedList.push_back(request);
+    }
+
+    uint32_t fastPathCount() const {
+        return fastPathCounts[MODE_IS] + fastPathCounts[MODE_IX];
+    }
+
     // Methods to maintain the granted queue
     void incGrantedModeCount(LockMode mode) {
         invariant(grantedCounts[mode] >= 0);
@@ -331,6 +376,15 @@ struct LockHead {
     // be switched to compatible-first. As long as this value is > 0, the policy will stay
     // compatible-first.
     uint32_t compatibleFirstCount;
+
+    //
+    // Fast path
+    //
+
+    // Counts the requests of each intent mode which were granted through the fast path before it
+    // was closed, and have not been released yet. These requests are not on the granted queue, but
+    // are accounted for in the grantedCounts array.
+    uint32_t fastPathCounts[LockModesCount];
 };
 
 /**
@@ -373,6 +427,102 @@ struct PartitionedLockHead {
     LockRequestList grantedList;
 };
 
+/**
+ * The FastPathLockHead allows intent mode requests on the global resources, which every operation
+ * acquires, to be granted with a single atomic operation and without locking any mutex.
+ *
+ * While the fast path is open, 'state' counts the requests granted through it in each of the
+ * intent modes, and these requests are not on any queue. Before a request in any other mode can be
+ * queued on the LockHead of the resource, the fast path is closed and its counts are transferred
+ * to the LockHead, which from then on accounts for these requests as granted. Requests granted
+ * through the fast path are released from the fast path counts if it is still open, or from the
+ * LockHead otherwise. The fast path is only reopened once the LockHead has neither non-intent
+ * modes nor requests granted through the fast path left.
+ *
+ * Closing and reopening the fast path must be done under the bucket lock of its LockHead.
+ */
+struct alignas(stdx::hardware_destructive_interference_size) FastPathLockHead {
+    // Layout of 'state': the count of MODE_IS requests in the low bits, the count of MODE_IX
+    // requests in the high bits and the closed flag in the topmost bit.
+    static constexpr uint64_t kClosed = 1ULL << 63;
+    static constexpr int kIXShift = 32;
+    static constexpr uint64_t kCountMask = (1ULL << 31) - 1;
+
+    static uint64_t unit(LockMode mode) {
+        return mode == MODE_IS ? 1 : 1ULL << kIXShift;
+    }
+
+    static uint32_t count(uint64_t state, LockMode mode) {
+        return ((mode == MODE_IS) ? state : state >> kIXShift) & kCountMask;
+    }
+
+    /**
+     * Returns false if the fast path is closed, in which case the request must go through the
+     * LockHead.
+     */
+    bool tryLock(LockMode mode) {
+        auto current = state.load();
+        while (!(current & kClosed)) {
+            if (state.compareAndSwap(&current, current + unit(mode))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Returns false if the fast path has been closed since the request was granted, in which case
+     * the grant must be released from the LockHead.
+     */
+    bool tryUnlock(LockMode mode) {
+        auto current = state.load();
+        while (!(current & kClosed)) {
+            invariant(count(current, mode) >= 1);
+            if (state.compareAndSwap(&current, current - unit(mode))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void newRequest(LockRequest* request) {
+        invariant(!request->lock && !request->partitionedLock);
+        request->partitioned = false;
+        request->fastPathLock = this;
+        request->status = LockRequest::STATUS_GRANTED;
+    }
+
+    /**
+     * Closes the fast path, if not already closed, and transfers its counts to 'lock'.
+     */
+    void close(LockHead* lock) {
+        const auto previous = state.swap(kClosed);
+        lock->addFastPathGrants(MODE_IS, count(previous, MODE_IS));
+        lock->addFastPathGrants(MODE_IX, count(previous, MODE_IX));
+    }
+
+    /**
+     * Reopens the fast path if 'lock' allows for it. Returns whether the fast path is open.
+     */
+    bool tryReopen(LockHead* lock) {
+        const auto current = state.load();
+        if (!(current & kClosed)) {
+            return true;
+        }
+        if ((lock->grantedModes & ~intentModes) || lock->conflictModes || lock->fastPathCount()) {
+            return false;
+        }
+
+        // Nothing can be granted through a closed fast path, so its counts must be zero.
+        invariant(current == kClosed);
+        state.store(0);
+        return true;
+    }
+
+    ResourceId resourceId;
+    AtomicWord<uint64_t> state{0};
+};
+
 void LockHead::migratePartitionedLockHeads() {
     invariant(partitioned());
 
@@ -417,6 +567,9 @@ const unsigned LockManager::_numLockBuckets(128);
 // The exact value doesn't appear very important, but should be power of two
 const unsigned LockManager::_numPartitions = 32;
 
+// One for each of the global resources, which every operation acquires, mostly in intent modes
+const unsigned LockManager::_numFastPathLocks = 3;
+
 // static
 std::map<LockerId, BSONObj> LockManager::getLockToClientMap(ServiceContext* serviceContext) {
     std::map<LockerId, BSONObj> lockToClientMap;
@@ -446,6 +599,10 @@ std::map<LockerId, BSONObj> LockManager::getLockToClientMap(ServiceContext* serv
 LockManager::LockManager() {
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
+    _fastPathLocks = new FastPathLockHead[_numFastPathLocks];
+    _fastPathLocks[0].resourceId = resourceIdParallelBatchWriterMode;
+    _fastPathLocks[1].resourceId = resourceIdReplicationStateTransitionLock;
+    _fastPathLocks[2].resourceId = resourceIdGlobal;
 }
 
 LockManager::~LockManager() {
@@ -456,8 +613,15 @@ LockManager::~LockManager() {
         invariant(_lockBuckets[i].data.empty());
     }
 
+    for (unsigned i = 0; i < _numFastPathLocks; i++) {
+        const auto state = _fastPathLocks[i].state.load();
+        invariant(!FastPathLockHead::count(state, MODE_IS));
+        invariant(!FastPathLockHead::count(state, MODE_IX));
+    }
+
     delete[] _lockBuckets;
     delete[] _partitions;
+    delete[] _fastPathLocks;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -467,6 +631,18 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
     request->mode = mode;
 
+    // Fastest path for intent locks on the global resources, which does not lock any mutex.
+    // Requests changing the policy of the lock cannot be granted this way, as they must be on the
+    // granted queue.
+    FastPathLockHead* fastPathLock = _getFastPathLock(resId);
+    if (fastPathLock && request->partitioned && !request->compatibleFirst) {
+        invariant(request->status == LockRequest::STATUS_NEW);
+        if (fastPathLock->tryLock(mode)) {
+            fastPathLock->newRequest(request);
+            return LOCK_OK;
+        }
+    }
+
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
         Partition* partition = _getPartition(request);
@@ -492,6 +668,18 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     LockHead* lock = bucket->findOrInsert(resId);
 
+    // Any request in a non-intent mode must account for the requests granted through the fast
+    // path. Intent requests reopen the fast path once the conflicting requests are gone.
+    if (fastPathLock) {
+        if (!request->partitioned) {
+            fastPathLock->close(lock);
+        } else if (!request->compatibleFirst && fastPathLock->tryReopen(lock) &&
+                   fastPathLock->tryLock(mode)) {
+            fastPathLock->newRequest(request);
+            return LOCK_OK;
+        }
+    }
+
     // Start a partitioned lock if possible
     if (request->partitioned && !(lock->grantedModes & (~intentModes)) && !lock->conflictModes) {
         Partition* partition = _getPartition(request);
@@ -538,10 +726,23 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
     stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
     invariant(request->status == LockRequest::STATUS_GRANTED);
 
-    LockBucket::Map::iterator it = bucket->data.find(resId);
-    invariant(it != bucket->data.end());
+    LockHead* lock;
+    if (request->fastPathLock) {
+        // Requests granted through the fast path are not on the LockHead, which might not even
+        // exist, so close the fast path and move the request to the granted queue.
+        lock = bucket->findOrInsert(resId);
+        request->fastPathLock->close(lock);
+        lock->migrateFastPathRequest(request);
+    } else {
+        LockBucket::Map::iterator it = bucket->data.find(resId);
+        invariant(it != bucket->data.end());
+
+        lock = it->second;
 
-    LockHead* const lock = it->second;
+        if (FastPathLockHead* fastPathLock = _getFastPathLock(resId)) {
+            fastPathLock->close(lock);
+        }
+    }
 
     if (lock->partitioned()) {
         lock->migratePartitionedLockHeads();
@@ -590,6 +791,30 @@ bool LockManager::unlock(LockRequest* request) {
     invariant(request->recursiveCount > 0);
     request->recursiveCount--;
 
+    if (request->fastPathLock) {
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+        if (request->recursiveCount > 0)
+            return false;
+
+        // Fastest path: the fast path is still open, so the request is only accounted for there.
+        FastPathLockHead* fastPathLock = request->fastPathLock;
+        if (fastPathLock->tryUnlock(request->mode))
+            return true;
+
+        // The fast path has been closed since the request was granted, which transferred it to
+        // the LockHead.
+        LockBucket* bucket = _getBucket(fastPathLock->resourceId);
+        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+
+        LockBucket::Map::iterator it = bucket->data.find(fastPathLock->resourceId);
+        invariant(it != bucket->data.end());
+
+        LockHead* lock = it->second;
+        lock->removeFastPathGrant(request->mode);
+        _onLockModeChanged(lock, lock->grantedCounts[request->mode] == 0);
+        return true;
+    }
+
     if (request->partitioned) {
         // Unlocking a lock that was acquired as partitioned. The lock request may since have
         // moved to the lock head, but there is no safe way to find out without synchronizing
@@ -831,7 +1056,8 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
 
     // This is a convenient place to check that the state of the two request queues is in sync
     // with the bitmask on the modes.
-    invariant((lock->grantedModes == 0) ^ (lock->grantedList._front != nullptr));
+    invariant((lock->grantedModes == 0) ^
+              (lock->grantedList._front != nullptr || lock->fastPathCount() != 0));
     invariant((lock->conflictModes == 0) ^ (lock->conflictList._front != nullptr));
 }
 
@@ -843,6 +1069,15 @@ LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
     return &_partitions[request->locker->getId() % _numPartitions];
 }
 
+FastPathLockHead* LockManager::_getFastPathLock(ResourceId resId) const {
+    for (unsigned i = 0; i < _numFastPathLocks; i++) {
+        if (_fastPathLocks[i].resourceId == resId) {
+            return &_fastPathLocks[i];
+        }
+    }
+    return nullptr;
+}
+
 void LockManager::dump() const {
     BSONArrayBuilder locks;
     _buildLocksArray(getLockToClientMap(getGlobalServiceContext()), true, nullptr, &locks);
@@ -873,7 +1108,7 @@ void LockManager::_buildLocksArray(const std::map<LockerId, BSONObj>& lockToClie
         }
         for (auto&& kv : bucket.data) {
             const auto& lock = kv.second;
-            if (lock->grantedList.empty())
+            if (lock->grantedList.empty() && !lock->fastPathCount())
                 continue;
             auto o = BSONObjBuilder(locks->subobjStart());
             if (forLogging)
@@ -906,8 +1141,29 @@ void LockManager::_buildLocksArray(const std::map<LockerId, BSONObj>& lockToClie
                     }
                 }
             }
+            if (lock->fastPathCount()) {
+                o.append("fastPathGranted",
+                         BSON(modeName(MODE_IS)
+                              << static_cast<int>(lock->fastPathCounts[MODE_IS])
+                              << modeName(MODE_IX)
+                              << static_cast<int>(lock->fastPathCounts[MODE_IX])));
+            }
         }
     }
+
+    // The requests granted through an open fast path are only known by their number.
+    for (unsigned i = 0; i < _numFastPathLocks; i++) {
+        const auto state = _fastPathLocks[i].state.load();
+        const auto numIS = FastPathLockHead::count(state, MODE_IS);
+        const auto numIX = FastPathLockHead::count(state, MODE_IX);
+        if (!numIS && !numIX)
+            continue;
+        auto o = BSONObjBuilder(locks->subobjStart());
+        o.append("resourceId", _fastPathLocks[i].resourceId.toString());
+        o.append("fastPathGranted",
+                 BSON(modeName(MODE_IS) << static_cast<int>(numIS) << modeName(MODE_IX)
+                                        << static_cast<int>(numIX)));
+    }
 }
 
 PartitionedLockHead* LockManager::Partition::find(ResourceId resId) {
@@ -981,6 +1237,7 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
 
     lock = nullptr;
     partitionedLock = nullptr;
+    fastPathLock = nullptr;
     prev = nullptr;
     next = nullptr;
     status = STATUS_NEW;
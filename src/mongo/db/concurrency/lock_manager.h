@@ -187,6 +187,12 @@ private:
      */
     Partition* _getPartition(LockRequest* request) const;
 
+    /**
+     * Retrieves the FastPathLockHead of the resource, or nullptr if intent mode requests on the
+     * resource cannot be granted through the fast path.
+     */
+    FastPathLockHead* _getFastPathLock(ResourceId resId) const;
+
     /**
      * The backend of `dump` and `getLockInfoBSON`.
      * If `mutableThis`, then we also clean the unused locks in the buckets while iterating.
@@ -221,5 +227,8 @@ private:
 
     static const unsigned _numPartitions;
     Partition* _partitions;
+
+    static const unsigned _numFastPathLocks;
+    FastPathLockHead* _fastPathLocks;
 };
 }  // namespace mongo
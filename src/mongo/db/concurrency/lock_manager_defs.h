@@ -48,6 +48,7 @@ class Locker;
 
 struct LockHead;
 struct PartitionedLockHead;
+struct FastPathLockHead;
 
 /**
  * LockMode compatibility matrix.
@@ -208,11 +209,11 @@ class ResourceId {
     MONGO_STATIC_ASSERT(ResourceTypesCount <= (1 << resourceTypeBits));
 
 public:
-    ResourceId() : _fullHash(0) {}
+    constexpr ResourceId() : _fullHash(0) {}
     ResourceId(ResourceType type, StringData ns) : _fullHash(fullHash(type, hashStringData(ns))) {}
     ResourceId(ResourceType type, const std::string& ns)
         : _fullHash(fullHash(type, hashStringData(ns))) {}
-    ResourceId(ResourceType type, uint64_t hashId) : _fullHash(fullHash(type, hashId)) {}
+    constexpr ResourceId(ResourceType type, uint64_t hashId) : _fullHash(fullHash(type, hashId)) {}
 
     bool isValid() const {
         return getType() != RESOURCE_INVALID;
@@ -250,7 +251,7 @@ private:
      */
     uint64_t _fullHash;
 
-    static uint64_t fullHash(ResourceType type, uint64_t hashId) {
+    static constexpr uint64_t fullHash(ResourceType type, uint64_t hashId) {
         return (static_cast<uint64_t>(type) << (64 - resourceTypeBits)) +
             (hashId & (std::numeric_limits<uint64_t>::max() >> resourceTypeBits));
     }
@@ -426,6 +427,15 @@ struct LockRequest {
     // Protected by LockHead bucket's mutex
     PartitionedLockHead* partitionedLock;
 
+    // Pointer to the fast path lock through which this request was granted, or null if it was not
+    // granted through the fast path. Only one of 'lock', 'partitionedLock' and 'fastPathLock' is
+    // non-NULL, and a request can only transition from 'fastPathLock' to 'lock', when converted.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    FastPathLockHead* fastPathLock;
+
     // The linked list chain on which this request hangs off the owning lock head. The reason
     // intrusive linked list is used instead of the std::list class is to allow for entries to be
     // removed from the middle of the list in O(1) time, if they are known instead of having to
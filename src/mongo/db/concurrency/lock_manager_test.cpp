@@ -952,4 +952,79 @@ TEST(LockManager, Fairness) {
     ASSERT(lockMgr.unlock(&requestIX1));
 }
 
+TEST(LockManager, FastPathIntentLocks) {
+    LockManager lockMgr;
+    const ResourceId resId = resourceIdGlobal;
+
+    LockerImpl lockerIS;
+    LockRequestCombo requestIS(&lockerIS);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIS, MODE_IS));
+    ASSERT(requestIS.fastPathLock);
+
+    LockerImpl lockerIX;
+    LockRequestCombo requestIX(&lockerIX);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX, MODE_IX));
+    ASSERT(requestIX.fastPathLock);
+
+    // The exclusive request must wait for the requests granted through the fast path
+    LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+    // New intent requests can no longer use the fast path and queue behind it
+    LockerImpl lockerIS1;
+    LockRequestCombo requestIS1(&lockerIS1);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestIS1, MODE_IS));
+    ASSERT(!requestIS1.fastPathLock);
+
+    ASSERT(lockMgr.unlock(&requestIS));
+    ASSERT_EQ(0, requestX.numNotifies);
+    ASSERT(lockMgr.unlock(&requestIX));
+    ASSERT_EQ(LOCK_OK, requestX.lastResult);
+    ASSERT_EQ(1, requestX.numNotifies);
+    ASSERT_EQ(0, requestIS1.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestX));
+    ASSERT_EQ(LOCK_OK, requestIS1.lastResult);
+    ASSERT_EQ(1, requestIS1.numNotifies);
+
+    // Once the exclusive request is gone, the next intent request reopens the fast path
+    LockerImpl lockerIX1;
+    LockRequestCombo requestIX1(&lockerIX1);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX1, MODE_IX));
+    ASSERT(requestIX1.fastPathLock);
+
+    // Unlock all locks so we don't assert for leaked locks
+    ASSERT(lockMgr.unlock(&requestIX1));
+    ASSERT(lockMgr.unlock(&requestIS1));
+}
+
+TEST(LockManager, FastPathConversion) {
+    LockManager lockMgr;
+    const ResourceId resId = resourceIdGlobal;
+
+    LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IS));
+
+    LockerImpl locker2;
+    LockRequestCombo request2(&locker2);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request2, MODE_IX));
+
+    // Converting a request granted through the fast path moves it to the granted queue, where it
+    // has to wait for the other request granted through the fast path
+    ASSERT(LOCK_WAITING == lockMgr.convert(resId, &request1, MODE_S));
+    ASSERT(!request1.fastPathLock);
+    ASSERT_EQ(0, request1.numNotifies);
+
+    ASSERT(lockMgr.unlock(&request2));
+    ASSERT_EQ(LOCK_OK, request1.lastResult);
+    ASSERT_EQ(1, request1.numNotifies);
+    ASSERT(request1.mode == MODE_S);
+
+    // The conversion counts as a second acquisition
+    ASSERT_FALSE(lockMgr.unlock(&request1));
+    ASSERT(lockMgr.unlock(&request1));
+}
+
 }  // namespace mongo
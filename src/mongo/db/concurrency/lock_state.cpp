@@ -360,17 +360,35 @@ bool LockerImpl::_acquireTicket(OperationContext* opCtx, LockMode mode, Date_t d
             invariant(!opCtx->recoveryUnit()->isTimestamped());
 
         OperationContext* interruptible = _uninterruptibleLocksRequested ? nullptr : opCtx;
+        auto lane = _getLaneForTicket();
         if (deadline == Date_t::max()) {
-            holder->waitForTicket(interruptible);
-        } else if (!holder->waitForTicketUntil(interruptible, deadline)) {
+            holder->waitForTicket(interruptible, lane);
+        } else if (!holder->waitForTicketUntil(interruptible, deadline, lane)) {
             return false;
         }
         restoreStateOnErrorGuard.dismiss();
+        _laneForTicket = lane;
+        ++_numTicketAcquisitions;
     }
     _clientState.store(reader ? kActiveReader : kActiveWriter);
     return true;
 }
 
+TicketHolder::Lane LockerImpl::_getLaneForTicket() const {
+    // The number of ticket acquisitions after which an operation is considered long-running. Every
+    // yield releases the ticket and acquires it again, so this is reached by the operations which
+    // have already yielded a couple of times.
+    constexpr int kLongRunningTicketAcquisitions = 3;
+
+    if (shouldUseInternalTicketLane()) {
+        return TicketHolder::Lane::kInternal;
+    }
+    if (_numTicketAcquisitions >= kLongRunningTicketAcquisitions) {
+        return TicketHolder::Lane::kLong;
+    }
+    return TicketHolder::Lane::kShort;
+}
+
 void LockerImpl::lockGlobal(OperationContext* opCtx, LockMode mode, Date_t deadline) {
     dassert(isLocked() == (_modeForTicket != MODE_NONE));
     if (_modeForTicket == MODE_NONE) {
@@ -406,6 +424,11 @@ bool LockerImpl::unlockGlobal() {
 
     invariant(!inAWriteUnitOfWork());
 
+    // The outermost global lock of a scope is released, so the next ticket is acquired for a new
+    // unit of work. Yields release the global lock through saveLockStateAndUnlock() instead, and
+    // keep counting towards the long lane.
+    _numTicketAcquisitions = 0;
+
     LockRequestsMap::Iterator it = _requests.begin();
     while (!it.finished()) {
         // If we're here we should only have one reference to any lock. It is a programming
@@ -1036,7 +1059,7 @@ void LockerImpl::releaseTicket() {
 void LockerImpl::_releaseTicket() {
     auto holder = shouldAcquireTicket() ? ticketHolders[_modeForTicket] : nullptr;
     if (holder) {
-        holder->release();
+        holder->release(_laneForTicket);
     }
     _clientState.store(kInactive);
 }
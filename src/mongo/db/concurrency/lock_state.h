@@ -36,6 +36,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/concurrency/ticketholder.h"
 
 namespace mongo {
 
@@ -315,6 +316,14 @@ private:
      */
     bool _acquireTicket(OperationContext* opCtx, LockMode mode, Date_t deadline);
 
+    /**
+     * Picks the TicketHolder lane the next ticket should be acquired from. Lockers flagged with
+     * setShouldUseInternalTicketLane() are admitted first, while the units of work which have
+     * already reacquired their ticket several times, such as yielding collection scans, are put in
+     * the long-running lane.
+     */
+    TicketHolder::Lane _getLaneForTicket() const;
+
     void _setWaitingResource(ResourceId resId);
 
     // Used to disambiguate different lockers
@@ -346,6 +355,12 @@ private:
     // Mode for which the Locker acquired a ticket, or MODE_NONE if no ticket was acquired.
     LockMode _modeForTicket = MODE_NONE;
 
+    // Lane from which the current ticket was acquired, and the number of tickets this Locker has
+    // acquired since it last released the global lock outside of a yield, which is used to tell
+    // long-running units of work apart.
+    TicketHolder::Lane _laneForTicket = TicketHolder::Lane::kShort;
+    int _numTicketAcquisitions = 0;
+
     // Indicates whether the client is active reader/writer or is queued.
     AtomicWord<ClientState> _clientState{kInactive};
 
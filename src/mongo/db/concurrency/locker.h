@@ -491,6 +491,18 @@ public:
         return _shouldAcquireTicket;
     }
 
+    /**
+     * Admits this locker through the internal lane of the ticket holders, ahead of user
+     * operations. This is reserved for the threads replication depends on, such as oplog
+     * application, which must not queue behind the user operations they would otherwise unblock.
+     */
+    void setShouldUseInternalTicketLane(bool newValue) {
+        _shouldUseInternalTicketLane = newValue;
+    }
+    bool shouldUseInternalTicketLane() const {
+        return _shouldUseInternalTicketLane;
+    }
+
     /**
      * Acquire a flow control admission ticket into the system. Flow control is used as a
      * backpressure mechanism to limit replication majority point lag.
@@ -539,6 +551,7 @@ protected:
 private:
     bool _shouldConflictWithSecondaryBatchApplication = true;
     bool _shouldAcquireTicket = true;
+    bool _shouldUseInternalTicketLane = false;
     std::string _debugInfo;  // Extra info about this locker for debugging purpose
 };
 
@@ -38,6 +38,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/str.h"
 
@@ -53,19 +54,21 @@ FetchStage::FetchStage(ExpressionContext* expCtx,
                        WorkingSet* ws,
                        std::unique_ptr<PlanStage> child,
                        const MatchExpression* filter,
-                       const CollectionPtr& collection)
+                       const CollectionPtr& collection,
+                       boost::optional<long long> limit)
     : RequiresCollectionStage(kStageType, expCtx, collection),
       _ws(ws),
       _filter((filter && !filter->isTriviallyTrue()) ? filter : nullptr),
-      _idRetrying(WorkingSet::INVALID_ID) {
+      _batchSize(internalQueryFetchBatchSize.load()),
+      _limit(limit) {
     _children.emplace_back(std::move(child));
 }
 
 FetchStage::~FetchStage() {}
 
 bool FetchStage::isEOF() {
-    if (WorkingSet::INVALID_ID != _idRetrying) {
-        // We have a working set member that we need to retry.
+    if (!_pendingBatch.empty() || !_fetchedBatch.empty()) {
+        // We have working set members that we need to fetch or to return.
         return false;
     }
 
@@ -77,52 +80,110 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
-    // Either retry the last WSM we worked on or get a new one from our child.
-    WorkingSetID id;
-    StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
-        status = ADVANCED;
-        id = _idRetrying;
-        _idRetrying = WorkingSet::INVALID_ID;
-    }
+    // Unless there are fetched members left to return, or a full batch of members to retry
+    // fetching, get a new member from our child.
+    const auto batchSize = maxPendingBatchSize();
+    if (_fetchedBatch.empty() && _pendingBatch.size() < batchSize && !child()->isEOF()) {
+        WorkingSetID id;
+        StageState status = child()->work(&id);
 
-    if (PlanStage::ADVANCED == status) {
-        WorkingSetMember* member = _ws->get(id);
+        if (PlanStage::ADVANCED == status) {
+            WorkingSetMember* member = _ws->get(id);
+
+            // If there's an obj there, there is no fetching to perform.
+            if (member->hasObj()) {
+                ++_specificStats.alreadyHasObj;
 
-        // If there's an obj there, there is no fetching to perform.
-        if (member->hasObj()) {
-            ++_specificStats.alreadyHasObj;
-        } else {
-            // We need a valid RecordId to fetch from and this is the only state that has one.
-            verify(WorkingSetMember::RID_AND_IDX == member->getState());
-            verify(member->hasRecordId());
-
-            try {
-                if (!_cursor)
-                    _cursor = collection()->getCursor(opCtx());
-
-                if (!WorkingSetCommon::fetch(opCtx(), _ws, id, _cursor, collection()->ns())) {
-                    _ws->free(id);
-                    return NEED_TIME;
+                // The member may wait for the rest of the batch across yields.
+                if (batchSize > 1) {
+                    member->makeObjOwnedIfNeeded();
                 }
-            } catch (const WriteConflictException&) {
-                // Ensure that the BSONObj underlying the WorkingSetMember is owned because it may
-                // be freed when we yield.
-                member->makeObjOwnedIfNeeded();
-                _idRetrying = id;
-                *out = WorkingSet::INVALID_ID;
-                return NEED_YIELD;
+            } else {
+                // We need a valid RecordId to fetch from and this is the only state that has one.
+                verify(WorkingSetMember::RID_AND_IDX == member->getState());
+                verify(member->hasRecordId());
+            }
+
+            _pendingBatch.push_back(id);
+            if (_pendingBatch.size() < batchSize && !child()->isEOF()) {
+                return NEED_TIME;
+            }
+        } else if (PlanStage::IS_EOF != status || _pendingBatch.empty()) {
+            if (PlanStage::NEED_YIELD == status) {
+                *out = id;
             }
+            return status;
         }
+    }
+
+    if (!_pendingBatch.empty()) {
+        try {
+            fetchPendingBatch();
+        } catch (const WriteConflictException&) {
+            // Ensure that the BSONObjs underlying the WorkingSetMembers are owned because they may
+            // be freed when we yield.
+            for (auto id : _pendingBatch) {
+                _ws->get(id)->makeObjOwnedIfNeeded();
+            }
+            *out = WorkingSet::INVALID_ID;
+            return NEED_YIELD;
+        }
+    }
+
+    if (_fetchedBatch.empty()) {
+        // None of the records of the batch exist anymore.
+        return NEED_TIME;
+    }
+
+    WorkingSetID id = _fetchedBatch.front();
+    _fetchedBatch.pop_front();
+    return returnIfMatches(_ws->get(id), id, out);
+}
+
+void FetchStage::fetchPendingBatch() {
+    std::vector<RecordId> recordIds;
+    for (auto id : _pendingBatch) {
+        WorkingSetMember* member = _ws->get(id);
+        if (!member->hasObj()) {
+            recordIds.push_back(member->recordId);
+        }
+    }
+
+    if (!_cursor)
+        _cursor = collection()->getCursor(opCtx());
+
+    // Read all the records before modifying any member, so that a WriteConflictException leaves
+    // the batch as it was.
+    std::vector<boost::optional<Record>> records;
+    if (_pendingBatch.size() == 1 && recordIds.size() == 1) {
+        // The member is returned right away, so there is no need for seekExactBatch() to copy its
+        // record.
+        records.push_back(_cursor->seekExact(recordIds.front()));
+    } else if (!recordIds.empty()) {
+        records = _cursor->seekExactBatch(recordIds);
+    }
+
+    auto record = records.begin();
+    for (auto id : _pendingBatch) {
+        if (!_ws->get(id)->hasObj() &&
+            !WorkingSetCommon::fetch(opCtx(), _ws, id, std::move(*record++), collection()->ns())) {
+            _ws->free(id);
+            continue;
+        }
+        _fetchedBatch.push_back(id);
+    }
+    _pendingBatch.clear();
+}
 
-        return returnIfMatches(member, id, out);
-    } else if (PlanStage::NEED_YIELD == status) {
-        *out = id;
+size_t FetchStage::maxPendingBatchSize() const {
+    if (!_limit) {
+        return _batchSize;
     }
 
-    return status;
+    // Every result we return counts towards the limit of our consumers, unless they filter it out,
+    // so they use at least as many more results as are left to reach their limit.
+    const auto numLeft = std::max(*_limit - _numReturned, 1LL);
+    return std::min(_batchSize, static_cast<size_t>(numLeft));
 }
 
 void FetchStage::doSaveStateRequiresCollection() {
@@ -168,6 +229,7 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
     ++_specificStats.docsExamined;
 
     if (Filter::passes(member, _filter)) {
+        ++_numReturned;
         *out = memberID;
         return PlanStage::ADVANCED;
     } else {
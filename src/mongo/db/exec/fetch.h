@@ -29,7 +29,10 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/jsobj.h"
@@ -46,6 +49,12 @@ class SeekableRecordCursor;
  * In WorkingSetMember terms, it transitions from RID_AND_IDX to RID_AND_OBJ by reading
  * the record at the provided RecordId.  Returns verbatim any data that already has an object.
  *
+ * When 'internalQueryFetchBatchSize' is greater than 1, the records of that many results of the
+ * child are read at once, in RecordId order, before the results are returned in their original
+ * order. When 'limit' is set, it is the most results of this stage its consumers may use, and a
+ * batch never holds more results of the child than are left to reach it, so that the stage does
+ * not examine more results of its child than it would one at a time.
+ *
  * Preconditions: Valid RecordId.
  */
 class FetchStage : public RequiresCollectionStage {
@@ -54,7 +63,8 @@ public:
                WorkingSet* ws,
                std::unique_ptr<PlanStage> child,
                const MatchExpression* filter,
-               const CollectionPtr& collection);
+               const CollectionPtr& collection,
+               boost::optional<long long> limit = boost::none);
 
     ~FetchStage();
 
@@ -86,6 +96,19 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Reads the records of the members of '_pendingBatch' which do not already have an object, and
+     * moves the members whose record exists to '_fetchedBatch'.
+     *
+     * WriteConflict exceptions may be thrown. When they are, '_pendingBatch' is unmodified.
+     */
+    void fetchPendingBatch();
+
+    /**
+     * Returns the number of results of the child whose records are read at once at this point.
+     */
+    size_t maxPendingBatchSize() const;
+
     // Used to fetch Records from _collection.
     std::unique_ptr<SeekableRecordCursor> _cursor;
 
@@ -95,8 +118,21 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
-    // If not Null, we use this rather than asking our child what to do next.
-    WorkingSetID _idRetrying;
+    // The number of results of the child whose records are read at once.
+    const size_t _batchSize;
+
+    // The most results of this stage its consumers may use, if known, and the number of results
+    // returned so far.
+    const boost::optional<long long> _limit;
+    long long _numReturned = 0;
+
+    // The results of the child whose records are yet to be read, in the order the child returned
+    // them. When it holds '_batchSize' results or the child is EOF, we read their records rather
+    // than asking our child what to do next.
+    std::vector<WorkingSetID> _pendingBatch;
+
+    // The results whose records were read and which are yet to be returned.
+    std::deque<WorkingSetID> _fetchedBatch;
 
     // Stats
     FetchStats _specificStats;
@@ -657,6 +657,11 @@ struct SortStats : public SpecificStats {
 
     // The number of times that we spilled data to disk during the execution of this query.
     uint64_t spills = 0u;
+
+    // The size of the data spilled to disk before compression, and the number of bytes actually
+    // written to disk for it.
+    uint64_t spilledDataSizeBytes = 0u;
+    uint64_t spilledDataStorageSizeBytes = 0u;
 };
 
 struct MergeSortStats : public SpecificStats {
@@ -845,6 +845,34 @@ std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeCopy(bool isSmp) {
     return std::unique_ptr<RuntimeEnvironment>(new RuntimeEnvironment(*this));
 }
 
+std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeDeepCopy() const {
+    auto env = std::make_unique<RuntimeEnvironment>();
+    auto& state = *env->_state;
+    state.slots = _state->slots;
+    state.typeTags = _state->typeTags;
+    state.vals = _state->vals;
+    state.owned = _state->owned;
+
+    for (size_t idx = 0; idx < state.vals.size(); ++idx) {
+        if (state.owned[idx]) {
+            std::tie(state.typeTags[idx], state.vals[idx]) =
+                value::copyValue(state.typeTags[idx], state.vals[idx]);
+        }
+    }
+
+    for (auto&& [type, slot] : state.slots) {
+        env->emplaceAccessor(slot.first, slot.second);
+    }
+    return env;
+}
+
+boost::optional<value::SlotId> RuntimeEnvironment::getSlotIfExists(StringData type) const {
+    if (auto it = _state->slots.find(type); it != _state->slots.end()) {
+        return it->second.first;
+    }
+    return boost::none;
+}
+
 void RuntimeEnvironment::debugString(StringBuilder* builder) {
     *builder << "env: { ";
     for (auto&& [type, slot] : _state->slots) {
@@ -118,6 +118,18 @@ public:
      */
     std::unique_ptr<RuntimeEnvironment> makeCopy(bool isSmp);
 
+    /**
+     * Makes a copy of this environment which holds its own copies of the slot values, so that the
+     * slots of either environment can be reset without affecting the other one. Slots keep their
+     * SlotIds. Unowned values are not copied, and stay unowned in the new environment as well.
+     */
+    std::unique_ptr<RuntimeEnvironment> makeDeepCopy() const;
+
+    /**
+     * Returns the SlotId registered for the given slot 'type', or boost::none if there is none.
+     */
+    boost::optional<value::SlotId> getSlotIfExists(StringData type) const;
+
     /**
      * Dumps all the slots currently defined in this environment into the given string builder.
      */
@@ -241,6 +253,14 @@ public:
 
     virtual std::vector<DebugPrinter::Block> debugPrint() const = 0;
 
+    /**
+     * Returns the children of this expression, so that callers can inspect the shape of the
+     * expression tree.
+     */
+    const std::vector<std::unique_ptr<EExpression>>& getNodes() const {
+        return _nodes;
+    }
+
 protected:
     std::vector<std::unique_ptr<EExpression>> _nodes;
 
@@ -326,6 +346,13 @@ public:
 
     std::vector<DebugPrinter::Block> debugPrint() const override;
 
+    /**
+     * Returns a view of the constant, which remains owned by this expression.
+     */
+    std::pair<value::TypeTags, value::Value> getConstant() const {
+        return {_tag, _val};
+    }
+
 private:
     value::TypeTags _tag;
     value::Value _val;
@@ -347,6 +374,14 @@ public:
 
     std::vector<DebugPrinter::Block> debugPrint() const override;
 
+    value::SlotId getSlotId() const {
+        return _var;
+    }
+
+    boost::optional<FrameId> getFrameId() const {
+        return _frameId;
+    }
+
 private:
     value::SlotId _var;
     boost::optional<FrameId> _frameId;
@@ -392,6 +427,10 @@ public:
 
     std::vector<DebugPrinter::Block> debugPrint() const override;
 
+    Op getOp() const {
+        return _op;
+    }
+
 private:
     Op _op;
 };
@@ -439,6 +478,10 @@ public:
 
     std::vector<DebugPrinter::Block> debugPrint() const override;
 
+    const std::string& getName() const {
+        return _name;
+    }
+
 private:
     std::string _name;
 };
@@ -138,7 +138,18 @@ static constexpr auto kSyntax = R"(
                                    MKOBJ_FLAG # Return old object
                                    OPERATOR # child
 
-                GROUP <- 'group' IDENT_LIST PROJECT_LIST OPERATOR
+                GROUP <- 'group' IDENT_LIST # group by slots
+                                 PROJECT_LIST # accumulators
+                                 GROUP_SPILL? # optional spilling to disk
+                                 OPERATOR # input
+                GROUP_SPILL <- 'spill' NUMBER # memory limit in bytes
+                                       GROUP_SPILL_FLAG # allow disk use
+                                       MERGE_LIST # merging expressions
+                GROUP_SPILL_FLAG <- <'true'> / <'false'>
+                MERGE_LIST <- '[' (MERGE (',' MERGE)* )?']'
+                MERGE <- IDENT # output slot of the accumulator
+                         IDENT # slot of the spilled partial aggregate
+                         '=' EXPR # merging expression
                 HJOIN <- 'hj' LEFT RIGHT
                 LEFT <- 'left' IDENT_LIST IDENT_LIST OPERATOR
                 RIGHT <- 'right' IDENT_LIST IDENT_LIST OPERATOR
@@ -966,12 +977,39 @@ void Parser::walkMkObj(AstQuery& ast) {
 void Parser::walkGroup(AstQuery& ast) {
     walkChildren(ast);
 
-    ast.stage = makeS<HashAggStage>(std::move(ast.nodes[2]->stage),
+    if (ast.nodes.size() == 3) {
+        ast.stage = makeS<HashAggStage>(std::move(ast.nodes[2]->stage),
+                                        lookupSlots(std::move(ast.nodes[0]->identifiers)),
+                                        lookupSlots(std::move(ast.nodes[1]->projects)),
+                                        getCurrentPlanNodeId());
+        return;
+    }
+
+    auto& spill = *ast.nodes[2];
+    HashAggStage::MergingExprs mergingExprs;
+    for (auto& merge : spill.nodes[2]->nodes) {
+        mergingExprs.emplace(
+            lookupSlotStrict(merge->identifier),
+            std::make_pair(lookupSlotStrict(merge->rename), std::move(merge->expr)));
+    }
+
+    ast.stage = makeS<HashAggStage>(std::move(ast.nodes[3]->stage),
                                     lookupSlots(std::move(ast.nodes[0]->identifiers)),
                                     lookupSlots(std::move(ast.nodes[1]->projects)),
+                                    std::move(mergingExprs),
+                                    std::stoull(spill.nodes[0]->token),
+                                    spill.nodes[1]->token == "true",
                                     getCurrentPlanNodeId());
 }
 
+void Parser::walkMerge(AstQuery& ast) {
+    walkChildren(ast);
+
+    ast.identifier = ast.nodes[0]->identifier;
+    ast.rename = ast.nodes[1]->identifier;
+    ast.expr = std::move(ast.nodes[2]->expr);
+}
+
 void Parser::walkHashJoin(AstQuery& ast) {
     walkChildren(ast);
     ast.stage =
@@ -1541,6 +1579,9 @@ void Parser::walk(AstQuery& ast) {
         case "GROUP"_:
             walkGroup(ast);
             break;
+        case "MERGE"_:
+            walkMerge(ast);
+            break;
         case "HJOIN"_:
             walkHashJoin(ast);
             break;
@@ -206,6 +206,7 @@ private:
     void walkUnwind(AstQuery& ast);
     void walkMkObj(AstQuery& ast);
     void walkGroup(AstQuery& ast);
+    void walkMerge(AstQuery& ast);
     void walkHashJoin(AstQuery& ast);
     void walkNLJoin(AstQuery& ast);
     void walkLimit(AstQuery& ast);
@@ -249,5 +249,33 @@ TEST_F(SBEParserTest, TestPlanNodeIdIsParsed) {
     }
 }
 
+TEST_F(SBEParserTest, TestHashAggSpillOptionsAreParsed) {
+    sbe::DebugPrinter printer;
+
+    auto makeSum = [](sbe::value::SlotId slot) {
+        return sbe::makeE<sbe::EFunction>("sum", sbe::makeEs(sbe::makeE<sbe::EVariable>(slot)));
+    };
+    sbe::HashAggStage::MergingExprs mergingExprs;
+    mergingExprs.emplace(2, std::make_pair(sbe::value::SlotId{4}, makeSum(4)));
+    auto stage = sbe::makeS<sbe::HashAggStage>(sbe::makeS<sbe::CoScanStage>(planNodeId),
+                                               sbe::makeSV(1),
+                                               sbe::makeEM(2, makeSum(3)),
+                                               std::move(mergingExprs),
+                                               1024,
+                                               true,
+                                               planNodeId);
+
+    // The parser numbers the slots in the order it looks them up, so only compare the output of
+    // two fresh parsers given the same plan.
+    const auto parsedStage = sbe::Parser().parse(nullptr, "testDb", printer.print(stage.get()));
+    const auto stageText = printer.print(parsedStage.get());
+    const auto reparsedStage = sbe::Parser().parse(nullptr, "testDb", stageText);
+    ASSERT_EQ(stageText, printer.print(reparsedStage.get()));
+
+    const auto stats = parsedStage->getStats(true /* includeDebugInfo */);
+    ASSERT_EQ(stats->debugInfo["memLimit"].numberLong(), 1024);
+    ASSERT_EQ(stats->debugInfo["mergingExprs"].Obj().nFields(), 1);
+}
+
 }  // namespace
 }  // namespace mongo
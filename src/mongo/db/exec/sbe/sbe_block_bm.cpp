@@ -0,0 +1,176 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/exec/sbe/stages/block.h"
+#include "mongo/db/exec/sbe/stages/filter.h"
+#include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+
+namespace mongo {
+namespace sbe {
+namespace {
+const size_t kNumValues = 4 * 1024 * 1024;
+const size_t kBlockSize = 1024;
+
+/**
+ * Makes a virtual scan returning 'kNumValues' doubles, which stands for a scan over a numeric field
+ * of as many documents.
+ */
+std::pair<value::SlotId, std::unique_ptr<PlanStage>> makeScan(
+    value::SlotIdGenerator* slotIdGenerator) {
+    auto [arrTag, arrVal] = value::makeNewArray();
+    auto arr = value::getArrayView(arrVal);
+    arr->reserve(kNumValues);
+    for (size_t idx = 0; idx < kNumValues; ++idx) {
+        arr->push_back(value::TypeTags::NumberDouble,
+                       value::bitcastFrom<double>(static_cast<double>(idx % 1000)));
+    }
+    return stage_builder::generateVirtualScan(slotIdGenerator, arrTag, arrVal);
+}
+
+/**
+ * Makes the analytical filter 'slot >= 100 && slot < 900', which selects 80% of the values.
+ */
+std::unique_ptr<EExpression> makeFilter(value::SlotId slot) {
+    return makeE<EPrimBinary>(
+        EPrimBinary::logicAnd,
+        makeE<EPrimBinary>(
+            EPrimBinary::greaterEq,
+            makeE<EVariable>(slot),
+            makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(100))),
+        makeE<EPrimBinary>(
+            EPrimBinary::less,
+            makeE<EVariable>(slot),
+            makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(900))));
+}
+
+std::unique_ptr<EExpression> makeProject(value::SlotId slot) {
+    return makeE<EPrimBinary>(
+        EPrimBinary::mul,
+        makeE<EVariable>(slot),
+        makeE<EConstant>(value::TypeTags::NumberDouble, value::bitcastFrom<double>(2.5)));
+}
+
+/**
+ * Runs the plan built by 'makePlan' over the virtual scan to completion for every iteration, and
+ * reports the number of scanned values per second.
+ */
+template <typename MakePlanFn>
+void runPlan(benchmark::State& state, MakePlanFn makePlan) {
+    QueryTestServiceContext testServiceContext;
+    auto opCtx = testServiceContext.makeOperationContext();
+    value::SlotIdGenerator slotIdGenerator;
+
+    auto [scanSlot, scanStage] = makeScan(&slotIdGenerator);
+    auto [outSlot, stage] = makePlan(&slotIdGenerator, scanSlot, std::move(scanStage));
+
+    CompileCtx ctx{std::make_unique<RuntimeEnvironment>()};
+    stage->prepare(ctx);
+    stage->attachToOperationContext(opCtx.get());
+    auto accessor = stage->getAccessor(ctx, outSlot);
+
+    for (auto keepRunning : state) {
+        stage->open(false);
+        size_t count = 0;
+        while (stage->getNext() == PlanState::ADVANCED) {
+            benchmark::DoNotOptimize(accessor->getViewOfValue());
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+        stage->close();
+    }
+    state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+
+void BM_RowFilter(benchmark::State& state) {
+    runPlan(state,
+            [](value::SlotIdGenerator*, value::SlotId slot, std::unique_ptr<PlanStage> input) {
+                auto stage = makeS<FilterStage<false>>(
+                    std::move(input), makeFilter(slot), kEmptyPlanNodeId);
+                return std::make_pair(slot, std::move(stage));
+            });
+}
+
+void BM_BlockFilter(benchmark::State& state) {
+    runPlan(state,
+            [](value::SlotIdGenerator*, value::SlotId slot, std::unique_ptr<PlanStage> input) {
+                auto stage = makeS<BlockStage>(std::move(input),
+                                               makeSV(slot),
+                                               makeFilter(slot),
+                                               makeEM(),
+                                               kBlockSize,
+                                               kEmptyPlanNodeId);
+                return std::make_pair(slot, std::move(stage));
+            });
+}
+
+void BM_RowFilterProject(benchmark::State& state) {
+    runPlan(state,
+            [](value::SlotIdGenerator* slotIdGenerator,
+               value::SlotId slot,
+               std::unique_ptr<PlanStage> input) {
+                auto outSlot = slotIdGenerator->generate();
+                auto stage = makeProjectStage(
+                    makeS<FilterStage<false>>(std::move(input), makeFilter(slot), kEmptyPlanNodeId),
+                    kEmptyPlanNodeId,
+                    outSlot,
+                    makeProject(slot));
+                return std::make_pair(outSlot, std::move(stage));
+            });
+}
+
+void BM_BlockFilterProject(benchmark::State& state) {
+    runPlan(state,
+            [](value::SlotIdGenerator* slotIdGenerator,
+               value::SlotId slot,
+               std::unique_ptr<PlanStage> input) {
+                auto outSlot = slotIdGenerator->generate();
+                auto stage = makeS<BlockStage>(std::move(input),
+                                               makeSV(slot),
+                                               makeFilter(slot),
+                                               makeEM(outSlot, makeProject(slot)),
+                                               kBlockSize,
+                                               kEmptyPlanNodeId);
+                return std::make_pair(outSlot, std::move(stage));
+            });
+}
+
+BENCHMARK(BM_RowFilter)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BlockFilter)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RowFilterProject)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BlockFilterProject)->Unit(benchmark::kMillisecond);
+}  // namespace
+}  // namespace sbe
+}  // namespace mongo
@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+/**
+ * This file contains tests for sbe::BlockStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/block.h"
+
+namespace mongo::sbe {
+
+class BlockStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Builds a BlockStage over the scan slot with the given filter, projecting 'project' into a new
+     * slot if it is not null. Returns the projected slot, or the scan slot if there is no project.
+     */
+    std::pair<value::SlotId, std::unique_ptr<PlanStage>> makeBlockStage(
+        value::SlotId scanSlot,
+        std::unique_ptr<PlanStage> scanStage,
+        std::unique_ptr<EExpression> filter,
+        std::unique_ptr<EExpression> project,
+        size_t blockSize) {
+        auto outSlot = scanSlot;
+        value::SlotMap<std::unique_ptr<EExpression>> projects;
+        if (project) {
+            outSlot = generateSlotId();
+            projects.emplace(outSlot, std::move(project));
+        }
+
+        auto stage = makeS<BlockStage>(std::move(scanStage),
+                                       makeSV(scanSlot),
+                                       std::move(filter),
+                                       std::move(projects),
+                                       blockSize,
+                                       kEmptyPlanNodeId);
+        return {outSlot, std::move(stage)};
+    }
+
+    /**
+     * Runs the BlockStage built by makeBlockStage() over 'input' and checks that it produces
+     * 'expected'. Returns the stats of the stage.
+     */
+    BlockStats runBlockStage(const BSONArray& input,
+                             const BSONArray& expected,
+                             std::function<std::unique_ptr<EExpression>(value::SlotId)> makeFilter,
+                             std::function<std::unique_ptr<EExpression>(value::SlotId)> makeProject,
+                             size_t blockSize) {
+        auto [scanSlot, scanStage] = generateVirtualScan(input);
+        auto [outSlot, stage] =
+            makeBlockStage(scanSlot,
+                           std::move(scanStage),
+                           makeFilter ? makeFilter(scanSlot) : nullptr,
+                           makeProject ? makeProject(scanSlot) : nullptr,
+                           blockSize);
+
+        auto ctx = makeCompileCtx();
+        auto resultAccessor = prepareTree(ctx.get(), stage.get(), outSlot);
+        auto [resultsTag, resultsVal] = getAllResults(stage.get(), resultAccessor);
+        value::ValueGuard resultGuard{resultsTag, resultsVal};
+
+        auto [expectedTag, expectedVal] = stage_builder::makeValue(expected);
+        value::ValueGuard expectedGuard{expectedTag, expectedVal};
+        assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
+
+        auto stats = *static_cast<const BlockStats*>(stage->getSpecificStats());
+        stage->close();
+        return stats;
+    }
+
+    static std::unique_ptr<EExpression> makeInt32(int32_t value) {
+        return makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(value));
+    }
+};
+
+TEST_F(BlockStageTest, CompareWithConstantIsVectorized) {
+    auto makeFilter = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(EPrimBinary::greater, makeE<EVariable>(slot), makeInt32(4));
+    };
+
+    auto stats = runBlockStage(BSON_ARRAY(1 << 5 << 10 << 3 << 7),
+                               BSON_ARRAY(5 << 10 << 7),
+                               makeFilter,
+                               nullptr,
+                               2);
+    ASSERT_EQ(stats.numBlocks, 3U);
+    ASSERT_EQ(stats.numTested, 5U);
+    ASSERT_EQ(stats.numFallbacks, 0U);
+}
+
+TEST_F(BlockStageTest, ConstantOnLeftIsVectorized) {
+    // '4.5 >= s' promotes the int64 values of the column to doubles, like the VM does.
+    auto makeFilter = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(
+            EPrimBinary::greaterEq,
+            makeE<EConstant>(value::TypeTags::NumberDouble, value::bitcastFrom<double>(4.5)),
+            makeE<EVariable>(slot));
+    };
+
+    auto stats = runBlockStage(BSON_ARRAY(1LL << 5LL << 4LL << 10LL),
+                               BSON_ARRAY(1LL << 4LL),
+                               makeFilter,
+                               nullptr,
+                               1024);
+    ASSERT_EQ(stats.numBlocks, 1U);
+    ASSERT_EQ(stats.numFallbacks, 0U);
+}
+
+TEST_F(BlockStageTest, MixedTypesFallBackToVM) {
+    auto makeFilter = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(EPrimBinary::lessEq, makeE<EVariable>(slot), makeInt32(5));
+    };
+
+    // Values which can't be compared with a number produce Nothing, which filters them out.
+    auto stats = runBlockStage(BSON_ARRAY(1 << "foo" << 5.5 << 3LL << BSON("a" << 1) << 5),
+                               BSON_ARRAY(1 << 3LL << 5),
+                               makeFilter,
+                               nullptr,
+                               1024);
+    ASSERT_EQ(stats.numBlocks, 1U);
+    ASSERT_EQ(stats.numFallbacks, 1U);
+}
+
+TEST_F(BlockStageTest, CompareGuardedByIsArrayIsVectorized) {
+    auto makeFilter = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(
+            EPrimBinary::logicOr,
+            makeE<EFunction>("isArray", makeEs(makeE<EVariable>(slot))),
+            makeE<EPrimBinary>(EPrimBinary::less, makeE<EVariable>(slot), makeInt32(4)));
+    };
+
+    // The first block only holds numbers and is left to the kernel. The second one holds an array,
+    // which the VM lets through.
+    auto stats = runBlockStage(BSON_ARRAY(1 << 5 << 3 << BSON_ARRAY(10) << 7 << 2),
+                               BSON_ARRAY(1 << 3 << BSON_ARRAY(10) << 2),
+                               makeFilter,
+                               nullptr,
+                               3);
+    ASSERT_EQ(stats.numBlocks, 2U);
+    ASSERT_EQ(stats.numFallbacks, 1U);
+}
+
+TEST_F(BlockStageTest, ConjunctsAreEvaluatedInOrder) {
+    // The first conjunct has a kernel but the second one doesn't, so the second one is only
+    // evaluated by the VM over the rows selected by the first one.
+    auto makeFilter = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(
+            EPrimBinary::logicAnd,
+            makeE<EFunction>("isNumber", makeEs(makeE<EVariable>(slot))),
+            makeE<EPrimBinary>(
+                EPrimBinary::greater,
+                makeE<EPrimBinary>(EPrimBinary::add, makeE<EVariable>(slot), makeInt32(1)),
+                makeInt32(3)));
+    };
+
+    auto stats = runBlockStage(BSON_ARRAY("foo" << 1 << 3 << 5.5 << BSONNULL),
+                               BSON_ARRAY(3 << 5.5),
+                               makeFilter,
+                               nullptr,
+                               1024);
+    ASSERT_EQ(stats.numFallbacks, 1U);
+}
+
+TEST_F(BlockStageTest, ProjectionIsVectorized) {
+    auto makeFilter = [](value::SlotId slot) {
+        return makeE<EFunction>("exists", makeEs(makeE<EVariable>(slot)));
+    };
+    auto makeProject = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(EPrimBinary::mul, makeInt32(3), makeE<EVariable>(slot));
+    };
+
+    auto stats = runBlockStage(BSON_ARRAY(1 << 2 << 3 << 4 << 5),
+                               BSON_ARRAY(3 << 6 << 9 << 12 << 15),
+                               makeFilter,
+                               makeProject,
+                               3);
+    ASSERT_EQ(stats.numBlocks, 2U);
+    ASSERT_EQ(stats.numFallbacks, 0U);
+}
+
+TEST_F(BlockStageTest, ProjectionOverflowFallsBackToVM) {
+    auto makeProject = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(EPrimBinary::add, makeE<EVariable>(slot), makeInt32(1));
+    };
+
+    // The VM widens the result to a 64-bit integer when it overflows.
+    const auto max = std::numeric_limits<int32_t>::max();
+    auto stats = runBlockStage(BSON_ARRAY(1 << max << 2),
+                               BSON_ARRAY(2 << (static_cast<long long>(max) + 1) << 3),
+                               nullptr,
+                               makeProject,
+                               1024);
+    ASSERT_EQ(stats.numFallbacks, 1U);
+}
+
+TEST_F(BlockStageTest, ProjectionIsOnlyComputedForSelectedRows) {
+    auto makeFilter = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(EPrimBinary::neq, makeE<EVariable>(slot), makeInt32(0));
+    };
+    auto makeProject = [](value::SlotId slot) {
+        return makeE<EPrimBinary>(
+            EPrimBinary::div,
+            makeE<EConstant>(value::TypeTags::NumberDouble, value::bitcastFrom<double>(1.0)),
+            makeE<EVariable>(slot));
+    };
+
+    // Division by zero raises an error, so it must not be attempted for the filtered out rows.
+    auto stats = runBlockStage(
+        BSON_ARRAY(2 << 0 << 4), BSON_ARRAY(0.5 << 0.25), makeFilter, makeProject, 1024);
+    ASSERT_EQ(stats.numFallbacks, 1U);
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,257 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo::sbe {
+
+class HashAggStageTest : public PlanStageTestFixture {
+public:
+    void setUp() override {
+        PlanStageTestFixture::setUp();
+        _originalDbPath = storageGlobalParams.dbpath;
+        storageGlobalParams.dbpath = _tempDir.path();
+    }
+
+    void tearDown() override {
+        storageGlobalParams.dbpath = _originalDbPath;
+        PlanStageTestFixture::tearDown();
+    }
+
+    /**
+     * Makes a HashAggStage which groups by the first input slot and sums up the second one.
+     */
+    std::pair<value::SlotVector, std::unique_ptr<PlanStage>> makeSumStage(
+        value::SlotVector scanSlots,
+        std::unique_ptr<PlanStage> scanStage,
+        size_t memoryLimit,
+        bool allowDiskUse) {
+        auto sumSlot = generateSlotId();
+        auto spillSlot = generateSlotId();
+
+        HashAggStage::MergingExprs mergingExprs;
+        mergingExprs.emplace(
+            sumSlot,
+            std::make_pair(spillSlot,
+                           makeE<EFunction>("sum", makeEs(makeE<EVariable>(spillSlot)))));
+
+        auto hashAggStage = makeS<HashAggStage>(
+            std::move(scanStage),
+            makeSV(scanSlots[0]),
+            makeEM(sumSlot, makeE<EFunction>("sum", makeEs(makeE<EVariable>(scanSlots[1])))),
+            std::move(mergingExprs),
+            memoryLimit,
+            allowDiskUse,
+            kEmptyPlanNodeId);
+
+        return std::make_pair(makeSV(scanSlots[0], sumSlot), std::move(hashAggStage));
+    }
+
+    /**
+     * Makes a HashAggStage which groups by the first two input slots, and sums up and takes the
+     * maximum of the third one.
+     */
+    std::pair<value::SlotVector, std::unique_ptr<PlanStage>> makeMultiKeySumMaxStage(
+        value::SlotVector scanSlots,
+        std::unique_ptr<PlanStage> scanStage,
+        size_t memoryLimit,
+        bool allowDiskUse) {
+        auto sumSlot = generateSlotId();
+        auto maxSlot = generateSlotId();
+        auto sumSpillSlot = generateSlotId();
+        auto maxSpillSlot = generateSlotId();
+
+        HashAggStage::MergingExprs mergingExprs;
+        mergingExprs.emplace(
+            sumSlot,
+            std::make_pair(sumSpillSlot,
+                           makeE<EFunction>("sum", makeEs(makeE<EVariable>(sumSpillSlot)))));
+        mergingExprs.emplace(
+            maxSlot,
+            std::make_pair(maxSpillSlot,
+                           makeE<EFunction>("max", makeEs(makeE<EVariable>(maxSpillSlot)))));
+
+        auto hashAggStage = makeS<HashAggStage>(
+            std::move(scanStage),
+            makeSV(scanSlots[0], scanSlots[1]),
+            makeEM(sumSlot,
+                   makeE<EFunction>("sum", makeEs(makeE<EVariable>(scanSlots[2]))),
+                   maxSlot,
+                   makeE<EFunction>("max", makeEs(makeE<EVariable>(scanSlots[2])))),
+            std::move(mergingExprs),
+            memoryLimit,
+            allowDiskUse,
+            kEmptyPlanNodeId);
+
+        return std::make_pair(makeSV(scanSlots[0], scanSlots[1], sumSlot, maxSlot),
+                              std::move(hashAggStage));
+    }
+
+private:
+    unittest::TempDir _tempDir{"sbe_hash_agg_test"};
+    std::string _originalDbPath;
+};
+
+TEST_F(HashAggStageTest, SpillingMergesPartialAggregates) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(
+        BSON_ARRAY(1 << 1) << BSON_ARRAY(2 << 2) << BSON_ARRAY(1 << 3) << BSON_ARRAY(3 << 4)
+                           << BSON_ARRAY(2 << 5) << BSON_ARRAY(1 << 6)));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    // Once spilled, the groups are returned in key order.
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY(1 << 10) << BSON_ARRAY(2 << 7) << BSON_ARRAY(3 << 4)));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    // A zero memory limit makes the stage spill after every input row.
+    auto makeStageFn = [this](value::SlotVector scanSlots, std::unique_ptr<PlanStage> scanStage) {
+        return makeSumStage(std::move(scanSlots), std::move(scanStage), 0, true);
+    };
+
+    inputGuard.reset();
+    expectedGuard.reset();
+    runTestMulti(2, inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
+}
+
+TEST_F(HashAggStageTest, SpillingMergesPartialAggregatesOfMultiKeyGroups) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY(1 << "x" << 1)
+                   << BSON_ARRAY(2 << "x" << 2) << BSON_ARRAY(1 << "y" << 3)
+                   << BSON_ARRAY(1 << "x" << 4) << BSON_ARRAY(2 << "x" << 5)
+                   << BSON_ARRAY(1 << "y" << 6) << BSON_ARRAY(2 << "y" << 7)));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    // Once spilled, the groups are returned in the order of their compound keys.
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY(1 << "x" << 5 << 4)
+                   << BSON_ARRAY(1 << "y" << 9 << 6) << BSON_ARRAY(2 << "x" << 7 << 5)
+                   << BSON_ARRAY(2 << "y" << 7 << 7)));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto makeStageFn = [this](value::SlotVector scanSlots, std::unique_ptr<PlanStage> scanStage) {
+        return makeMultiKeySumMaxStage(std::move(scanSlots), std::move(scanStage), 0, true);
+    };
+
+    inputGuard.reset();
+    expectedGuard.reset();
+    runTestMulti(3, inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
+}
+
+TEST_F(HashAggStageTest, RunsOfSeveralMultiKeyGroupsAreMerged) {
+    // Spread the input over 35 groups. Every group is seen 4 times in a row, so that the spilled
+    // runs hold fewer records than the input, and again once the groups repeat after 140 rows, so
+    // that some groups are spread over several runs.
+    const int kNumRows = 200;
+    std::map<std::pair<int, int>, std::pair<int, int>> groups;
+    BSONArrayBuilder input;
+    for (int i = 0; i < kNumRows; ++i) {
+        const std::pair<int, int> key{(i / 4) % 7, (i / 4) % 5};
+        input.append(BSON_ARRAY(key.first << key.second << i));
+        auto& [sum, max] = groups[key];
+        sum += i;
+        max = i;
+    }
+    BSONArrayBuilder expected;
+    for (auto&& [key, aggs] : groups) {
+        expected.append(BSON_ARRAY(key.first << key.second << aggs.first << aggs.second));
+    }
+
+    auto [scanSlots, scanStage] = generateVirtualScanMulti(3, input.arr());
+    auto [outSlots, stage] = makeMultiKeySumMaxStage(scanSlots, std::move(scanStage), 1024, true);
+
+    auto ctx = makeCompileCtx();
+    auto accessors = prepareTree(ctx.get(), stage.get(), outSlots);
+    auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), accessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(expected.arr());
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+    assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
+
+    auto stats = static_cast<const HashAggStats*>(stage->getSpecificStats());
+    ASSERT_GT(stats->spills, 1U);
+    ASSERT_LT(stats->spilledRecords, static_cast<size_t>(kNumRows));
+    stage->close();
+}
+
+TEST_F(HashAggStageTest, SpillStatsAreReported) {
+    auto [scanSlots, scanStage] = generateVirtualScanMulti(
+        2, BSON_ARRAY(BSON_ARRAY(1 << 1) << BSON_ARRAY(2 << 2) << BSON_ARRAY(1 << 3)));
+    auto [outSlots, stage] = makeSumStage(scanSlots, std::move(scanStage), 0, true);
+
+    auto ctx = makeCompileCtx();
+    prepareTree(ctx.get(), stage.get());
+    while (stage->getNext() == PlanState::ADVANCED) {
+    }
+
+    auto stats = static_cast<const HashAggStats*>(stage->getSpecificStats());
+    ASSERT_EQ(stats->spills, 3U);
+    ASSERT_EQ(stats->spilledRecords, 3U);
+    ASSERT_GT(stats->spilledBytes, 0U);
+    stage->close();
+}
+
+TEST_F(HashAggStageTest, ExceedingMemoryLimitWithoutDiskUseFails) {
+    auto [scanSlots, scanStage] = generateVirtualScanMulti(
+        2, BSON_ARRAY(BSON_ARRAY(1 << 1) << BSON_ARRAY(2 << 2) << BSON_ARRAY(1 << 3)));
+    auto [outSlots, stage] = makeSumStage(scanSlots, std::move(scanStage), 0, false);
+
+    auto ctx = makeCompileCtx();
+    ASSERT_THROWS_CODE(prepareTree(ctx.get(), stage.get()),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
+TEST_F(HashAggStageTest, NoSpillingWithinMemoryLimit) {
+    auto [scanSlots, scanStage] = generateVirtualScanMulti(
+        2, BSON_ARRAY(BSON_ARRAY(1 << 1) << BSON_ARRAY(1 << 2) << BSON_ARRAY(1 << 3)));
+    auto [outSlots, stage] =
+        makeSumStage(scanSlots, std::move(scanStage), 100 * 1024 * 1024, false);
+
+    auto ctx = makeCompileCtx();
+    auto accessors = prepareTree(ctx.get(), stage.get(), outSlots);
+    ASSERT_TRUE(stage->getNext() == PlanState::ADVANCED);
+    auto [sumTag, sumVal] = accessors[1]->getViewOfValue();
+    assertValuesEqual(sumTag, sumVal, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(6));
+    ASSERT_TRUE(stage->getNext() == PlanState::IS_EOF);
+
+    auto stats = static_cast<const HashAggStats*>(stage->getSpecificStats());
+    ASSERT_EQ(stats->spills, 0U);
+    stage->close();
+}
+
+}  // namespace mongo::sbe
@@ -0,0 +1,471 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/block.h"
+
+namespace mongo {
+namespace sbe {
+namespace {
+boost::optional<vm::ColumnCompareOp> getColumnCompareOp(EPrimBinary::Op op) {
+    switch (op) {
+        case EPrimBinary::less:
+            return vm::ColumnCompareOp::less;
+        case EPrimBinary::lessEq:
+            return vm::ColumnCompareOp::lessEq;
+        case EPrimBinary::greater:
+            return vm::ColumnCompareOp::greater;
+        case EPrimBinary::greaterEq:
+            return vm::ColumnCompareOp::greaterEq;
+        case EPrimBinary::eq:
+            return vm::ColumnCompareOp::eq;
+        case EPrimBinary::neq:
+            return vm::ColumnCompareOp::neq;
+        default:
+            return boost::none;
+    }
+}
+
+boost::optional<vm::ColumnArithOp> getColumnArithOp(EPrimBinary::Op op) {
+    switch (op) {
+        case EPrimBinary::add:
+            return vm::ColumnArithOp::add;
+        case EPrimBinary::sub:
+            return vm::ColumnArithOp::sub;
+        case EPrimBinary::mul:
+            return vm::ColumnArithOp::mul;
+        default:
+            return boost::none;
+    }
+}
+}  // namespace
+
+BlockStage::BlockStage(std::unique_ptr<PlanStage> input,
+                       value::SlotVector vals,
+                       std::unique_ptr<EExpression> filter,
+                       value::SlotMap<std::unique_ptr<EExpression>> projects,
+                       size_t blockSize,
+                       PlanNodeId planNodeId)
+    : PlanStage("block"_sd, planNodeId),
+      _vals(std::move(vals)),
+      _filter(std::move(filter)),
+      _projects(std::move(projects)),
+      _blockSize(blockSize) {
+    invariant(_blockSize > 0);
+    _children.emplace_back(std::move(input));
+}
+
+std::unique_ptr<PlanStage> BlockStage::clone() const {
+    value::SlotMap<std::unique_ptr<EExpression>> projects;
+    for (auto& [k, v] : _projects) {
+        projects.emplace(k, v->clone());
+    }
+    return std::make_unique<BlockStage>(_children[0]->clone(),
+                                        _vals,
+                                        _filter ? _filter->clone() : nullptr,
+                                        std::move(projects),
+                                        _blockSize,
+                                        _commonStats.nodeId);
+}
+
+void BlockStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+
+    // The accessors of the buffered slots must not move once the expressions are compiled, so
+    // both vectors are sized upfront.
+    _columns.resize(_vals.size());
+    _columnAccessors.resize(_vals.size());
+    for (size_t idx = 0; idx < _vals.size(); ++idx) {
+        auto [it, inserted] = _columnIndex.emplace(_vals[idx], idx);
+        uassert(5188800, str::stream() << "duplicate field: " << _vals[idx], inserted);
+
+        _inAccessors.emplace_back(_children[0]->getAccessor(ctx, _vals[idx]));
+        _columns[idx].reserve(_blockSize);
+    }
+
+    if (_filter) {
+        ctx.root = this;
+        addConjuncts(_filter.get(), ctx);
+    }
+
+    _projections.reserve(_projects.size());
+    for (auto& [slot, expr] : _projects) {
+        uassert(5188801,
+                str::stream() << "duplicate field: " << slot,
+                _columnIndex.find(slot) == _columnIndex.end());
+
+        ctx.root = this;
+        addProjection(slot, expr.get(), ctx);
+        _projectionIndex.emplace(slot, _projections.size() - 1);
+    }
+    _compiled = true;
+}
+
+value::SlotAccessor* BlockStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _columnIndex.find(slot); it != _columnIndex.end()) {
+        return &_columnAccessors[it->second];
+    }
+
+    if (auto it = _projectionIndex.find(slot); _compiled && it != _projectionIndex.end()) {
+        return &_projections[it->second].accessor;
+    }
+
+    return ctx.getAccessor(slot);
+}
+
+boost::optional<size_t> BlockStage::matchColumn(const EExpression* expr) const {
+    auto variable = dynamic_cast<const EVariable*>(expr);
+    if (!variable || variable->getFrameId()) {
+        return boost::none;
+    }
+
+    if (auto it = _columnIndex.find(variable->getSlotId()); it != _columnIndex.end()) {
+        return it->second;
+    }
+    return boost::none;
+}
+
+boost::optional<BlockStage::ColumnOperand> BlockStage::matchColumnOperand(
+    const EExpression* lhs, const EExpression* rhs) const {
+    if (auto lhsColumn = matchColumn(lhs)) {
+        if (auto constant = dynamic_cast<const EConstant*>(rhs)) {
+            return ColumnOperand{*lhsColumn, constant, false};
+        }
+    } else if (auto rhsColumn = matchColumn(rhs)) {
+        if (auto constant = dynamic_cast<const EConstant*>(lhs)) {
+            return ColumnOperand{*rhsColumn, constant, true};
+        }
+    }
+    return boost::none;
+}
+
+void BlockStage::addConjuncts(const EExpression* expr, CompileCtx& ctx) {
+    auto binary = dynamic_cast<const EPrimBinary*>(expr);
+    if (binary && binary->getOp() == EPrimBinary::logicAnd) {
+        // The conjuncts are evaluated in order, each one over the rows selected by the previous
+        // ones only, which preserves the short-circuiting of the VM.
+        addConjuncts(binary->getNodes()[0].get(), ctx);
+        addConjuncts(binary->getNodes()[1].get(), ctx);
+        return;
+    }
+
+    Conjunct conjunct;
+    conjunct.code = expr->compile(ctx);
+
+    // A comparison may be guarded by 'isArray(<column>) || ...', to let the arrays through to a
+    // filter above this stage which checks their elements. The comparison kernel only accepts
+    // columns of numbers and missing values, which hold no arrays, so it can ignore the guard.
+    if (binary && binary->getOp() == EPrimBinary::logicOr) {
+        auto guard = dynamic_cast<const EFunction*>(binary->getNodes()[0].get());
+        auto compare = dynamic_cast<const EPrimBinary*>(binary->getNodes()[1].get());
+        if (guard && guard->getName() == "isArray" && guard->getNodes().size() == 1 && compare) {
+            auto column = matchColumn(guard->getNodes()[0].get());
+            auto op = getColumnCompareOp(compare->getOp());
+            auto operand =
+                matchColumnOperand(compare->getNodes()[0].get(), compare->getNodes()[1].get());
+            if (column && op && operand && operand->column == *column) {
+                conjunct.kind = Conjunct::Kind::compare;
+                conjunct.op = *op;
+                conjunct.operand = *operand;
+            }
+        }
+    } else if (binary) {
+        auto op = getColumnCompareOp(binary->getOp());
+        auto operand =
+            matchColumnOperand(binary->getNodes()[0].get(), binary->getNodes()[1].get());
+        if (op && operand) {
+            conjunct.kind = Conjunct::Kind::compare;
+            conjunct.op = *op;
+            conjunct.operand = *operand;
+        }
+    } else if (auto function = dynamic_cast<const EFunction*>(expr);
+               function && function->getNodes().size() == 1) {
+        if (auto column = matchColumn(function->getNodes()[0].get())) {
+            if (function->getName() == "exists") {
+                conjunct.kind = Conjunct::Kind::exists;
+                conjunct.operand.column = *column;
+            } else if (function->getName() == "isNumber") {
+                conjunct.kind = Conjunct::Kind::isNumber;
+                conjunct.operand.column = *column;
+            }
+        }
+    }
+
+    _conjuncts.emplace_back(std::move(conjunct));
+}
+
+void BlockStage::addProjection(value::SlotId slot, const EExpression* expr, CompileCtx& ctx) {
+    Projection projection;
+    projection.slot = slot;
+    projection.code = expr->compile(ctx);
+
+    if (auto binary = dynamic_cast<const EPrimBinary*>(expr)) {
+        auto op = getColumnArithOp(binary->getOp());
+        auto operand =
+            matchColumnOperand(binary->getNodes()[0].get(), binary->getNodes()[1].get());
+        if (op && operand) {
+            projection.vectorizable = true;
+            projection.op = *op;
+            projection.operand = *operand;
+        }
+    }
+
+    projection.values.reserve(_blockSize);
+    _projections.emplace_back(std::move(projection));
+}
+
+void BlockStage::open(bool reOpen) {
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+
+    _blockRows = 0;
+    _nextRow = 0;
+    _inputEof = false;
+}
+
+size_t BlockStage::readBlock() {
+    for (auto& column : _columns) {
+        column.clear();
+    }
+    for (auto& projection : _projections) {
+        projection.values.clear();
+    }
+
+    size_t size = 0;
+    while (size < _blockSize) {
+        if (_children[0]->getNext() == PlanState::IS_EOF) {
+            _inputEof = true;
+            break;
+        }
+
+        for (size_t idx = 0; idx < _inAccessors.size(); ++idx) {
+            auto [tag, val] = _inAccessors[idx]->copyOrMoveValue();
+            _columns[idx].push_back(tag, val);
+        }
+        ++size;
+    }
+    return size;
+}
+
+void BlockStage::positionColumnAccessors(size_t row) {
+    for (size_t idx = 0; idx < _columns.size(); ++idx) {
+        auto [tag, val] = _columns[idx].at(row);
+        _columnAccessors[idx].reset(tag, val);
+    }
+}
+
+void BlockStage::runFilter(size_t size) {
+    _selection.assign(size, 1);
+    if (_conjuncts.empty()) {
+        return;
+    }
+    _specificStats.numTested += size;
+
+    for (auto& conjunct : _conjuncts) {
+        bool vectorized = true;
+        switch (conjunct.kind) {
+            case Conjunct::Kind::exists:
+                vm::selectExists(_columns[conjunct.operand.column], _selection.data());
+                break;
+            case Conjunct::Kind::isNumber:
+                vm::selectIsNumber(_columns[conjunct.operand.column], _selection.data());
+                break;
+            case Conjunct::Kind::compare: {
+                auto [constTag, constVal] = conjunct.operand.constant->getConstant();
+                vectorized = vm::selectCompareConstant(_columns[conjunct.operand.column],
+                                                       conjunct.op,
+                                                       constTag,
+                                                       constVal,
+                                                       conjunct.operand.constantOnLeft,
+                                                       _selection.data());
+                break;
+            }
+            case Conjunct::Kind::generic:
+                vectorized = false;
+                break;
+        }
+
+        if (!vectorized) {
+            _specificStats.numFallbacks++;
+            for (size_t row = 0; row < size; ++row) {
+                if (_selection[row]) {
+                    positionColumnAccessors(row);
+                    _selection[row] = _bytecode.runPredicate(conjunct.code.get());
+                }
+            }
+        }
+    }
+}
+
+void BlockStage::runProjections(size_t size) {
+    for (auto& projection : _projections) {
+        if (projection.vectorizable) {
+            auto [constTag, constVal] = projection.operand.constant->getConstant();
+            if (vm::computeArithConstant(_columns[projection.operand.column],
+                                         projection.op,
+                                         constTag,
+                                         constVal,
+                                         projection.operand.constantOnLeft,
+                                         _selection.data(),
+                                         &projection.values)) {
+                continue;
+            }
+        }
+
+        _specificStats.numFallbacks++;
+        auto [tags, vals] = projection.values.extend(size);
+        for (size_t row = 0; row < size; ++row) {
+            if (_selection[row]) {
+                positionColumnAccessors(row);
+                auto [owned, tag, val] = _bytecode.run(projection.code.get());
+                if (!owned) {
+                    std::tie(tag, val) = value::copyValue(tag, val);
+                }
+                tags[row] = tag;
+                vals[row] = val;
+            }
+        }
+    }
+}
+
+PlanState BlockStage::getNext() {
+    while (true) {
+        while (_nextRow < _blockRows) {
+            auto row = _nextRow++;
+            if (_selection[row]) {
+                positionColumnAccessors(row);
+                for (auto& projection : _projections) {
+                    auto [tag, val] = projection.values.at(row);
+                    projection.accessor.reset(tag, val);
+                }
+                return trackPlanState(PlanState::ADVANCED);
+            }
+        }
+
+        if (_inputEof) {
+            return trackPlanState(PlanState::IS_EOF);
+        }
+
+        _blockRows = readBlock();
+        _nextRow = 0;
+        if (_blockRows > 0) {
+            _specificStats.numBlocks++;
+            runFilter(_blockRows);
+            runProjections(_blockRows);
+        }
+    }
+}
+
+void BlockStage::close() {
+    _commonStats.closes++;
+    _children[0]->close();
+
+    for (auto& column : _columns) {
+        column.clear();
+    }
+    for (auto& projection : _projections) {
+        projection.values.clear();
+    }
+    _blockRows = 0;
+    _nextRow = 0;
+}
+
+std::unique_ptr<PlanStageStats> BlockStage::getStats(bool includeDebugInfo) const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<BlockStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        DebugPrinter printer;
+        BSONObjBuilder bob;
+        bob.appendNumber("blockSize", static_cast<long long>(_blockSize));
+        bob.appendNumber("numBlocks", static_cast<long long>(_specificStats.numBlocks));
+        bob.appendNumber("numTested", static_cast<long long>(_specificStats.numTested));
+        bob.appendNumber("numFallbacks", static_cast<long long>(_specificStats.numFallbacks));
+        if (_filter) {
+            bob.append("filter", printer.print(_filter->debugPrint()));
+        }
+        BSONObjBuilder projectsBob(bob.subobjStart("projections"));
+        for (auto&& [slot, expr] : _projects) {
+            projectsBob.append(str::stream() << slot, printer.print(expr->debugPrint()));
+        }
+        projectsBob.doneFast();
+        ret->debugInfo = bob.obj();
+    }
+
+    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    return ret;
+}
+
+const SpecificStats* BlockStage::getSpecificStats() const {
+    return &_specificStats;
+}
+
+std::vector<DebugPrinter::Block> BlockStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _vals.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+
+        DebugPrinter::addIdentifier(ret, _vals[idx]);
+    }
+    ret.emplace_back("`]");
+
+    ret.emplace_back("{`");
+    if (_filter) {
+        DebugPrinter::addBlocks(ret, _filter->debugPrint());
+    }
+    ret.emplace_back("`}");
+
+    ret.emplace_back("[`");
+    bool first = true;
+    for (auto& p : _projects) {
+        if (!first) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+
+        DebugPrinter::addIdentifier(ret, p.first);
+        ret.emplace_back("=");
+        DebugPrinter::addBlocks(ret, p.second->debugPrint());
+        first = false;
+    }
+    ret.emplace_back("`]");
+
+    ret.emplace_back(std::to_string(_blockSize));
+
+    DebugPrinter::addNewLine(ret);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    return ret;
+}
+}  // namespace sbe
+}  // namespace mongo
@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/sbe/vm/vectorized.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+namespace mongo::sbe {
+/**
+ * This is a block-at-a-time filter and project stage. It buffers the values of the 'vals' slots
+ * for up to 'blockSize' rows of its input into columns, and then evaluates the 'filter' and the
+ * 'projects' expressions over whole columns at once instead of running the VM for every row.
+ * Selected rows are then returned one at a time, so the stage can be placed anywhere a pair of
+ * filter and project stages would go.
+ *
+ * Only some shapes of expressions have column kernels: the conjuncts of the filter may compare a
+ * buffered slot with a constant, optionally as 'isArray(<slot>) || <slot> <op> <constant>', or
+ * test it with the 'exists' and 'isNumber' builtins, and the projects may add, subtract or
+ * multiply a buffered slot by a constant. Any other expression, as well as any column the kernels
+ * can't process (e.g. because its values are of different types), is evaluated by the VM row by
+ * row, which produces the same results, only more slowly.
+ *
+ * The filter and the projects can only reference the 'vals' slots and slots defined above this
+ * stage, and the parent of this stage can only access the 'vals' slots and the projected slots,
+ * as the other slots of the input don't hold the values of the row being returned.
+ */
+class BlockStage final : public PlanStage {
+public:
+    BlockStage(std::unique_ptr<PlanStage> input,
+               value::SlotVector vals,
+               std::unique_ptr<EExpression> filter,
+               value::SlotMap<std::unique_ptr<EExpression>> projects,
+               size_t blockSize,
+               PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats(bool includeDebugInfo) const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+private:
+    /**
+     * The operand of an expression of the form '<slot> <op> <constant>', or '<constant> <op>
+     * <slot>' if 'constantOnLeft' is true, where the slot is one of the buffered slots.
+     */
+    struct ColumnOperand {
+        size_t column;
+        const EConstant* constant;
+        bool constantOnLeft;
+    };
+
+    /**
+     * A conjunct of the filter. If 'kind' is not 'generic' then the conjunct can be evaluated over
+     * a whole column by a kernel, which may still refuse some blocks. The compiled 'code' is then
+     * used instead.
+     */
+    struct Conjunct {
+        enum class Kind { generic, exists, isNumber, compare };
+
+        Kind kind{Kind::generic};
+        vm::ColumnCompareOp op{vm::ColumnCompareOp::eq};
+        ColumnOperand operand{};
+        std::unique_ptr<vm::CodeFragment> code;
+    };
+
+    /**
+     * A projected slot. If 'vectorizable' is true then the expression can be evaluated over a whole
+     * column by a kernel, which may still refuse some blocks. The compiled 'code' is then used
+     * instead. The values of the slot for the whole block are stored in 'values'.
+     */
+    struct Projection {
+        value::SlotId slot;
+        bool vectorizable{false};
+        vm::ColumnArithOp op{vm::ColumnArithOp::add};
+        ColumnOperand operand{};
+        std::unique_ptr<vm::CodeFragment> code;
+        vm::ValueColumn values;
+        value::ViewOfValueAccessor accessor;
+    };
+
+    boost::optional<ColumnOperand> matchColumnOperand(const EExpression* lhs,
+                                                      const EExpression* rhs) const;
+    boost::optional<size_t> matchColumn(const EExpression* expr) const;
+    void addConjuncts(const EExpression* expr, CompileCtx& ctx);
+    void addProjection(value::SlotId slot, const EExpression* expr, CompileCtx& ctx);
+
+    /**
+     * Pulls up to '_blockSize' rows from the input into the columns. Returns the number of rows
+     * which were read.
+     */
+    size_t readBlock();
+    void runFilter(size_t size);
+    void runProjections(size_t size);
+
+    /**
+     * Points the accessors of the buffered slots at the values of the given row of the block, so
+     * that the VM can evaluate expressions over it.
+     */
+    void positionColumnAccessors(size_t row);
+
+    const value::SlotVector _vals;
+    const std::unique_ptr<EExpression> _filter;
+    const value::SlotMap<std::unique_ptr<EExpression>> _projects;
+    const size_t _blockSize;
+
+    std::vector<value::SlotAccessor*> _inAccessors;
+    value::SlotMap<size_t> _columnIndex;
+    std::vector<vm::ValueColumn> _columns;
+    std::vector<value::ViewOfValueAccessor> _columnAccessors;
+
+    std::vector<Conjunct> _conjuncts;
+    std::vector<Projection> _projections;
+    value::SlotMap<size_t> _projectionIndex;
+    bool _compiled{false};
+
+    vm::ByteCode _bytecode;
+
+    // One byte per row of the current block, which is non-zero if the row passed the filter.
+    std::vector<uint8_t> _selection;
+    size_t _blockRows{0};
+    size_t _nextRow{0};
+    bool _inputEof{false};
+
+    BlockStats _specificStats;
+};
+}  // namespace mongo::sbe
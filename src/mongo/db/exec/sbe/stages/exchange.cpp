@@ -31,10 +31,33 @@
 
 #include "mongo/db/exec/sbe/stages/exchange.h"
 
+#include <algorithm>
+
 #include "mongo/base/init.h"
 #include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
 
 namespace mongo::sbe {
+namespace {
+/**
+ * Makes a deep copy of 'stats', which unlike PlanStageStats::clone() also copies their debug info
+ * when 'includeDebugInfo' is true.
+ */
+std::unique_ptr<PlanStageStats> copyStats(const PlanStageStats& stats, bool includeDebugInfo) {
+    auto ret = std::make_unique<PlanStageStats>(stats.common);
+    if (stats.specific) {
+        ret->specific.reset(stats.specific->clone());
+    }
+    if (includeDebugInfo) {
+        ret->debugInfo = stats.debugInfo;
+    }
+    for (auto& child : stats.children) {
+        ret->children.emplace_back(copyStats(*child, includeDebugInfo));
+    }
+    return ret;
+}
+}  // namespace
+
 std::unique_ptr<ThreadPool> s_globalThreadPool;
 MONGO_INITIALIZER(s_globalThreadPool)(InitializerContext* context) {
     ThreadPool::Options options;
@@ -126,7 +149,9 @@ ExchangeState::ExchangeState(size_t numOfProducers,
       _numOfProducers(numOfProducers),
       _fields(std::move(fields)),
       _partition(std::move(partition)),
-      _orderLess(std::move(orderLess)) {}
+      _orderLess(std::move(orderLess)) {
+    _producerStats.resize(_numOfProducers);
+}
 
 ExchangePipe* ExchangeState::pipe(size_t consumerTid, size_t producerTid) {
     return _consumers[consumerTid]->pipe(producerTid);
@@ -247,6 +272,14 @@ void ExchangeConsumer::open(bool reOpen) {
                 }
             }
 
+            // The producers read on their own OperationContexts. Make them read at the timestamp
+            // of this consumer, e.g. the lastApplied timestamp on a secondary, rather than at the
+            // latest data, so that all of them see the snapshot a serial plan would see.
+            _state->producerReadTimestamp() =
+                _opCtx->recoveryUnit()->getPointInTimeReadTimestamp(_opCtx);
+            _state->producerPrepareConflictBehavior() =
+                _opCtx->recoveryUnit()->getPrepareConflictBehavior();
+
             // Start n producers.
             invariant(_state->producerCompileCtxs().size() == _state->numOfProducers());
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
@@ -256,6 +289,12 @@ void ExchangeConsumer::open(bool reOpen) {
                         invariant(status);
 
                         auto opCtx = cc().makeOperationContext();
+                        if (auto readTimestamp = _state->producerReadTimestamp()) {
+                            opCtx->recoveryUnit()->setTimestampReadSource(
+                                RecoveryUnit::ReadSource::kProvided, *readTimestamp);
+                        }
+                        opCtx->recoveryUnit()->setPrepareConflictBehavior(
+                            _state->producerPrepareConflictBehavior());
 
                         promise.setWith([&] {
                             ExchangeProducer::start(opCtx.get(),
@@ -361,7 +400,27 @@ void ExchangeConsumer::close() {
 
 std::unique_ptr<PlanStageStats> ExchangeConsumer::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
-    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    // Once the exchange is opened the subtree is handed over to the producers, whose stats are
+    // reported by the first consumer once all of them are done. A producer is about to be done
+    // once this consumer received its EOF.
+    const auto& producerResults = _state->producerResults();
+    if (!_children.empty()) {
+        ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    } else if (_tid == 0 && producerResults.size() == _state->numOfProducers() &&
+               (_eofs == _state->numOfProducers() ||
+                std::all_of(producerResults.begin(),
+                            producerResults.end(),
+                            [](auto& result) { return result.isReady(); }))) {
+        for (auto& result : producerResults) {
+            result.wait();
+        }
+        for (auto& producerStats : _state->producerStats()) {
+            if (!producerStats) {
+                continue;
+            }
+            ret->children.emplace_back(copyStats(*producerStats, includeDebugInfo));
+        }
+    }
     return ret;
 }
 
@@ -394,8 +453,10 @@ std::vector<DebugPrinter::Block> ExchangeConsumer::debugPrint() const {
             uasserted(4822835, "policy not yet implemented");
     }
 
-    DebugPrinter::addNewLine(ret);
-    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    if (!_children.empty()) {
+        DebugPrinter::addNewLine(ret);
+        DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    }
 
     return ret;
 }
@@ -473,6 +534,10 @@ void ExchangeProducer::start(OperationContext* opCtx,
         p->closePipes();
         throw;
     }
+
+    // The producer plan is destroyed along with this thread's OperationContext, so save its stats
+    // for the explain output of the consumer.
+    p->_state->producerStats()[p->_tid] = p->getStats(true /* includeDebugInfo */);
 }
 
 std::unique_ptr<PlanStage> ExchangeProducer::clone() const {
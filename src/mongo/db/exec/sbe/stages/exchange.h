@@ -29,10 +29,13 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <vector>
 
+#include "mongo/bson/timestamp.h"
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/storage/recovery_unit.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/future.h"
 #include "mongo/util/concurrency/thread_pool.h"
@@ -205,6 +208,18 @@ public:
         return _producerResults;
     }
 
+    auto& producerStats() {
+        return _producerStats;
+    }
+
+    auto& producerReadTimestamp() {
+        return _producerReadTimestamp;
+    }
+
+    auto& producerPrepareConflictBehavior() {
+        return _producerPrepareConflictBehavior;
+    }
+
     auto numOfConsumers() const {
         return _consumers.size();
     }
@@ -226,6 +241,16 @@ private:
     std::vector<CompileCtx> _producerCompileCtxs;
     std::vector<Future<void>> _producerResults;
 
+    // The stats of the producer plans, including their debug info, which are saved by every
+    // producer once it is done, as the producer plans are destroyed with their threads.
+    std::vector<std::unique_ptr<PlanStageStats>> _producerStats;
+
+    // The read timestamp of the consumer, if it has one, at which every producer opens its
+    // snapshot, so that the producers see the same data as the consumer's own snapshot would.
+    boost::optional<Timestamp> _producerReadTimestamp;
+
+    PrepareConflictBehavior _producerPrepareConflictBehavior{PrepareConflictBehavior::kEnforce};
+
     // Variables (fields) that pass through the exchange.
     const value::SlotVector _fields;
 
@@ -31,16 +31,75 @@
 
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 
+#include "mongo/db/stats/resource_consumption_metrics.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashAggFileCounter;
+    return "extsort-hash-agg-sbe." + std::to_string(hashAggFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
+namespace {
+/**
+ * Orders group-by keys for the purpose of writing and merging spilled runs.
+ */
+int compareKeys(const value::MaterializedRow& lhs, const value::MaterializedRow& rhs) {
+    for (size_t idx = 0; idx < lhs.size(); ++idx) {
+        auto [lhsTag, lhsVal] = lhs.getViewOfValue(idx);
+        auto [rhsTag, rhsVal] = rhs.getViewOfValue(idx);
+        auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal);
+
+        auto result = value::bitcastTo<int32_t>(val);
+        if (result) {
+            return result;
+        }
+    }
+
+    return 0;
+}
+}  // namespace
+
 HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
                            value::SlotVector gbs,
                            value::SlotMap<std::unique_ptr<EExpression>> aggs,
                            PlanNodeId planNodeId)
-    : PlanStage("group"_sd, planNodeId), _gbs(std::move(gbs)), _aggs(std::move(aggs)) {
+    : HashAggStage(std::move(input),
+                   std::move(gbs),
+                   std::move(aggs),
+                   {},
+                   std::numeric_limits<size_t>::max(),
+                   false,
+                   planNodeId) {}
+
+HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
+                           value::SlotVector gbs,
+                           value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                           MergingExprs mergingExprs,
+                           size_t memoryLimit,
+                           bool allowDiskUse,
+                           PlanNodeId planNodeId)
+    : PlanStage("group"_sd, planNodeId),
+      _gbs(std::move(gbs)),
+      _aggs(std::move(aggs)),
+      _mergingExprs(std::move(mergingExprs)),
+      _allowDiskUse(allowDiskUse),
+      _spilledRow({0, 0}) {
     _children.emplace_back(std::move(input));
+
+    // Spilled partial aggregates can only be combined if every accumulator can be merged.
+    invariant(!_allowDiskUse || _mergingExprs.size() == _aggs.size());
+
+    _specificStats.maxMemoryUsageBytes = memoryLimit;
+}
+
+HashAggStage::~HashAggStage() {
+    removeSpillFile();
 }
 
 std::unique_ptr<PlanStage> HashAggStage::clone() const {
@@ -48,8 +107,17 @@ std::unique_ptr<PlanStage> HashAggStage::clone() const {
     for (auto& [k, v] : _aggs) {
         aggs.emplace(k, v->clone());
     }
-    return std::make_unique<HashAggStage>(
-        _children[0]->clone(), _gbs, std::move(aggs), _commonStats.nodeId);
+    MergingExprs mergingExprs;
+    for (auto& [k, v] : _mergingExprs) {
+        mergingExprs.emplace(k, std::make_pair(v.first, v.second->clone()));
+    }
+    return std::make_unique<HashAggStage>(_children[0]->clone(),
+                                          _gbs,
+                                          std::move(aggs),
+                                          std::move(mergingExprs),
+                                          _specificStats.maxMemoryUsageBytes,
+                                          _allowDiskUse,
+                                          _commonStats.nodeId);
 }
 
 void HashAggStage::prepare(CompileCtx& ctx) {
@@ -76,7 +144,7 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         const auto slotId = slot;
         uassert(4822828, str::stream() << "duplicate field: " << slotId, inserted);
 
-        _outAggAccessors.emplace_back(std::make_unique<HashAggAccessor>(_htIt, counter++));
+        _outAggAccessors.emplace_back(std::make_unique<HashAggAccessor>(_htIt, counter));
         _outAccessors[slot] = _outAggAccessors.back().get();
 
         ctx.root = this;
@@ -84,7 +152,23 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         ctx.accumulator = _outAggAccessors.back().get();
 
         _aggCodes.emplace_back(expr->compile(ctx));
+
+        // The merging expression accumulates into the same accumulator, reading the spilled
+        // partial aggregate from its own slot.
+        if (auto mergeIt = _mergingExprs.find(slot); mergeIt != _mergingExprs.end()) {
+            auto& [spillSlot, mergingExpr] = mergeIt->second;
+            auto [spillIt, spillInserted] = dupCheck.emplace(spillSlot);
+            const auto spillSlotId = spillSlot;
+            uassert(5188700, str::stream() << "duplicate field: " << spillSlotId, spillInserted);
+
+            _spilledAggAccessors.emplace_back(
+                std::make_unique<SpilledRowAccessor>(_spilledRowIt, counter));
+            _spilledAccessorsMap[spillSlot] = _spilledAggAccessors.back().get();
+
+            _mergingCodes.emplace_back(mergingExpr->compile(ctx));
+        }
         ctx.aggExpression = false;
+        ++counter;
     }
     _compiled = true;
 }
@@ -95,19 +179,93 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
             return it->second;
         }
     } else {
+        if (auto it = _spilledAccessorsMap.find(slot); it != _spilledAccessorsMap.end()) {
+            return it->second;
+        }
+
         return _children[0]->getAccessor(ctx, slot);
     }
 
     return ctx.getAccessor(slot);
 }
 
+bool HashAggStage::shouldSpill() const {
+    if (_memoryUsage <= _specificStats.maxMemoryUsageBytes) {
+        return false;
+    }
+
+    uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+            str::stream() << "Hash aggregation exceeded memory limit of "
+                          << _specificStats.maxMemoryUsageBytes
+                          << " bytes, but did not opt in to external sorting.",
+            _allowDiskUse);
+    return true;
+}
+
+void HashAggStage::spill() {
+    if (_spillFileName.empty()) {
+        _spillFileName = storageGlobalParams.dbpath + "/_tmp/" + nextFileName();
+        _nextSpillFileOffset = 0;
+    }
+
+    // Sort pointers rather than the rows themselves to avoid copying them.
+    std::vector<const TableType::value_type*> rows;
+    rows.reserve(_ht.size());
+    for (auto& row : _ht) {
+        rows.push_back(&row);
+    }
+    std::sort(rows.begin(), rows.end(), [](const auto* lhs, const auto* rhs) {
+        return compareKeys(lhs->first, rhs->first) < 0;
+    });
+
+    SortedFileWriter<value::MaterializedRow, value::MaterializedRow> writer(
+        SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp"),
+        _spillFileName,
+        _nextSpillFileOffset);
+    for (auto row : rows) {
+        writer.addAlreadySorted(row->first, row->second);
+    }
+    _spilledRuns.emplace_back(writer.done());
+
+    auto fileEndOffset = writer.getFileEndOffset();
+    _specificStats.spilledBytes += static_cast<size_t>(fileEndOffset - _nextSpillFileOffset);
+    _specificStats.spilledRecords += rows.size();
+    ++_specificStats.spills;
+    _nextSpillFileOffset = fileEndOffset;
+
+    auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+    metricsCollector.incrementKeysSorted(rows.size());
+    metricsCollector.incrementSorterSpills(1);
+
+    _ht.clear();
+    _memoryUsage = 0;
+}
+
+void HashAggStage::removeSpillFile() {
+    _mergeIt.reset();
+    _spilledRuns.clear();
+    _haveSpilledRow = false;
+
+    if (!_spillFileName.empty()) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(_spillFileName, ec);
+        _spillFileName.clear();
+    }
+}
+
 void HashAggStage::open(bool reOpen) {
     _commonStats.opens++;
     _children[0]->open(reOpen);
 
     if (reOpen) {
         _ht.clear();
+        removeSpillFile();
     }
+    _memoryUsage = 0;
+
+    // Only pay for the memory accounting if there is a limit to enforce.
+    const bool trackMemory =
+        _specificStats.maxMemoryUsageBytes != std::numeric_limits<size_t>::max();
 
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow key{_inKeyAccessors.size()};
@@ -124,22 +282,93 @@ void HashAggStage::open(bool reOpen) {
             const_cast<value::MaterializedRow&>(it->first).makeOwned();
             // Initialize accumulators.
             it->second.resize(_outAggAccessors.size());
+
+            if (trackMemory) {
+                _memoryUsage += it->first.memUsageForSorter();
+            }
         }
 
+        // The accumulators may grow (e.g. when building an array), so account for the difference
+        // in their size rather than just for the new groups.
+        const size_t oldAggSize = trackMemory ? it->second.memUsageForSorter() : 0;
+
         // Accumulate.
         _htIt = it;
         for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
             auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
             _outAggAccessors[idx]->reset(owned, tag, val);
         }
+
+        if (trackMemory) {
+            _memoryUsage = _memoryUsage + it->second.memUsageForSorter() - oldAggSize;
+            if (shouldSpill()) {
+                spill();
+            }
+        }
     }
 
     _children[0]->close();
 
+    if (!_spilledRuns.empty()) {
+        // Write out the remaining groups as well, so that all of them are returned through the
+        // merge of the spilled runs.
+        if (!_ht.empty()) {
+            spill();
+        }
+
+        _mergeIt.reset(SpillIterator::merge(
+            _spilledRuns, SortOptions(), [](const SpilledRow& lhs, const SpilledRow& rhs) {
+                return compareKeys(lhs.first, rhs.first);
+            }));
+        _haveSpilledRow = false;
+    }
+
     _htIt = _ht.end();
 }
 
+bool HashAggStage::readNextSpilledGroup() {
+    // The hash table only ever holds the group which was returned last.
+    _ht.clear();
+
+    if (!_haveSpilledRow) {
+        if (!_mergeIt->more()) {
+            return false;
+        }
+        _spilledRow = _mergeIt->next();
+    }
+    _haveSpilledRow = false;
+
+    auto [it, inserted] =
+        _ht.emplace(std::move(_spilledRow.first), std::move(_spilledRow.second));
+    invariant(inserted);
+    _htIt = it;
+
+    // The runs are merged in key order, so all partial aggregates of this group follow it.
+    while (_mergeIt->more()) {
+        _spilledRow = _mergeIt->next();
+        if (compareKeys(_spilledRow.first, _htIt->first) != 0) {
+            _haveSpilledRow = true;
+            break;
+        }
+
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [owned, tag, val] = _bytecode.run(_mergingCodes[idx].get());
+            _outAggAccessors[idx]->reset(owned, tag, val);
+        }
+    }
+
+    return true;
+}
+
 PlanState HashAggStage::getNext() {
+    if (_mergeIt) {
+        if (!readNextSpilledGroup()) {
+            return trackPlanState(PlanState::IS_EOF);
+        }
+
+        return trackPlanState(PlanState::ADVANCED);
+    }
+
     if (_htIt == _ht.end()) {
         _htIt = _ht.begin();
     } else {
@@ -155,6 +384,7 @@ PlanState HashAggStage::getNext() {
 
 std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashAggStats>(_specificStats);
 
     if (includeDebugInfo) {
         DebugPrinter printer;
@@ -166,6 +396,20 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
                 childrenBob.append(str::stream() << slot, printer.print(expr->debugPrint()));
             }
         }
+        if (!_mergingExprs.empty()) {
+            BSONObjBuilder childrenBob(bob.subobjStart("mergingExprs"));
+            for (auto&& [slot, mergingExpr] : _mergingExprs) {
+                childrenBob.append(str::stream() << slot,
+                                   printer.print(mergingExpr.second->debugPrint()));
+            }
+        }
+        if (_specificStats.maxMemoryUsageBytes != std::numeric_limits<size_t>::max()) {
+            bob.appendIntOrLL("memLimit", _specificStats.maxMemoryUsageBytes);
+        }
+        bob.appendBool("usedDisk", _specificStats.spills > 0);
+        bob.appendIntOrLL("spills", _specificStats.spills);
+        bob.appendIntOrLL("spilledRecords", _specificStats.spilledRecords);
+        bob.appendIntOrLL("spilledBytes", _specificStats.spilledBytes);
         ret->debugInfo = bob.obj();
     }
 
@@ -174,12 +418,13 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
 }
 
 const SpecificStats* HashAggStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 void HashAggStage::close() {
     _commonStats.closes++;
     _ht.clear();
+    removeSpillFile();
 }
 
 std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
@@ -209,6 +454,28 @@ std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
     }
     ret.emplace_back("`]");
 
+    if (!_mergingExprs.empty() ||
+        _specificStats.maxMemoryUsageBytes != std::numeric_limits<size_t>::max()) {
+        ret.emplace_back("spill");
+        ret.emplace_back(std::to_string(_specificStats.maxMemoryUsageBytes));
+        ret.emplace_back(_allowDiskUse ? "true" : "false");
+
+        ret.emplace_back(DebugPrinter::Block("[`"));
+        first = true;
+        for (auto&& [slot, mergingExpr] : _mergingExprs) {
+            if (!first) {
+                ret.emplace_back(DebugPrinter::Block("`,"));
+            }
+
+            DebugPrinter::addIdentifier(ret, slot);
+            DebugPrinter::addIdentifier(ret, mergingExpr.first);
+            ret.emplace_back("=");
+            DebugPrinter::addBlocks(ret, mergingExpr.second->debugPrint());
+            first = false;
+        }
+        ret.emplace_back("`]");
+    }
+
     DebugPrinter::addNewLine(ret);
     DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
 
@@ -37,14 +37,41 @@
 #include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+
 namespace sbe {
+/**
+ * Groups the input rows by the values of the 'gbs' slots and evaluates the 'aggs' accumulators
+ * for every group. The groups are kept in an in-memory hash table.
+ *
+ * If the estimated size of the hash table exceeds 'memoryLimit' and 'allowDiskUse' is set, the
+ * partial aggregates are sorted by the group-by key, written to disk as a sorted run and the table
+ * is emptied. Once the input is exhausted, the runs are merged and the partial aggregates of the
+ * same group are combined by the 'mergingExprs'. These are keyed by the output slot of the
+ * accumulator they merge into, and read the partial aggregate being merged in through their
+ * paired slot. If the limit is exceeded and spilling is not allowed, the stage uasserts.
+ */
 class HashAggStage final : public PlanStage {
 public:
+    using MergingExprs =
+        value::SlotMap<std::pair<value::SlotId, std::unique_ptr<EExpression>>>;
+
+    HashAggStage(std::unique_ptr<PlanStage> input,
+                 value::SlotVector gbs,
+                 value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                 PlanNodeId planNodeId);
+
     HashAggStage(std::unique_ptr<PlanStage> input,
                  value::SlotVector gbs,
                  value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                 MergingExprs mergingExprs,
+                 size_t memoryLimit,
+                 bool allowDiskUse,
                  PlanNodeId planNodeId);
 
+    ~HashAggStage();
+
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -64,8 +91,35 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashAggAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpilledRowAccessor = value::MaterializedRowValueAccessor<SpilledRow*>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+
+    /**
+     * Sorts the contents of the hash table by key, appends them to the spill file as a new sorted
+     * run and empties the table.
+     */
+    void spill();
+
+    /**
+     * Reads the next group from the merged spilled runs into the (otherwise empty) hash table,
+     * merging the partial aggregates of all runs which hold the same key. Returns false once all
+     * runs have been exhausted.
+     */
+    bool readNextSpilledGroup();
+
+    /**
+     * Returns true if the estimated memory footprint of the hash table has exceeded the limit.
+     * Throws if the limit has been exceeded but the stage is not allowed to spill.
+     */
+    bool shouldSpill() const;
+
+    void removeSpillFile();
+
     const value::SlotVector _gbs;
     const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
+    const MergingExprs _mergingExprs;
+    const bool _allowDiskUse;
 
     value::SlotAccessorMap _outAccessors;
     std::vector<value::SlotAccessor*> _inKeyAccessors;
@@ -74,12 +128,31 @@ private:
     std::vector<std::unique_ptr<HashAggAccessor>> _outAggAccessors;
     std::vector<std::unique_ptr<vm::CodeFragment>> _aggCodes;
 
+    // Accessors to the partial aggregates read back from disk, and the code combining them with
+    // the accumulators in the hash table.
+    value::SlotAccessorMap _spilledAccessorsMap;
+    std::vector<std::unique_ptr<SpilledRowAccessor>> _spilledAggAccessors;
+    std::vector<std::unique_ptr<vm::CodeFragment>> _mergingCodes;
+
     TableType _ht;
     TableType::iterator _htIt;
 
+    // Estimated number of bytes held by the hash table.
+    size_t _memoryUsage{0};
+
+    std::string _spillFileName;
+    std::streampos _nextSpillFileOffset{0};
+    std::vector<std::shared_ptr<SpillIterator>> _spilledRuns;
+    std::unique_ptr<SpillIterator> _mergeIt;
+    SpilledRow _spilledRow;
+    SpilledRow* _spilledRowIt{&_spilledRow};
+    bool _haveSpilledRow{false};
+
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    HashAggStats _specificStats;
 };
 }  // namespace sbe
 }  // namespace mongo
@@ -115,6 +115,21 @@ struct FilterStats final : public SpecificStats {
     size_t numTested{0};
 };
 
+struct BlockStats final : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new BlockStats(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    size_t numBlocks{0};
+    size_t numTested{0};
+    // The number of times an expression had to be evaluated row by row over a block.
+    size_t numFallbacks{0};
+};
+
 struct LimitSkipStats final : public SpecificStats {
     SpecificStats* clone() const final {
         return new LimitSkipStats(*this);
@@ -195,6 +210,27 @@ struct TraverseStats : public SpecificStats {
     size_t innerCloses{0};
 };
 
+struct HashAggStats final : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new HashAggStats(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    void accumulate(PlanSummaryStats& summary) const final {
+        if (spills > 0) {
+            summary.usedDisk = true;
+        }
+    }
+
+    size_t maxMemoryUsageBytes{0};
+    size_t spills{0};
+    size_t spilledRecords{0};
+    size_t spilledBytes{0};
+};
+
 /**
  * Calculates the total number of physical reads in the given plan stats tree. If a stage can do
  * a physical read (e.g. COLLSCAN or IXSCAN), then its 'numReads' stats is added to the total.
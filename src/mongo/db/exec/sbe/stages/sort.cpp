@@ -199,6 +199,8 @@ void SortStage::open(bool reOpen) {
     _specificStats.totalDataSizeBytes += _sorter->totalDataSizeSorted();
     _mergeIt.reset(_sorter->done());
     _specificStats.spills += _sorter->numSpills();
+    _specificStats.spilledDataSizeBytes += _sorter->spilledDataSize();
+    _specificStats.spilledDataStorageSizeBytes += _sorter->spilledDataStorageSize();
     _specificStats.keysSorted += _sorter->numSorted();
     auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
     metricsCollector.incrementKeysSorted(_sorter->numSorted());
@@ -233,6 +235,11 @@ std::unique_ptr<PlanStageStats> SortStage::getStats(bool includeDebugInfo) const
         bob.appendIntOrLL("memLimit", _specificStats.maxMemoryUsageBytes);
         bob.appendIntOrLL("totalDataSizeSorted", _specificStats.totalDataSizeBytes);
         bob.appendBool("usedDisk", _specificStats.spills > 0);
+        if (_specificStats.spills > 0) {
+            bob.appendIntOrLL("spilledDataSize", _specificStats.spilledDataSizeBytes);
+            bob.appendIntOrLL("spilledDataStorageSize",
+                              _specificStats.spilledDataStorageSizeBytes);
+        }
 
         BSONObjBuilder childrenBob(bob.subobjStart("orderBySlots"));
         for (size_t idx = 0; idx < _obs.size(); ++idx) {
@@ -278,7 +278,7 @@ public:
     }
 
 protected:
-    PlanYieldPolicy* const _yieldPolicy{nullptr};
+    PlanYieldPolicy* _yieldPolicy{nullptr};
 
 private:
     static const int kInterruptCheckPeriod = 128;
@@ -340,6 +340,26 @@ public:
      */
     virtual void close() = 0;
 
+    /**
+     * Makes every stage in this tree which has yielding enabled yield according to 'yieldPolicy'
+     * instead of the policy it was constructed, or cloned, with. Must be called before prepare().
+     *
+     * Propagates to all children.
+     */
+    void attachNewYieldPolicy(PlanYieldPolicy* yieldPolicy) {
+        invariant(yieldPolicy);
+
+        for (auto&& child : _children) {
+            child->attachNewYieldPolicy(yieldPolicy);
+        }
+
+        // Stages cloned from a tree built for another query inherit its yield policy. Only the
+        // stages which had yielding enabled in the first place should yield.
+        if (_yieldPolicy) {
+            _yieldPolicy = yieldPolicy;
+        }
+    }
+
     virtual std::vector<DebugPrinter::Block> debugPrint() const {
         auto stats = getCommonStats();
         std::string str = str::stream() << '[' << stats->nodeId << "] " << stats->stageType;
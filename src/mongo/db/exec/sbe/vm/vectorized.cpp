@@ -0,0 +1,495 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/vm/vectorized.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "mongo/platform/overflow_arithmetic.h"
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+using namespace value;
+
+namespace {
+/**
+ * Returns the tag shared by all the values of the column which are not Nothing, or Nothing if all
+ * the values are Nothing. Returns boost::none if the column holds values of more than one type
+ * other than Nothing, in which case the kernels below can't process it with a tight loop.
+ */
+boost::optional<TypeTags> getColumnType(const ValueColumn& column) {
+    auto tags = column.tags();
+    auto size = column.size();
+
+    size_t idx = 0;
+    while (idx < size && tags[idx] == TypeTags::Nothing) {
+        ++idx;
+    }
+    if (idx == size) {
+        return TypeTags::Nothing;
+    }
+
+    auto type = tags[idx];
+    bool uniform = true;
+    for (; idx < size; ++idx) {
+        uniform &= (tags[idx] == type) | (tags[idx] == TypeTags::Nothing);
+    }
+    return uniform ? boost::make_optional(type) : boost::none;
+}
+
+/**
+ * Returns true if values with this tag can be processed by the tight loops below. Decimals are
+ * excluded because they are stored out of line and are slow to operate on anyway.
+ */
+bool isFastNumber(TypeTags tag) {
+    return tag == TypeTags::NumberInt32 || tag == TypeTags::NumberInt64 ||
+        tag == TypeTags::NumberDouble;
+}
+
+/**
+ * The inner loop of selectCompareConstant(). All the values of the column are either Nothing or
+ * of type 'columnType', whose values are stored as 'Source' and compared as 'T'. The loop has no
+ * branches and no calls, so that the compiler can vectorize it.
+ */
+template <typename T, typename Source, typename Op>
+void compareLoop(const TypeTags* tags,
+                 const Value* vals,
+                 size_t size,
+                 TypeTags columnType,
+                 T constant,
+                 bool constantOnLeft,
+                 Op op,
+                 uint8_t* selection) {
+    if (constantOnLeft) {
+        for (size_t idx = 0; idx < size; ++idx) {
+            const T val = static_cast<T>(bitcastTo<Source>(vals[idx]));
+            selection[idx] &= static_cast<uint8_t>(op(constant, val) & (tags[idx] == columnType));
+        }
+    } else {
+        for (size_t idx = 0; idx < size; ++idx) {
+            const T val = static_cast<T>(bitcastTo<Source>(vals[idx]));
+            selection[idx] &= static_cast<uint8_t>(op(val, constant) & (tags[idx] == columnType));
+        }
+    }
+}
+
+template <typename T, typename Op>
+void compareNumbers(const ValueColumn& column,
+                    TypeTags columnType,
+                    T constant,
+                    bool constantOnLeft,
+                    Op op,
+                    uint8_t* selection) {
+    auto tags = column.tags();
+    auto vals = column.vals();
+    auto size = column.size();
+
+    switch (columnType) {
+        case TypeTags::NumberInt32:
+            compareLoop<T, int32_t>(
+                tags, vals, size, columnType, constant, constantOnLeft, op, selection);
+            break;
+        case TypeTags::NumberInt64:
+            compareLoop<T, int64_t>(
+                tags, vals, size, columnType, constant, constantOnLeft, op, selection);
+            break;
+        case TypeTags::NumberDouble:
+            compareLoop<T, double>(
+                tags, vals, size, columnType, constant, constantOnLeft, op, selection);
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+template <typename Op>
+void compareNumbers(const ValueColumn& column,
+                    TypeTags columnType,
+                    TypeTags constTag,
+                    Value constVal,
+                    bool constantOnLeft,
+                    Op op,
+                    uint8_t* selection) {
+    // Mirror the type promotion done by genericNumericCompare() in the VM.
+    switch (getWidestNumericalType(columnType, constTag)) {
+        case TypeTags::NumberInt32:
+            compareNumbers(column,
+                           columnType,
+                           numericCast<int32_t>(constTag, constVal),
+                           constantOnLeft,
+                           op,
+                           selection);
+            break;
+        case TypeTags::NumberInt64:
+            compareNumbers(column,
+                           columnType,
+                           numericCast<int64_t>(constTag, constVal),
+                           constantOnLeft,
+                           op,
+                           selection);
+            break;
+        case TypeTags::NumberDouble:
+            compareNumbers(column,
+                           columnType,
+                           numericCast<double>(constTag, constVal),
+                           constantOnLeft,
+                           op,
+                           selection);
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+/**
+ * The inner loop of computeArithConstant() for the cases which can't overflow. All the values of
+ * the column are either Nothing or of type 'columnType', whose values are stored as 'Source'.
+ */
+template <typename Source, typename Op>
+void doubleArithLoop(const TypeTags* tags,
+                     const Value* vals,
+                     size_t size,
+                     TypeTags columnType,
+                     double constant,
+                     bool constantOnLeft,
+                     Op op,
+                     const uint8_t* selection,
+                     TypeTags* outTags,
+                     Value* outVals) {
+    for (size_t idx = 0; idx < size; ++idx) {
+        const double val = static_cast<double>(bitcastTo<Source>(vals[idx]));
+        const double result = constantOnLeft ? op(constant, val) : op(val, constant);
+        const bool present = selection[idx] && tags[idx] == columnType;
+        outTags[idx] = present ? TypeTags::NumberDouble : TypeTags::Nothing;
+        outVals[idx] = present ? bitcastFrom<double>(result) : 0;
+    }
+}
+
+/**
+ * Computes the integer results of computeArithConstant() into 'results'. Returns false if any of
+ * the selected rows overflowed, as the VM would then produce a result of a wider type for it.
+ */
+template <typename T, typename Source>
+bool integerArithLoop(const TypeTags* tags,
+                      const Value* vals,
+                      size_t size,
+                      TypeTags columnType,
+                      T constant,
+                      bool constantOnLeft,
+                      ColumnArithOp op,
+                      const uint8_t* selection,
+                      std::vector<T>* results) {
+    results->resize(size);
+    bool overflowed = false;
+    for (size_t idx = 0; idx < size; ++idx) {
+        const T val = static_cast<T>(bitcastTo<Source>(vals[idx]));
+        const T lhs = constantOnLeft ? constant : val;
+        const T rhs = constantOnLeft ? val : constant;
+        T result = 0;
+        bool rowOverflowed = false;
+        switch (op) {
+            case ColumnArithOp::add:
+                rowOverflowed = overflow::add(lhs, rhs, &result);
+                break;
+            case ColumnArithOp::sub:
+                rowOverflowed = overflow::sub(lhs, rhs, &result);
+                break;
+            case ColumnArithOp::mul:
+                rowOverflowed = overflow::mul(lhs, rhs, &result);
+                break;
+        }
+        overflowed |= rowOverflowed && selection[idx] && tags[idx] == columnType;
+        (*results)[idx] = result;
+    }
+    return !overflowed;
+}
+
+template <typename T>
+bool integerArith(const ValueColumn& column,
+                  TypeTags columnType,
+                  T constant,
+                  bool constantOnLeft,
+                  ColumnArithOp op,
+                  const uint8_t* selection,
+                  ValueColumn* out) {
+    auto tags = column.tags();
+    auto vals = column.vals();
+    auto size = column.size();
+
+    std::vector<T> results;
+    bool succeeded = columnType == TypeTags::NumberInt32
+        ? integerArithLoop<T, int32_t>(
+              tags, vals, size, columnType, constant, constantOnLeft, op, selection, &results)
+        : integerArithLoop<T, int64_t>(
+              tags, vals, size, columnType, constant, constantOnLeft, op, selection, &results);
+    if (!succeeded) {
+        return false;
+    }
+
+    constexpr auto resultType =
+        std::is_same_v<T, int32_t> ? TypeTags::NumberInt32 : TypeTags::NumberInt64;
+    auto [outTags, outVals] = out->extend(size);
+    for (size_t idx = 0; idx < size; ++idx) {
+        const bool present = selection[idx] && tags[idx] == columnType;
+        outTags[idx] = present ? resultType : TypeTags::Nothing;
+        outVals[idx] = present ? bitcastFrom<T>(results[idx]) : 0;
+    }
+    return true;
+}
+
+template <typename Op>
+void doubleArith(const ValueColumn& column,
+                 TypeTags columnType,
+                 double constant,
+                 bool constantOnLeft,
+                 Op op,
+                 const uint8_t* selection,
+                 ValueColumn* out) {
+    auto tags = column.tags();
+    auto vals = column.vals();
+    auto size = column.size();
+    auto [outTags, outVals] = out->extend(size);
+
+    switch (columnType) {
+        case TypeTags::NumberInt32:
+            doubleArithLoop<int32_t>(tags,
+                                     vals,
+                                     size,
+                                     columnType,
+                                     constant,
+                                     constantOnLeft,
+                                     op,
+                                     selection,
+                                     outTags,
+                                     outVals);
+            break;
+        case TypeTags::NumberInt64:
+            doubleArithLoop<int64_t>(tags,
+                                     vals,
+                                     size,
+                                     columnType,
+                                     constant,
+                                     constantOnLeft,
+                                     op,
+                                     selection,
+                                     outTags,
+                                     outVals);
+            break;
+        case TypeTags::NumberDouble:
+            doubleArithLoop<double>(tags,
+                                    vals,
+                                    size,
+                                    columnType,
+                                    constant,
+                                    constantOnLeft,
+                                    op,
+                                    selection,
+                                    outTags,
+                                    outVals);
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+}  // namespace
+
+void selectExists(const ValueColumn& column, uint8_t* selection) {
+    auto tags = column.tags();
+    for (size_t idx = 0; idx < column.size(); ++idx) {
+        selection[idx] &= static_cast<uint8_t>(tags[idx] != TypeTags::Nothing);
+    }
+}
+
+void selectIsNumber(const ValueColumn& column, uint8_t* selection) {
+    auto tags = column.tags();
+    for (size_t idx = 0; idx < column.size(); ++idx) {
+        selection[idx] &= static_cast<uint8_t>(isNumber(tags[idx]));
+    }
+}
+
+bool selectCompareConstant(const ValueColumn& column,
+                           ColumnCompareOp op,
+                           TypeTags constTag,
+                           Value constVal,
+                           bool constantOnLeft,
+                           uint8_t* selection) {
+    auto columnType = getColumnType(column);
+    if (!columnType) {
+        return false;
+    }
+
+    if (*columnType == TypeTags::Nothing || constTag == TypeTags::Nothing) {
+        // Comparisons with Nothing always produce Nothing, which a filter treats as false.
+        std::fill(selection, selection + column.size(), 0);
+        return true;
+    }
+
+    if (!isFastNumber(*columnType) || !isFastNumber(constTag)) {
+        return false;
+    }
+
+    switch (op) {
+        case ColumnCompareOp::less:
+            compareNumbers(
+                column, *columnType, constTag, constVal, constantOnLeft, std::less<>{}, selection);
+            break;
+        case ColumnCompareOp::lessEq:
+            compareNumbers(column,
+                           *columnType,
+                           constTag,
+                           constVal,
+                           constantOnLeft,
+                           std::less_equal<>{},
+                           selection);
+            break;
+        case ColumnCompareOp::greater:
+            compareNumbers(column,
+                           *columnType,
+                           constTag,
+                           constVal,
+                           constantOnLeft,
+                           std::greater<>{},
+                           selection);
+            break;
+        case ColumnCompareOp::greaterEq:
+            compareNumbers(column,
+                           *columnType,
+                           constTag,
+                           constVal,
+                           constantOnLeft,
+                           std::greater_equal<>{},
+                           selection);
+            break;
+        case ColumnCompareOp::eq:
+            compareNumbers(column,
+                           *columnType,
+                           constTag,
+                           constVal,
+                           constantOnLeft,
+                           std::equal_to<>{},
+                           selection);
+            break;
+        case ColumnCompareOp::neq:
+            compareNumbers(column,
+                           *columnType,
+                           constTag,
+                           constVal,
+                           constantOnLeft,
+                           std::not_equal_to<>{},
+                           selection);
+            break;
+    }
+    return true;
+}
+
+bool computeArithConstant(const ValueColumn& column,
+                          ColumnArithOp op,
+                          TypeTags constTag,
+                          Value constVal,
+                          bool constantOnLeft,
+                          const uint8_t* selection,
+                          ValueColumn* out) {
+    auto columnType = getColumnType(column);
+    if (!columnType) {
+        return false;
+    }
+
+    if (*columnType == TypeTags::Nothing || constTag == TypeTags::Nothing) {
+        // Arithmetic on Nothing always produces Nothing.
+        out->extend(column.size());
+        return true;
+    }
+
+    if (!isFastNumber(*columnType) || !isFastNumber(constTag)) {
+        return false;
+    }
+
+    // Mirror the type promotion done by genericArithmeticOp() in the VM.
+    switch (getWidestNumericalType(*columnType, constTag)) {
+        case TypeTags::NumberInt32:
+            return integerArith(column,
+                                *columnType,
+                                numericCast<int32_t>(constTag, constVal),
+                                constantOnLeft,
+                                op,
+                                selection,
+                                out);
+        case TypeTags::NumberInt64:
+            return integerArith(column,
+                                *columnType,
+                                numericCast<int64_t>(constTag, constVal),
+                                constantOnLeft,
+                                op,
+                                selection,
+                                out);
+        case TypeTags::NumberDouble: {
+            auto constant = numericCast<double>(constTag, constVal);
+            switch (op) {
+                case ColumnArithOp::add:
+                    doubleArith(column,
+                                *columnType,
+                                constant,
+                                constantOnLeft,
+                                std::plus<>{},
+                                selection,
+                                out);
+                    break;
+                case ColumnArithOp::sub:
+                    doubleArith(column,
+                                *columnType,
+                                constant,
+                                constantOnLeft,
+                                std::minus<>{},
+                                selection,
+                                out);
+                    break;
+                case ColumnArithOp::mul:
+                    doubleArith(column,
+                                *columnType,
+                                constant,
+                                constantOnLeft,
+                                std::multiplies<>{},
+                                selection,
+                                out);
+                    break;
+            }
+            return true;
+        }
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
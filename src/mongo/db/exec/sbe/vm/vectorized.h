@@ -0,0 +1,165 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/exec/sbe/values/value.h"
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+/**
+ * A column of values produced by a single slot over a block of rows. The values are stored as two
+ * parallel arrays of tags and values, so that kernels processing the column can run tight loops
+ * over the raw values once they have established that all the tags are the same.
+ *
+ * The column owns all the values pushed into it.
+ */
+class ValueColumn {
+public:
+    ValueColumn() = default;
+    ValueColumn(const ValueColumn&) = delete;
+    ValueColumn& operator=(const ValueColumn&) = delete;
+    ValueColumn(ValueColumn&&) = default;
+
+    ~ValueColumn() {
+        clear();
+    }
+
+    /**
+     * Appends a value to the column, taking the ownership of it.
+     */
+    void push_back(value::TypeTags tag, value::Value val) {
+        _tags.push_back(tag);
+        _vals.push_back(val);
+    }
+
+    /**
+     * Releases all the values in the column, keeping the memory allocated for the arrays.
+     */
+    void clear() {
+        for (size_t idx = 0; idx < _tags.size(); ++idx) {
+            value::releaseValue(_tags[idx], _vals[idx]);
+        }
+        _tags.clear();
+        _vals.clear();
+    }
+
+    /**
+     * Appends 'count' Nothing values to the column and returns pointers to their tags and values,
+     * which the caller can overwrite with values to be owned by the column.
+     */
+    std::pair<value::TypeTags*, value::Value*> extend(size_t count) {
+        auto oldSize = size();
+        _tags.resize(oldSize + count, value::TypeTags::Nothing);
+        _vals.resize(oldSize + count, 0);
+        return {_tags.data() + oldSize, _vals.data() + oldSize};
+    }
+
+    void reserve(size_t size) {
+        _tags.reserve(size);
+        _vals.reserve(size);
+    }
+
+    size_t size() const {
+        return _tags.size();
+    }
+
+    std::pair<value::TypeTags, value::Value> at(size_t idx) const {
+        return {_tags[idx], _vals[idx]};
+    }
+
+    const value::TypeTags* tags() const {
+        return _tags.data();
+    }
+
+    const value::Value* vals() const {
+        return _vals.data();
+    }
+
+private:
+    std::vector<value::TypeTags> _tags;
+    std::vector<value::Value> _vals;
+};
+
+/**
+ * The comparisons and arithmetic operations which can be evaluated over a whole column.
+ */
+enum class ColumnCompareOp { less, lessEq, greater, greaterEq, eq, neq };
+enum class ColumnArithOp { add, sub, mul };
+
+/**
+ * The 'selection' arrays below hold one byte per row of a column, which is non-zero if the row is
+ * still selected. Predicate kernels narrow down the selection to the rows for which the predicate
+ * is true, with the same semantics as the corresponding VM instruction followed by a filter.
+ *
+ * Kernels returning a bool may refuse to process a column for which they have no tight loop, such
+ * as a column with values of different types, by returning false. In this case nothing is written
+ * to their output and the caller must evaluate the operation row by row using the VM instead.
+ */
+
+/**
+ * Narrows 'selection' to the rows where the value is not Nothing, like the 'exists' builtin.
+ */
+void selectExists(const ValueColumn& column, uint8_t* selection);
+
+/**
+ * Narrows 'selection' to the rows where the value is a number, like the 'isNumber' builtin.
+ */
+void selectIsNumber(const ValueColumn& column, uint8_t* selection);
+
+/**
+ * Narrows 'selection' to the rows where '<value> <op> <constant>' holds. If 'constantOnLeft' is
+ * true then '<constant> <op> <value>' is evaluated instead.
+ */
+bool selectCompareConstant(const ValueColumn& column,
+                           ColumnCompareOp op,
+                           value::TypeTags constTag,
+                           value::Value constVal,
+                           bool constantOnLeft,
+                           uint8_t* selection);
+
+/**
+ * Computes '<value> <op> <constant>' for every selected row, or '<constant> <op> <value>' if
+ * 'constantOnLeft' is true, and appends the results to 'out'. A Nothing is appended for the rows
+ * which are not selected.
+ */
+bool computeArithConstant(const ValueColumn& column,
+                          ColumnArithOp op,
+                          value::TypeTags constTag,
+                          value::Value constVal,
+                          bool constantOnLeft,
+                          const uint8_t* selection,
+                          ValueColumn* out);
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
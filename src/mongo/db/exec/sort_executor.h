@@ -141,6 +141,8 @@ public:
         _stats.keysSorted += _sorter->numSorted();
         _stats.spills += _sorter->numSpills();
         _stats.totalDataSizeBytes += _sorter->totalDataSizeSorted();
+        _stats.spilledDataSizeBytes += _sorter->spilledDataSize();
+        _stats.spilledDataStorageSizeBytes += _sorter->spilledDataStorageSize();
         _sorter.reset();
     }
 
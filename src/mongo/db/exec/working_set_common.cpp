@@ -43,6 +43,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/execution_context.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/logv2/log.h"
 
 namespace mongo {
@@ -77,7 +78,18 @@ bool WorkingSetCommon::fetch(OperationContext* opCtx,
     // state appropriately.
     invariant(member->hasRecordId());
 
-    auto record = cursor->seekExact(member->recordId);
+    return fetch(opCtx, workingSet, id, cursor->seekExact(member->recordId), ns);
+}
+
+// static
+bool WorkingSetCommon::fetch(OperationContext* opCtx,
+                             WorkingSet* workingSet,
+                             WorkingSetID id,
+                             boost::optional<Record> record,
+                             const NamespaceString& ns) {
+    WorkingSetMember* member = workingSet->get(id);
+    invariant(member->hasRecordId());
+
     if (!record) {
         // The record referenced by this index entry is gone. If the query yielded some time after
         // we first examined the index entry, then it's likely that the record was deleted while we
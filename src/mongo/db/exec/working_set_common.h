@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/util/unowned_ptr.h"
@@ -37,6 +39,7 @@ namespace mongo {
 
 class OperationContext;
 class SeekableRecordCursor;
+struct Record;
 
 class WorkingSetCommon {
 public:
@@ -54,6 +57,17 @@ public:
                       WorkingSetID id,
                       unowned_ptr<SeekableRecordCursor> cursor,
                       const NamespaceString& ns);
+
+    /**
+     * Same as above, for a document which was already looked up, for example along with others by
+     * SeekableRecordCursor::seekExactBatch(). 'record' is boost::none if the RecordId of the
+     * WorkingSetMember has no document.
+     */
+    static bool fetch(OperationContext* opCtx,
+                      WorkingSet* workingSet,
+                      WorkingSetID id,
+                      boost::optional<Record> record,
+                      const NamespaceString& ns);
 };
 
 }  // namespace mongo
@@ -36,6 +36,7 @@
 #include <utility>
 #include <vector>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/error_codes.h"
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -492,7 +493,8 @@ public:
     Status insert(OperationContext* opCtx,
                   const BSONObj& obj,
                   const RecordId& loc,
-                  const InsertDeleteOptions& options) final;
+                  const InsertDeleteOptions& options,
+                  const RecordSkippedFn& onRecordSkipped = nullptr) final;
 
     void addToSorter(const KeyString::Value& keyString) final {
         _sorter->add(keyString, mongo::NullValue());
@@ -502,6 +504,8 @@ public:
 
     bool isMultikey() const final;
 
+    void merge(std::unique_ptr<BulkBuilder> other) final;
+
     /**
      * Inserts all multikey metadata keys cached during the BulkBuilder's lifetime into the
      * underlying Sorter, finalizes it, and returns an iterator over the sorted dataset.
@@ -515,6 +519,8 @@ public:
 private:
     void _insertMultikeyMetadataKeysIntoSorter();
 
+    void _mergeMultikeyPaths(const MultikeyPaths& multikeyPaths);
+
     Sorter* _makeSorter(
         size_t maxMemoryUsageBytes,
         StringData dbName,
@@ -538,6 +544,10 @@ private:
     // These are inserted into the sorter after all normal data keys have been added, just
     // before the bulk build is committed.
     KeyStringSet _multikeyMetadataKeys;
+
+    // The BulkBuilders whose keys were merged into this one. Their Sorters remove their files when
+    // destroyed, so they are kept for as long as this BulkBuilder.
+    std::vector<std::unique_ptr<BulkBuilderImpl>> _mergedBuilders;
 };
 
 std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::initiateBulk(
@@ -569,7 +579,8 @@ AbstractIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(IndexCatalogEntry* i
 Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCtx,
                                                           const BSONObj& obj,
                                                           const RecordId& loc,
-                                                          const InsertDeleteOptions& options) {
+                                                          const InsertDeleteOptions& options,
+                                                          const RecordSkippedFn& onRecordSkipped) {
     auto& executionCtx = StorageExecutionContext::get(opCtx);
 
     auto keys = executionCtx.keys();
@@ -597,25 +608,18 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
                                 "error"_attr = status,
                                 "loc"_attr = loc,
                                 "obj"_attr = redact(obj));
-                    interceptor->getSkippedRecordTracker()->record(opCtx, loc);
+                    if (onRecordSkipped) {
+                        onRecordSkipped(loc);
+                    } else {
+                        interceptor->getSkippedRecordTracker()->record(opCtx, loc);
+                    }
                 }
             });
     } catch (...) {
         return exceptionToStatus();
     }
 
-    if (!multikeyPaths->empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = *multikeyPaths;
-        } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths->size());
-            for (size_t i = 0; i < multikeyPaths->size(); ++i) {
-                _indexMultikeyPaths[i].insert(boost::container::ordered_unique_range_t(),
-                                              (*multikeyPaths)[i].begin(),
-                                              (*multikeyPaths)[i].end());
-            }
-        }
-    }
+    _mergeMultikeyPaths(*multikeyPaths);
 
     for (const auto& keyString : *keys) {
         _sorter->add(keyString, mongo::NullValue());
@@ -637,10 +641,41 @@ bool AbstractIndexAccessMethod::BulkBuilderImpl::isMultikey() const {
     return _isMultiKey;
 }
 
+void AbstractIndexAccessMethod::BulkBuilderImpl::merge(std::unique_ptr<BulkBuilder> other) {
+    std::unique_ptr<BulkBuilderImpl> otherImpl(checked_cast<BulkBuilderImpl*>(other.release()));
+    invariant(otherImpl->_indexCatalogEntry == _indexCatalogEntry);
+    invariant(otherImpl->_mergedBuilders.empty());
+
+    _keysInserted += otherImpl->_keysInserted;
+    _isMultiKey = _isMultiKey || otherImpl->_isMultiKey;
+    _mergeMultikeyPaths(otherImpl->_indexMultikeyPaths);
+
+    // The multikey metadata keys of the BulkBuilders may overlap, so they are inserted into the
+    // Sorter of this one only, once.
+    _multikeyMetadataKeys.insert(otherImpl->_multikeyMetadataKeys.begin(),
+                                 otherImpl->_multikeyMetadataKeys.end());
+    otherImpl->_multikeyMetadataKeys.clear();
+
+    // The keys the merged BulkBuilder holds in memory are written to disk, so that only the Sorter
+    // of this one uses the memory of the index build from now on.
+    otherImpl->_sorter->spill();
+
+    _mergedBuilders.push_back(std::move(otherImpl));
+}
+
 IndexAccessMethod::BulkBuilder::Sorter::Iterator*
 AbstractIndexAccessMethod::BulkBuilderImpl::done() {
     _insertMultikeyMetadataKeysIntoSorter();
-    return _sorter->done();
+    if (_mergedBuilders.empty()) {
+        return _sorter->done();
+    }
+
+    std::vector<std::shared_ptr<Sorter::Iterator>> iters;
+    iters.emplace_back(_sorter->done());
+    for (const auto& mergedBuilder : _mergedBuilders) {
+        iters.emplace_back(mergedBuilder->_sorter->done());
+    }
+    return Sorter::Iterator::merge(iters, SortOptions(), BtreeExternalSortComparison());
 }
 
 int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
@@ -650,7 +685,20 @@ int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
 AbstractIndexAccessMethod::BulkBuilder::Sorter::PersistedState
 AbstractIndexAccessMethod::BulkBuilderImpl::persistDataForShutdown() {
     _insertMultikeyMetadataKeysIntoSorter();
-    return _sorter->persistDataForShutdown();
+
+    auto state = _sorter->persistDataForShutdown();
+
+    // The state of a resumable index build only refers to the file of one Sorter, so the ranges
+    // the merged BulkBuilders spilled are appended to the file of this one, without sorting their
+    // keys again.
+    const auto opts = makeSortOptions(0, StringData());
+    for (const auto& mergedBuilder : _mergedBuilders) {
+        Sorter::appendPersistedState(
+            opts, &state, mergedBuilder->_sorter->persistDataForShutdown());
+    }
+    _mergedBuilders.clear();
+
+    return state;
 }
 
 void AbstractIndexAccessMethod::BulkBuilderImpl::_insertMultikeyMetadataKeysIntoSorter() {
@@ -664,6 +712,24 @@ void AbstractIndexAccessMethod::BulkBuilderImpl::_insertMultikeyMetadataKeysInto
     _multikeyMetadataKeys.clear();
 }
 
+void AbstractIndexAccessMethod::BulkBuilderImpl::_mergeMultikeyPaths(
+    const MultikeyPaths& multikeyPaths) {
+    if (multikeyPaths.empty()) {
+        return;
+    }
+
+    if (_indexMultikeyPaths.empty()) {
+        _indexMultikeyPaths = multikeyPaths;
+    } else {
+        invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
+        for (size_t i = 0; i < multikeyPaths.size(); ++i) {
+            _indexMultikeyPaths[i].insert(boost::container::ordered_unique_range_t(),
+                                          multikeyPaths[i].begin(),
+                                          multikeyPaths[i].end());
+        }
+    }
+}
+
 AbstractIndexAccessMethod::BulkBuilderImpl::Sorter::Settings
 AbstractIndexAccessMethod::BulkBuilderImpl::_makeSorterSettings() const {
     return std::pair<KeyString::Value::SorterDeserializeSettings,
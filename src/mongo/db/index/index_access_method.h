@@ -237,16 +237,23 @@ public:
     class BulkBuilder {
     public:
         using Sorter = mongo::Sorter<KeyString::Value, mongo::NullValue>;
+        using RecordSkippedFn = std::function<void(const RecordId& loc)>;
 
         virtual ~BulkBuilder() = default;
 
         /**
          * Insert into the BulkBuilder as-if inserting into an IndexAccessMethod.
+         *
+         * If 'onRecordSkipped' is set, it is passed the documents whose key generation errors are
+         * suppressed, instead of them being recorded in the skipped record tracker of the index
+         * build, which writes to a table. This lets the keys be generated by a thread which holds
+         * none of the locks of the index build.
          */
         virtual Status insert(OperationContext* opCtx,
                               const BSONObj& obj,
                               const RecordId& loc,
-                              const InsertDeleteOptions& options) = 0;
+                              const InsertDeleteOptions& options,
+                              const RecordSkippedFn& onRecordSkipped = nullptr) = 0;
 
         /**
          * Inserts the keyString directly into the sorter. No additional logic (related to multikey
@@ -258,6 +265,14 @@ public:
 
         virtual bool isMultikey() const = 0;
 
+        /**
+         * Takes over the keys of 'other', which must be a BulkBuilder for the same index, along
+         * with its multikey state, so that done() returns them sorted together with the keys of
+         * this BulkBuilder. The keys 'other' holds in memory are written to disk. Used to combine
+         * the BulkBuilders of the threads which generate the keys of an index build.
+         */
+        virtual void merge(std::unique_ptr<BulkBuilder> other) = 0;
+
         /**
          * Inserts all multikey metadata keys cached during the BulkBuilder's lifetime into the
          * underlying Sorter, finalizes it, and returns an iterator over the sorted dataset.
@@ -271,7 +286,8 @@ public:
 
         /**
          * Persists on disk the keys that have been inserted using this BulkBuilder. Returns the
-         * state of the underlying Sorter.
+         * state of the underlying Sorter, whose file also holds the ranges of the merged
+         * BulkBuilders.
          */
         virtual Sorter::PersistedState persistDataForShutdown() = 0;
     };
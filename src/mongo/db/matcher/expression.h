@@ -203,6 +203,10 @@ public:
     using Iterator = MatchExpressionIterator<false>;
     using ConstIterator = MatchExpressionIterator<true>;
 
+    // Identifies a parameter of a query, i.e. a constant in its filter which may be replaced with
+    // the corresponding constant of another query of the same shape.
+    using InputParamId = int32_t;
+
     /**
      * Tracks the information needed to generate a document validation error for a
      * MatchExpression node.
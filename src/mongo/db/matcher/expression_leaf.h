@@ -193,6 +193,34 @@ public:
     virtual ~ComparisonMatchExpression() = default;
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
+
+    /**
+     * Returns the id of this predicate among the parameters of its query, or boost::none if its
+     * right-hand side is not a parameter. See CanonicalQuery::getInputParams().
+     */
+    boost::optional<InputParamId> getInputParamId() const {
+        return _inputParamId;
+    }
+
+    void setInputParamId(InputParamId paramId) {
+        _inputParamId = paramId;
+    }
+
+protected:
+    /**
+     * Copies the members of this ComparisonMatchExpression which are not passed to the
+     * constructor into 'clone'.
+     */
+    void cloneInto(ComparisonMatchExpression* clone) const {
+        if (getTag()) {
+            clone->setTag(getTag()->clone());
+        }
+        clone->setCollator(_collator);
+        clone->_inputParamId = _inputParamId;
+    }
+
+private:
+    boost::optional<InputParamId> _inputParamId;
 };
 
 class EqualityMatchExpression final : public ComparisonMatchExpression {
@@ -217,10 +245,7 @@ public:
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<ComparisonMatchExpression> e =
             std::make_unique<EqualityMatchExpression>(path(), Value(getData()), _errorAnnotation);
-        if (getTag()) {
-            e->setTag(getTag()->clone());
-        }
-        e->setCollator(_collator);
+        cloneInto(e.get());
         return e;
     }
 
@@ -253,10 +278,7 @@ public:
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<ComparisonMatchExpression> e =
             std::make_unique<LTEMatchExpression>(path(), _rhs, _errorAnnotation);
-        if (getTag()) {
-            e->setTag(getTag()->clone());
-        }
-        e->setCollator(_collator);
+        cloneInto(e.get());
         return e;
     }
 
@@ -289,10 +311,7 @@ public:
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<ComparisonMatchExpression> e =
             std::make_unique<LTMatchExpression>(path(), _rhs, _errorAnnotation);
-        if (getTag()) {
-            e->setTag(getTag()->clone());
-        }
-        e->setCollator(_collator);
+        cloneInto(e.get());
         return e;
     }
 
@@ -330,10 +349,7 @@ public:
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<ComparisonMatchExpression> e =
             std::make_unique<GTMatchExpression>(path(), _rhs, _errorAnnotation);
-        if (getTag()) {
-            e->setTag(getTag()->clone());
-        }
-        e->setCollator(_collator);
+        cloneInto(e.get());
         return e;
     }
 
@@ -370,10 +386,7 @@ public:
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<ComparisonMatchExpression> e =
             std::make_unique<GTEMatchExpression>(path(), _rhs, _errorAnnotation);
-        if (getTag()) {
-            e->setTag(getTag()->clone());
-        }
-        e->setCollator(_collator);
+        cloneInto(e.get());
         return e;
     }
 
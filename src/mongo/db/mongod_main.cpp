@@ -108,8 +108,10 @@
 #include "mongo/db/periodic_runner_job_abort_expired_transactions.h"
 #include "mongo/db/pipeline/process_interface/replica_set_node_process_interface.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache_snapshot.h"
 #include "mongo/db/read_write_concern_defaults_cache_lookup_mongod.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
+#include "mongo/db/repl/file_copy_initial_syncer.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/primary_only_service.h"
 #include "mongo/db/repl/primary_only_service_op_observer.h"
@@ -390,6 +392,10 @@ ExitCode _initAndListen(ServiceContext* serviceContext, int listenPort) {
                      std::make_unique<FlowControl>(
                          serviceContext, repl::ReplicationCoordinator::get(serviceContext)));
 
+    // A node seeded with the files of its sync source starts the storage engine on them. The copy
+    // connects to the sync source before the transport layer of this node is started.
+    repl::runFileCopyInitialSyncIfNeeded();
+
     // Creating the operation context before initializing the storage engine allows the storage
     // engine initialization to make use of the lock manager. As the storage engine is not yet
     // initialized, a noop recovery unit is used until the initialization is complete.
@@ -716,6 +722,18 @@ ExitCode _initAndListen(ServiceContext* serviceContext, int listenPort) {
         }
     }
 
+    // Start up a background task to load the plan cache snapshots and to periodically persist the
+    // plan caches of the primary.
+    if (!storageGlobalParams.readOnly) {
+        try {
+            PeriodicThreadToSnapshotPlanCaches::get(serviceContext)->start();
+        } catch (ExceptionFor<ErrorCodes::PeriodicJobIsStopped>&) {
+            LOGV2_WARNING(5190934, "Not starting periodic jobs as shutdown is in progress");
+            MONGO_IDLE_THREAD_BLOCK;
+            return waitForShutdown();
+        }
+    }
+
     // Set up the logical session cache
     LogicalSessionCacheServer kind = LogicalSessionCacheServer::kStandalone;
     if (serverGlobalParams.clusterRole == ClusterRole::ShardServer) {
@@ -1155,6 +1173,9 @@ void shutdownTask(const ShutdownTaskArgs& shutdownArgs) {
             PeriodicThreadToAbortExpiredTransactions::get(serviceContext)->stop();
         }
 
+        LOGV2(5190933, "Shutting down the PeriodicThreadToSnapshotPlanCaches");
+        PeriodicThreadToSnapshotPlanCaches::get(serviceContext)->stop();
+
         ServiceContext::UniqueOperationContext uniqueOpCtx;
         OperationContext* opCtx = client->getOperationContext();
         if (!opCtx) {
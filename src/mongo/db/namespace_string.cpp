@@ -101,6 +101,8 @@ const NamespaceString NamespaceString::kConfigSettingsNamespace(NamespaceString:
                                                                 "settings");
 const NamespaceString NamespaceString::kVectorClockNamespace(NamespaceString::kConfigDb,
                                                              "vectorClock");
+const NamespaceString NamespaceString::kPlanCacheSnapshotsNamespace(NamespaceString::kConfigDb,
+                                                                    "planCacheSnapshots");
 
 const NamespaceString NamespaceString::kReshardingApplierProgressNamespace(
     NamespaceString::kConfigDb, "localReshardingOperations.recipient.progress_applier");
@@ -278,7 +280,8 @@ bool NamespaceString::isNamespaceAlwaysUnsharded() const {
     // Certain config collections can never be sharded
     if (ns() == kSessionTransactionsTableNamespace.ns() || ns() == kRangeDeletionNamespace.ns() ||
         ns() == kTransactionCoordinatorsNamespace.ns() || ns() == kVectorClockNamespace.ns() ||
-        ns() == kMigrationCoordinatorsNamespace.ns() || ns() == kIndexBuildEntryNamespace.ns())
+        ns() == kMigrationCoordinatorsNamespace.ns() || ns() == kIndexBuildEntryNamespace.ns() ||
+        ns() == kPlanCacheSnapshotsNamespace.ns())
         return true;
 
     if (isSystemDotProfile())
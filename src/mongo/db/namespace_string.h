@@ -142,6 +142,9 @@ public:
     // Namespace for vector clock state.
     static const NamespaceString kVectorClockNamespace;
 
+    // Namespace for the snapshots of the winning plans of the plan caches.
+    static const NamespaceString kPlanCacheSnapshotsNamespace;
+
     // Namespace for storing oplog applier progress for resharding.
     static const NamespaceString kReshardingApplierProgressNamespace;
 
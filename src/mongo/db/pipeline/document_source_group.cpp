@@ -30,19 +30,33 @@
 #include "mongo/platform/basic.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <deque>
+#include <map>
 #include <memory>
 
+#include "mongo/base/init.h"
+#include "mongo/db/client.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/accumulator_js_reduce.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/expression_function.h"
+#include "mongo/db/pipeline/expression_js_emit.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/stats/resource_consumption_metrics.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/future.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -538,13 +552,84 @@ private:
 };
 }  // namespace
 
+template <typename GetArgument>
+bool DocumentSourceGroup::accumulate(const Value& id,
+                                     const GetArgument& getArgument,
+                                     bool merging) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    vector<uint64_t> oldAccumMemUsage(numAccumulators, 0);
+    if (inserted) {
+        _memoryTracker.memoryUsageBytes += id.getApproximateSize();
+
+        // Initialize and add the accumulators
+        Value expandedId = expandId(id);
+        Document idDoc =
+            expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            auto accum = accumulatedField.makeAccumulator();
+            Value initializerValue =
+                accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
+            accum->startNewGroup(initializerValue);
+            group.push_back(accum);
+        }
+    } else {
+        for (size_t i = 0; i < group.size(); i++) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryTracker.memoryUsageBytes -= group[i]->memUsageForSorter();
+            oldAccumMemUsage[i] = group[i]->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(getArgument(i), merging);
+
+        _memoryTracker.memoryUsageBytes += group[i]->memUsageForSorter();
+        _memoryTracker.accumStatementMemoryBytes[i].currentMemoryBytes +=
+            group[i]->memUsageForSorter() - oldAccumMemUsage[i];
+    }
+
+    return inserted;
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
 
+    if (!_parallelAccumulationChecked) {
+        _parallelAccumulationChecked = true;
+        if (internalDocumentSourceGroupParallelWorkers.load() > 1 && canAccumulateInParallel()) {
+            _inputsBeforeParallelAccumulation = internalDocumentSourceGroupParallelMinDocs.load();
+        }
+    }
+
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
 
     for (; input.isAdvanced(); input = pSource->getNext()) {
+        if (_inputsBeforeParallelAccumulation && --*_inputsBeforeParallelAccumulation < 0) {
+            _inputsBeforeParallelAccumulation = boost::none;
+
+            // The number of workers may have been lowered at runtime, leaving nothing to gain.
+            const auto numWorkers = internalDocumentSourceGroupParallelWorkers.load();
+            if (numWorkers > 1) {
+                input = accumulateInParallel(std::move(input), static_cast<size_t>(numWorkers));
+                if (!input.isAdvanced()) {
+                    break;
+                }
+            }
+        }
+
         if (shouldSpillWithAttemptToSaveMemory([this]() { return freeMemory(); })) {
             _sortedFiles.push_back(spill());
         }
@@ -552,51 +637,13 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
         auto rootDocument = input.releaseDocument();
-        Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        vector<uint64_t> oldAccumMemUsage(numAccumulators, 0);
-        if (inserted) {
-            _memoryTracker.memoryUsageBytes += id.getApproximateSize();
-
-            // Initialize and add the accumulators
-            Value expandedId = expandId(id);
-            Document idDoc =
-                expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                auto accum = accumulatedField.makeAccumulator();
-                Value initializerValue =
-                    accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
-                accum->startNewGroup(initializerValue);
-                group.push_back(accum);
-            }
-        } else {
-            for (size_t i = 0; i < group.size(); i++) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryTracker.memoryUsageBytes -= group[i]->memUsageForSorter();
-                oldAccumMemUsage[i] = group[i]->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(
-                _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables),
-                _doingMerge);
-
-            _memoryTracker.memoryUsageBytes += group[i]->memUsageForSorter();
-            _memoryTracker.accumStatementMemoryBytes[i].currentMemoryBytes +=
-                group[i]->memUsageForSorter() - oldAccumMemUsage[i];
-        }
+        const bool inserted = accumulate(
+            computeId(rootDocument, &pExpCtx->variables),
+            [&](size_t i) {
+                return _accumulatedFields[i].expr.argument->evaluate(rootDocument,
+                                                                      &pExpCtx->variables);
+            },
+            _doingMerge);
 
         if (kDebugBuild && !storageGlobalParams.readOnly) {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
@@ -654,6 +701,376 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+namespace {
+
+// The number of input documents sent to the workers of a parallel $group at once, and the number
+// of such batches per worker which may be waiting to be accumulated before the thread reading the
+// input blocks.
+constexpr size_t kParallelGroupBatchSize = 512;
+constexpr size_t kParallelGroupMaxQueuedBatches = 4;
+
+std::unique_ptr<ThreadPool> parallelGroupThreadPool;
+MONGO_INITIALIZER(ParallelGroupThreadPool)(InitializerContext* context) {
+    ThreadPool::Options options;
+    options.poolName = "parallel $group pool";
+    options.threadNamePrefix = "GroupWorker";
+    options.minThreads = 0;
+    // The workers wait for the operation feeding them until it has read its input, so the pool
+    // must not make operations wait for each other's workers.
+    options.maxThreads = ThreadPool::Options::kUnlimited;
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    parallelGroupThreadPool = std::make_unique<ThreadPool>(options);
+    parallelGroupThreadPool->startup();
+}
+
+bool usesJavascript(const Expression* expr) {
+    if (dynamic_cast<const ExpressionFunction*>(expr) ||
+        dynamic_cast<const ExpressionInternalJsEmit*>(expr)) {
+        return true;
+    }
+    for (auto&& child : expr->getChildren()) {
+        if (child && usesJavascript(child.get())) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+struct DocumentSourceGroup::ParallelGroupPartition {
+    explicit ParallelGroupPartition(const ValueComparator& comparator)
+        : groups(comparator.makeUnorderedValueMap<Accumulators>()) {}
+
+    // The group keys of this partition computed from each input batch, by position of the batch in
+    // the input. Each key is followed by the accumulator arguments of the document it was computed
+    // from.
+    std::map<size_t, std::vector<Value>> evaluatedBatches;
+
+    // The position of the next batch to accumulate, and whether a worker is accumulating it.
+    size_t nextBatch = 0;
+    bool busy = false;
+
+    // Only accessed by the worker which set 'busy' until all the workers are done.
+    GroupsMap groups;
+
+    long long memoryUsageBytes = 0;
+};
+
+struct DocumentSourceGroup::ParallelGroupState {
+    // Guards all the members below, and those of the partitions unless stated otherwise.
+    Mutex mutex = MONGO_MAKE_LATCH("ParallelGroupState::mutex");
+    stdx::condition_variable cv;
+
+    // The batches of input documents no worker has picked up yet, with their position in the input.
+    std::deque<std::pair<size_t, std::vector<BSONObj>>> inputBatches;
+    size_t numBatches = 0;
+    bool inputDone = false;
+
+    std::vector<std::unique_ptr<ParallelGroupPartition>> partitions;
+
+    // Tells the workers to stop, either because one of them failed or because the thread reading
+    // the input did.
+    Status status = Status::OK();
+
+    bool allBatchesAccumulated(WithLock) const {
+        return std::all_of(partitions.begin(), partitions.end(), [&](auto&& partition) {
+            return partition->nextBatch == numBatches;
+        });
+    }
+};
+
+bool DocumentSourceGroup::canAccumulateInParallel() const {
+    for (auto&& idExpression : _idExpressions) {
+        if (usesJavascript(idExpression.get())) {
+            return false;
+        }
+    }
+
+    DepsTracker deps;
+    getDependencies(&deps);
+    for (auto&& accumulatedField : _accumulatedFields) {
+        StringData opName = accumulatedField.makeAccumulator()->getOpName();
+        if (opName == AccumulatorJs::kAccumulatorName ||
+            opName == AccumulatorInternalJsReduce::kAccumulatorName ||
+            usesJavascript(accumulatedField.expr.initializer.get()) ||
+            usesJavascript(accumulatedField.expr.argument.get())) {
+            return false;
+        }
+        accumulatedField.expr.initializer->addDependencies(&deps);
+    }
+    if (deps.needRandomGenerator || deps.getNeedsAnyMetadata()) {
+        return false;
+    }
+
+    // The workers evaluate against copies of the variables, whose documents and arrays may still
+    // share their lazily loaded storage with those of this thread.
+    for (auto&& id : deps.vars) {
+        if (pExpCtx->variables.hasValue(id)) {
+            auto type = pExpCtx->variables.getUserDefinedValue(id).getType();
+            if (type == BSONType::Object || type == BSONType::Array) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::accumulateInParallel(GetNextResult input,
+                                                                        size_t numWorkers) {
+    ParallelGroupState state;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        state.partitions.push_back(
+            std::make_unique<ParallelGroupPartition>(pExpCtx->getValueComparator()));
+    }
+
+    std::vector<Future<void>> workers;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        auto pf = makePromiseFuture<void>();
+        workers.push_back(std::move(pf.future));
+        parallelGroupThreadPool->schedule([this,
+                                           state = &state,
+                                           variables = pExpCtx->variables,
+                                           promise = std::move(pf.promise)](auto status) mutable {
+            if (status.isOK()) {
+                try {
+                    runParallelGroupWorker(state, std::move(variables));
+                } catch (const DBException& ex) {
+                    status = ex.toStatus();
+                }
+            }
+
+            // This has to happen before the promise is fulfilled, after which 'state' may be
+            // destroyed.
+            if (!status.isOK()) {
+                stdx::lock_guard<Latch> lk(state->mutex);
+                if (state->status.isOK()) {
+                    state->status = std::move(status);
+                }
+                state->cv.notify_all();
+            }
+            promise.emplaceValue();
+        });
+    }
+
+    // The workers refer to this stage and to 'state', so they must be done before we return, even
+    // on error.
+    auto stopWorkers = makeGuard([&] {
+        {
+            stdx::lock_guard<Latch> lk(state.mutex);
+            if (state.status.isOK()) {
+                state.status = {ErrorCodes::CallbackCanceled, "parallel $group was abandoned"};
+            }
+            state.cv.notify_all();
+        }
+        for (auto&& worker : workers) {
+            worker.getNoThrow().ignore();
+        }
+    });
+
+    const long long memoryBudget =
+        static_cast<long long>(_memoryTracker.maxMemoryUsageBytes) -
+        static_cast<long long>(_memoryTracker.memoryUsageBytes);
+
+    // Hands 'documents' over to the workers, waits until they are not too far behind, and returns
+    // false if their groups have outgrown the memory budget of this stage.
+    std::vector<BSONObj> documents;
+    auto pushBatch = [&] {
+        stdx::unique_lock<Latch> lk(state.mutex);
+        state.inputBatches.emplace_back(state.numBatches++, std::exchange(documents, {}));
+        state.cv.notify_all();
+
+        pExpCtx->opCtx->waitForConditionOrInterrupt(state.cv, lk, [&] {
+            if (!state.status.isOK()) {
+                return true;
+            }
+            size_t oldestBatch = state.numBatches;
+            for (auto&& partition : state.partitions) {
+                oldestBatch = std::min(oldestBatch, partition->nextBatch);
+            }
+            return state.numBatches - oldestBatch < numWorkers * kParallelGroupMaxQueuedBatches;
+        });
+        uassertStatusOK(state.status);
+
+        long long memoryUsageBytes = 0;
+        for (auto&& partition : state.partitions) {
+            memoryUsageBytes += partition->memoryUsageBytes;
+        }
+        return memoryUsageBytes <= memoryBudget;
+    };
+
+    for (; input.isAdvanced(); input = pSource->getNext()) {
+        // Only the BSON is handed over, as the fields of a Document are lazily loaded and so not
+        // safe to read from several threads. This is free for the documents which were not
+        // modified by an earlier stage.
+        auto rootDocument = input.releaseDocument();
+        auto bson = rootDocument.toBsonIfTriviallyConvertible();
+        if (!bson) {
+            BSONObjBuilder builder;
+            rootDocument.toBson(&builder);
+
+            // The documents produced by an earlier stage may outgrow the size limit of BSON, in
+            // which case this one and the rest of the input are left to the caller.
+            if (builder.len() > BSONObjMaxInternalSize) {
+                input = std::move(rootDocument);
+                break;
+            }
+            bson = builder.obj();
+        }
+        documents.push_back(bson->getOwned());
+
+        if (documents.size() >= kParallelGroupBatchSize && !pushBatch()) {
+            // Leave the rest of the input to the caller, which is able to spill, once the workers
+            // hold as much as this stage may keep in memory.
+            input = pSource->getNext();
+            break;
+        }
+    }
+    if (!documents.empty()) {
+        pushBatch();
+    }
+
+    {
+        stdx::unique_lock<Latch> lk(state.mutex);
+        state.inputDone = true;
+        state.cv.notify_all();
+        pExpCtx->opCtx->waitForConditionOrInterrupt(state.cv, lk, [&] {
+            return !state.status.isOK() || state.allBatchesAccumulated(lk);
+        });
+        uassertStatusOK(state.status);
+    }
+
+    // Every batch has been accumulated, so the workers are on their way out.
+    stopWorkers.dismiss();
+    for (auto&& worker : workers) {
+        worker.get();
+    }
+
+    // Merge the partial groups of the workers as if they had been spilled.
+    for (auto&& partition : state.partitions) {
+        for (auto&& group : partition->groups) {
+            if (shouldSpillWithAttemptToSaveMemory([this]() { return freeMemory(); })) {
+                _sortedFiles.push_back(spill());
+            }
+            accumulate(
+                group.first,
+                [&](size_t i) { return group.second[i]->getValue(/*toBeMerged=*/true); },
+                true);
+        }
+        partition->groups.clear();
+    }
+
+    return input;
+}
+
+void DocumentSourceGroup::runParallelGroupWorker(ParallelGroupState* state, Variables variables) {
+    const auto& comparator = pExpCtx->getValueComparator();
+    const size_t numPartitions = state->partitions.size();
+
+    stdx::unique_lock<Latch> lk(state->mutex);
+    for (;;) {
+        if (!state->status.isOK()) {
+            return;
+        }
+
+        // Accumulating comes first, as it frees the evaluated batches and lets the thread reading
+        // the input carry on.
+        auto ready = std::find_if(
+            state->partitions.begin(), state->partitions.end(), [](auto&& partition) {
+                return !partition->busy && !partition->evaluatedBatches.empty() &&
+                    partition->evaluatedBatches.begin()->first == partition->nextBatch;
+            });
+        if (ready != state->partitions.end()) {
+            auto partition = ready->get();
+            auto batch = std::move(partition->evaluatedBatches.begin()->second);
+            partition->evaluatedBatches.erase(partition->evaluatedBatches.begin());
+            partition->busy = true;
+
+            lk.unlock();
+            const long long memoryUsageDelta =
+                accumulateParallelGroupBatch(partition, batch, &variables);
+            batch.clear();
+            lk.lock();
+
+            partition->busy = false;
+            partition->memoryUsageBytes += memoryUsageDelta;
+            ++partition->nextBatch;
+            state->cv.notify_all();
+            continue;
+        }
+
+        if (!state->inputBatches.empty()) {
+            auto [position, documents] = std::move(state->inputBatches.front());
+            state->inputBatches.pop_front();
+
+            lk.unlock();
+            std::vector<std::vector<Value>> batches(numPartitions);
+            for (auto&& bson : documents) {
+                Document rootDocument(bson);
+                Value id = computeId(rootDocument, &variables);
+
+                // The groups hash the keys again, so leave them the low bits.
+                auto& batch =
+                    batches[(static_cast<uint64_t>(comparator.hash(id)) >> 32) % numPartitions];
+                batch.push_back(std::move(id));
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    batch.push_back(
+                        accumulatedField.expr.argument->evaluate(rootDocument, &variables));
+                }
+            }
+            documents.clear();
+            lk.lock();
+
+            // Every partition gets a batch, even an empty one, so that it can tell which comes
+            // next.
+            for (size_t i = 0; i < numPartitions; ++i) {
+                state->partitions[i]->evaluatedBatches.emplace(position, std::move(batches[i]));
+            }
+            state->cv.notify_all();
+            continue;
+        }
+
+        if (state->inputDone && state->allBatchesAccumulated(lk)) {
+            return;
+        }
+        state->cv.wait(lk);
+    }
+}
+
+long long DocumentSourceGroup::accumulateParallelGroupBatch(ParallelGroupPartition* partition,
+                                                            const std::vector<Value>& batch,
+                                                            Variables* variables) {
+    const size_t numAccumulators = _accumulatedFields.size();
+    long long memoryUsageDelta = 0;
+
+    for (auto it = batch.begin(); it != batch.end(); it += 1 + numAccumulators) {
+        const Value& id = *it;
+        const size_t oldSize = partition->groups.size();
+        Accumulators& group = partition->groups[id];
+
+        if (partition->groups.size() != oldSize) {
+            memoryUsageDelta += id.getApproximateSize();
+
+            Value expandedId = expandId(id);
+            Document idDoc =
+                expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+            group.reserve(numAccumulators);
+            for (auto&& accumulatedField : _accumulatedFields) {
+                auto accum = accumulatedField.makeAccumulator();
+                accum->startNewGroup(accumulatedField.expr.initializer->evaluate(idDoc, variables));
+                group.push_back(std::move(accum));
+            }
+        }
+
+        for (size_t i = 0; i < numAccumulators; ++i) {
+            memoryUsageDelta -= group[i]->memUsageForSorter();
+            group[i]->process(it[1 + i], _doingMerge);
+            memoryUsageDelta += group[i]->memUsageForSorter();
+        }
+    }
+
+    return memoryUsageDelta;
+}
+
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     _stats.usedDisk = true;
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
@@ -711,10 +1128,10 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
 }
 
-Value DocumentSourceGroup::computeId(const Document& root) {
+Value DocumentSourceGroup::computeId(const Document& root, Variables* variables) {
     // If only one expression, return result directly
     if (_idExpressions.size() == 1) {
-        Value retValue = _idExpressions[0]->evaluate(root, &pExpCtx->variables);
+        Value retValue = _idExpressions[0]->evaluate(root, variables);
         return retValue.missing() ? Value(BSONNULL) : std::move(retValue);
     }
 
@@ -722,7 +1139,7 @@ Value DocumentSourceGroup::computeId(const Document& root) {
     vector<Value> vals;
     vals.reserve(_idExpressions.size());
     for (size_t i = 0; i < _idExpressions.size(); i++) {
-        vals.push_back(_idExpressions[i]->evaluate(root, &pExpCtx->variables));
+        vals.push_back(_idExpressions[i]->evaluate(root, variables));
     }
     return Value(std::move(vals));
 }
@@ -188,6 +188,9 @@ protected:
     void doDispose() final;
 
 private:
+    struct ParallelGroupPartition;
+    struct ParallelGroupState;
+
     struct MemoryUsageTracker {
         struct AccumStatementMemoryTracker {
             // Maximum memory consumption thus far observed. Only updated when data is spilled to
@@ -231,6 +234,51 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Looks up the group for 'id', creating it if there is none yet, and feeds 'getArgument(i)' to
+     * the accumulator of its i-th accumulation statement. Keeps '_memoryTracker' up to date and
+     * returns true if the group was created.
+     */
+    template <typename GetArgument>
+    bool accumulate(const Value& id, const GetArgument& getArgument, bool merging);
+
+    /**
+     * Returns true if the group keys and the accumulators can be computed on threads other than
+     * the one running the operation. This rules out any use of JavaScript, of the shared random
+     * generator, of metadata, and of variables holding documents or arrays defined outside of this
+     * stage, none of which may be used from several threads at once.
+     */
+    bool canAccumulateInParallel() const;
+
+    /**
+     * Exhausts 'pSource', starting with 'input', by handing batches of the input documents, as
+     * BSON, to 'numWorkers' worker threads. The workers compute the group keys and the accumulator
+     * arguments and split them into one partition per worker by the hash of their key, so that
+     * each group lives in a single partition. The batches of a partition are accumulated one at a
+     * time and in their input order, so that the documents of a group are accumulated in their
+     * input order. The partial groups are then merged into '_groups'.
+     *
+     * Stops early if the workers run out of memory, or at the first input document too large to be
+     * converted to BSON, in which case the rest of the input has to be accumulated on this thread.
+     * Returns the first GetNextResult which was not accumulated.
+     */
+    GetNextResult accumulateInParallel(GetNextResult input, size_t numWorkers);
+
+    /**
+     * The body of the worker threads of accumulateInParallel(). Evaluates the input batches and
+     * accumulates the partitions whose next batch has been evaluated, using its own copy of the
+     * variables, until all the input has been accumulated or 'state' reports an error.
+     */
+    void runParallelGroupWorker(ParallelGroupState* state, Variables variables);
+
+    /**
+     * Feeds the group keys and accumulator arguments in 'batch' to the groups of 'partition', and
+     * returns by how much this changed the memory used by these groups.
+     */
+    long long accumulateParallelGroupBatch(ParallelGroupPartition* partition,
+                                           const std::vector<Value>& batch,
+                                           Variables* variables);
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -247,9 +295,10 @@ private:
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
-     * Computes the internal representation of the group key.
+     * Computes the internal representation of the group key, evaluating '_idExpressions' against
+     * 'variables'.
      */
-    Value computeId(const Document& root);
+    Value computeId(const Document& root, Variables* variables);
 
     /**
      * Converts the internal representation of the group key to the _id shape specified by the
@@ -288,6 +337,12 @@ private:
 
     bool _initialized;
 
+    // The number of documents left to accumulate on this thread before the rest of the input is
+    // spread across worker threads, or boost::none if it is accumulated on this thread only. Only
+    // set once initialize() has been called.
+    boost::optional<long long> _inputsBeforeParallelAccumulation;
+    bool _parallelAccumulationChecked = false;
+
     Value _currentId;
     Accumulators _currentAccumulators;
 
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/json.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_test_service_context.h"
+
+namespace mongo {
+namespace {
+
+const int kNumDocuments = 200 * 1000;
+
+std::vector<BSONObj> makeInput() {
+    std::vector<BSONObj> input;
+    input.reserve(kNumDocuments);
+    for (int i = 0; i < kNumDocuments; ++i) {
+        input.push_back(BSON("_id" << i << "a" << i % 1000 << "b" << i % 7 << "c" << i << "d"
+                                   << static_cast<double>(i) / 3 << "sub"
+                                   << BSON("x" << i % 5 << "y" << BSON_ARRAY(i % 3 << i % 4))));
+    }
+    return input;
+}
+
+/**
+ * Tests performance of an unsorted $group whose input is spread across 'state.range(0)' threads,
+ * one meaning that it is accumulated on the thread running the operation only.
+ */
+void BM_UnsortedGroup(benchmark::State& state) {
+    static const auto input = makeInput();
+
+    QueryTestServiceContext testServiceContext;
+    auto opCtx = testServiceContext.makeOperationContext();
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx =
+        new ExpressionContextForTest(opCtx.get(), NamespaceString("test.bm"));
+
+    const auto groupSpec = fromjson(
+        "{$group: {_id: {a: '$a', b: {$mod: ['$c', 97]}},"
+        "count: {$sum: 1},"
+        "total: {$sum: {$multiply: ['$c', '$d']}},"
+        "max: {$max: '$sub'},"
+        "ys: {$addToSet: {$arrayElemAt: ['$sub.y', 1]}}}}");
+
+    const auto oldNumWorkers = internalDocumentSourceGroupParallelWorkers.load();
+    const auto oldMinDocs = internalDocumentSourceGroupParallelMinDocs.load();
+    internalDocumentSourceGroupParallelWorkers.store(state.range(0));
+    internalDocumentSourceGroupParallelMinDocs.store(0);
+
+    for (auto keepRunning : state) {
+        state.PauseTiming();
+        std::deque<DocumentSource::GetNextResult> results;
+        for (auto&& obj : input) {
+            results.emplace_back(Document(obj));
+        }
+        auto source = DocumentSourceMock::createForTest(std::move(results), expCtx);
+        auto group = DocumentSourceGroup::createFromBson(groupSpec.firstElement(), expCtx);
+        group->setSource(source.get());
+        state.ResumeTiming();
+
+        for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    internalDocumentSourceGroupParallelWorkers.store(oldNumWorkers);
+    internalDocumentSourceGroupParallelMinDocs.store(oldMinDocs);
+}
+
+BENCHMARK(BM_UnsortedGroup)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mongo
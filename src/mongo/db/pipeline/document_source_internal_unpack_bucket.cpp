@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/timeseries/bucket_compression.h"
 
 namespace mongo {
 
@@ -51,7 +52,15 @@ void BucketUnpacker::reset(Document&& bucket) {
     _bucket = std::move(bucket);
     uassert(5346510, "An empty bucket cannot be unpacked", !_bucket.empty());
 
-    if (_bucket[kBucketDataFieldName].getDocument().empty()) {
+    auto data = _bucket[kBucketDataFieldName].getDocument();
+    auto version = _bucket[kBucketControlFieldName][kBucketControlVersionFieldName];
+    if (version.numeric() && version.coerceToInt() == timeseries::kCompressedBucketControlVersion) {
+        // Closed buckets may have had their columns compressed, in which case they are turned back
+        // into the uncompressed format so that they can be iterated over below.
+        data = Document(timeseries::decompressBucketData(data.toBson()));
+    }
+
+    if (data.empty()) {
         // If the data field of a bucket is present but it holds an empty object, there's nothing to
         // unpack.
         return;
@@ -75,11 +84,11 @@ void BucketUnpacker::reset(Document&& bucket) {
                 _metaValue.missing());
     }
 
-    _timeFieldIter = _bucket[kBucketDataFieldName][_spec.timeField].getDocument().fieldIterator();
+    _timeFieldIter = data[_spec.timeField].getDocument().fieldIterator();
 
     // Walk the data region of the bucket, and decide if an iterator should be set up based on the
     // include or exclude case.
-    auto colIter = _bucket[kBucketDataFieldName].getDocument().fieldIterator();
+    auto colIter = data.fieldIterator();
     while (colIter.more()) {
         auto&& [colName, colVal] = colIter.next();
         if (colName == _spec.timeField) {
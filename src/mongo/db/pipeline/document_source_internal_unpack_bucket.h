@@ -60,6 +60,8 @@ public:
     static constexpr StringData kBucketIdFieldName = "_id"_sd;
     static constexpr StringData kBucketDataFieldName = "data"_sd;
     static constexpr StringData kBucketMetaFieldName = "meta"_sd;
+    static constexpr StringData kBucketControlFieldName = "control"_sd;
+    static constexpr StringData kBucketControlVersionFieldName = "version"_sd;
 
     // When BucketUnpacker is created with kInclude it must produce measurements that contain the
     // set of fields. Otherwise, if the kExclude option is used, the measurements will include the
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/document_source_sort.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/timeseries/bucket_compression.h"
 
 namespace mongo {
 namespace {
@@ -595,6 +596,48 @@ TEST_F(InternalUnpackBucketStageTest, BucketUnpackerHandlesNullMetadata) {
     ASSERT_TRUE(next.isEOF());
 }
 
+TEST_F(InternalUnpackBucketStageTest, UnpacksCompressedBucket) {
+    auto expCtx = getExpCtx();
+    auto spec =
+        BSON("$_internalUnpackBucket"
+             << BSON("exclude" << BSONArray() << DocumentSourceInternalUnpackBucket::kTimeFieldName
+                               << kUserDefinedTimeName
+                               << DocumentSourceInternalUnpackBucket::kMetaFieldName
+                               << kUserDefinedMetaName));
+    auto unpack = DocumentSourceInternalUnpackBucket::createFromBson(spec.firstElement(), expCtx);
+
+    auto data = timeseries::compressBucketData(
+        {fromjson("{_id: 1, time: 1, myMeta: {m1: 999}, a: 1}"),
+         fromjson("{_id: 2, time: 2, myMeta: {m1: 999}}"),
+         fromjson("{_id: 3, time: 3, myMeta: {m1: 999}, a: 1}")},
+        kUserDefinedMetaName);
+    auto source = DocumentSourceMock::createForTest(
+        Document{{"_id", 1},
+                 {"control", Document{{"version", timeseries::kCompressedBucketControlVersion}}},
+                 {"meta", Document{{"m1", 999}}},
+                 {"data", data}},
+        expCtx);
+    unpack->setSource(source.get());
+
+    auto next = unpack->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.getDocument(),
+                       Document(fromjson("{time: 1, myMeta: {m1: 999}, _id: 1, a: 1}")));
+
+    next = unpack->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.getDocument(),
+                       Document(fromjson("{time: 2, myMeta: {m1: 999}, _id: 2}")));
+
+    next = unpack->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.getDocument(),
+                       Document(fromjson("{time: 3, myMeta: {m1: 999}, _id: 3, a: 1}")));
+
+    next = unpack->getNext();
+    ASSERT_TRUE(next.isEOF());
+}
+
 TEST_F(InternalUnpackBucketStageTest, ThrowsOnEmptyDataValue) {
     auto expCtx = getExpCtx();
     auto spec =
@@ -125,6 +125,12 @@ void DocumentSourceSort::serializeToArray(
         mutDoc["totalDataSizeSortedBytesEstimate"] =
             Value(static_cast<long long>(stats.totalDataSizeBytes));
         mutDoc["usedDisk"] = Value(stats.spills > 0 ? true : false);
+        if (stats.spills > 0) {
+            mutDoc["spilledDataSizeBytes"] =
+                Value(static_cast<long long>(stats.spilledDataSizeBytes));
+            mutDoc["spilledDataStorageSizeBytes"] =
+                Value(static_cast<long long>(stats.spilledDataStorageSizeBytes));
+        }
     }
 
     array.push_back(Value(mutDoc.freeze()));
@@ -1028,6 +1028,14 @@ void addMergeCursorsSource(Pipeline* mergePipeline,
     armParams.setTailableMode(mergePipeline->getContext()->tailableMode);
     armParams.setNss(mergePipeline->getContext()->ns);
 
+    // A $limit at the front of the merging pipeline bounds the results needed from the shards.
+    if (!mergePipeline->getSources().empty()) {
+        if (auto limitStage =
+                dynamic_cast<DocumentSourceLimit*>(mergePipeline->getSources().front().get())) {
+            armParams.setLimit(limitStage->getLimit());
+        }
+    }
+
     OperationSessionInfoFromClient sessionInfo;
     boost::optional<LogicalSessionFromClient> lsidFromClient;
 
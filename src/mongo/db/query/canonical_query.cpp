@@ -38,6 +38,7 @@
 #include "mongo/db/cst/cst_parser.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_array.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/canonical_query_encoder.h"
@@ -56,6 +57,62 @@ bool parsingCanProduceNoopMatchNodes(const ExtensionsCallback& extensionsCallbac
          allowedFeatures & MatchExpressionParser::AllowedFeatures::kJavascript);
 }
 
+/**
+ * Returns true if a comparison against 'rhs' can be evaluated regardless of its value, so that the
+ * value can be bound to the plan as a parameter. The other values either change the semantics of
+ * the comparison (e.g. null also matches missing fields, arrays match whole arrays as well as
+ * elements), or are compiled into a different plan (MinKey, MaxKey).
+ */
+bool isParameterizable(const BSONElement& rhs) {
+    switch (rhs.type()) {
+        case Array:
+        case Object:
+        case RegEx:
+        case jstNULL:
+        case Undefined:
+        case MinKey:
+        case MaxKey:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Assigns an InputParamId to every parameterizable comparison in the tree rooted at 'expr', in
+ * pre-order, and appends the comparisons to 'params'.
+ */
+void parameterize(MatchExpression* expr, std::vector<const ComparisonMatchExpression*>* params) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto comparison = static_cast<ComparisonMatchExpression*>(expr);
+        if (isParameterizable(comparison->getData())) {
+            comparison->setInputParamId(
+                static_cast<MatchExpression::InputParamId>(params->size()));
+            params->push_back(comparison);
+        }
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        parameterize(expr->getChild(i), params);
+    }
+}
+
+/**
+ * Replaces the right-hand side of every parameter in the tree rooted at 'expr' with 'placeholder'.
+ */
+void removeInputParams(MatchExpression* expr, const BSONElement& placeholder) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto comparison = static_cast<ComparisonMatchExpression*>(expr);
+        if (comparison->getInputParamId()) {
+            comparison->setData(placeholder);
+        }
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        removeInputParams(expr->getChild(i), placeholder);
+    }
+}
+
 }  // namespace
 
 // static
@@ -200,6 +257,8 @@ Status CanonicalQuery::init(OperationContext* opCtx,
     }
     auto unavailableMetadata = validStatus.getValue();
 
+    parameterize(_root.get(), &_inputParams);
+
     // Validate the projection if there is one.
     if (!_qr->getProj().isEmpty()) {
         try {
@@ -265,6 +324,19 @@ void CanonicalQuery::initSortPattern(QueryMetadataBitSet unavailableMetadata) {
     }
 }
 
+BSONObj CanonicalQuery::serializeFilterWithoutInputParams() const {
+    return serializeWithoutInputParams(*_root);
+}
+
+BSONObj CanonicalQuery::serializeWithoutInputParams(const MatchExpression& expr) {
+    // Queries cannot compare against undefined, so it cannot be confused with an actual value.
+    static const BSONObj kPlaceholder = BSON("" << BSONUndefined);
+
+    auto clone = expr.shallowClone();
+    removeInputParams(clone.get(), kPlaceholder.firstElement());
+    return clone->serialize();
+}
+
 void CanonicalQuery::setCollator(std::unique_ptr<CollatorInterface> collator) {
     auto collatorRaw = collator.get();
     // We must give the ExpressionContext the same collator.
@@ -43,6 +43,7 @@
 
 namespace mongo {
 
+class ComparisonMatchExpression;
 class OperationContext;
 
 class CanonicalQuery {
@@ -139,6 +140,28 @@ public:
         return *_qr;
     }
 
+    /**
+     * Returns the predicates of the filter whose right-hand side is a parameter of this query,
+     * indexed by their InputParamId. Only comparisons against scalars are parameters, and they are
+     * numbered in the same order for all queries of the same shape.
+     */
+    const std::vector<const ComparisonMatchExpression*>& getInputParams() const {
+        return _inputParams;
+    }
+
+    /**
+     * Returns the filter as normalized by canonicalization, with the right-hand side of every
+     * parameter replaced by a placeholder. Two queries with the same such filter differ only in
+     * the values of their parameters.
+     */
+    BSONObj serializeFilterWithoutInputParams() const;
+
+    /**
+     * Same as serializeFilterWithoutInputParams(), for 'expr', a subtree or a clone of a subtree of
+     * the filter of a query, such as the filter of a QuerySolutionNode.
+     */
+    static BSONObj serializeWithoutInputParams(const MatchExpression& expr);
+
     /**
      * Returns the projection, or nullptr if none.
      */
@@ -239,6 +262,9 @@ private:
 
     std::unique_ptr<MatchExpression> _root;
 
+    // The parameterized predicates of '_root', see getInputParams().
+    std::vector<const ComparisonMatchExpression*> _inputParams;
+
     boost::optional<projection_ast::Projection> _proj;
 
     boost::optional<SortPattern> _sortPattern;
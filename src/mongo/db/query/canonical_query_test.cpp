@@ -30,6 +30,7 @@
 #include "mongo/db/query/canonical_query.h"
 
 #include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
@@ -450,5 +451,35 @@ TEST(CanonicalQueryTest, InvalidSortOrdersFailToCanonicalize) {
     assertInvalidSortOrder(fromjson("{'': -1}"));
 }
 
+TEST(CanonicalQueryTest, ComparisonsAgainstScalarsAreInputParams) {
+    auto cq = canonicalize("{a: 1, b: {$gt: 'x'}, c: null, d: [1, 2], e: {$lte: 5}}");
+    auto&& params = cq->getInputParams();
+    ASSERT_EQ(3U, params.size());
+    for (size_t paramId = 0; paramId < params.size(); ++paramId) {
+        ASSERT(params[paramId]->getInputParamId());
+        ASSERT_EQ(static_cast<MatchExpression::InputParamId>(paramId),
+                  *params[paramId]->getInputParamId());
+    }
+
+    // The parameters are numbered in the order of the normalized filter, which sorts the EQ
+    // predicates before the LTE and GT ones.
+    ASSERT_BSONELT_EQ(fromjson("{a: 1}").firstElement(), params[0]->getData());
+    ASSERT_BSONELT_EQ(fromjson("{e: 5}").firstElement(), params[1]->getData());
+    ASSERT_BSONELT_EQ(fromjson("{b: 'x'}").firstElement(), params[2]->getData());
+}
+
+TEST(CanonicalQueryTest, FiltersWithoutInputParamsOnlyDifferInTheirShape) {
+    auto cq = canonicalize("{a: 1, b: {$gt: 'x'}, c: null}");
+    ASSERT_BSONOBJ_EQ(cq->serializeFilterWithoutInputParams(),
+                      canonicalize("{a: 2, b: {$gt: 'y'}, c: null}")
+                          ->serializeFilterWithoutInputParams());
+    ASSERT_BSONOBJ_NE(cq->serializeFilterWithoutInputParams(),
+                      canonicalize("{a: 1, b: {$gt: 'x'}, c: 1}")
+                          ->serializeFilterWithoutInputParams());
+
+    // Serializing the filter without its parameters leaves them in place.
+    ASSERT_BSONELT_EQ(fromjson("{a: 1}").firstElement(), cq->getInputParams()[0]->getData());
+}
+
 }  // namespace
 }  // namespace mongo
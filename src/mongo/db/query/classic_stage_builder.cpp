@@ -65,13 +65,65 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/logv2/log.h"
+#include "mongo/platform/overflow_arithmetic.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::stage_builder {
+namespace {
+/**
+ * Returns the most results the children of 'node' may have to return, when 'node' may have to
+ * return at most 'limit' results. Returns 1 when the stage of 'node' may stop asking for the
+ * results of its children before they are EOF, but not after a number of results known here.
+ */
+boost::optional<long long> getChildrenLimit(const QuerySolutionNode* node,
+                                            boost::optional<long long> limit) {
+    switch (node->getType()) {
+        case STAGE_LIMIT: {
+            const auto nodeLimit = static_cast<const LimitNode*>(node)->limit;
+            if (nodeLimit <= 0) {
+                return limit;
+            }
+            return limit ? std::min(*limit, nodeLimit) : nodeLimit;
+        }
+        case STAGE_SKIP: {
+            if (!limit) {
+                return boost::none;
+            }
+            long long childrenLimit;
+            if (overflow::add(*limit, static_cast<const SkipNode*>(node)->skip, &childrenLimit)) {
+                return boost::none;
+            }
+            return childrenLimit;
+        }
+        case STAGE_SORT_DEFAULT:
+        case STAGE_SORT_SIMPLE:
+            // The sort reads all the results of its child before returning any.
+            return boost::none;
+        case STAGE_ENSURE_SORTED:
+        case STAGE_FETCH:
+        case STAGE_PROJECTION_COVERED:
+        case STAGE_PROJECTION_DEFAULT:
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_RETURN_KEY:
+        case STAGE_SHARDING_FILTER:
+        case STAGE_SORT_KEY_GENERATOR:
+            // These stages return at most one result for each result of their child.
+            return limit;
+        default:
+            return limit ? boost::make_optional(1LL) : boost::none;
+    }
+}
+}  // namespace
+
 // Returns a non-null pointer to the root of a plan tree, or a non-OK status if the PlanStage tree
 // could not be constructed.
 std::unique_ptr<PlanStage> ClassicStageBuilder::build(const QuerySolutionNode* root) {
     auto* const expCtx = _cq.getExpCtxRaw();
 
+    const auto limit = _limit;
+    _limit = getChildrenLimit(root, limit);
+    ON_BLOCK_EXIT([&] { _limit = limit; });
+
     switch (root->getType()) {
         case STAGE_COLLSCAN: {
             const CollectionScanNode* csn = static_cast<const CollectionScanNode*>(root);
@@ -119,7 +171,7 @@ std::unique_ptr<PlanStage> ClassicStageBuilder::build(const QuerySolutionNode* r
             const FetchNode* fn = static_cast<const FetchNode*>(root);
             auto childStage = build(fn->children[0]);
             return std::make_unique<FetchStage>(
-                expCtx, _ws, std::move(childStage), fn->filter.get(), _collection);
+                expCtx, _ws, std::move(childStage), fn->filter.get(), _collection, limit);
         }
         case STAGE_SORT_DEFAULT: {
             auto snDefault = static_cast<const SortNodeDefault*>(root);
@@ -29,7 +29,10 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/query/stage_builder.h"
 
 namespace mongo::stage_builder {
@@ -43,11 +46,21 @@ public:
                         const CanonicalQuery& cq,
                         const QuerySolution& solution,
                         WorkingSet* ws)
-        : StageBuilder<PlanStage>{opCtx, collection, cq, solution}, _ws{ws} {}
+        : StageBuilder<PlanStage>{opCtx, collection, cq, solution},
+          _ws{ws},
+          _limit{solution.plannerOptions & QueryPlannerParams::NO_FETCH_BATCHING
+                     ? boost::make_optional(1LL)
+                     : boost::none} {}
 
     std::unique_ptr<PlanStage> build(const QuerySolutionNode* root) final;
 
 private:
     WorkingSet* _ws;
+
+    // The most results the stage being built may have to return before the stages above it stop
+    // asking for more, if they may stop before it is EOF. Passed to the FETCH stages, which do not
+    // read ahead of it. When the number is unknown, it is 1, so that they read one record at a
+    // time.
+    boost::optional<long long> _limit;
 };
 }  // namespace mongo::stage_builder
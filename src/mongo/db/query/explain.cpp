@@ -56,6 +56,7 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/query/query_settings_decoration.h"
+#include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/db/server_options.h"
 #include "mongo/util/hex.h"
@@ -365,6 +366,22 @@ void Explain::planCacheEntryToBSON(const PlanCacheEntry& entry, BSONObjBuilder*
     out->append("works", static_cast<long long>(entry.works));
     out->append("timeOfCreation", entry.timeOfCreation);
 
+    // Append the statistics on reusing the cached SBE execution tree, if SBE queries have ever
+    // hit this entry.
+    const auto hits = entry.sbeCounters->hits.load();
+    const auto misses = entry.sbeCounters->misses.load();
+    const auto rebuilds = entry.sbeCounters->rebuilds.load();
+    if (hits || misses || rebuilds) {
+        BSONObjBuilder sbeBuilder(out->subobjStart("sbePlanCacheStats"));
+        sbeBuilder.append("hits", hits);
+        sbeBuilder.append("misses", misses);
+        sbeBuilder.append("rebuilds", rebuilds);
+        sbeBuilder.append("hasCachedPlanStageTree", static_cast<bool>(entry.sbePlanStageTree));
+        if (entry.sbePlanStageTree) {
+            sbeBuilder.append("isParameterized", entry.sbePlanStageTree->isParameterized());
+        }
+    }
+
     if (entry.debugInfo) {
         const auto& debugInfo = *entry.debugInfo;
         invariant(debugInfo.decision);
@@ -622,7 +622,7 @@ public:
                     }
 
                     return buildCachedPlan(
-                        std::move(querySolution), plannerParams, cs->decisionWorks);
+                        planCacheKey, *cs, std::move(querySolution), plannerParams);
                 }
             }
         }
@@ -712,10 +712,15 @@ protected:
      *       deactivated and we use multi-planning to select an entirely new  winning plan.
      *     * Or stores additional information in the result object, in case runtime planning is
      *       implemented as a standalone component, rather than as part of the execution tree.
+     *
+     * The 'solution' has been reconstituted from the 'cachedSolution' found in the plan cache
+     * under 'planCacheKey'.
      */
-    virtual std::unique_ptr<ResultType> buildCachedPlan(std::unique_ptr<QuerySolution> solution,
-                                                        const QueryPlannerParams& plannerParams,
-                                                        size_t decisionWorks) = 0;
+    virtual std::unique_ptr<ResultType> buildCachedPlan(
+        const PlanCacheKey& planCacheKey,
+        const CachedSolution& cachedSolution,
+        std::unique_ptr<QuerySolution> solution,
+        const QueryPlannerParams& plannerParams) = 0;
 
     /**
      * Constructs a special PlanStage tree for rooted $or queries. Each clause of the $or is planned
@@ -829,9 +834,10 @@ protected:
     }
 
     std::unique_ptr<ClassicPrepareExecutionResult> buildCachedPlan(
+        const PlanCacheKey& planCacheKey,
+        const CachedSolution& cachedSolution,
         std::unique_ptr<QuerySolution> solution,
-        const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        const QueryPlannerParams& plannerParams) final {
         auto result = makeResult();
         auto&& root = buildExecutableTree(*solution);
 
@@ -844,7 +850,7 @@ protected:
                                                           _ws,
                                                           _cq,
                                                           plannerParams,
-                                                          decisionWorks,
+                                                          cachedSolution.decisionWorks,
                                                           std::move(root)),
                         std::move(solution));
         return result;
@@ -916,16 +922,73 @@ protected:
     }
 
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildCachedPlan(
+        const PlanCacheKey& planCacheKey,
+        const CachedSolution& cachedSolution,
         std::unique_ptr<QuerySolution> solution,
-        const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        const QueryPlannerParams& plannerParams) final {
         auto result = makeResult();
-        auto execTree = buildExecutableTree(*solution);
+        auto execTree =
+            buildCachedExecutableTree(planCacheKey, cachedSolution, *solution, plannerParams);
         result->emplace(std::move(execTree), std::move(solution));
-        result->setDecisionWorks(decisionWorks);
+        result->setDecisionWorks(cachedSolution.decisionWorks);
         return result;
     }
 
+    /**
+     * Returns a copy of the SBE tree attached to the plan cache entry 'cachedSolution' was created
+     * from, bound to the parameters of this query, if that tree can be reused for it. Otherwise
+     * builds a new tree from the 'solution', and attaches it to the cache entry if the entry has
+     * none yet.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
+    buildCachedExecutableTree(const PlanCacheKey& planCacheKey,
+                              const CachedSolution& cachedSolution,
+                              const QuerySolution& solution,
+                              const QueryPlannerParams& plannerParams) const {
+        // Trees with a shard filter hold the filtering metadata of the operation they were built
+        // for, parallel trees share their exchange and scan state between all their copies, and
+        // block prefilters inline the parameters of the query, so none of them can be cached.
+        const bool canUseCachedTree =
+            !(plannerParams.options & QueryPlannerParams::INCLUDE_SHARD_FILTER) &&
+            internalQuerySlotBasedExecutionParallelScanDOP.load() <= 1 &&
+            !internalQuerySlotBasedExecutionEnableBlockPrefilter.load();
+
+        auto&& cachedTree = cachedSolution.sbePlanStageTree;
+        auto execTree = canUseCachedTree && cachedTree
+            ? cachedTree->makeCopyFor(_opCtx, _collection, *_cq, solution, plannerParams.options)
+            : boost::none;
+        if (execTree) {
+            cachedSolution.sbeCounters->hits.fetchAndAdd(1);
+
+            auto sbeYieldPolicy = dynamic_cast<PlanYieldPolicySBE*>(_yieldPolicy);
+            invariant(sbeYieldPolicy);
+
+            auto&& root = execTree->first;
+            root->attachNewYieldPolicy(sbeYieldPolicy);
+            root->attachToOperationContext(_opCtx);
+            sbeYieldPolicy->registerPlan(root.get());
+            return std::move(*execTree);
+        }
+
+        if (cachedTree) {
+            cachedSolution.sbeCounters->rebuilds.fetchAndAdd(1);
+        } else {
+            cachedSolution.sbeCounters->misses.fetchAndAdd(1);
+        }
+
+        auto newExecTree = buildExecutableTree(solution);
+        if (canUseCachedTree && !cachedTree) {
+            auto&& [root, data] = newExecTree;
+            auto tree = std::make_shared<stage_builder::CachedPlanStageTree>(
+                *_cq, plannerParams.options, solution, *root, data);
+            const auto treeSizeBytes = tree->estimateObjectSizeInBytes();
+            CollectionQueryInfo::get(_collection)
+                .getPlanCache()
+                ->setSbePlanStageTree(planCacheKey, cachedSolution, std::move(tree), treeSizeBytes);
+        }
+        return newExecTree;
+    }
+
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildSubPlan(
         const QueryPlannerParams& plannerParams) final {
         // Nothing do be done here, all planning and stage building will be done by a SubPlanner.
@@ -1336,7 +1399,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorDele
 
     // The underlying query plan must preserve the record id, since it will be needed in order to
     // identify the record to update.
-    const size_t defaultPlannerOptions = QueryPlannerParams::PRESERVE_RECORD_ID;
+    const size_t defaultPlannerOptions =
+        QueryPlannerParams::PRESERVE_RECORD_ID | QueryPlannerParams::NO_FETCH_BATCHING;
 
     ClassicPrepareExecutionHelper helper{
         opCtx, collection, ws.get(), cq.get(), nullptr, defaultPlannerOptions};
@@ -1505,7 +1569,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorUpda
 
     // The underlying query plan must preserve the record id, since it will be needed in order to
     // identify the record to update.
-    const size_t defaultPlannerOptions = QueryPlannerParams::PRESERVE_RECORD_ID;
+    const size_t defaultPlannerOptions =
+        QueryPlannerParams::PRESERVE_RECORD_ID | QueryPlannerParams::NO_FETCH_BATCHING;
 
     ClassicPrepareExecutionHelper helper{
         opCtx, collection, ws.get(), cq.get(), nullptr, defaultPlannerOptions};
@@ -1759,6 +1824,9 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorCoun
     if (OperationShardingState::isOperationVersioned(opCtx)) {
         plannerOptions |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
+    if (limit != 0) {
+        plannerOptions |= QueryPlannerParams::NO_FETCH_BATCHING;
+    }
 
     ClassicPrepareExecutionHelper helper{
         opCtx, collection, ws.get(), cq.get(), nullptr, plannerOptions};
@@ -184,8 +184,12 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> InternalPlanner::deleteWith
                                                  startKey,
                                                  endKey,
                                                  boundInclusion,
-                                                 direction,
-                                                 InternalPlanner::IXSCAN_FETCH);
+                                                 direction);
+
+    // The DeleteStage reads again the records fetched before its last delete, so they are read one
+    // at a time.
+    root = std::make_unique<FetchStage>(
+        expCtx.get(), ws.get(), std::move(root), nullptr, collection, 1 /* limit */);
 
     root = std::make_unique<DeleteStage>(
         expCtx.get(), std::move(params), ws.get(), collection, root.release());
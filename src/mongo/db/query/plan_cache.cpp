@@ -165,7 +165,10 @@ bool PlanCache::shouldCacheQuery(const CanonicalQuery& query) {
 }
 
 CachedSolution::CachedSolution(const PlanCacheEntry& entry)
-    : plannerData(entry.plannerData->clone()), decisionWorks(entry.works) {}
+    : plannerData(entry.plannerData->clone()),
+      decisionWorks(entry.works),
+      sbePlanStageTree(entry.sbePlanStageTree),
+      sbeCounters(entry.sbeCounters) {}
 
 //
 // PlanCacheEntry
@@ -221,22 +224,49 @@ std::unique_ptr<PlanCacheEntry> PlanCacheEntry::create(
         debugInfo.emplace(std::move(createdFromQuery), std::move(decision));
     }
 
-    return std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(std::move(plannerDataForCache),
-                                                              timeOfCreation,
-                                                              queryHash,
-                                                              planCacheKey,
-                                                              isActive,
-                                                              works,
-                                                              std::move(debugInfo)));
+    return std::unique_ptr<PlanCacheEntry>(
+        new PlanCacheEntry(std::move(plannerDataForCache),
+                           timeOfCreation,
+                           queryHash,
+                           planCacheKey,
+                           isActive,
+                           works,
+                           std::move(debugInfo),
+                           nullptr,
+                           0,
+                           std::make_shared<SbePlanCacheCounters>()));
 }
 
-PlanCacheEntry::PlanCacheEntry(std::unique_ptr<const SolutionCacheData> plannerData,
-                               const Date_t timeOfCreation,
-                               const uint32_t queryHash,
-                               const uint32_t planCacheKey,
-                               const bool isActive,
-                               const size_t works,
-                               boost::optional<DebugInfo> debugInfo)
+std::unique_ptr<PlanCacheEntry> PlanCacheEntry::createRestored(
+    std::unique_ptr<const SolutionCacheData> plannerData,
+    uint32_t queryHash,
+    uint32_t planCacheKey,
+    Date_t timeOfCreation,
+    size_t works) {
+    return std::unique_ptr<PlanCacheEntry>(
+        new PlanCacheEntry(std::move(plannerData),
+                           timeOfCreation,
+                           queryHash,
+                           planCacheKey,
+                           true /* isActive */,
+                           works,
+                           boost::none,
+                           nullptr,
+                           0,
+                           std::make_shared<SbePlanCacheCounters>()));
+}
+
+PlanCacheEntry::PlanCacheEntry(
+    std::unique_ptr<const SolutionCacheData> plannerData,
+    const Date_t timeOfCreation,
+    const uint32_t queryHash,
+    const uint32_t planCacheKey,
+    const bool isActive,
+    const size_t works,
+    boost::optional<DebugInfo> debugInfo,
+    std::shared_ptr<const stage_builder::CachedPlanStageTree> sbePlanStageTree,
+    uint64_t sbePlanStageTreeSizeBytes,
+    std::shared_ptr<SbePlanCacheCounters> sbeCounters)
     : plannerData(std::move(plannerData)),
       timeOfCreation(timeOfCreation),
       queryHash(queryHash),
@@ -244,8 +274,12 @@ PlanCacheEntry::PlanCacheEntry(std::unique_ptr<const SolutionCacheData> plannerD
       isActive(isActive),
       works(works),
       debugInfo(std::move(debugInfo)),
+      sbePlanStageTree(std::move(sbePlanStageTree)),
+      sbePlanStageTreeSizeBytes(sbePlanStageTreeSizeBytes),
+      sbeCounters(std::move(sbeCounters)),
       estimatedEntrySizeBytes(_estimateObjectSizeInBytes()) {
     invariant(this->plannerData);
+    invariant(this->sbeCounters);
     // Account for the object in the global metric for estimating the server's total plan cache
     // memory consumption.
     planCacheTotalSizeEstimateBytes.increment(estimatedEntrySizeBytes);
@@ -267,7 +301,10 @@ std::unique_ptr<PlanCacheEntry> PlanCacheEntry::clone() const {
                                                               planCacheKey,
                                                               isActive,
                                                               works,
-                                                              std::move(debugInfoCopy)));
+                                                              std::move(debugInfoCopy),
+                                                              sbePlanStageTree,
+                                                              sbePlanStageTreeSizeBytes,
+                                                              sbeCounters));
 }
 
 uint64_t PlanCacheEntry::CreatedFromQuery::estimateObjectSizeInBytes() const {
@@ -310,6 +347,8 @@ uint64_t PlanCacheEntry::_estimateObjectSizeInBytes() const {
         size += debugInfo->estimateObjectSizeInBytes();
     }
 
+    size += sbePlanStageTreeSizeBytes;
+
     return size;
 }
 
@@ -450,6 +489,35 @@ std::unique_ptr<CachedSolution> PlanCache::getCacheEntryIfActive(const PlanCache
     return std::move(res.cachedSolution);
 }
 
+void PlanCache::setSbePlanStageTree(
+    const PlanCacheKey& key,
+    const CachedSolution& cachedSolution,
+    std::shared_ptr<const stage_builder::CachedPlanStageTree> tree,
+    uint64_t treeSizeBytes) {
+    invariant(tree);
+
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry = nullptr;
+    Status cacheStatus = _cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        invariant(cacheStatus == ErrorCodes::NoSuchKey);
+        return;
+    }
+    invariant(entry);
+
+    // The entry may have been replaced by a different plan since 'cachedSolution' was looked up,
+    // in which case 'tree' does not correspond to its planner data.
+    if (entry->sbeCounters != cachedSolution.sbeCounters || entry->sbePlanStageTree) {
+        return;
+    }
+    entry->sbePlanStageTree = std::move(tree);
+
+    // The entry is only ever accessed while holding the mutex, so its size can be updated in place.
+    entry->sbePlanStageTreeSizeBytes = treeSizeBytes;
+    entry->estimatedEntrySizeBytes += treeSizeBytes;
+    PlanCacheEntry::planCacheTotalSizeEstimateBytes.increment(treeSizeBytes);
+}
+
 /**
  * Given a query, and an (optional) current cache entry for its shape ('oldEntry'), determine
  * whether:
@@ -637,6 +705,23 @@ Status PlanCache::set(const CanonicalQuery& query,
     return Status::OK();
 }
 
+bool PlanCache::restore(const PlanCacheKey& key, std::unique_ptr<PlanCacheEntry> entry) {
+    invariant(entry);
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    if (_cache.hasKey(key)) {
+        return false;
+    }
+
+    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(key, entry.release());
+    if (evictedEntry) {
+        LOGV2_DEBUG(5190923,
+                    1,
+                    "Plan cache maximum size exceeded - removed least recently used entry",
+                    "evictedEntry"_attr = redact(evictedEntry->debugString()));
+    }
+    return true;
+}
+
 void PlanCache::deactivate(const CanonicalQuery& query) {
     if (internalQueryCacheDisableInactiveEntries.load()) {
         // This is a noop if inactive entries are disabled.
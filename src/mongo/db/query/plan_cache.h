@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional/optional.hpp>
+#include <memory>
 #include <set>
 
 #include "mongo/db/exec/plan_stats.h"
@@ -263,6 +264,27 @@ struct SolutionCacheData {
 
 class PlanCacheEntry;
 
+namespace stage_builder {
+class CachedPlanStageTree;
+}  // namespace stage_builder
+
+/**
+ * Counters describing how the queries which hit a plan cache entry obtained their SBE execution
+ * tree. They are shared between an entry, its clones and the CachedSolutions handed out from it,
+ * so that they can be bumped without taking the plan cache mutex.
+ */
+struct SbePlanCacheCounters {
+    // Number of times a cached SBE tree was cloned instead of running the stage builder.
+    AtomicWord<long long> hits;
+
+    // Number of times the entry had no SBE tree attached yet, so one had to be built.
+    AtomicWord<long long> misses;
+
+    // Number of times the attached SBE tree was built for different query parameters, so a new
+    // tree had to be built.
+    AtomicWord<long long> rebuilds;
+};
+
 /**
  * Information returned from a get(...) query.
  */
@@ -280,6 +302,14 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     const size_t decisionWorks;
+
+    // An SBE execution tree built from 'plannerData', or nullptr if none has been attached to the
+    // cache entry yet.
+    std::shared_ptr<const stage_builder::CachedPlanStageTree> sbePlanStageTree;
+
+    // The SBE counters of the cache entry this solution was created from. Never nullptr. Also
+    // identifies the entry when attaching an SBE tree to it, see PlanCache::setSbePlanStageTree().
+    std::shared_ptr<SbePlanCacheCounters> sbeCounters;
 };
 
 /**
@@ -355,6 +385,17 @@ public:
         bool isActive,
         size_t works);
 
+    /**
+     * Creates an active PlanCacheEntry for a plan which was not chosen by this process, such as one
+     * restored from a plan cache snapshot. The entry carries no debug info.
+     */
+    static std::unique_ptr<PlanCacheEntry> createRestored(
+        std::unique_ptr<const SolutionCacheData> plannerData,
+        uint32_t queryHash,
+        uint32_t planCacheKey,
+        Date_t timeOfCreation,
+        size_t works);
+
     ~PlanCacheEntry();
 
     /**
@@ -396,10 +437,21 @@ public:
     // debug info is omitted from new plan cache entries.
     const boost::optional<DebugInfo> debugInfo;
 
+    // An unprepared SBE execution tree built from 'plannerData', which queries using this entry
+    // clone rather than re-running the SBE stage builder. Attached lazily by the first query
+    // which hits the entry on the SBE path, and only ever set while holding the plan cache mutex.
+    std::shared_ptr<const stage_builder::CachedPlanStageTree> sbePlanStageTree;
+
+    // The estimated size of 'sbePlanStageTree' in bytes, or 0 if there is none.
+    uint64_t sbePlanStageTreeSizeBytes;
+
+    // Tracks the reuse of 'sbePlanStageTree'. Never nullptr.
+    const std::shared_ptr<SbePlanCacheCounters> sbeCounters;
+
     // An estimate of the size in bytes of this plan cache entry. This is the "deep size",
     // calculated by recursively incorporating the size of owned objects, the objects that they in
-    // turn own, and so on.
-    const uint64_t estimatedEntrySizeBytes;
+    // turn own, and so on. Grows when an SBE tree is attached to the entry.
+    uint64_t estimatedEntrySizeBytes;
 
     /**
      * Tracks the approximate cumulative size of the plan cache entries across all the collections.
@@ -416,7 +468,10 @@ private:
                    uint32_t planCacheKey,
                    bool isActive,
                    size_t works,
-                   boost::optional<DebugInfo> debugInfo);
+                   boost::optional<DebugInfo> debugInfo,
+                   std::shared_ptr<const stage_builder::CachedPlanStageTree> sbePlanStageTree,
+                   uint64_t sbePlanStageTreeSizeBytes,
+                   std::shared_ptr<SbePlanCacheCounters> sbeCounters);
 
     // Ensure that PlanCacheEntry is non-copyable.
     PlanCacheEntry(const PlanCacheEntry&) = delete;
@@ -499,6 +554,13 @@ public:
                Date_t now,
                boost::optional<double> worksGrowthCoefficient = boost::none);
 
+    /**
+     * Inserts 'entry' under 'key', unless the cache already holds an entry for it, which is then
+     * left untouched. Returns whether 'entry' was inserted. Used to warm the cache up with entries
+     * created by PlanCacheEntry::createRestored().
+     */
+    bool restore(const PlanCacheKey& key, std::unique_ptr<PlanCacheEntry> entry);
+
     /**
      * Set a cache entry back to the 'inactive' state. Rather than completely evicting an entry
      * when the associated plan starts to perform poorly, we deactivate it, so that plans which
@@ -530,6 +592,16 @@ public:
      */
     std::unique_ptr<CachedSolution> getCacheEntryIfActive(const PlanCacheKey& key) const;
 
+    /**
+     * Attaches 'tree', whose estimated size is 'treeSizeBytes', to the cache entry for 'key',
+     * provided that the entry is still the one 'cachedSolution' was created from and that it has
+     * no SBE tree attached yet. Otherwise this is a noop.
+     */
+    void setSbePlanStageTree(const PlanCacheKey& key,
+                             const CachedSolution& cachedSolution,
+                             std::shared_ptr<const stage_builder::CachedPlanStageTree> tree,
+                             uint64_t treeSizeBytes);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
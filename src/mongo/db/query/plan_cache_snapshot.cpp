@@ -0,0 +1,524 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_snapshot.h"
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/catalog/collection_catalog_helper.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/persistent_task_store.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/canonical_query_encoder.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache_snapshot_gen.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace plan_cache_snapshot {
+namespace {
+
+constexpr auto kTypeField = "type"_sd;
+constexpr auto kDirectionField = "direction"_sd;
+constexpr auto kIndexFilterAppliedField = "indexFilterApplied"_sd;
+constexpr auto kTreeField = "tree"_sd;
+constexpr auto kIndexField = "index"_sd;
+constexpr auto kKeyPatternField = "keyPattern"_sd;
+constexpr auto kIndexPositionField = "indexPosition"_sd;
+constexpr auto kCanCombineBoundsField = "canCombineBounds"_sd;
+constexpr auto kOrPushdownsField = "orPushdowns"_sd;
+constexpr auto kPositionField = "position"_sd;
+constexpr auto kRouteField = "route"_sd;
+constexpr auto kChildrenField = "children"_sd;
+
+constexpr auto kWholeIndexScanType = "wholeIndexScan"_sd;
+constexpr auto kCollectionScanType = "collectionScan"_sd;
+constexpr auto kIndexTagsType = "indexTags"_sd;
+
+// The snapshots are rewritten in full by every round, so there is no point in waiting for them to
+// be replicated.
+const WriteConcernOptions kLocalWriteConcern{1, WriteConcernOptions::SyncMode::UNSET, Seconds(0)};
+
+StringData solutionTypeToString(SolutionCacheData::SolutionType type) {
+    switch (type) {
+        case SolutionCacheData::WHOLE_IXSCAN_SOLN:
+            return kWholeIndexScanType;
+        case SolutionCacheData::COLLSCAN_SOLN:
+            return kCollectionScanType;
+        case SolutionCacheData::USE_INDEX_TAGS_SOLN:
+            return kIndexTagsType;
+    }
+    MONGO_UNREACHABLE;
+}
+
+SolutionCacheData::SolutionType parseSolutionType(StringData type) {
+    if (type == kWholeIndexScanType) {
+        return SolutionCacheData::WHOLE_IXSCAN_SOLN;
+    } else if (type == kCollectionScanType) {
+        return SolutionCacheData::COLLSCAN_SOLN;
+    } else if (type == kIndexTagsType) {
+        return SolutionCacheData::USE_INDEX_TAGS_SOLN;
+    }
+    uasserted(5190924, str::stream() << "Unknown plan cache snapshot solution type: " << type);
+}
+
+size_t parsePosition(const BSONElement& elem) {
+    uassert(5190925,
+            str::stream() << "Expected a non-negative number in plan cache snapshot: " << elem,
+            elem.isNumber() && elem.safeNumberLong() >= 0);
+    return static_cast<size_t>(elem.safeNumberLong());
+}
+
+bool serializeTree(const PlanCacheIndexTree& tree, BSONObjBuilder* builder) {
+    if (tree.entry) {
+        // The index entries of wildcard indexes depend on the paths of the query, which would
+        // have to be recomputed. Give up on these plans.
+        if (!tree.entry->identifier.disambiguator.empty()) {
+            return false;
+        }
+        builder->append(kIndexField, tree.entry->identifier.catalogName);
+        builder->append(kKeyPatternField, tree.entry->keyPattern);
+        builder->append(kIndexPositionField, static_cast<long long>(tree.index_pos));
+    }
+    builder->append(kCanCombineBoundsField, tree.canCombineBounds);
+
+    if (!tree.orPushdowns.empty()) {
+        BSONArrayBuilder orPushdownsBuilder(builder->subarrayStart(kOrPushdownsField));
+        for (auto&& orPushdown : tree.orPushdowns) {
+            if (!orPushdown.indexEntryId.disambiguator.empty()) {
+                return false;
+            }
+            BSONObjBuilder orPushdownBuilder(orPushdownsBuilder.subobjStart());
+            orPushdownBuilder.append(kIndexField, orPushdown.indexEntryId.catalogName);
+            orPushdownBuilder.append(kPositionField, static_cast<long long>(orPushdown.position));
+            orPushdownBuilder.append(kCanCombineBoundsField, orPushdown.canCombineBounds);
+            BSONArrayBuilder routeBuilder(orPushdownBuilder.subarrayStart(kRouteField));
+            for (auto step : orPushdown.route) {
+                routeBuilder.append(static_cast<long long>(step));
+            }
+        }
+    }
+
+    if (!tree.children.empty()) {
+        BSONArrayBuilder childrenBuilder(builder->subarrayStart(kChildrenField));
+        for (auto&& child : tree.children) {
+            BSONObjBuilder childBuilder(childrenBuilder.subobjStart());
+            if (!serializeTree(*child, &childBuilder)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const IndexEntry& findIndex(StringData name, const std::vector<IndexEntry>& indexes) {
+    auto it = std::find_if(indexes.begin(), indexes.end(), [&](const IndexEntry& index) {
+        return index.identifier.disambiguator.empty() && index.identifier.catalogName == name;
+    });
+    uassert(ErrorCodes::IndexNotFound,
+            str::stream() << "Index '" << name << "' of plan cache snapshot no longer exists",
+            it != indexes.end());
+    return *it;
+}
+
+std::unique_ptr<PlanCacheIndexTree> parseTree(const BSONObj& obj,
+                                              const std::vector<IndexEntry>& indexes) {
+    auto tree = std::make_unique<PlanCacheIndexTree>();
+
+    if (auto indexElem = obj[kIndexField]) {
+        const auto& index = findIndex(indexElem.checkAndGetStringData(), indexes);
+        uassert(ErrorCodes::IndexNotFound,
+                str::stream() << "Index '" << index.identifier.catalogName
+                              << "' of plan cache snapshot has a different key pattern",
+                SimpleBSONObjComparator::kInstance.evaluate(index.keyPattern ==
+                                                            obj[kKeyPatternField].Obj()));
+        tree->setIndexEntry(index);
+        tree->index_pos = parsePosition(obj[kIndexPositionField]);
+    }
+    tree->canCombineBounds = obj[kCanCombineBoundsField].trueValue();
+
+    if (auto orPushdownsElem = obj[kOrPushdownsField]) {
+        for (auto&& orPushdownElem : orPushdownsElem.Array()) {
+            auto orPushdownObj = orPushdownElem.Obj();
+            const auto& index =
+                findIndex(orPushdownObj[kIndexField].checkAndGetStringData(), indexes);
+            std::deque<size_t> route;
+            for (auto&& step : orPushdownObj[kRouteField].Array()) {
+                route.push_back(parsePosition(step));
+            }
+            tree->orPushdowns.push_back({index.identifier,
+                                         parsePosition(orPushdownObj[kPositionField]),
+                                         orPushdownObj[kCanCombineBoundsField].trueValue(),
+                                         std::move(route)});
+        }
+    }
+
+    if (auto childrenElem = obj[kChildrenField]) {
+        for (auto&& childElem : childrenElem.Array()) {
+            tree->children.push_back(parseTree(childElem.Obj(), indexes).release());
+        }
+    }
+    return tree;
+}
+
+/**
+ * Returns the shape of the query which created 'entry', as accepted by canonicalizeShape().
+ */
+BSONObj serializeShape(const PlanCacheEntry::CreatedFromQuery& createdFromQuery) {
+    BSONObjBuilder builder;
+    builder.append("query", createdFromQuery.filter);
+    builder.append("sort", createdFromQuery.sort);
+    builder.append("projection", createdFromQuery.projection);
+    if (!createdFromQuery.collation.isEmpty()) {
+        builder.append("collation", createdFromQuery.collation);
+    }
+    return builder.obj();
+}
+
+std::unique_ptr<CanonicalQuery> canonicalizeShape(OperationContext* opCtx,
+                                                  const NamespaceString& nss,
+                                                  const BSONObj& shape) {
+    auto qr = std::make_unique<QueryRequest>(nss);
+    qr->setFilter(shape["query"].Obj().getOwned());
+    qr->setSort(shape["sort"].Obj().getOwned());
+    qr->setProj(shape["projection"].Obj().getOwned());
+    if (auto collationElem = shape["collation"]) {
+        qr->setCollation(collationElem.Obj().getOwned());
+    }
+
+    const ExtensionsCallbackReal extensionsCallback(opCtx, &nss);
+    return uassertStatusOK(
+        CanonicalQuery::canonicalize(opCtx,
+                                     std::move(qr),
+                                     nullptr,
+                                     extensionsCallback,
+                                     MatchExpressionParser::kAllowAllSpecialFeatures));
+}
+
+/**
+ * Inserts the entry described by 'doc' into the plan cache of its collection, if it is still valid
+ * for the collection. Returns whether the entry was inserted.
+ */
+bool preloadEntry(OperationContext* opCtx, const PlanCacheSnapshotEntry& doc) {
+    const auto& id = doc.getId();
+    AutoGetCollectionForRead collection(
+        opCtx, NamespaceStringOrUUID(doc.getNs().db().toString(), id.getCollectionUUID()));
+
+    auto cq = canonicalizeShape(opCtx, collection.getNss(), doc.getQuery());
+    if (!PlanCache::shouldCacheQuery(*cq)) {
+        return false;
+    }
+
+    // The full plan cache key includes the indexability discriminators, so a matching hash means
+    // that the shape is planned against an equivalent set of indexes.
+    auto planCache = CollectionQueryInfo::get(collection.getCollection()).getPlanCache();
+    const auto key = planCache->computeKey(*cq);
+    const auto planCacheKey = canonical_query_encoder::computeHash(key.stringData());
+    if (planCacheKey != id.getPlanCacheKey()) {
+        return false;
+    }
+
+    QueryPlannerParams plannerParams;
+    fillOutPlannerParams(opCtx, collection.getCollection(), cq.get(), &plannerParams);
+    auto plannerData = parseSolutionCacheData(doc.getPlan(), plannerParams.indices);
+    if (plannerData->indexFilterApplied != plannerParams.indexFiltersApplied) {
+        return false;
+    }
+
+    auto entry = PlanCacheEntry::createRestored(
+        std::move(plannerData),
+        canonical_query_encoder::computeHash(key.getStableKeyStringData()),
+        planCacheKey,
+        Date_t::now(),
+        static_cast<size_t>(doc.getWorks()));
+
+    // Make sure the planner is still able to build a solution out of the plan before handing it
+    // to the queries.
+    uassertStatusOK(QueryPlanner::planFromCache(*cq, plannerParams, CachedSolution(*entry)));
+
+    return planCache->restore(key, std::move(entry));
+}
+
+}  // namespace
+
+boost::optional<BSONObj> serializeSolutionCacheData(const SolutionCacheData& data) {
+    BSONObjBuilder builder;
+    builder.append(kTypeField, solutionTypeToString(data.solnType));
+    builder.append(kDirectionField, data.wholeIXSolnDir);
+    builder.append(kIndexFilterAppliedField, data.indexFilterApplied);
+    if (data.tree) {
+        BSONObjBuilder treeBuilder(builder.subobjStart(kTreeField));
+        if (!serializeTree(*data.tree, &treeBuilder)) {
+            return boost::none;
+        }
+    }
+    return builder.obj();
+}
+
+std::unique_ptr<SolutionCacheData> parseSolutionCacheData(const BSONObj& obj,
+                                                          const std::vector<IndexEntry>& indexes) {
+    auto data = std::make_unique<SolutionCacheData>();
+    data->solnType = parseSolutionType(obj[kTypeField].checkAndGetStringData());
+    data->wholeIXSolnDir = obj[kDirectionField].numberInt();
+    data->indexFilterApplied = obj[kIndexFilterAppliedField].trueValue();
+    if (auto treeElem = obj[kTreeField]) {
+        data->tree = parseTree(treeElem.Obj(), indexes);
+    }
+
+    uassert(5190926,
+            "Plan cache snapshot of an index solution has no index",
+            data->solnType == SolutionCacheData::COLLSCAN_SOLN || data->tree);
+    uassert(5190927,
+            "Plan cache snapshot of a whole index scan has no index",
+            data->solnType != SolutionCacheData::WHOLE_IXSCAN_SOLN || data->tree->entry);
+    return data;
+}
+
+void snapshotPlanCaches(OperationContext* opCtx) {
+    const auto now = Date_t::now();
+    const size_t maxEntries = internalQueryPlanCacheSnapshotMaxEntries.load();
+
+    // Collect the entries while holding the collection locks, then write them without any.
+    std::vector<PlanCacheSnapshotEntry> docs;
+    std::vector<PlanCacheSnapshotId> restoredIds;
+    for (auto&& dbName : CollectionCatalog::get(opCtx)->getAllDbNames()) {
+        if (dbName == NamespaceString::kLocalDb) {
+            continue;
+        }
+
+        Lock::DBLock dbLock(opCtx, dbName, MODE_IS);
+        catalog::forEachCollectionFromDb(
+            opCtx, dbName, MODE_IS, [&](const CollectionPtr& collection) {
+                if (collection->ns() == NamespaceString::kPlanCacheSnapshotsNamespace) {
+                    return true;
+                }
+
+                auto planCache = CollectionQueryInfo::get(collection).getPlanCache();
+                for (auto&& entry : planCache->getAllEntries()) {
+                    if (docs.size() + restoredIds.size() >= maxEntries) {
+                        return false;
+                    }
+                    if (!entry->isActive) {
+                        continue;
+                    }
+
+                    PlanCacheSnapshotId id(collection->uuid(),
+                                           static_cast<long long>(entry->planCacheKey));
+
+                    // The entries without debug info lack the shape of their query. These are
+                    // either restored from a snapshot, which is then kept, or were created once the
+                    // plan caches grew too large and are not worth persisting.
+                    if (!entry->debugInfo) {
+                        restoredIds.push_back(std::move(id));
+                        continue;
+                    }
+
+                    auto plan = serializeSolutionCacheData(*entry->plannerData);
+                    if (!plan) {
+                        continue;
+                    }
+
+                    docs.emplace_back(std::move(id),
+                                      collection->ns(),
+                                      static_cast<long long>(entry->queryHash),
+                                      serializeShape(entry->debugInfo->createdFromQuery),
+                                      std::move(*plan),
+                                      static_cast<long long>(entry->works),
+                                      now);
+                }
+                return true;
+            });
+    }
+
+    PersistentTaskStore<PlanCacheSnapshotEntry> store(
+        NamespaceString::kPlanCacheSnapshotsNamespace);
+    for (auto&& doc : docs) {
+        store.upsert(opCtx,
+                     QUERY(PlanCacheSnapshotEntry::kIdFieldName << doc.getId().toBSON()),
+                     doc.toBSON(),
+                     kLocalWriteConcern);
+    }
+    for (auto&& id : restoredIds) {
+        try {
+            store.update(opCtx,
+                         QUERY(PlanCacheSnapshotEntry::kIdFieldName << id.toBSON()),
+                         BSON("$set" << BSON(PlanCacheSnapshotEntry::kLastSnapshotFieldName
+                                             << now)),
+                         kLocalWriteConcern);
+        } catch (const ExceptionFor<ErrorCodes::NoMatchingDocument>&) {
+            // The entry was not restored from a snapshot.
+        }
+    }
+    store.remove(opCtx,
+                 QUERY(PlanCacheSnapshotEntry::kLastSnapshotFieldName << LT << now),
+                 kLocalWriteConcern);
+
+    LOGV2_DEBUG(5190928,
+                1,
+                "Snapshotted the plan caches",
+                "entries"_attr = docs.size(),
+                "restoredEntries"_attr = restoredIds.size());
+}
+
+size_t preloadPlanCaches(OperationContext* opCtx) {
+    size_t numRestored = 0;
+    size_t numSkipped = 0;
+    PersistentTaskStore<PlanCacheSnapshotEntry> store(
+        NamespaceString::kPlanCacheSnapshotsNamespace);
+    store.forEach(opCtx, Query(), [&](const PlanCacheSnapshotEntry& doc) {
+        try {
+            if (preloadEntry(opCtx, doc)) {
+                ++numRestored;
+            } else {
+                ++numSkipped;
+            }
+        } catch (const ExceptionForCat<ErrorCategory::Interruption>&) {
+            throw;
+        } catch (const DBException& ex) {
+            ++numSkipped;
+            LOGV2_DEBUG(5190929,
+                        2,
+                        "Skipping plan cache snapshot entry",
+                        "namespace"_attr = doc.getNs(),
+                        "entry"_attr = doc.getId().toBSON(),
+                        "error"_attr = redact(ex.toStatus()));
+        }
+        return true;
+    });
+
+    LOGV2(5190930,
+          "Loaded the plan cache snapshots",
+          "restoredEntries"_attr = numRestored,
+          "skippedEntries"_attr = numSkipped);
+    return numRestored;
+}
+
+}  // namespace plan_cache_snapshot
+
+namespace {
+
+/**
+ * The state of the plan cache snapshot job, only accessed by the job's thread.
+ */
+struct SnapshotJobState {
+    bool preloaded = false;
+    long long preloadedTerm = repl::OpTime::kUninitializedTerm;
+    Date_t lastSnapshot;
+};
+
+void runSnapshotJob(OperationContext* opCtx, SnapshotJobState* state) {
+    auto replCoord = repl::ReplicationCoordinator::get(opCtx);
+    const bool isReplSet = replCoord->isReplEnabled();
+    if (isReplSet && !replCoord->getMemberState().readable()) {
+        return;
+    }
+
+    // The writes of the snapshot fail on their own if the node steps down in the meantime.
+    const bool isPrimary =
+        replCoord->canAcceptWritesForDatabase_UNSAFE(opCtx, NamespaceString::kConfigDb);
+    const auto term = isReplSet ? replCoord->getTerm() : repl::OpTime::kUninitializedTerm;
+
+    // Load the snapshots once the node is readable, and again when it steps up, as the snapshots
+    // written by the previous primary were replicated in the meantime.
+    if (!state->preloaded || (isPrimary && term != state->preloadedTerm)) {
+        plan_cache_snapshot::preloadPlanCaches(opCtx);
+        state->preloaded = true;
+        state->preloadedTerm = term;
+        state->lastSnapshot = Date_t::now();
+        return;
+    }
+
+    const Seconds interval(internalQueryPlanCacheSnapshotIntervalSecs.load());
+    if (isPrimary && interval > Seconds(0) && Date_t::now() - state->lastSnapshot >= interval) {
+        state->lastSnapshot = Date_t::now();
+        plan_cache_snapshot::snapshotPlanCaches(opCtx);
+    }
+}
+
+}  // namespace
+
+auto PeriodicThreadToSnapshotPlanCaches::get(ServiceContext* serviceContext)
+    -> PeriodicThreadToSnapshotPlanCaches& {
+    auto& jobContainer = _serviceDecoration(serviceContext);
+    jobContainer._init(serviceContext);
+
+    return jobContainer;
+}
+
+auto PeriodicThreadToSnapshotPlanCaches::operator*() const noexcept -> PeriodicJobAnchor& {
+    stdx::lock_guard lk(_mutex);
+    return *_anchor;
+}
+
+auto PeriodicThreadToSnapshotPlanCaches::operator-> () const noexcept -> PeriodicJobAnchor* {
+    stdx::lock_guard lk(_mutex);
+    return _anchor.get();
+}
+
+void PeriodicThreadToSnapshotPlanCaches::_init(ServiceContext* serviceContext) {
+    stdx::lock_guard lk(_mutex);
+    if (_anchor) {
+        return;
+    }
+
+    auto periodicRunner = serviceContext->getPeriodicRunner();
+    invariant(periodicRunner);
+
+    PeriodicRunner::PeriodicJob job(
+        "snapshotPlanCaches",
+        [state = std::make_shared<SnapshotJobState>()](Client* client) {
+            auto opCtx = client->makeOperationContext();
+            try {
+                runSnapshotJob(opCtx.get(), state.get());
+            } catch (ExceptionForCat<ErrorCategory::CancelationError>& ex) {
+                LOGV2_DEBUG(5190931, 2, "Periodic job canceled", "reason"_attr = ex.reason());
+            } catch (const DBException& ex) {
+                LOGV2_WARNING(5190932,
+                              "Failed to snapshot or load the plan caches",
+                              "error"_attr = redact(ex.toStatus()));
+            }
+        },
+        Seconds(1));
+
+    _anchor = std::make_shared<PeriodicJobAnchor>(periodicRunner->makeJob(std::move(job)));
+}
+
+}  // namespace mongo
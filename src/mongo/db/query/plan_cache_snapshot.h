@@ -0,0 +1,104 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/index_entry.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/hierarchical_acquisition.h"
+#include "mongo/util/periodic_runner.h"
+
+namespace mongo {
+namespace plan_cache_snapshot {
+
+/**
+ * Serializes 'data' into the 'plan' field of a config.planCacheSnapshots document. Indexes are
+ * identified by their name and key pattern. Returns boost::none if the plan cannot be persisted,
+ * which is the case for the plans using wildcard indexes, whose index entries are derived from the
+ * paths of the query.
+ */
+boost::optional<BSONObj> serializeSolutionCacheData(const SolutionCacheData& data);
+
+/**
+ * Rebuilds the SolutionCacheData serialized by serializeSolutionCacheData(), resolving the indexes
+ * it references against 'indexes'. Throws if the plan is malformed or if one of its indexes no
+ * longer exists with the same key pattern.
+ */
+std::unique_ptr<SolutionCacheData> parseSolutionCacheData(const BSONObj& obj,
+                                                          const std::vector<IndexEntry>& indexes);
+
+/**
+ * Writes the active entries of the plan caches of all collections to config.planCacheSnapshots,
+ * and removes the documents of the entries which are no longer cached. Must run on the primary.
+ */
+void snapshotPlanCaches(OperationContext* opCtx);
+
+/**
+ * Inserts the entries of config.planCacheSnapshots into the plan caches of their collections, as
+ * active entries. Entries whose query shape or plan does not match the current indexes of their
+ * collection are skipped, as are the shapes which are already cached. Returns the number of
+ * entries inserted.
+ */
+size_t preloadPlanCaches(OperationContext* opCtx);
+
+}  // namespace plan_cache_snapshot
+
+/**
+ * Defines a periodic background job which loads the plan cache snapshots on startup and on
+ * step-up, and which snapshots the plan caches every internalQueryPlanCacheSnapshotIntervalSecs
+ * seconds while the node is primary.
+ */
+class PeriodicThreadToSnapshotPlanCaches {
+public:
+    static PeriodicThreadToSnapshotPlanCaches& get(ServiceContext* serviceContext);
+
+    PeriodicJobAnchor& operator*() const noexcept;
+    PeriodicJobAnchor* operator->() const noexcept;
+
+private:
+    void _init(ServiceContext* serviceContext);
+
+    inline static const auto _serviceDecoration =
+        ServiceContext::declareDecoration<PeriodicThreadToSnapshotPlanCaches>();
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(1),
+                                            "PeriodicThreadToSnapshotPlanCaches::_mutex");
+    std::shared_ptr<PeriodicJobAnchor> _anchor;
+};
+
+}  // namespace mongo
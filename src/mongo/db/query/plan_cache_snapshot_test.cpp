@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_snapshot.h"
+
+#include "mongo/db/index/wildcard_key_generator.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+IndexEntry makeIndexEntry(BSONObj keyPattern, std::string name) {
+    return IndexEntry(keyPattern,
+                      IndexNames::nameToType(IndexNames::findPluginName(keyPattern)),
+                      IndexDescriptor::kLatestIndexVersion,
+                      false,  // multikey
+                      {},
+                      {},
+                      false,  // sparse
+                      false,  // unique
+                      IndexEntry::Identifier{std::move(name)},
+                      nullptr,
+                      BSONObj(),
+                      nullptr,
+                      nullptr);
+}
+
+std::vector<IndexEntry> makeIndexes() {
+    return {makeIndexEntry(BSON("a" << 1), "a_1"),
+            makeIndexEntry(BSON("b" << 1 << "c" << -1), "b_1_c_-1")};
+}
+
+std::unique_ptr<PlanCacheIndexTree> makeLeaf(const IndexEntry& index, size_t pos) {
+    auto leaf = std::make_unique<PlanCacheIndexTree>();
+    leaf->setIndexEntry(index);
+    leaf->index_pos = pos;
+    return leaf;
+}
+
+/**
+ * Checks that 'data' survives a round trip through its serialized form.
+ */
+void assertRoundTrips(const SolutionCacheData& data, const std::vector<IndexEntry>& indexes) {
+    auto serialized = plan_cache_snapshot::serializeSolutionCacheData(data);
+    ASSERT(serialized);
+
+    auto parsed = plan_cache_snapshot::parseSolutionCacheData(*serialized, indexes);
+    ASSERT_EQ(data.toString(), parsed->toString());
+    ASSERT_EQ(data.indexFilterApplied, parsed->indexFilterApplied);
+    ASSERT_BSONOBJ_EQ(*serialized, *plan_cache_snapshot::serializeSolutionCacheData(*parsed));
+}
+
+TEST(PlanCacheSnapshotTest, RoundTripsCollectionScan) {
+    SolutionCacheData data;
+    data.solnType = SolutionCacheData::COLLSCAN_SOLN;
+    assertRoundTrips(data, makeIndexes());
+}
+
+TEST(PlanCacheSnapshotTest, RoundTripsWholeIndexScan) {
+    auto indexes = makeIndexes();
+    SolutionCacheData data;
+    data.solnType = SolutionCacheData::WHOLE_IXSCAN_SOLN;
+    data.wholeIXSolnDir = -1;
+    data.tree = makeLeaf(indexes[1], 0);
+    assertRoundTrips(data, indexes);
+}
+
+TEST(PlanCacheSnapshotTest, RoundTripsIndexTagsWithOrPushdowns) {
+    auto indexes = makeIndexes();
+    auto root = std::make_unique<PlanCacheIndexTree>();
+    root->children.push_back(makeLeaf(indexes[0], 0).release());
+
+    auto orNode = std::make_unique<PlanCacheIndexTree>();
+    orNode->children.push_back(makeLeaf(indexes[1], 1).release());
+    auto leaf = makeLeaf(indexes[1], 0);
+    leaf->canCombineBounds = false;
+    orNode->children.push_back(leaf.release());
+    root->children.push_back(orNode.release());
+
+    auto pushdownLeaf = std::make_unique<PlanCacheIndexTree>();
+    pushdownLeaf->orPushdowns.push_back({indexes[1].identifier, 1, true, {1, 0}});
+    root->children.push_back(pushdownLeaf.release());
+
+    SolutionCacheData data;
+    data.solnType = SolutionCacheData::USE_INDEX_TAGS_SOLN;
+    data.indexFilterApplied = true;
+    data.tree = std::move(root);
+    assertRoundTrips(data, indexes);
+}
+
+TEST(PlanCacheSnapshotTest, DoesNotSerializeWildcardIndexes) {
+    auto keyPattern = BSON("$**" << 1);
+    auto wildcardProjection = std::make_unique<WildcardProjection>(
+        WildcardKeyGenerator::createProjectionExecutor(keyPattern, {}));
+    IndexEntry wildcardIndex(keyPattern,
+                             INDEX_WILDCARD,
+                             IndexDescriptor::kLatestIndexVersion,
+                             false,  // multikey
+                             {},
+                             {},
+                             false,  // sparse
+                             false,  // unique
+                             IndexEntry::Identifier{"$**_1", "a"},
+                             nullptr,
+                             BSONObj(),
+                             nullptr,
+                             wildcardProjection.get());
+
+    SolutionCacheData data;
+    data.solnType = SolutionCacheData::USE_INDEX_TAGS_SOLN;
+    data.tree = makeLeaf(wildcardIndex, 0);
+    ASSERT_FALSE(plan_cache_snapshot::serializeSolutionCacheData(data));
+}
+
+TEST(PlanCacheSnapshotTest, RejectsMissingOrChangedIndexes) {
+    auto indexes = makeIndexes();
+    SolutionCacheData data;
+    data.solnType = SolutionCacheData::USE_INDEX_TAGS_SOLN;
+    data.tree = makeLeaf(indexes[0], 0);
+    auto serialized = plan_cache_snapshot::serializeSolutionCacheData(data);
+    ASSERT(serialized);
+
+    ASSERT_THROWS_CODE(plan_cache_snapshot::parseSolutionCacheData(*serialized, {indexes[1]}),
+                       DBException,
+                       ErrorCodes::IndexNotFound);
+
+    std::vector<IndexEntry> changedIndexes{makeIndexEntry(BSON("a" << -1), "a_1")};
+    ASSERT_THROWS_CODE(plan_cache_snapshot::parseSolutionCacheData(*serialized, changedIndexes),
+                       DBException,
+                       ErrorCodes::IndexNotFound);
+}
+
+TEST(PlanCacheSnapshotTest, RejectsMalformedPlans) {
+    auto indexes = makeIndexes();
+    ASSERT_THROWS_CODE(
+        plan_cache_snapshot::parseSolutionCacheData(fromjson("{type: 'unknown'}"), indexes),
+        DBException,
+        5190924);
+    ASSERT_THROWS_CODE(
+        plan_cache_snapshot::parseSolutionCacheData(fromjson("{type: 'indexTags'}"), indexes),
+        DBException,
+        5190926);
+    ASSERT_THROWS_CODE(plan_cache_snapshot::parseSolutionCacheData(
+                           fromjson("{type: 'indexTags', tree: {index: 'a_1', keyPattern: {a: 1}, "
+                                    "indexPosition: -1}}"),
+                           indexes),
+                       DBException,
+                       5190925);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -832,6 +832,38 @@ TEST(PlanCacheTest, DeactivateCacheEntry) {
     ASSERT_EQ(entry->works, 20U);
 }
 
+TEST(PlanCacheTest, SbeCountersAreSharedWithClonesAndResetByNewEntries) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 20), Date_t{}));
+
+    // A CachedSolution handed out from the entry shares its counters, and has no SBE tree attached.
+    auto cachedSolution = std::move(planCache.get(*cq).cachedSolution);
+    ASSERT(cachedSolution);
+    ASSERT(cachedSolution->sbeCounters);
+    ASSERT_FALSE(cachedSolution->sbePlanStageTree);
+    cachedSolution->sbeCounters->hits.fetchAndAdd(2);
+    cachedSolution->sbeCounters->misses.fetchAndAdd(1);
+
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->sbeCounters, cachedSolution->sbeCounters);
+    ASSERT_EQ(entry->sbeCounters->hits.load(), 2);
+    ASSERT_EQ(entry->sbeCounters->misses.load(), 1);
+    ASSERT_EQ(entry->sbeCounters->rebuilds.load(), 0);
+    ASSERT_EQ(entry->clone()->sbeCounters, entry->sbeCounters);
+
+    // Replacing the entry with an active one starts counting from scratch.
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 10), Date_t{}));
+    entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_NE(entry->sbeCounters, cachedSolution->sbeCounters);
+    ASSERT_EQ(entry->sbeCounters->hits.load(), 0);
+    ASSERT_EQ(entry->sbeCounters->misses.load(), 0);
+}
+
 TEST(PlanCacheTest, GetMatchingStatsMatchesAndSerializesCorrectly) {
     PlanCache planCache;
 
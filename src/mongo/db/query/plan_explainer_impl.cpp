@@ -423,6 +423,10 @@ void statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendIntOrLL("totalDataSizeSorted", spec->totalDataSizeBytes);
             bob->appendBool("usedDisk", (spec->spills > 0));
+            if (spec->spills > 0) {
+                bob->appendIntOrLL("spilledDataSize", spec->spilledDataSizeBytes);
+                bob->appendIntOrLL("spilledDataStorageSize", spec->spilledDataStorageSizeBytes);
+            }
         }
     } else if (STAGE_SORT_MERGE == stats.stageType) {
         MergeSortStats* spec = static_cast<MergeSortStats*>(stats.specific.get());
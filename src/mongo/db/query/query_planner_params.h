@@ -129,6 +129,12 @@ struct QueryPlannerParams {
         // Ensure that any plan generated returns data that is "owned." That is, all BSONObjs are
         // in an "owned" state and are not pointing to data that belongs to the storage engine.
         RETURN_OWNED_DATA = 1 << 14,
+
+        // Instructs the stage builder to build FETCH stages which read one record at a time. Set
+        // for the plans of updates and deletes, whose write stages read again the records which
+        // were fetched before their last write, and of the counts whose COUNT stage stops at a
+        // limit.
+        NO_FETCH_BATCHING = 1 << 15,
     };
 
     // See Options enum above.
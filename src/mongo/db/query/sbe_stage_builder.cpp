@@ -47,6 +47,7 @@
 #include "mongo/db/exec/sbe/stages/traverse.h"
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/stages/unique.h"
+#include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/exec/shard_filterer.h"
 #include "mongo/db/fts/fts_index_format.h"
 #include "mongo/db/fts/fts_query_impl.h"
@@ -101,6 +102,199 @@ std::string PlanStageData::debugString() const {
     return builder.str();
 }
 
+namespace {
+/**
+ * Returns true if the SBE tree built for the solution rooted at 'node', with the runtime
+ * environment 'env', reads the parameters of its query and its index bounds from 'env', and does
+ * not depend on their values otherwise. This is not the case for oplog scans, whose minimum and
+ * maximum timestamps are derived from the constants of the query, nor for the stages which are not
+ * built from parameterized filters, such as text or geo stages.
+ */
+bool isParameterizedTree(const QuerySolutionNode* node, const sbe::RuntimeEnvironment& env) {
+    switch (node->getType()) {
+        case STAGE_COLLSCAN: {
+            auto csn = static_cast<const CollectionScanNode*>(node);
+            if (csn->minTs || csn->maxTs) {
+                return false;
+            }
+            break;
+        }
+        case STAGE_IXSCAN: {
+            if (!canBindIndexBounds(static_cast<const IndexScanNode*>(node), env)) {
+                return false;
+            }
+            break;
+        }
+        case STAGE_FETCH:
+        case STAGE_LIMIT:
+        case STAGE_SKIP:
+        case STAGE_SORT_DEFAULT:
+        case STAGE_SORT_SIMPLE:
+        case STAGE_SORT_KEY_GENERATOR:
+        case STAGE_SORT_MERGE:
+        case STAGE_OR:
+        case STAGE_RETURN_KEY:
+        case STAGE_PROJECTION_DEFAULT:
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_PROJECTION_COVERED:
+            break;
+        default:
+            return false;
+    }
+
+    for (auto&& child : node->children) {
+        if (!isParameterizedTree(child, env)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Appends the shape of the solution rooted at 'node' to 'shape', see makeSolutionShape().
+ */
+void appendSolutionShape(const QuerySolutionNode* node, BSONArrayBuilder* shape) {
+    {
+        BSONObjBuilder bob{shape->subobjStart()};
+        bob.append("stage", stageTypeToString(node->getType()));
+        if (node->filter) {
+            bob.append("filter", CanonicalQuery::serializeWithoutInputParams(*node->filter));
+        }
+        if (node->getType() == STAGE_IXSCAN) {
+            auto ixn = static_cast<const IndexScanNode*>(node);
+            bob.append("index", ixn->index.identifier.catalogName);
+            bob.append("direction", ixn->direction);
+            bob.append("dedup", ixn->shouldDedup);
+        }
+    }
+
+    for (auto&& child : node->children) {
+        appendSolutionShape(child, shape);
+    }
+}
+
+/**
+ * Returns the stages of 'solution' in pre-order, with their filters without parameters and the
+ * indexes they scan. Two solutions with the same shape, planned for queries whose filters only
+ * differ in the values of their parameters, build the same SBE tree, up to the values of the
+ * parameters and index bounds held in its runtime environment.
+ */
+BSONObj makeSolutionShape(const QuerySolution& solution) {
+    BSONArrayBuilder shape;
+    appendSolutionShape(solution.root(), &shape);
+    return shape.arr();
+}
+
+/**
+ * Binds the index bounds of every index scan of the solution rooted at 'node' to 'env', see
+ * bindIndexBounds(). Returns false if some of them cannot be bound.
+ */
+bool bindAllIndexBounds(OperationContext* opCtx,
+                        const CollectionPtr& collection,
+                        const QuerySolutionNode* node,
+                        sbe::RuntimeEnvironment* env) {
+    if (node->getType() == STAGE_IXSCAN &&
+        !bindIndexBounds(opCtx, collection, static_cast<const IndexScanNode*>(node), env)) {
+        return false;
+    }
+
+    for (auto&& child : node->children) {
+        if (!bindAllIndexBounds(opCtx, collection, child, env)) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+CachedPlanStageTree::CachedPlanStageTree(const CanonicalQuery& cq,
+                                         size_t plannerOptions,
+                                         const QuerySolution& solution,
+                                         const sbe::PlanStage& root,
+                                         PlanStageData& data)
+    : _isParameterized(isParameterizedTree(solution.root(), *data.env)),
+      _findCommand(getFindCommandToMatch(cq)),
+      _filterWithoutInputParams(_isParameterized ? cq.serializeFilterWithoutInputParams()
+                                                 : BSONObj()),
+      _solutionShape(_isParameterized ? makeSolutionShape(solution) : BSONObj()),
+      _plannerOptions(plannerOptions),
+      _root(root.clone()),
+      _data(data.env->makeDeepCopy()) {
+    _data.outputs = data.outputs;
+    _data.shouldTrackLatestOplogTimestamp = data.shouldTrackLatestOplogTimestamp;
+    _data.shouldTrackResumeToken = data.shouldTrackResumeToken;
+    _data.shouldUseTailableScan = data.shouldUseTailableScan;
+
+    // There is no accounting of the memory held by PlanStages, so the size of the plan as printed
+    // for explain stands in for the size of its stages and expressions.
+    _estimatedSizeBytes = sizeof(CachedPlanStageTree) + _findCommand.objsize() +
+        _filterWithoutInputParams.objsize() + _solutionShape.objsize() +
+        sbe::DebugPrinter{}.print(_root.get()).size();
+}
+
+BSONObj CachedPlanStageTree::getFindCommandToMatch(const CanonicalQuery& cq) const {
+    auto findCommand = cq.getQueryRequest().asFindCommand();
+    return _isParameterized ? findCommand.removeField(FindCommand::kFilterFieldName)
+                            : findCommand;
+}
+
+bool CachedPlanStageTree::bindParameters(OperationContext* opCtx,
+                                         const CollectionPtr& collection,
+                                         const CanonicalQuery& cq,
+                                         const QuerySolution& solution,
+                                         sbe::RuntimeEnvironment* env) const {
+    // The parameters consumed by exact index bounds are not read by any filter, and have no slot.
+    auto&& params = cq.getInputParams();
+    for (size_t paramId = 0; paramId < params.size(); ++paramId) {
+        auto paramSlot = env->getSlotIfExists(makeInputParamSlotName(paramId));
+        if (!paramSlot) {
+            continue;
+        }
+
+        const auto& rhs = params[paramId]->getData();
+        auto [tagView, valView] = sbe::bson::convertFrom(
+            true, rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
+        auto [tag, val] = sbe::value::copyValue(tagView, valView);
+        env->resetSlot(*paramSlot, tag, val, true);
+    }
+
+    return bindAllIndexBounds(opCtx, collection, solution.root(), env);
+}
+
+boost::optional<std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageData>>
+CachedPlanStageTree::makeCopyFor(OperationContext* opCtx,
+                                 const CollectionPtr& collection,
+                                 const CanonicalQuery& cq,
+                                 const QuerySolution& solution,
+                                 size_t plannerOptions) const {
+    if (_plannerOptions != plannerOptions || !_findCommand.binaryEqual(getFindCommandToMatch(cq))) {
+        return boost::none;
+    }
+
+    // Queries whose filters only differ in the values of their parameters have the same number of
+    // parameters, in the same positions. If they are planned to solutions of the same shape, the
+    // stages built for both read the same slots.
+    if (_isParameterized &&
+        !(_filterWithoutInputParams.binaryEqual(cq.serializeFilterWithoutInputParams()) &&
+          _solutionShape.binaryEqual(makeSolutionShape(solution)))) {
+        return boost::none;
+    }
+
+    // Every copy gets its own environment, so that its parameters can be bound without affecting
+    // the other copies, which may be executing concurrently.
+    PlanStageData data{_data.env->makeDeepCopy()};
+    data.outputs = _data.outputs;
+    data.shouldTrackLatestOplogTimestamp = _data.shouldTrackLatestOplogTimestamp;
+    data.shouldTrackResumeToken = _data.shouldTrackResumeToken;
+    data.shouldUseTailableScan = _data.shouldUseTailableScan;
+
+    if (_isParameterized && !bindParameters(opCtx, collection, cq, solution, data.env)) {
+        return boost::none;
+    }
+
+    return std::make_pair(_root->clone(), std::move(data));
+}
+
 namespace {
 const QuerySolutionNode* getNodeByType(const QuerySolutionNode* root, StageType type) {
     if (root->getType() == type) {
@@ -191,6 +385,10 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
 
     auto csn = static_cast<const CollectionScanNode*>(root);
 
+    // A $natural sort is normalized to a $natural hint before planning.
+    const bool requiresNaturalOrder =
+        !_cq.getQueryRequest().getHint()[QueryRequest::kNaturalSortField].eoo();
+
     auto [stage, outputs] = generateCollScan(_opCtx,
                                              _collection,
                                              csn,
@@ -199,6 +397,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                              _yieldPolicy,
                                              _data.env,
                                              reqs.getIsTailableCollScanResumeBranch(),
+                                             requiresNaturalOrder,
                                              _lockAcquisitionCallback);
 
     if (reqs.has(kReturnKey)) {
@@ -266,6 +465,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                              reqs,
                              &_slotIdGenerator,
                              &_spoolIdGenerator,
+                             _data.env,
                              _yieldPolicy,
                              _lockAcquisitionCallback);
 }
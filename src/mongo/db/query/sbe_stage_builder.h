@@ -236,6 +236,92 @@ struct PlanStageData {
     bool shouldUseTailableScan{false};
 };
 
+/**
+ * An unprepared SBE PlanStage tree along with its PlanStageData, kept in a plan cache entry so
+ * that queries hitting the entry can clone it instead of re-running the stage builder.
+ *
+ * The filters of the tree read the parameters of the query (see CanonicalQuery::getInputParams())
+ * from slots of the runtime environment, and so do its index scans for their bounds, unless the
+ * bounds can only be scanned by a generic index scan. If all the stages of the tree are built this
+ * way, the tree is "parameterized": any query of the same shape whose other constants are the
+ * same, and which is planned to the same solution, can reuse it, and every copy is bound to the
+ * values of the query it is made for. Any other tree has the values of its query inlined, e.g.
+ * into the bounds of an oplog scan, and can only be reused by a query with exactly the same
+ * parameters.
+ *
+ * The tree itself is never attached to an OperationContext nor executed, and its stages still
+ * reference the yield policy of the query it was built for, so every copy must be given a new one
+ * via attachNewYieldPolicy().
+ */
+class CachedPlanStageTree {
+public:
+    CachedPlanStageTree(const CanonicalQuery& cq,
+                        size_t plannerOptions,
+                        const QuerySolution& solution,
+                        const sbe::PlanStage& root,
+                        PlanStageData& data);
+
+    /**
+     * Returns a fresh copy of the cached tree and its PlanStageData, bound to the parameters of
+     * 'cq', which can be attached to an OperationContext and prepared. 'solution' is the solution
+     * planned for 'cq' from the cache entry this tree is attached to, and 'plannerOptions' the
+     * options it was planned with. Returns boost::none if this tree cannot be reused for 'cq'.
+     */
+    boost::optional<std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageData>> makeCopyFor(
+        OperationContext* opCtx,
+        const CollectionPtr& collection,
+        const CanonicalQuery& cq,
+        const QuerySolution& solution,
+        size_t plannerOptions) const;
+
+    bool isParameterized() const {
+        return _isParameterized;
+    }
+
+    /**
+     * Returns an estimate of the memory held by this tree, which is accounted for in the size of
+     * the plan cache entry it is attached to.
+     */
+    uint64_t estimateObjectSizeInBytes() const {
+        return _estimatedSizeBytes;
+    }
+
+private:
+    /**
+     * Returns the find command of 'cq' which a query reusing this tree must match. The filter is
+     * left out for a parameterized tree, and compared without its parameters instead.
+     */
+    BSONObj getFindCommandToMatch(const CanonicalQuery& cq) const;
+
+    /**
+     * Binds the parameters of 'cq', and the index bounds of 'solution', to the runtime environment
+     * 'env' of a copy of this parameterized tree. Returns false if some index bounds cannot be
+     * bound to the index scans of the tree.
+     */
+    bool bindParameters(OperationContext* opCtx,
+                        const CollectionPtr& collection,
+                        const CanonicalQuery& cq,
+                        const QuerySolution& solution,
+                        sbe::RuntimeEnvironment* env) const;
+
+    const bool _isParameterized;
+
+    // The find command the tree was built from, see getFindCommandToMatch().
+    const BSONObj _findCommand;
+
+    // For a parameterized tree, the filter it was built from without its parameters, and the shape
+    // of the solution it was built from, see makeSolutionShape(). Empty otherwise.
+    const BSONObj _filterWithoutInputParams;
+    const BSONObj _solutionShape;
+
+    const size_t _plannerOptions;
+
+    const std::unique_ptr<sbe::PlanStage> _root;
+    PlanStageData _data;
+
+    uint64_t _estimatedSizeBytes{0};
+};
+
 /**
  * A stage builder which builds an executable tree using slot-based PlanStages.
  */
@@ -33,7 +33,10 @@
 
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
 
+#include <cmath>
+
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/exec/sbe/stages/block.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
 #include "mongo/db/exec/sbe/stages/exchange.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
@@ -42,9 +45,14 @@
 #include "mongo/db/exec/sbe/stages/project.h"
 #include "mongo/db/exec/sbe/stages/scan.h"
 #include "mongo/db/exec/sbe/stages/union.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
 #include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/str.h"
@@ -100,6 +108,143 @@ makeOplogTimestampSlotsIfNeeded(const CollectionPtr& collection,
     return {};
 };
 
+// The number of records a block prefilter buffers before evaluating its predicates over them.
+constexpr size_t kBlockPrefilterSize = 1024;
+
+/**
+ * The top-level fields a collection scan reads into slots for a block prefilter, and the filter
+ * expression of the prefilter over these slots.
+ */
+struct BlockPrefilter {
+    std::vector<std::string> fields;
+    sbe::value::SlotVector slots;
+    std::unique_ptr<sbe::EExpression> filter;
+};
+
+/**
+ * Adds the predicates of 'expr', a conjunct of a collection scan filter, which a BlockStage can
+ * evaluate with its column kernels to 'prefilter'. These are the comparisons of a top-level field
+ * with a number, and the $exists predicates on a top-level field. The other predicates are left to
+ * the filter above the prefilter.
+ *
+ * The prefilter lets through every document the filter may match. The comparisons are therefore
+ * guarded by 'isArray', as the elements of an array may match even if the array doesn't.
+ */
+void addBlockPrefilterConjuncts(const MatchExpression* expr,
+                                sbe::value::SlotIdGenerator* slotIdGenerator,
+                                BlockPrefilter* prefilter) {
+    if (expr->matchType() == MatchExpression::AND) {
+        for (size_t i = 0; i < expr->numChildren(); ++i) {
+            addBlockPrefilterConjuncts(expr->getChild(i), slotIdGenerator, prefilter);
+        }
+        return;
+    }
+
+    const auto path = expr->path();
+    if (path.empty() || path.find('.') != std::string::npos) {
+        return;
+    }
+
+    auto getFieldSlot = [&]() {
+        auto it = std::find(prefilter->fields.begin(), prefilter->fields.end(), path);
+        if (it != prefilter->fields.end()) {
+            return prefilter->slots[it - prefilter->fields.begin()];
+        }
+        prefilter->fields.push_back(path.toString());
+        prefilter->slots.push_back(slotIdGenerator->generate());
+        return prefilter->slots.back();
+    };
+
+    std::unique_ptr<sbe::EExpression> conjunct;
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            const auto& rhs = static_cast<const ComparisonMatchExpression*>(expr)->getData();
+            // NaN is compared differently by the kernels and the match expressions.
+            const bool isNaN = (rhs.type() == NumberDouble && std::isnan(rhs._numberDouble())) ||
+                (rhs.type() == NumberDecimal && rhs._numberDecimal().isNaN());
+            if (!rhs.isNumber() || isNaN) {
+                return;
+            }
+
+            const auto op = [&] {
+                switch (expr->matchType()) {
+                    case MatchExpression::EQ:
+                        return sbe::EPrimBinary::eq;
+                    case MatchExpression::LT:
+                        return sbe::EPrimBinary::less;
+                    case MatchExpression::LTE:
+                        return sbe::EPrimBinary::lessEq;
+                    case MatchExpression::GT:
+                        return sbe::EPrimBinary::greater;
+                    default:
+                        return sbe::EPrimBinary::greaterEq;
+                }
+            }();
+
+            auto [tagView, valView] = sbe::bson::convertFrom(
+                true, rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
+            auto [tag, val] = sbe::value::copyValue(tagView, valView);
+            auto slot = getFieldSlot();
+            conjunct = sbe::makeE<sbe::EPrimBinary>(
+                sbe::EPrimBinary::logicOr,
+                makeFunction("isArray", sbe::makeE<sbe::EVariable>(slot)),
+                sbe::makeE<sbe::EPrimBinary>(
+                    op, sbe::makeE<sbe::EVariable>(slot), sbe::makeE<sbe::EConstant>(tag, val)));
+            break;
+        }
+        case MatchExpression::EXISTS:
+            conjunct = makeFunction("exists", sbe::makeE<sbe::EVariable>(getFieldSlot()));
+            break;
+        default:
+            return;
+    }
+
+    prefilter->filter = prefilter->filter
+        ? sbe::makeE<sbe::EPrimBinary>(
+              sbe::EPrimBinary::logicAnd, std::move(prefilter->filter), std::move(conjunct))
+        : std::move(conjunct);
+}
+
+/**
+ * Returns the block prefilter of the collection scan 'csn' if block processing is enabled and its
+ * filter has predicates which a BlockStage can evaluate with its column kernels.
+ */
+boost::optional<BlockPrefilter> makeBlockPrefilterIfNeeded(
+    const CollectionScanNode* csn, sbe::value::SlotIdGenerator* slotIdGenerator) {
+    if (!internalQuerySlotBasedExecutionEnableBlockPrefilter.load() || !csn->filter) {
+        return boost::none;
+    }
+
+    BlockPrefilter prefilter;
+    addBlockPrefilterConjuncts(csn->filter.get(), slotIdGenerator, &prefilter);
+    if (!prefilter.filter) {
+        return boost::none;
+    }
+    return std::move(prefilter);
+}
+
+/**
+ * Puts a BlockStage evaluating 'prefilter' on top of 'scan', which must read the fields of the
+ * prefilter into its slots. Only the slots in 'outputSlots' are visible above the BlockStage.
+ */
+std::unique_ptr<sbe::PlanStage> makeBlockPrefilterStage(std::unique_ptr<sbe::PlanStage> scan,
+                                                        BlockPrefilter prefilter,
+                                                        sbe::value::SlotVector outputSlots,
+                                                        PlanNodeId planNodeId) {
+    auto vals = std::move(outputSlots);
+    vals.insert(vals.end(), prefilter.slots.begin(), prefilter.slots.end());
+    return sbe::makeS<sbe::BlockStage>(std::move(scan),
+                                       std::move(vals),
+                                       std::move(prefilter.filter),
+                                       sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>>{},
+                                       kBlockPrefilterSize,
+                                       planNodeId);
+}
+
 /**
  * Creates a collection scan sub-tree optimized for oplog scans. We can built an optimized scan
  * when there is a predicted on the 'ts' field of the oplog collection.
@@ -339,6 +484,16 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
     auto&& [fields, slots, tsSlot] = makeOplogTimestampSlotsIfNeeded(
         collection, slotIdGenerator, csn->shouldTrackLatestOplogTimestamp);
 
+    // A plain scan may run the simple predicates of its filter over blocks of records first. The
+    // scan then reads the fields of these predicates into slots.
+    auto blockPrefilter = !tsSlot && !seekRecordIdSlot && !csn->tailable
+        ? makeBlockPrefilterIfNeeded(csn, slotIdGenerator)
+        : boost::none;
+    if (blockPrefilter) {
+        fields = blockPrefilter->fields;
+        slots = blockPrefilter->slots;
+    }
+
     NamespaceStringOrUUID nss{collection->ns().db().toString(), collection->uuid()};
     auto stage = sbe::makeS<sbe::ScanStage>(nss,
                                             resultSlot,
@@ -424,6 +579,13 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
             csn->nodeId());
     }
 
+    if (blockPrefilter) {
+        stage = makeBlockPrefilterStage(std::move(stage),
+                                        std::move(*blockPrefilter),
+                                        sbe::makeSV(resultSlot, recordIdSlot),
+                                        csn->nodeId());
+    }
+
     if (csn->filter) {
         // The 'stopApplyingFilterAfterFirstMatch' optimization is only applicable when the 'ts'
         // lower bound is also provided for an oplog scan, and is handled in
@@ -456,6 +618,123 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
 
     return {std::move(stage), std::move(outputs)};
 }
+
+/**
+ * Checks whether the collection scan described by 'csn' can be split across multiple threads. A
+ * parallel scan returns documents in no particular order and cannot be repositioned, so it is
+ * only used for plain forward scans over a non-capped, non-oplog collection which is large enough
+ * for the extra threads to pay off, when the query does not ask for the natural order.
+ *
+ * The producers read on their own OperationContexts, which carry neither the transaction nor the
+ * read concern of the query, so the parallel scan is also only used for reads without a
+ * transaction or read concern arguments. A read timestamp, such as the lastApplied one of reads on
+ * secondaries, is fine: the exchange opens the snapshots of all producers at the read timestamp of
+ * the query, so that they see the same data as a serial scan would.
+ */
+bool shouldGenerateParallelCollScan(OperationContext* opCtx,
+                                    const CollectionPtr& collection,
+                                    const CollectionScanNode* csn,
+                                    bool isTailableResumeBranch,
+                                    bool requiresNaturalOrder) {
+    if (internalQuerySlotBasedExecutionParallelScanDOP.load() <= 1) {
+        return false;
+    }
+
+    if (isTailableResumeBranch || csn->tailable || csn->resumeAfterRecordId ||
+        csn->requestResumeToken || csn->shouldTrackLatestOplogTimestamp ||
+        csn->stopApplyingFilterAfterFirstMatch || csn->direction != 1 || requiresNaturalOrder) {
+        return false;
+    }
+
+    if (collection->ns().isOplog() || collection->isCapped()) {
+        return false;
+    }
+
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    if (opCtx->inMultiDocumentTransaction() ||
+        readConcernArgs.getLevel() != repl::ReadConcernLevel::kLocalReadConcern ||
+        readConcernArgs.getArgsOpTime() || readConcernArgs.getArgsAfterClusterTime() ||
+        readConcernArgs.getArgsAtClusterTime()) {
+        return false;
+    }
+
+    return collection->getRecordStore()->numRecords(opCtx) >=
+        internalQuerySlotBasedExecutionParallelScanMinRecords.load();
+}
+
+/**
+ * Generates a collection scan sub-tree which is executed by
+ * 'internalQuerySlotBasedExecutionParallelScanDOP' producer threads. Each producer runs its own
+ * copy of the 'pscan' and the filter on top of it, using its own OperationContext, and thus its
+ * own storage engine cursor and snapshot. The RecordId ranges are shared between the producers, so
+ * that every record is returned exactly once:
+ *
+ *   exchange [resultSlot, recordIdSlot] dop round
+ *   filter <predicate>
+ *   pscan resultSlot recordIdSlot @coll
+ *
+ * A block prefilter may sit between the 'pscan' and the filter, see makeBlockPrefilterIfNeeded().
+ *
+ * Only the filter runs on the producers. Any projection is built by the parent PROJECTION node on
+ * top of the exchange, and thus runs on the thread of the query.
+ */
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateParallelCollScan(
+    OperationContext* opCtx,
+    const CollectionPtr& collection,
+    const CollectionScanNode* csn,
+    sbe::value::SlotIdGenerator* slotIdGenerator,
+    sbe::value::FrameIdGenerator* frameIdGenerator,
+    sbe::RuntimeEnvironment* env) {
+    auto resultSlot = slotIdGenerator->generate();
+    auto recordIdSlot = slotIdGenerator->generate();
+
+    // The producers run on their own threads with their own OperationContexts, so they must not
+    // share the yield policy of the main plan.
+    NamespaceStringOrUUID nss{collection->ns().db().toString(), collection->uuid()};
+    auto blockPrefilter = makeBlockPrefilterIfNeeded(csn, slotIdGenerator);
+    std::unique_ptr<sbe::PlanStage> stage = sbe::makeS<sbe::ParallelScanStage>(
+        nss,
+        resultSlot,
+        recordIdSlot,
+        blockPrefilter ? blockPrefilter->fields : std::vector<std::string>{},
+        blockPrefilter ? blockPrefilter->slots : sbe::makeSV(),
+        nullptr /* yieldPolicy */,
+        csn->nodeId());
+
+    if (blockPrefilter) {
+        stage = makeBlockPrefilterStage(std::move(stage),
+                                        std::move(*blockPrefilter),
+                                        sbe::makeSV(resultSlot, recordIdSlot),
+                                        csn->nodeId());
+    }
+
+    if (csn->filter) {
+        stage = generateFilter(opCtx,
+                               csn->filter.get(),
+                               std::move(stage),
+                               slotIdGenerator,
+                               frameIdGenerator,
+                               resultSlot,
+                               env,
+                               sbe::makeSV(resultSlot, recordIdSlot),
+                               csn->nodeId());
+    }
+
+    stage = sbe::makeS<sbe::ExchangeConsumer>(
+        std::move(stage),
+        internalQuerySlotBasedExecutionParallelScanDOP.load(),
+        sbe::makeSV(resultSlot, recordIdSlot),
+        sbe::ExchangePolicy::roundrobin,
+        nullptr,
+        nullptr,
+        csn->nodeId());
+
+    PlanStageSlots outputs;
+    outputs.set(PlanStageSlots::kResult, resultSlot);
+    outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
+
+    return {std::move(stage), std::move(outputs)};
+}
 }  // namespace
 
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
@@ -467,6 +746,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     PlanYieldPolicy* yieldPolicy,
     sbe::RuntimeEnvironment* env,
     bool isTailableResumeBranch,
+    bool requiresNaturalOrder,
     sbe::LockAcquisitionCallback lockAcquisitionCallback) {
     if (csn->minTs || csn->maxTs) {
         return generateOptimizedOplogScan(opCtx,
@@ -478,6 +758,10 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
                                           env,
                                           isTailableResumeBranch,
                                           std::move(lockAcquisitionCallback));
+    } else if (shouldGenerateParallelCollScan(
+                   opCtx, collection, csn, isTailableResumeBranch, requiresNaturalOrder)) {
+        return generateParallelCollScan(
+            opCtx, collection, csn, slotIdGenerator, frameIdGenerator, env);
     } else {
         return generateGenericCollScan(opCtx,
                                        collection,
@@ -410,12 +410,30 @@ void generateArraySize(MatchExpressionVisitorContext* context,
 void generateComparison(MatchExpressionVisitorContext* context,
                         const ComparisonMatchExpression* expr,
                         sbe::EPrimBinary::Op binaryOp) {
-    auto makePredicate = [expr, binaryOp](sbe::value::SlotId inputSlot,
-                                          EvalStage inputStage) -> EvalExprStagePair {
+    auto makePredicate = [context, expr, binaryOp](sbe::value::SlotId inputSlot,
+                                                   EvalStage inputStage) -> EvalExprStagePair {
         const auto& rhs = expr->getData();
         auto [tagView, valView] = sbe::bson::convertFrom(
             true, rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
 
+        // A parameter of the query is read from a slot of the runtime environment rather than
+        // inlined, so that the tree can be reused by queries with other values for it. Its value
+        // is never MinKey nor MaxKey, so the comparison is always generic.
+        if (auto paramId = expr->getInputParamId()) {
+            auto slotName = makeInputParamSlotName(*paramId);
+            auto paramSlot = context->env->getSlotIfExists(slotName);
+            if (!paramSlot) {
+                auto [tag, val] = sbe::value::copyValue(tagView, valView);
+                paramSlot = context->env->registerSlot(
+                    slotName, tag, val, true, context->slotIdGenerator);
+            }
+            return {makeFillEmptyFalse(sbe::makeE<sbe::EPrimBinary>(
+                        binaryOp,
+                        sbe::makeE<sbe::EVariable>(inputSlot),
+                        sbe::makeE<sbe::EVariable>(*paramSlot))),
+                    std::move(inputStage)};
+        }
+
         // SBE EConstant assumes ownership of the value so we have to make a copy here.
         auto [tag, val] = sbe::value::copyValue(tagView, valView);
 
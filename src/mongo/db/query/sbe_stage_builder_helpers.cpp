@@ -490,4 +490,8 @@ uint32_t dateTypeMask() {
             getBSONTypeMask(sbe::value::TypeTags::ObjectId) |
             getBSONTypeMask(sbe::value::TypeTags::bsonObjectId));
 }
+
+std::string makeInputParamSlotName(MatchExpression::InputParamId paramId) {
+    return str::stream() << "inputParam" << paramId;
+}
 }  // namespace mongo::stage_builder
@@ -37,6 +37,7 @@
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/sbe_stage_builder_eval_frame.h"
 #include "mongo/db/query/stage_types.h"
 
@@ -351,4 +352,10 @@ std::pair<sbe::value::TypeTags, sbe::value::Value> makeValue(const BSONArray& ba
  * Returns a BSON type mask of all data types coercible to date.
  */
 uint32_t dateTypeMask();
+
+/**
+ * Returns the name of the RuntimeEnvironment slot which holds the value of the query parameter
+ * 'paramId'.
+ */
+std::string makeInputParamSlotName(MatchExpression::InputParamId paramId);
 }  // namespace mongo::stage_builder
@@ -243,6 +243,63 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
     return result;
 }
 
+/**
+ * Computes the low/high key values of the intervals scanned by 'ixn', see
+ * makeIntervalsFromIndexBounds().
+ */
+std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
+makeIntervalsFromIndexScanNode(OperationContext* opCtx,
+                               const CollectionPtr& collection,
+                               const IndexScanNode* ixn) {
+    auto descriptor =
+        collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.identifier.catalogName);
+    auto accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
+    return makeIntervalsFromIndexBounds(
+        ixn->bounds,
+        ixn->direction == 1,
+        accessMethod->getSortedDataInterface()->getKeyStringVersion(),
+        accessMethod->getSortedDataInterface()->getOrdering());
+}
+
+/**
+ * Constructs an array containing objects with the low and high keys for each of the 'intervals'.
+ * E.g.,
+ *    [ {l: KS(...), h: KS(...)},
+ *      {l: KS(...), h: KS(...)}, ... ]
+ */
+std::pair<sbe::value::TypeTags, sbe::value::Value> makeIntervalsArray(
+    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
+        intervals) {
+    using namespace std::literals;
+
+    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
+    auto arr = sbe::value::getArrayView(boundsVal);
+    for (auto&& [lowKey, highKey] : intervals) {
+        auto [tag, val] = sbe::value::makeNewObject();
+        auto obj = sbe::value::getObjectView(val);
+        obj->push_back("l"sv,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
+        obj->push_back("h"sv,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
+        arr->push_back(tag, val);
+    }
+    return {boundsTag, boundsVal};
+}
+
+// The index bounds of an index scan are held in the runtime environment, in slots named after the
+// node of the scan, so that they can be rebound to the bounds of another query, see
+// bindIndexBounds(). A single interval is held as a pair of keys, multiple intervals as an array
+// built by makeIntervalsArray().
+constexpr auto kLowKey = "lowKey"_sd;
+constexpr auto kHighKey = "highKey"_sd;
+constexpr auto kIntervals = "intervals"_sd;
+
+std::string makeIndexBoundsSlotName(PlanNodeId nodeId, StringData part) {
+    return str::stream() << "indexBounds" << nodeId << "." << part;
+}
+
 /**
  * Constructs an optimized version of an index scan for multi-interval index bounds for the case
  * when the bounds can be decomposed in a number of single-interval bounds. In this case, instead
@@ -255,8 +312,7 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
  *                  project [lowKeySlot = getField (unwindSlot, "l"),
  *                           highKeySlot = getField (unwindSlot, "h")]
  *                  unwind unwindSlot indexSlot boundsSlot false
- *                  project [boundsSlot = [{"l" : KS(...), "h" : KS(...)},
- *                                         {"l" : KS(...), "h" : KS(...)}, ...]]
+ *                  project [boundsSlot = intervalsExpr]
  *                  limit 1
  *                  coscan
  *               right
@@ -265,14 +321,14 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
  * This subtree is similar to the single-interval subtree with the only difference that instead
  * of projecting a single pair of the low/high keys, we project an array of such pairs and then
  * use the unwind stage to flatten the array and generate multiple input intervals to the ixscan.
+ * 'intervalsExpr' must produce an array of intervals built by makeIntervalsArray().
  */
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
 generateOptimizedMultiIntervalIndexScan(
     const CollectionPtr& collection,
     const std::string& indexName,
     bool forward,
-    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-        intervals,
+    std::unique_ptr<sbe::EExpression> intervalsExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector indexKeySlots,
     sbe::value::SlotIdGenerator* slotIdGenerator,
@@ -285,35 +341,18 @@ generateOptimizedMultiIntervalIndexScan(
     auto lowKeySlot = slotIdGenerator->generate();
     auto highKeySlot = slotIdGenerator->generate();
 
-    // Construct an array containing objects with the low and high keys for each interval. E.g.,
-    //    [ {l: KS(...), h: KS(...)},
-    //      {l: KS(...), h: KS(...)}, ... ]
-    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
-    auto arr = sbe::value::getArrayView(boundsVal);
-    for (auto&& [lowKey, highKey] : intervals) {
-        auto [tag, val] = sbe::value::makeNewObject();
-        auto obj = sbe::value::getObjectView(val);
-        obj->push_back("l"sv,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
-        obj->push_back("h"sv,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
-        arr->push_back(tag, val);
-    }
-
     auto boundsSlot = slotIdGenerator->generate();
     auto unwindSlot = slotIdGenerator->generate();
 
-    // Project out the constructed array as a constant value and add an unwind stage on top to
-    // flatten the array.
+    // Project out the array of intervals built by makeIntervalsArray() and add an unwind stage on
+    // top to flatten the array.
     auto unwind = sbe::makeS<sbe::UnwindStage>(
         sbe::makeProjectStage(
             sbe::makeS<sbe::LimitSkipStage>(
                 sbe::makeS<sbe::CoScanStage>(planNodeId), 1, boost::none, planNodeId),
             planNodeId,
             boundsSlot,
-            sbe::makeE<sbe::EConstant>(boundsTag, boundsVal)),
+            std::move(intervalsExpr)),
         boundsSlot,
         unwindSlot,
         slotIdGenerator->generate(), /* We don't need an index slot but must to provide it. */
@@ -617,14 +656,17 @@ generateGenericMultiIntervalIndexScan(const CollectionPtr& collection,
                                            sbe::makeEs(sbe::makeE<sbe::EVariable>(resultSlot))),
                 ixn->nodeId())};
 }
-}  // namespace
 
-std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleIntervalIndexScan(
+/**
+ * Same as generateSingleIntervalIndexScan(), but the low and high keys are the results of
+ * 'lowKeyExpr' and 'highKeyExpr'.
+ */
+std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleIntervalIndexScanImpl(
     const CollectionPtr& collection,
     const std::string& indexName,
     bool forward,
-    std::unique_ptr<KeyString::Value> lowKey,
-    std::unique_ptr<KeyString::Value> highKey,
+    std::unique_ptr<sbe::EExpression> lowKeyExpr,
+    std::unique_ptr<sbe::EExpression> highKeyExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector indexKeySlots,
     boost::optional<sbe::value::SlotId> recordSlot,
@@ -643,11 +685,9 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
             sbe::makeS<sbe::CoScanStage>(planNodeId), 1, boost::none, planNodeId),
         planNodeId,
         lowKeySlot,
-        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
-                                   sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release())),
+        std::move(lowKeyExpr),
         highKeySlot,
-        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
-                                   sbe::value::bitcastFrom<KeyString::Value*>(highKey.release())));
+        std::move(highKeyExpr));
 
     // Scan the index in the range {'lowKeySlot', 'highKeySlot'} (subject to inclusive or
     // exclusive boundaries), and produce a single field recordIdSlot that can be used to
@@ -676,6 +716,38 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
                                            planNodeId)};
 }
 
+}  // namespace
+
+std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleIntervalIndexScan(
+    const CollectionPtr& collection,
+    const std::string& indexName,
+    bool forward,
+    std::unique_ptr<KeyString::Value> lowKey,
+    std::unique_ptr<KeyString::Value> highKey,
+    sbe::IndexKeysInclusionSet indexKeysToInclude,
+    sbe::value::SlotVector indexKeySlots,
+    boost::optional<sbe::value::SlotId> recordSlot,
+    sbe::value::SlotIdGenerator* slotIdGenerator,
+    PlanYieldPolicy* yieldPolicy,
+    PlanNodeId planNodeId,
+    sbe::LockAcquisitionCallback lockAcquisitionCallback) {
+    return generateSingleIntervalIndexScanImpl(
+        collection,
+        indexName,
+        forward,
+        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
+                                   sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release())),
+        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
+                                   sbe::value::bitcastFrom<KeyString::Value*>(highKey.release())),
+        indexKeysToInclude,
+        std::move(indexKeySlots),
+        recordSlot,
+        slotIdGenerator,
+        yieldPolicy,
+        planNodeId,
+        std::move(lockAcquisitionCallback));
+}
+
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     OperationContext* opCtx,
     const CollectionPtr& collection,
@@ -683,6 +755,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     PlanStageReqs reqs,
     sbe::value::SlotIdGenerator* slotIdGenerator,
     sbe::value::SpoolIdGenerator* spoolIdGenerator,
+    sbe::RuntimeEnvironment* env,
     PlanYieldPolicy* yieldPolicy,
     sbe::LockAcquisitionCallback lockAcquisitionCallback) {
     uassert(4822864, "Index scans with a filter are not supported in SBE", !ixn->filter);
@@ -731,34 +804,54 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     }
 
     if (intervals.size() == 1) {
-        // If we have just a single interval, we can construct a simplified sub-tree.
+        // If we have just a single interval, we can construct a simplified sub-tree. The keys are
+        // read from the runtime environment, so that they can be rebound by bindIndexBounds().
         auto&& [lowKey, highKey] = intervals[0];
+        auto lowKeySlot =
+            env->registerSlot(makeIndexBoundsSlotName(ixn->nodeId(), kLowKey),
+                              sbe::value::TypeTags::ksValue,
+                              sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()),
+                              true,
+                              slotIdGenerator);
+        auto highKeySlot =
+            env->registerSlot(makeIndexBoundsSlotName(ixn->nodeId(), kHighKey),
+                              sbe::value::TypeTags::ksValue,
+                              sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()),
+                              true,
+                              slotIdGenerator);
         sbe::value::SlotId recordIdSlot;
 
         std::tie(recordIdSlot, stage) =
-            generateSingleIntervalIndexScan(collection,
-                                            ixn->index.identifier.catalogName,
-                                            ixn->direction == 1,
-                                            std::move(lowKey),
-                                            std::move(highKey),
-                                            indexKeyBitset,
-                                            indexKeySlots,
-                                            boost::none,  // recordSlot
-                                            slotIdGenerator,
-                                            yieldPolicy,
-                                            ixn->nodeId(),
-                                            std::move(lockAcquisitionCallback));
+            generateSingleIntervalIndexScanImpl(collection,
+                                                ixn->index.identifier.catalogName,
+                                                ixn->direction == 1,
+                                                sbe::makeE<sbe::EVariable>(lowKeySlot),
+                                                sbe::makeE<sbe::EVariable>(highKeySlot),
+                                                indexKeyBitset,
+                                                indexKeySlots,
+                                                boost::none,  // recordSlot
+                                                slotIdGenerator,
+                                                yieldPolicy,
+                                                ixn->nodeId(),
+                                                std::move(lockAcquisitionCallback));
 
         outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
     } else if (intervals.size() > 1) {
         // If we were able to decompose multi-interval index bounds into a number of single-interval
-        // bounds, we can also built an optimized sub-tree to perform an index scan.
+        // bounds, we can also built an optimized sub-tree to perform an index scan. As above, the
+        // intervals are read from the runtime environment.
+        auto [intervalsTag, intervalsVal] = makeIntervalsArray(std::move(intervals));
+        auto intervalsSlot = env->registerSlot(makeIndexBoundsSlotName(ixn->nodeId(), kIntervals),
+                                               intervalsTag,
+                                               intervalsVal,
+                                               true,
+                                               slotIdGenerator);
         sbe::value::SlotId recordIdSlot;
         std::tie(recordIdSlot, stage) =
             generateOptimizedMultiIntervalIndexScan(collection,
                                                     ixn->index.identifier.catalogName,
                                                     ixn->direction == 1,
-                                                    std::move(intervals),
+                                                    sbe::makeE<sbe::EVariable>(intervalsSlot),
                                                     indexKeyBitset,
                                                     indexKeySlots,
                                                     slotIdGenerator,
@@ -833,4 +926,49 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
 
     return {std::move(stage), std::move(outputs)};
 }
+bool canBindIndexBounds(const IndexScanNode* ixn, const sbe::RuntimeEnvironment& env) {
+    return (env.getSlotIfExists(makeIndexBoundsSlotName(ixn->nodeId(), kLowKey)) &&
+            env.getSlotIfExists(makeIndexBoundsSlotName(ixn->nodeId(), kHighKey))) ||
+        env.getSlotIfExists(makeIndexBoundsSlotName(ixn->nodeId(), kIntervals));
+}
+
+bool bindIndexBounds(OperationContext* opCtx,
+                     const CollectionPtr& collection,
+                     const IndexScanNode* ixn,
+                     sbe::RuntimeEnvironment* env) {
+    auto intervals = makeIntervalsFromIndexScanNode(opCtx, collection, ixn);
+
+    if (intervals.size() == 1) {
+        auto lowKeySlot = env->getSlotIfExists(makeIndexBoundsSlotName(ixn->nodeId(), kLowKey));
+        auto highKeySlot = env->getSlotIfExists(makeIndexBoundsSlotName(ixn->nodeId(), kHighKey));
+        if (!lowKeySlot || !highKeySlot) {
+            return false;
+        }
+
+        auto&& [lowKey, highKey] = intervals[0];
+        env->resetSlot(*lowKeySlot,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()),
+                       true);
+        env->resetSlot(*highKeySlot,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()),
+                       true);
+        return true;
+    } else if (intervals.size() > 1) {
+        auto intervalsSlot =
+            env->getSlotIfExists(makeIndexBoundsSlotName(ixn->nodeId(), kIntervals));
+        if (!intervalsSlot) {
+            return false;
+        }
+
+        auto [intervalsTag, intervalsVal] = makeIntervalsArray(std::move(intervals));
+        env->resetSlot(*intervalsSlot, intervalsTag, intervalsVal, true);
+        return true;
+    }
+
+    // The bounds can only be scanned by a generic index scan, which has them built in.
+    return false;
+}
+
 }  // namespace mongo::stage_builder
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/lock_acquisition_callback.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/values/value.h"
@@ -56,6 +57,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     PlanStageReqs reqs,
     sbe::value::SlotIdGenerator* slotIdGenerator,
     sbe::value::SpoolIdGenerator* spoolIdGenerator,
+    sbe::RuntimeEnvironment* env,
     PlanYieldPolicy* yieldPolicy,
     sbe::LockAcquisitionCallback lockAcquisitionCallback);
 
@@ -91,4 +93,21 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
     PlanNodeId nodeId,
     sbe::LockAcquisitionCallback lockAcquisitionCallback);
 
+/**
+ * Returns true if the index bounds of the scan built by generateIndexScan() for 'ixn' are held in
+ * slots of 'env', which is the case unless the bounds could only be scanned by a generic index
+ * scan.
+ */
+bool canBindIndexBounds(const IndexScanNode* ixn, const sbe::RuntimeEnvironment& env);
+
+/**
+ * Recomputes the index bounds of 'ixn' and stores them into the slots of 'env' read by the scan
+ * built by generateIndexScan(). Returns false, leaving 'env' unchanged, if the bounds cannot be
+ * bound to the scan, e.g. if the scan has been built for a single interval but 'ixn' has several.
+ */
+bool bindIndexBounds(OperationContext* opCtx,
+                     const CollectionPtr& collection,
+                     const IndexScanNode* ixn,
+                     sbe::RuntimeEnvironment* env);
+
 }  // namespace mongo::stage_builder
@@ -0,0 +1,387 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/file.h"
+#include "mongo/util/periodic_runner.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/uuid.h"
+
+/**
+ * This file contains the commands through which a node started with 'fileCopyInitialSyncSource'
+ * copies the data files of this node. See file_copy_initial_syncer.h.
+ */
+namespace mongo {
+namespace repl {
+namespace {
+
+// The largest chunk of a file returned at once, which leaves room in the reply for the other
+// fields.
+const long long kMaxChunkSizeBytes = BSONObjMaxUserSize - 1024 * 1024;
+
+// The name of the file which holds the options of the storage engine. It is not a WiredTiger file
+// and is therefore not returned by the backup cursor.
+const auto kStorageMetadataFileName = "storage.bson"_sd;
+
+/**
+ * The backup cursor opened on behalf of a node which copies the data files of this node, along
+ * with the files it is allowed to read. At most one such backup cursor is open at a time.
+ */
+class ActiveBackupFiles {
+public:
+    static ActiveBackupFiles& get(ServiceContext* svcCtx);
+
+    /**
+     * Opens a backup cursor and appends its id and the paths, relative to the dbpath, and sizes of
+     * its files to 'result'.
+     */
+    void open(OperationContext* opCtx, BSONObjBuilder* result);
+
+    /**
+     * Returns the absolute path and the size of the file 'filename' of the backup 'backupId'.
+     */
+    std::pair<boost::filesystem::path, long long> getFile(const UUID& backupId,
+                                                          StringData filename);
+
+    void close(OperationContext* opCtx, const UUID& backupId);
+
+    /**
+     * Closes the backup cursor if it has not been used for
+     * 'fileCopyInitialSyncIdleBackupTimeoutSecs', so that the backup of a node which stopped
+     * copying without closing it does not pin the checkpoint and the oplog forever.
+     */
+    void closeIfIdle(OperationContext* opCtx);
+
+private:
+    bool _isIdle(WithLock) const;
+    void _close(WithLock, OperationContext* opCtx);
+
+    /**
+     * Starts the periodic job which closes the backup cursor once it is idle, unless it is running
+     * already.
+     */
+    void _startIdleBackupReaper(WithLock, ServiceContext* svcCtx);
+
+    Mutex _mutex = MONGO_MAKE_LATCH("ActiveBackupFiles::_mutex");
+
+    boost::optional<UUID> _backupId;
+    StringMap<long long> _fileSizes;
+    Date_t _lastUsed;
+
+    boost::optional<PeriodicJobAnchor> _idleBackupReaper;
+};
+
+const auto getActiveBackupFiles = ServiceContext::declareDecoration<ActiveBackupFiles>();
+
+ActiveBackupFiles& ActiveBackupFiles::get(ServiceContext* svcCtx) {
+    return getActiveBackupFiles(svcCtx);
+}
+
+void ActiveBackupFiles::open(OperationContext* opCtx, BSONObjBuilder* result) {
+    stdx::lock_guard<Latch> lk(_mutex);
+
+    if (_backupId) {
+        uassert(ErrorCodes::ObjectIsBusy,
+                str::stream() << "The backup cursor " << *_backupId
+                              << " is already open for copying the files of this node",
+                _isIdle(lk));
+        LOGV2(5190940,
+              "Closing the idle backup cursor opened for copying the files of this node",
+              "backupId"_attr = *_backupId,
+              "lastUsed"_attr = _lastUsed);
+        _close(lk, opCtx);
+    }
+
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    uassert(ErrorCodes::CommandNotSupported,
+            "The storage engine does not support copying its files",
+            storageEngine->supportsCheckpoints() && !storageEngine->isEphemeral());
+
+    auto cursor = uassertStatusOK(
+        storageEngine->beginNonBlockingBackup(opCtx, StorageEngine::BackupOptions()));
+    auto endBackupGuard = makeGuard([&] { storageEngine->endNonBlockingBackup(opCtx); });
+
+    const boost::filesystem::path dbpath(storageGlobalParams.dbpath);
+    StringMap<long long> fileSizes;
+    BSONArrayBuilder filesBuilder(result->subarrayStart("files"));
+    auto appendFile = [&](const boost::filesystem::path& path, long long fileSize) {
+        const auto filename = path.lexically_relative(dbpath).generic_string();
+        uassert(ErrorCodes::InvalidPath,
+                str::stream() << "The backup file " << path.string()
+                              << " is not in the dbpath " << dbpath.string(),
+                !filename.empty() && filename.find("..") != 0);
+        fileSizes[filename] = fileSize;
+        filesBuilder.append(BSON("filename" << filename << "fileSize" << fileSize));
+    };
+
+    const auto metadataPath = dbpath / kStorageMetadataFileName.toString();
+    if (boost::filesystem::exists(metadataPath)) {
+        appendFile(metadataPath, boost::filesystem::file_size(metadataPath));
+    }
+
+    while (true) {
+        auto blocks = uassertStatusOK(cursor->getNextBatch(1000));
+        if (blocks.empty()) {
+            break;
+        }
+        for (const auto& block : blocks) {
+            appendFile(block.filename, block.fileSize);
+        }
+    }
+    filesBuilder.doneFast();
+
+    endBackupGuard.dismiss();
+    _backupId = UUID::gen();
+    _fileSizes = std::move(fileSizes);
+    _lastUsed = Date_t::now();
+    _backupId->appendToBuilder(result, "backupId");
+    _startIdleBackupReaper(lk, opCtx->getServiceContext());
+
+    LOGV2(5190941,
+          "Opened a backup cursor for copying the files of this node",
+          "backupId"_attr = *_backupId,
+          "numFiles"_attr = _fileSizes.size());
+}
+
+std::pair<boost::filesystem::path, long long> ActiveBackupFiles::getFile(const UUID& backupId,
+                                                                         StringData filename) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    uassert(ErrorCodes::NoSuchSession,
+            str::stream() << "The backup cursor " << backupId << " is not open",
+            _backupId == backupId);
+
+    // Only the files of the backup can be read, whatever the path the request refers to.
+    auto it = _fileSizes.find(filename);
+    uassert(ErrorCodes::InvalidPath,
+            str::stream() << "The file " << filename << " is not part of the backup " << backupId,
+            it != _fileSizes.end());
+
+    _lastUsed = Date_t::now();
+    return {boost::filesystem::path(storageGlobalParams.dbpath) / it->first, it->second};
+}
+
+void ActiveBackupFiles::close(OperationContext* opCtx, const UUID& backupId) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_backupId != backupId) {
+        return;
+    }
+    LOGV2(5190942, "Closing the backup cursor", "backupId"_attr = backupId);
+    _close(lk, opCtx);
+}
+
+void ActiveBackupFiles::closeIfIdle(OperationContext* opCtx) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (!_backupId || !_isIdle(lk)) {
+        return;
+    }
+    LOGV2(5190959,
+          "Closing the idle backup cursor opened for copying the files of this node",
+          "backupId"_attr = *_backupId,
+          "lastUsed"_attr = _lastUsed);
+    _close(lk, opCtx);
+}
+
+bool ActiveBackupFiles::_isIdle(WithLock) const {
+    return Date_t::now() - _lastUsed > Seconds(fileCopyInitialSyncIdleBackupTimeoutSecs.load());
+}
+
+void ActiveBackupFiles::_startIdleBackupReaper(WithLock, ServiceContext* svcCtx) {
+    if (_idleBackupReaper) {
+        return;
+    }
+
+    auto periodicRunner = svcCtx->getPeriodicRunner();
+    invariant(periodicRunner);
+
+    PeriodicRunner::PeriodicJob job(
+        "closeIdleBackupFiles",
+        [](Client* client) {
+            auto opCtx = client->makeOperationContext();
+            try {
+                ActiveBackupFiles::get(client->getServiceContext()).closeIfIdle(opCtx.get());
+            } catch (ExceptionForCat<ErrorCategory::CancelationError>& ex) {
+                LOGV2_DEBUG(5190960, 2, "Periodic job canceled", "reason"_attr = ex.reason());
+            } catch (const DBException& ex) {
+                LOGV2_WARNING(5190961,
+                              "Failed to close the idle backup cursor",
+                              "error"_attr = redact(ex.toStatus()));
+            }
+        },
+        Seconds(1));
+
+    _idleBackupReaper.emplace(periodicRunner->makeJob(std::move(job)));
+    _idleBackupReaper->start();
+}
+
+void ActiveBackupFiles::_close(WithLock, OperationContext* opCtx) {
+    opCtx->getServiceContext()->getStorageEngine()->endNonBlockingBackup(opCtx);
+    _backupId = boost::none;
+    _fileSizes.clear();
+}
+
+/**
+ * Base class of the commands below, which are only run by other members of the replica set.
+ */
+class BackupFileCommandBase : public BasicCommand {
+public:
+    using BasicCommand::BasicCommand;
+
+    std::string help() const override {
+        return "internal";
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::internal);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+};
+
+/**
+ * {_replOpenBackupFiles: 1}
+ *
+ * Opens a backup cursor and returns its id along with the files to copy.
+ */
+class OpenBackupFilesCommand : public BackupFileCommandBase {
+public:
+    OpenBackupFilesCommand() : BackupFileCommandBase("_replOpenBackupFiles") {}
+
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        ActiveBackupFiles::get(opCtx->getServiceContext()).open(opCtx, &result);
+        return true;
+    }
+} openBackupFilesCommand;
+
+/**
+ * {_replReadBackupFile: 1, backupId: <UUID>, filename: <string>, offset: <long>, length: <long>}
+ *
+ * Returns at most 'length' bytes of a file of the backup starting at 'offset', and whether the
+ * end of the file has been reached.
+ */
+class ReadBackupFileCommand : public BackupFileCommandBase {
+public:
+    ReadBackupFileCommand() : BackupFileCommandBase("_replReadBackupFile") {}
+
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const auto backupId = uassertStatusOK(UUID::parse(cmdObj["backupId"]));
+        const auto filename = cmdObj["filename"].checkAndGetStringData();
+        const auto offset = cmdObj["offset"].safeNumberLong();
+        const auto length = cmdObj["length"].safeNumberLong();
+        uassert(ErrorCodes::BadValue,
+                str::stream() << "Invalid range of the file " << filename << ": " << offset << "+"
+                              << length,
+                offset >= 0 && length > 0);
+
+        auto [path, fileSize] =
+            ActiveBackupFiles::get(opCtx->getServiceContext()).getFile(backupId, filename);
+
+        // The file may have grown since the backup cursor was opened, but only the bytes up to
+        // its size at that time belong to the checkpoint of the backup.
+        const auto toRead =
+            std::max(0LL, std::min({length, kMaxChunkSizeBytes, fileSize - offset}));
+        auto buffer = std::make_unique<char[]>(toRead);
+        if (toRead > 0) {
+            File file;
+            file.open(path.string().c_str(), true /* readOnly */);
+            uassert(ErrorCodes::FileNotOpen,
+                    str::stream() << "Failed to open the backup file " << path.string(),
+                    file.is_open() && !file.bad());
+            file.read(offset, buffer.get(), toRead);
+            uassert(ErrorCodes::FileStreamFailed,
+                    str::stream() << "Failed to read the backup file " << path.string(),
+                    !file.bad());
+        }
+
+        result.appendBinData("data", toRead, BinDataGeneral, buffer.get());
+        result.append("eof", offset + toRead >= fileSize);
+        return true;
+    }
+} readBackupFileCommand;
+
+/**
+ * {_replCloseBackupFiles: 1, backupId: <UUID>}
+ *
+ * Closes the backup cursor, once all of its files have been copied.
+ */
+class CloseBackupFilesCommand : public BackupFileCommandBase {
+public:
+    CloseBackupFilesCommand() : BackupFileCommandBase("_replCloseBackupFiles") {}
+
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const auto backupId = uassertStatusOK(UUID::parse(cmdObj["backupId"]));
+        ActiveBackupFiles::get(opCtx->getServiceContext()).close(opCtx, backupId);
+        return true;
+    }
+} closeBackupFilesCommand;
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
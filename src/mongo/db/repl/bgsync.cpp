@@ -529,6 +529,12 @@ void BackgroundSync::_produce() {
         // replication coordinator.
         auto numRestarts =
             _replicationCoordinatorExternalState->getOplogFetcherSteadyStateMaxFetcherRestarts();
+        OplogFetcher::Config oplogFetcherConfig(lastOpTimeFetched,
+                                                source,
+                                                _replCoord->getConfig(),
+                                                syncSourceResp.rbid,
+                                                bgSyncOplogFetcherBatchSize);
+        oplogFetcherConfig.readAheadWhenLagging = true;
         auto oplogFetcherPtr = std::make_unique<OplogFetcher>(
             _replicationCoordinatorExternalState->getTaskExecutor(),
             std::make_unique<OplogFetcher::OplogFetcherRestartDecisionDefault>(numRestarts),
@@ -537,11 +543,7 @@ void BackgroundSync::_produce() {
                 return this->_enqueueDocuments(a1, a2, a3);
             },
             onOplogFetcherShutdownCallbackFn,
-            OplogFetcher::Config(lastOpTimeFetched,
-                                 source,
-                                 _replCoord->getConfig(),
-                                 syncSourceResp.rbid,
-                                 bgSyncOplogFetcherBatchSize));
+            std::move(oplogFetcherConfig));
         stdx::lock_guard<Latch> lock(_mutex);
         if (_state != ProducerState::Running) {
             return;
@@ -32,6 +32,9 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/list_collections_filter.h"
 #include "mongo/db/index_build_entry_helpers.h"
 #include "mongo/db/index_builds_coordinator.h"
@@ -39,11 +42,14 @@
 #include "mongo/db/repl/collection_cloner.h"
 #include "mongo/db/repl/database_cloner_gen.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/thread.h"
 
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 namespace repl {
@@ -56,6 +62,17 @@ MONGO_FAIL_POINT_DEFINE(initialSyncHangDuringCollectionClone);
 // DBClientConnection, optionally limited to a specific collection.
 MONGO_FAIL_POINT_DEFINE(initialSyncHangCollectionClonerAfterHandlingBatchResponse);
 
+namespace {
+
+// The number of ranges of the _id index per concurrent cursor, so that the cursors which are
+// done early take over the ranges left when the ranges are of uneven sizes.
+constexpr size_t kQueryRangesPerCursor = 4;
+
+// The number of _id values sampled per range, to even out the sizes of the ranges.
+constexpr size_t kSamplesPerQueryRange = 10;
+
+}  // namespace
+
 CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
                                    const CollectionOptions& collectionOptions,
                                    InitialSyncSharedData* sharedData,
@@ -96,6 +113,14 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
           _dbWorkTaskRunner.schedule(std::move(task));
           return executor::TaskExecutor::CallbackHandle();
       }),
+      _createClientFn([this] {
+          auto client = std::make_unique<DBClientConnection>(true /* autoReconnect */);
+          uassertStatusOK(client->connect(getSource(), "CollectionCloner"_sd, boost::none));
+          uassertStatusOK(replAuthenticate(client.get())
+                              .withContext(str::stream()
+                                           << "Failed to authenticate to " << getSource()));
+          return client;
+      }),
       _dbWorkTaskRunner(dbPool) {
     invariant(sourceNss.isValid());
     invariant(collectionOptions.uuid);
@@ -236,7 +261,18 @@ BaseCloner::AfterStageBehavior CollectionCloner::createCollectionStage() {
 }
 
 BaseCloner::AfterStageBehavior CollectionCloner::queryStage() {
-    runQuery();
+    if (!_queryPlanned) {
+        _queryPlanned = true;
+        if (shouldPartitionQuery()) {
+            splitQueryRanges();
+        }
+    }
+
+    if (_queryRanges.empty()) {
+        runQuery();
+    } else {
+        runPartitionedQueries();
+    }
     waitForDatabaseWorkToComplete();
     // We want to free the _collLoader regardless of whether the commit succeeds.
     std::unique_ptr<CollectionBulkLoader> loader = std::move(_collLoader);
@@ -371,41 +407,179 @@ void CollectionCloner::runQuery() {
     }
 }
 
-void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
-    {
-        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
-        if (!getSharedData()->getStatus(lk).isOK()) {
-            static constexpr char message[] =
-                "Collection cloning cancelled due to initial sync failure";
-            LOGV2(21136, message, "error"_attr = getSharedData()->getStatus(lk));
-            uasserted(ErrorCodes::CallbackCanceled,
-                      str::stream() << message << ": " << getSharedData()->getStatus(lk));
-        }
+bool CollectionCloner::shouldPartitionQuery() const {
+    if (collectionClonerParallelism.load() <= 1 || _idIndexSpec.isEmpty() ||
+        _collectionOptions.capped || !_collectionOptions.collation.isEmpty()) {
+        return false;
     }
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _stats.bytesToCopy >= collectionClonerMinBytesToPartition.load();
+}
 
-    // If this is 'true', it means that something happened to our remote cursor for a reason other
-    // than the collection being dropped, all while we were running a non-resumable (4.2) clone.
-    // We must abort initial sync in that case.
-    if (_lostNonResumableCursor) {
-        // This will be caught in runQuery().
-        uasserted(ErrorCodes::InitialSyncFailure, "Lost remote cursor");
+std::vector<CollectionCloner::QueryRange> CollectionCloner::makeQueryRanges(
+    std::vector<BSONObj> sampledIds, size_t numRanges) {
+    invariant(numRanges > 0);
+    std::sort(sampledIds.begin(),
+              sampledIds.end(),
+              SimpleBSONObjComparator::kInstance.makeLessThan());
+    sampledIds.erase(std::unique(sampledIds.begin(),
+                                 sampledIds.end(),
+                                 SimpleBSONObjComparator::kInstance.makeEqualTo()),
+                     sampledIds.end());
+
+    std::vector<QueryRange> ranges(1);
+    for (size_t i = 1; i < numRanges && !sampledIds.empty(); ++i) {
+        const auto& bound = sampledIds[i * sampledIds.size() / numRanges];
+        // With fewer samples than ranges, the same sample can be picked several times.
+        if (!ranges.back().min.isEmpty() &&
+            SimpleBSONObjComparator::kInstance.evaluate(ranges.back().min == bound)) {
+            continue;
+        }
+        ranges.back().max = bound;
+        ranges.emplace_back();
+        ranges.back().min = bound;
     }
+    return ranges;
+}
 
-    if (_firstBatchOfQueryRound && _resumeSupported) {
-        // Store the cursorId of the remote cursor.
-        _remoteCursorId = iter.getCursorId();
+void CollectionCloner::splitQueryRanges() {
+    const size_t numRanges = collectionClonerParallelism.load() * kQueryRangesPerCursor;
+    const int numSamples = numRanges * kSamplesPerQueryRange;
+
+    // The batch is larger than the sample, so that the cursor is exhausted by the first batch.
+    BSONObj res;
+    getClient()->runCommand(
+        _sourceNss.db().toString(),
+        BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                         << BSON_ARRAY(BSON("$sample" << BSON("size" << numSamples))
+                                       << BSON("$project" << BSON("_id" << 1)))
+                         << "cursor" << BSON("batchSize" << numSamples + 1)),
+        res,
+        QueryOption_SecondaryOk);
+    if (auto status = getStatusFromCommandResult(res); !status.isOK()) {
+        LOGV2_DEBUG(5190938,
+                    1,
+                    "Cloning collection with a single cursor due to failure in sampling its _id "
+                    "values",
+                    "namespace"_attr = _sourceNss,
+                    "error"_attr = status);
+        return;
     }
-    _firstBatchOfQueryRound = false;
 
-    {
-        stdx::lock_guard<Latch> lk(_mutex);
-        _stats.receivedBatches++;
-        while (iter.moreInCurrentBatch()) {
-            _documentsToInsert.emplace_back(iter.nextSafe());
+    std::vector<BSONObj> sampledIds;
+    for (auto&& elem : res["cursor"]["firstBatch"].Obj()) {
+        auto sampledId = elem.Obj()["_id"];
+        if (!sampledId.eoo()) {
+            sampledIds.push_back(sampledId.wrap());
         }
     }
 
-    // Schedule the next document batch insertion.
+    auto ranges = makeQueryRanges(std::move(sampledIds), numRanges);
+    if (ranges.size() < 2) {
+        return;
+    }
+    _queryRanges = std::move(ranges);
+
+    LOGV2(5190939,
+          "Cloning collection with concurrent cursors over ranges of its _id index",
+          "namespace"_attr = _sourceNss,
+          "numRanges"_attr = _queryRanges.size(),
+          "numCursors"_attr = collectionClonerParallelism.load());
+    stdx::lock_guard<Latch> lk(_mutex);
+    _stats.partitions = _queryRanges.size();
+}
+
+void CollectionCloner::runPartitionedQueries() {
+    const size_t numRangesLeft = std::count_if(
+        _queryRanges.begin(), _queryRanges.end(), [](const auto& range) { return !range.done; });
+    const size_t numCursors =
+        std::min<size_t>(collectionClonerParallelism.load(), numRangesLeft);
+
+    // The cursors block on the network, so they get threads of their own rather than those of the
+    // database work pool, which inserts the documents they receive.
+    ThreadPool::Options options;
+    options.poolName = "CollectionClonerCursors";
+    options.threadNamePrefix = "CollectionClonerCursor-";
+    options.minThreads = 0;
+    options.maxThreads = numCursors;
+    options.onCreateThread = [](const std::string& threadName) {
+        Client::initThread(threadName);
+    };
+    ThreadPool cursorPool(options);
+    cursorPool.startup();
+
+    // Each cursor takes the next range which is not done, until there are none left.
+    AtomicWord<size_t> nextRange{0};
+    std::vector<Status> cursorStatuses(numCursors, Status::OK());
+    for (size_t i = 0; i < numCursors; ++i) {
+        cursorPool.schedule([this, &nextRange, &cursorStatus = cursorStatuses[i]](auto status) {
+            if (!status.isOK()) {
+                cursorStatus = status;
+                return;
+            }
+            try {
+                auto client = _createClientFn();
+                for (auto idx = nextRange.fetchAndAdd(1); idx < _queryRanges.size();
+                     idx = nextRange.fetchAndAdd(1)) {
+                    auto& range = _queryRanges[idx];
+                    if (range.done) {
+                        continue;
+                    }
+                    runRangeQuery(client.get(), &range);
+                }
+            } catch (const DBException& ex) {
+                cursorStatus = ex.toStatus();
+            }
+        });
+    }
+    cursorPool.shutdown();
+    cursorPool.join();
+
+    for (const auto& status : cursorStatuses) {
+        uassertStatusOK(status);
+    }
+}
+
+void CollectionCloner::runRangeQuery(DBClientConnection* client, QueryRange* range) {
+    Query query;
+    query.hint(BSON("_id" << 1));
+    // A resumed query starts over at the last document received, which handleNextRangeBatch()
+    // skips, rather than after it, as the bounds of an index scan are inclusive.
+    const auto& min = range->lastId.isEmpty() ? range->min : range->lastId;
+    if (!min.isEmpty()) {
+        query.minKey(min);
+    }
+    if (!range->max.isEmpty()) {
+        query.maxKey(range->max);
+    }
+
+    client->query(
+        [this, range](DBClientCursorBatchIterator& iter) { handleNextRangeBatch(range, iter); },
+        _sourceDbAndUuid,
+        query,
+        nullptr /* fieldsToReturn */,
+        QueryOption_NoCursorTimeout | QueryOption_SecondaryOk |
+            (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
+        _collectionClonerBatchSize,
+        ReadConcernArgs::kImplicitDefault);
+
+    range->done = true;
+    stdx::lock_guard<Latch> lk(_mutex);
+    _stats.partitionsCopied++;
+}
+
+void CollectionCloner::checkInitialSyncStatus() {
+    stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+    if (!getSharedData()->getStatus(lk).isOK()) {
+        static constexpr char message[] =
+            "Collection cloning cancelled due to initial sync failure";
+        LOGV2(21136, message, "error"_attr = getSharedData()->getStatus(lk));
+        uasserted(ErrorCodes::CallbackCanceled,
+                  str::stream() << message << ": " << getSharedData()->getStatus(lk));
+    }
+}
+
+void CollectionCloner::scheduleInsertDocuments() {
     auto&& scheduleResult = _scheduleDbWorkFn(
         [=](const executor::TaskExecutor::CallbackArgs& cbd) { insertDocumentsCallback(cbd); });
 
@@ -415,12 +589,9 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         // We must throw an exception to terminate query.
         uassertStatusOK(newStatus);
     }
+}
 
-    if (_resumeSupported) {
-        // Store the resume token for this batch.
-        _resumeToken = iter.getPostBatchResumeToken();
-    }
-
+void CollectionCloner::hangAfterHandlingBatchResponse() {
     initialSyncHangCollectionClonerAfterHandlingBatchResponse.executeIf(
         [&](const BSONObj&) {
             while (MONGO_unlikely(
@@ -442,6 +613,68 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         });
 }
 
+void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
+    checkInitialSyncStatus();
+
+    // If this is 'true', it means that something happened to our remote cursor for a reason other
+    // than the collection being dropped, all while we were running a non-resumable (4.2) clone.
+    // We must abort initial sync in that case.
+    if (_lostNonResumableCursor) {
+        // This will be caught in runQuery().
+        uasserted(ErrorCodes::InitialSyncFailure, "Lost remote cursor");
+    }
+
+    if (_firstBatchOfQueryRound && _resumeSupported) {
+        // Store the cursorId of the remote cursor.
+        _remoteCursorId = iter.getCursorId();
+    }
+    _firstBatchOfQueryRound = false;
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _stats.receivedBatches++;
+        while (iter.moreInCurrentBatch()) {
+            _documentsToInsert.emplace_back(iter.nextSafe());
+        }
+    }
+
+    // Schedule the next document batch insertion.
+    scheduleInsertDocuments();
+
+    if (_resumeSupported) {
+        // Store the resume token for this batch.
+        _resumeToken = iter.getPostBatchResumeToken();
+    }
+
+    hangAfterHandlingBatchResponse();
+}
+
+void CollectionCloner::handleNextRangeBatch(QueryRange* range, DBClientCursorBatchIterator& iter) {
+    checkInitialSyncStatus();
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _stats.receivedBatches++;
+        while (iter.moreInCurrentBatch()) {
+            auto doc = iter.nextSafe();
+            auto id = doc["_id"];
+            if (!range->lastId.isEmpty() &&
+                SimpleBSONElementComparator::kInstance.evaluate(id ==
+                                                                range->lastId.firstElement())) {
+                // This document was already received before the query was resumed.
+                continue;
+            }
+            range->lastId = id.wrap();
+            _documentsToInsert.emplace_back(std::move(doc));
+        }
+    }
+
+    // Schedule the next document batch insertion.
+    scheduleInsertDocuments();
+
+    hangAfterHandlingBatchResponse();
+}
+
 void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::CallbackArgs& cbd) {
     uassertStatusOK(cbd.status);
 
@@ -452,10 +685,15 @@ void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::Cal
         // 'receivedBatches'.
         ++_stats.fetchedBatches;
         if (_documentsToInsert.size() == 0) {
-            LOGV2_WARNING(21145,
-                          "insertDocumentsCallback, but no documents to insert for ns:{namespace}",
-                          "insertDocumentsCallback, but no documents to insert",
-                          "namespace"_attr = _sourceNss);
+            // With concurrent cursors, the insertion scheduled for the batch of another cursor may
+            // have taken the documents of this batch.
+            if (!_stats.partitions) {
+                LOGV2_WARNING(
+                    21145,
+                    "insertDocumentsCallback, but no documents to insert for ns:{namespace}",
+                    "insertDocumentsCallback, but no documents to insert",
+                    "namespace"_attr = _sourceNss);
+            }
             return;
         }
         _documentsToInsert.swap(docs);
@@ -542,6 +780,10 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
         }
     }
     builder->appendNumber("receivedBatches", receivedBatches);
+    if (partitions) {
+        builder->appendNumber("partitions", partitions);
+        builder->appendNumber("partitionsCopied", partitionsCopied);
+    }
 }
 
 }  // namespace repl
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -63,6 +64,8 @@ public:
         long long bytesToCopy{0};
         long long avgObjSize{0};
         long long approxBytesCopied{0};
+        size_t partitions{0};  // Ranges of the _id index queried by concurrent cursors.
+        size_t partitionsCopied{0};
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -77,6 +80,37 @@ public:
     using ScheduleDbWorkFn = unique_function<StatusWith<executor::TaskExecutor::CallbackHandle>(
         executor::TaskExecutor::CallbackFn)>;
 
+    /**
+     * Type of function to create the connections to the sync source used by the concurrent
+     * cursors of a partitioned query.
+     */
+    using CreateClientFn = std::function<std::unique_ptr<DBClientConnection>()>;
+
+    /**
+     * A range of the _id index of the collection, the documents of which are retrieved by a single
+     * cursor when the collection is cloned by concurrent cursors.
+     */
+    struct QueryRange {
+        // The bounds of the range, as {_id: <value>}. 'min' is inclusive and 'max' is exclusive.
+        // An empty bound leaves the range open on that side.
+        BSONObj min;
+        BSONObj max;
+
+        // The _id of the last document received, as {_id: <value>}, after which the query of the
+        // range resumes if it is interrupted.
+        BSONObj lastId;
+
+        bool done = false;
+    };
+
+    /**
+     * Splits the _id index into at most 'numRanges' ranges, using values from 'sampledIds', which
+     * are of the form {_id: <value>}, as bounds. Returns a single unbounded range if there are no
+     * samples.
+     */
+    static std::vector<QueryRange> makeQueryRanges(std::vector<BSONObj> sampledIds,
+                                                   size_t numRanges);
+
     CollectionCloner(const NamespaceString& ns,
                      const CollectionOptions& collectionOptions,
                      InitialSyncSharedData* sharedData,
@@ -122,6 +156,15 @@ public:
         _scheduleDbWorkFn = std::move(scheduleDbWorkFn);
     }
 
+    /**
+     * Overrides how the connections of the concurrent cursors are created.
+     *
+     * For testing only.
+     */
+    void setCreateClientFn_forTest(CreateClientFn createClientFn) {
+        _createClientFn = std::move(createClientFn);
+    }
+
 protected:
     ClonerStages getStages() final;
 
@@ -206,12 +249,61 @@ private:
      */
     AfterStageBehavior setupIndexBuildersForUnfinishedIndexesStage();
 
+    /**
+     * Returns whether the documents of the collection should be retrieved by concurrent cursors
+     * over ranges of its _id index. This requires the collection to be large enough, to have an
+     * _id index which compares values without a collation, and not to depend on the order in
+     * which its documents are inserted, as capped collections do.
+     */
+    bool shouldPartitionQuery() const;
+
+    /**
+     * Samples the _id values of the collection on the source to split its _id index into
+     * _queryRanges. Leaves _queryRanges empty if the collection cannot be split.
+     */
+    void splitQueryRanges();
+
+    /**
+     * Retrieves the documents of the ranges of _queryRanges which are not done with concurrent
+     * cursors, each on its own connection to the source. Once all the cursors have stopped,
+     * throws the first error that any of them ran into. When the query stage is retried, the
+     * queries of the interrupted ranges resume after the last document they received.
+     */
+    void runPartitionedQueries();
+
+    /**
+     * Retrieves the documents of 'range' from 'client', starting after its 'lastId' if it is set.
+     */
+    void runRangeQuery(DBClientConnection* client, QueryRange* range);
+
     /**
      * Put all results from a query batch into a buffer to be inserted, and schedule
      * it to be inserted.
      */
     void handleNextBatch(DBClientCursorBatchIterator& iter);
 
+    /**
+     * Like handleNextBatch() for a batch of the query of 'range', which also tracks the last
+     * document received for the range.
+     */
+    void handleNextRangeBatch(QueryRange* range, DBClientCursorBatchIterator& iter);
+
+    /**
+     * Throws if the initial sync has failed, to terminate the query.
+     */
+    void checkInitialSyncStatus();
+
+    /**
+     * Schedules the insertion of the documents buffered in _documentsToInsert.
+     */
+    void scheduleInsertDocuments();
+
+    /**
+     * Hangs while the 'initialSyncHangCollectionClonerAfterHandlingBatchResponse' fail point is
+     * enabled for this collection.
+     */
+    void hangAfterHandlingBatchResponse();
+
     /**
      * Called whenever there is a new batch of documents ready from the DBClientConnection.
      *
@@ -259,6 +351,8 @@ private:
     std::unique_ptr<CollectionBulkLoader> _collLoader;  // (X)
     //  Function for scheduling database work using the executor.
     ScheduleDbWorkFn _scheduleDbWorkFn;  // (R)
+    // Function for creating the connections of the concurrent cursors.
+    CreateClientFn _createClientFn;  // (R)
     // Documents read from source to insert.
     std::vector<BSONObj> _documentsToInsert;  // (M)
     Stats _stats;                             // (M)
@@ -278,6 +372,14 @@ private:
     // If true, it means we are starting a new query or resuming an interrupted one.
     bool _firstBatchOfQueryRound = true;  // (X)
 
+    // Whether the query stage has decided how to retrieve the documents of the collection.
+    bool _queryPlanned = false;  // (X)
+
+    // The ranges of the _id index retrieved by concurrent cursors, or empty if the documents are
+    // retrieved by a single cursor. While the query stage runs, each range is only accessed by the
+    // thread running its query.
+    std::vector<QueryRange> _queryRanges;  // (X)
+
     // Only set during non-resumable (4.2) queries.
     // Signifies that there were changes to the collection on the sync source that resulted in
     // our remote cursor getting killed.
@@ -41,6 +41,7 @@
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace repl {
@@ -1229,5 +1230,165 @@ TEST_F(CollectionClonerTestNonResumable, NonResumableCursorErrorThenSuccessEqual
     clonerThread.join();
 }
 
+TEST_F(CollectionClonerTestResumable, MakeQueryRangesUsesSortedDistinctSamplesAsBounds) {
+    std::vector<BSONObj> sampledIds;
+    for (int i : {7, 3, 9, 1, 3, 5, 11, 13, 15, 17}) {
+        sampledIds.push_back(BSON("_id" << i));
+    }
+    // The samples with string values sort after the numbers.
+    sampledIds.push_back(BSON("_id"
+                              << "a"));
+
+    auto ranges = CollectionCloner::makeQueryRanges(std::move(sampledIds), 4);
+    ASSERT_EQ(4u, ranges.size());
+    ASSERT_BSONOBJ_EQ(BSONObj(), ranges[0].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 5), ranges[0].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 5), ranges[1].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 11), ranges[1].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 11), ranges[2].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 15), ranges[2].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 15), ranges[3].min);
+    ASSERT_BSONOBJ_EQ(BSONObj(), ranges[3].max);
+    for (const auto& range : ranges) {
+        ASSERT_FALSE(range.done);
+        ASSERT_BSONOBJ_EQ(BSONObj(), range.lastId);
+    }
+}
+
+TEST_F(CollectionClonerTestResumable, MakeQueryRangesWithFewSamples) {
+    auto ranges = CollectionCloner::makeQueryRanges({}, 4);
+    ASSERT_EQ(1u, ranges.size());
+    ASSERT_BSONOBJ_EQ(BSONObj(), ranges[0].min);
+    ASSERT_BSONOBJ_EQ(BSONObj(), ranges[0].max);
+
+    // A sample picked for several bounds only bounds one range.
+    ranges = CollectionCloner::makeQueryRanges({BSON("_id" << 1), BSON("_id" << 2)}, 8);
+    ASSERT_EQ(3u, ranges.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), ranges[0].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), ranges[1].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), ranges[1].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), ranges[2].min);
+}
+
+TEST_F(CollectionClonerTestResumable, LargeCollectionUsesSingleCursorIfSamplingFails) {
+    const auto minBytesToPartition = collectionClonerMinBytesToPartition.load();
+    collectionClonerMinBytesToPartition.store(0);
+    ON_BLOCK_EXIT([&] { collectionClonerMinBytesToPartition.store(minBytesToPartition); });
+
+    setMockServerReplies(BSON("size" << 10),
+                         createCountResponse(2),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    _mockServer->setCommandReply("aggregate", Status(ErrorCodes::OperationFailed, ""));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 1));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 2));
+
+    auto cloner = makeCollectionCloner();
+    cloner->setCreateClientFn_forTest([]() -> std::unique_ptr<DBClientConnection> {
+        FAIL("The collection should be cloned with the connection of the cloner");
+        return nullptr;
+    });
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQUALS(2, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(0u, cloner->getStats().partitions);
+}
+
+class CollectionClonerTestPartitioned : public CollectionClonerTest {
+protected:
+    void setUp() final {
+        CollectionClonerTest::setUp();
+        setInitialSyncId();
+
+        _minBytesToPartition = collectionClonerMinBytesToPartition.load();
+        _parallelism = collectionClonerParallelism.load();
+        collectionClonerMinBytesToPartition.store(0);
+        collectionClonerParallelism.store(2);
+
+        _mockServer->setCommandReply("replSetGetRBID", fromjson("{ok:1, rbid:1}"));
+        setMockServerReplies(BSON("size" << 60),
+                             createCountResponse(6),
+                             createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+        // The sample splits the _id index into the ranges [MinKey, 3) and [3, MaxKey).
+        _mockServer->setCommandReply(
+            "aggregate", createCursorResponse(_nss.ns(), BSON_ARRAY(BSON("_id" << 3))));
+        for (int i = 1; i <= 6; ++i) {
+            _mockServer->insert(_nss.ns(), BSON("_id" << i));
+        }
+    }
+
+    void tearDown() final {
+        collectionClonerMinBytesToPartition.store(_minBytesToPartition);
+        collectionClonerParallelism.store(_parallelism);
+        CollectionClonerTest::tearDown();
+    }
+
+    std::unique_ptr<CollectionCloner> makePartitionedCollectionCloner() {
+        auto cloner = makeCollectionCloner();
+        cloner->setBatchSize_forTest(2);
+        cloner->setCreateClientFn_forTest([this]() -> std::unique_ptr<DBClientConnection> {
+            _numCursorClients.fetchAndAdd(1);
+            return std::make_unique<MockDBClientConnection>(_mockServer.get());
+        });
+        return cloner;
+    }
+
+    AtomicWord<int> _numCursorClients{0};
+
+private:
+    long long _minBytesToPartition;
+    int _parallelism;
+};
+
+TEST_F(CollectionClonerTestPartitioned, LargeCollectionUsesOneCursorPerRange) {
+    auto cloner = makePartitionedCollectionCloner();
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQUALS(6, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(2, _numCursorClients.load());
+    auto stats = cloner->getStats();
+    ASSERT_EQUALS(6u, stats.documentsCopied);
+    ASSERT_EQUALS(2u, stats.partitions);
+    ASSERT_EQUALS(2u, stats.partitionsCopied);
+}
+
+TEST_F(CollectionClonerTestPartitioned, InterruptedRangeResumesAfterLastIdReceived) {
+    auto afterBatchFailpoint =
+        globalFailPointRegistry().find("initialSyncHangCollectionClonerAfterHandlingBatchResponse");
+    auto timesEnteredAfterBatch = afterBatchFailpoint->setMode(FailPoint::alwaysOn, 0);
+
+    auto cloner = makePartitionedCollectionCloner();
+
+    // Run the cloner in a separate thread.
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_OK(cloner->run());
+    });
+
+    // Wait for both cursors to process their first batch.
+    afterBatchFailpoint->waitForTimesEntered(timesEnteredAfterBatch + 2);
+    ASSERT_EQUALS(2u, cloner->getStats().receivedBatches);
+
+    // This will cause the next batch of one of the cursors to fail once (transiently).
+    auto failNextBatch = globalFailPointRegistry().find("mockCursorThrowErrorOnGetMore");
+    failNextBatch->setMode(FailPoint::nTimes, 1, fromjson("{errorType: 'HostUnreachable'}"));
+
+    // Let the query stage finish.
+    afterBatchFailpoint->setMode(FailPoint::off, 0);
+    clonerThread.join();
+
+    // Since the CollectionMockStats class does not de-duplicate inserts, insertCount=6 is evidence
+    // that the interrupted range resumed after the last _id it received rather than from its
+    // beginning, which would have inserted its first batch twice.
+    ASSERT_EQUALS(6, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    // The query of the interrupted range ran on a new connection.
+    ASSERT_EQUALS(3, _numCursorClients.load());
+    auto stats = cloner->getStats();
+    ASSERT_EQUALS(6u, stats.documentsCopied);
+    ASSERT_EQUALS(2u, stats.partitionsCopied);
+}
+
 }  // namespace repl
 }  // namespace mongo
@@ -0,0 +1,313 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_initial_syncer.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <set>
+
+#include "mongo/db/client.h"
+#include "mongo/db/global_settings.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/repl/replication_auth.h"
+#include "mongo/db/storage/storage_engine_metadata.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/file.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+// The files whose presence tells that the dbpath holds the data of a storage engine. They are moved
+// in place after all the other files, so that a copy interrupted while the files are moved is
+// started over on the next startup.
+const std::vector<std::string> kDataFileMarkers{"WiredTiger", "storage.bson"};
+
+/**
+ * Returns true if 'filename' is a relative path which does not point outside of the directory it
+ * is relative to.
+ */
+bool isRelativePathInside(const std::string& filename) {
+    const boost::filesystem::path path(filename);
+    if (path.empty() || path.has_root_path()) {
+        return false;
+    }
+    return std::none_of(
+        path.begin(), path.end(), [](const auto& component) { return component == ".."; });
+}
+
+}  // namespace
+
+BSONObj FileCopyInitialSyncer::Stats::toBSON() const {
+    return BSON("files" << static_cast<long long>(files) << "bytesCopied" << bytesCopied
+                        << "durationMillis" << durationCount<Milliseconds>(duration));
+}
+
+FileCopyInitialSyncer::FileCopyInitialSyncer(std::string dbpath,
+                                             CreateClientFn createClientFn,
+                                             int parallelism,
+                                             int chunkSizeBytes)
+    : _dbpath(std::move(dbpath)),
+      _createClientFn(std::move(createClientFn)),
+      _parallelism(parallelism),
+      _chunkSizeBytes(chunkSizeBytes) {
+    invariant(_parallelism > 0);
+    invariant(_chunkSizeBytes > 0);
+}
+
+bool FileCopyInitialSyncer::isDbPathEmpty(const std::string& dbpath) {
+    return std::none_of(kDataFileMarkers.begin(), kDataFileMarkers.end(), [&](const auto& name) {
+        return boost::filesystem::exists(boost::filesystem::path(dbpath) / name);
+    });
+}
+
+FileCopyInitialSyncer::Stats FileCopyInitialSyncer::run() {
+    Timer timer;
+
+    // The files left by an attempt which failed before moving them in place are copied again.
+    const auto tempDir = boost::filesystem::path(_dbpath) / kTempDirName.toString();
+    boost::filesystem::remove_all(tempDir);
+    boost::filesystem::create_directories(tempDir);
+
+    auto client = _createClientFn();
+    BSONObj openReply;
+    client->runCommand("admin", BSON("_replOpenBackupFiles" << 1), openReply);
+    uassertStatusOK(getStatusFromCommandResult(openReply));
+    const auto backupId = uassertStatusOK(UUID::parse(openReply["backupId"]));
+
+    ON_BLOCK_EXIT([&] {
+        try {
+            BSONObj closeReply;
+            client->runCommand(
+                "admin", BSON("_replCloseBackupFiles" << 1 << "backupId" << backupId), closeReply);
+            uassertStatusOK(getStatusFromCommandResult(closeReply));
+        } catch (const DBException& ex) {
+            // The sync source closes the backup cursor on its own once it has been idle.
+            LOGV2_WARNING(5190943,
+                          "Failed to close the backup cursor of the sync source",
+                          "backupId"_attr = backupId,
+                          "error"_attr = ex.toStatus());
+        }
+    });
+
+    std::vector<BackupFile> files;
+    long long totalBytes = 0;
+    for (auto&& elem : openReply["files"].Obj()) {
+        BackupFile file{elem["filename"].str(), elem["fileSize"].safeNumberLong()};
+        uassert(ErrorCodes::InvalidPath,
+                str::stream() << "Invalid path of a file of the sync source: " << file.filename,
+                isRelativePathInside(file.filename));
+        totalBytes += file.fileSize;
+        files.push_back(std::move(file));
+    }
+
+    LOGV2(5190944,
+          "Copying the files of a backup cursor of the sync source",
+          "backupId"_attr = backupId,
+          "numFiles"_attr = files.size(),
+          "totalBytes"_attr = totalBytes);
+
+    // The largest files are copied first, so that the connections finish at about the same time.
+    std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.fileSize > rhs.fileSize;
+    });
+
+    // Each connection copies the next file which has not been taken, until there are none left or
+    // one of them fails.
+    const size_t numConnections = std::min<size_t>(_parallelism, std::max<size_t>(files.size(), 1));
+    AtomicWord<size_t> nextFile{0};
+    AtomicWord<bool> failed{false};
+    AtomicWord<long long> bytesCopied{0};
+    std::vector<Status> copyStatuses(numConnections, Status::OK());
+    std::vector<stdx::thread> copyThreads;
+    copyThreads.reserve(numConnections);
+    for (size_t i = 0; i < numConnections; ++i) {
+        copyThreads.emplace_back([&, i, &status = copyStatuses[i]] {
+            Client::initThread(str::stream() << "FileCopyInitialSyncer-" << i);
+            try {
+                auto copyClient = _createClientFn();
+                for (auto idx = nextFile.fetchAndAdd(1); idx < files.size() && !failed.load();
+                     idx = nextFile.fetchAndAdd(1)) {
+                    bytesCopied.fetchAndAdd(_copyFile(copyClient.get(), backupId, files[idx]));
+                }
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+                failed.store(true);
+            }
+        });
+    }
+    for (auto& thread : copyThreads) {
+        thread.join();
+    }
+    for (const auto& status : copyStatuses) {
+        uassertStatusOK(status);
+    }
+
+    _moveFilesInPlace(files);
+    boost::filesystem::remove_all(tempDir);
+
+    Stats stats;
+    stats.files = files.size();
+    stats.bytesCopied = bytesCopied.load();
+    stats.duration = Milliseconds(timer.millis());
+    return stats;
+}
+
+long long FileCopyInitialSyncer::_copyFile(DBClientBase* client,
+                                           const UUID& backupId,
+                                           const BackupFile& file) {
+    const auto path = boost::filesystem::path(_dbpath) / kTempDirName.toString() / file.filename;
+    boost::filesystem::create_directories(path.parent_path());
+
+    File out;
+    out.open(path.string().c_str());
+    uassert(ErrorCodes::FileNotOpen,
+            str::stream() << "Failed to open " << path.string(),
+            out.is_open() && !out.bad());
+
+    long long offset = 0;
+    bool eof = file.fileSize == 0;
+    while (!eof) {
+        BSONObj reply;
+        client->runCommand("admin",
+                           BSON("_replReadBackupFile" << 1 << "backupId" << backupId << "filename"
+                                                      << file.filename << "offset" << offset
+                                                      << "length" << _chunkSizeBytes),
+                           reply);
+        uassertStatusOK(getStatusFromCommandResult(reply));
+
+        int length = 0;
+        const char* data = reply["data"].binData(length);
+        eof = reply["eof"].trueValue();
+        uassert(5190945,
+                str::stream() << "The sync source returned no data for " << file.filename
+                              << " at offset " << offset << " of " << file.fileSize,
+                length > 0 || eof);
+
+        out.write(offset, data, length);
+        uassert(ErrorCodes::FileStreamFailed,
+                str::stream() << "Failed to write to " << path.string(),
+                !out.bad());
+        offset += length;
+    }
+    out.fsync();
+
+    LOGV2_DEBUG(5190946, 1, "Copied a file of the sync source", "filename"_attr = file.filename);
+    return offset;
+}
+
+void FileCopyInitialSyncer::_moveFilesInPlace(const std::vector<BackupFile>& files) {
+    const boost::filesystem::path dbpath(_dbpath);
+    const auto tempDir = dbpath / kTempDirName.toString();
+
+    auto isDataFileMarker = [](const BackupFile& file) {
+        return std::find(kDataFileMarkers.begin(), kDataFileMarkers.end(), file.filename) !=
+            kDataFileMarkers.end();
+    };
+
+    // The renames of each pass are made durable by flushing the directories they went to.
+    for (bool markers : {false, true}) {
+        std::set<boost::filesystem::path> directories;
+        for (const auto& file : files) {
+            if (isDataFileMarker(file) != markers) {
+                continue;
+            }
+            const auto target = dbpath / file.filename;
+            for (auto dir = target.parent_path(); dir != dbpath && !boost::filesystem::exists(dir);
+                 dir = dir.parent_path()) {
+                directories.insert(dir.parent_path());
+            }
+            boost::filesystem::create_directories(target.parent_path());
+            boost::filesystem::rename(tempDir / file.filename, target);
+            directories.insert(target.parent_path());
+        }
+        // flushMyDirectory() flushes the parent directory of the path it is given.
+        for (const auto& dir : directories) {
+            flushMyDirectory(dir / ".");
+        }
+    }
+}
+
+void runFileCopyInitialSyncIfNeeded() {
+    if (fileCopyInitialSyncSource.empty()) {
+        return;
+    }
+    uassert(5190947,
+            "'fileCopyInitialSyncSource' requires the node to be started with --replSet",
+            getGlobalReplSettings().usingReplSets());
+    uassert(5190948,
+            "'fileCopyInitialSyncSource' requires the wiredTiger storage engine",
+            storageGlobalParams.engine == "wiredTiger");
+
+    if (storageGlobalParams.repair || storageGlobalParams.readOnly ||
+        !FileCopyInitialSyncer::isDbPathEmpty(storageGlobalParams.dbpath)) {
+        LOGV2(5190949,
+              "Not copying the files of the sync source, as the dbpath already holds data files",
+              "dbpath"_attr = storageGlobalParams.dbpath);
+        return;
+    }
+
+    const auto source = uassertStatusOK(HostAndPort::parse(fileCopyInitialSyncSource));
+    FileCopyInitialSyncer syncer(
+        storageGlobalParams.dbpath,
+        [source]() -> std::unique_ptr<DBClientBase> {
+            auto client = std::make_unique<DBClientConnection>(true /* autoReconnect */);
+            uassertStatusOK(client->connect(source, "FileCopyInitialSyncer"_sd, boost::none));
+            uassertStatusOK(replAuthenticate(client.get())
+                                .withContext(str::stream()
+                                             << "Failed to authenticate to " << source));
+            return client;
+        },
+        fileCopyInitialSyncParallelism,
+        fileCopyInitialSyncChunkSizeBytes);
+
+    LOGV2(5190950, "Starting a file copy initial sync", "syncSource"_attr = source);
+    const auto stats = syncer.run();
+    LOGV2(5190951,
+          "File copy initial sync done",
+          "syncSource"_attr = source,
+          "stats"_attr = stats.toBSON());
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/client/dbclient_connection.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Copies the data files of a member of the replica set into an empty dbpath, before the storage
+ * engine is started on it. This is much faster than the logical initial sync of the InitialSyncer
+ * for datasets with many indexes, which are copied rather than rebuilt.
+ *
+ * The sync source opens a backup cursor, which pins a checkpoint along with the journal files
+ * needed to recover from it, and the files are read in chunks over several connections. They are
+ * written to a temporary directory of the dbpath, and only moved in place once all of them have
+ * been copied and flushed, so that a failed copy leaves no data files behind. Once the storage
+ * engine starts on the copied files, startup recovery replays the oplog up to the end of the
+ * checkpoint and the node catches up with the rest of the oplog through steady state replication.
+ */
+class FileCopyInitialSyncer {
+public:
+    using CreateClientFn = std::function<std::unique_ptr<DBClientBase>()>;
+
+    struct Stats {
+        size_t files = 0;
+        long long bytesCopied = 0;
+        Milliseconds duration{0};
+
+        BSONObj toBSON() const;
+    };
+
+    /**
+     * The name of the directory of the dbpath to which the files are copied.
+     */
+    static constexpr StringData kTempDirName = "_fileCopyInitialSync"_sd;
+
+    FileCopyInitialSyncer(std::string dbpath,
+                          CreateClientFn createClientFn,
+                          int parallelism,
+                          int chunkSizeBytes);
+
+    /**
+     * Returns true if the dbpath holds no data files of a storage engine.
+     */
+    static bool isDbPathEmpty(const std::string& dbpath);
+
+    /**
+     * Copies the files of a backup cursor of the sync source into the dbpath. Throws if the copy
+     * fails, in which case none of the files have been moved to the dbpath.
+     */
+    Stats run();
+
+private:
+    struct BackupFile {
+        std::string filename;
+        long long fileSize = 0;
+    };
+
+    /**
+     * Copies one file to the temporary directory and flushes it. Returns the number of bytes
+     * copied.
+     */
+    long long _copyFile(DBClientBase* client, const UUID& backupId, const BackupFile& file);
+
+    /**
+     * Moves the copied files from the temporary directory to the dbpath.
+     */
+    void _moveFilesInPlace(const std::vector<BackupFile>& files);
+
+    const std::string _dbpath;
+    const CreateClientFn _createClientFn;
+    const int _parallelism;
+    const int _chunkSizeBytes;
+};
+
+/**
+ * Copies the files of the 'fileCopyInitialSyncSource' into the dbpath if that parameter is set and
+ * the dbpath holds no data files. Must be called before the storage engine is initialized.
+ */
+void runFileCopyInitialSyncIfNeeded();
+
+}  // namespace repl
+}  // namespace mongo
@@ -40,6 +40,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/repl/apply_ops.h"
 #include "mongo/db/repl/oplog_applier_utils.h"
@@ -52,6 +53,7 @@
 #include "mongo/platform/basic.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log_with_sampling.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace repl {
@@ -73,6 +75,65 @@ ServerStatusMetricField<Counter64> displayOplogApplicationBatchSize("repl.apply.
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+// Number and time of each stage of batch application. The stages of consecutive batches overlap
+// when the next batch is prepared while the current one is applied.
+TimerStats prepareStageStats;
+ServerStatusMetricField<TimerStats> displayPrepareStage("repl.apply.stages.prepare",
+                                                        &prepareStageStats);
+TimerStats writeOplogStageStats;
+ServerStatusMetricField<TimerStats> displayWriteOplogStage("repl.apply.stages.writeOplog",
+                                                           &writeOplogStageStats);
+TimerStats applyStageStats;
+ServerStatusMetricField<TimerStats> displayApplyStage("repl.apply.stages.apply",
+                                                      &applyStageStats);
+TimerStats finalizeStageStats;
+ServerStatusMetricField<TimerStats> displayFinalizeStage("repl.apply.stages.finalize",
+                                                         &finalizeStageStats);
+
+// Number of batches partitioned while the previous batch was being applied.
+Counter64 batchesPreparedAheadStats;
+ServerStatusMetricField<Counter64> displayBatchesPreparedAhead("repl.apply.stages.preparedAhead",
+                                                               &batchesPreparedAheadStats);
+
+// Documents looked up by _id ahead of the writer threads. Each is either read before the writer
+// threads start applying its batch, read while they apply it, or skipped once it has been applied.
+Counter64 prefetchDocumentsStats;
+ServerStatusMetricField<Counter64> displayPrefetchDocuments("repl.apply.prefetch.documents",
+                                                            &prefetchDocumentsStats);
+Counter64 prefetchFoundStats;
+ServerStatusMetricField<Counter64> displayPrefetchFound("repl.apply.prefetch.found",
+                                                        &prefetchFoundStats);
+Counter64 prefetchReadyBeforeApplyStats;
+ServerStatusMetricField<Counter64> displayPrefetchReadyBeforeApply(
+    "repl.apply.prefetch.readyBeforeApply", &prefetchReadyBeforeApplyStats);
+Counter64 prefetchSkippedStats;
+ServerStatusMetricField<Counter64> displayPrefetchSkipped("repl.apply.prefetch.skipped",
+                                                          &prefetchSkippedStats);
+
+/**
+ * The fraction of the prefetched documents which were read before the writer threads started
+ * applying their batch, and so were certainly in cache when the writer threads looked them up.
+ */
+class PrefetchHitRateMetric : public ServerStatusMetric {
+public:
+    PrefetchHitRateMetric() : ServerStatusMetric("repl.apply.prefetch.hitRate") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        const auto documents = prefetchDocumentsStats.get();
+        b.append(_leafName,
+                 documents ? static_cast<double>(prefetchReadyBeforeApplyStats.get()) / documents
+                           : 0.0);
+    }
+} prefetchHitRateMetric;
+
+/**
+ * Returns whether any of 'ops' is a command. Applying a command, such as a DDL operation, may
+ * change how the operations which follow it are partitioned among the writer threads.
+ */
+bool containsCommand(const std::vector<OplogEntry>& ops) {
+    return std::any_of(ops.begin(), ops.end(), [](const auto& op) { return op.isCommand(); });
+}
+
 /**
  * Used for logging a report of ops that take longer than "slowMS" to apply. This is called
  * right before returning from applyOplogEntryOrGroupedInserts, and it returns the same status.
@@ -234,6 +295,70 @@ void ApplyBatchFinalizerForJournal::_run() {
 
 }  // namespace
 
+struct OplogApplierImpl::BatchPrefetch {
+    struct Document {
+        NamespaceStringOrUUID nssOrUUID;
+        BSONObj idQuery;
+    };
+
+    // In the order in which the writer threads reach them.
+    std::vector<Document> documents;
+
+    // Index of the next document to read, shared by the prefetch threads.
+    AtomicWord<long long> next{0};
+
+    AtomicWord<bool> applyStarted{false};
+    AtomicWord<bool> batchApplied{false};
+};
+
+void OplogApplierImpl::_prefetchDocuments(const std::shared_ptr<BatchPrefetch>& prefetch) {
+    auto opCtx = cc().makeOperationContext();
+    opCtx->setShouldParticipateInFlowControl(false);
+
+    // Like the writer threads, reads the latest data while the applier holds the PBWM lock, and
+    // ignores prepare conflicts, which the writer threads ignore as well.
+    opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+    opCtx->lockState()->setShouldUseInternalTicketLane(true);
+    opCtx->recoveryUnit()->setPrepareConflictBehavior(PrepareConflictBehavior::kIgnoreConflicts);
+
+    const auto numDocuments = static_cast<long long>(prefetch->documents.size());
+    for (auto i = prefetch->next.fetchAndAdd(1); i < numDocuments;
+         i = prefetch->next.fetchAndAdd(1)) {
+        if (prefetch->batchApplied.load()) {
+            // Claims the documents which no prefetch thread has claimed yet, along with this one.
+            const auto firstUnclaimed = prefetch->next.swap(numDocuments);
+            prefetchSkippedStats.increment(1 + std::max(0LL, numDocuments - firstUnclaimed));
+            return;
+        }
+
+        const auto& document = prefetch->documents[i];
+        try {
+            AutoGetCollection coll(opCtx.get(), document.nssOrUUID, MODE_IS);
+            if (coll) {
+                auto recordId = Helpers::findById(opCtx.get(), *coll, document.idQuery);
+                Snapshotted<BSONObj> doc;
+                if (!recordId.isNull() && coll->findDoc(opCtx.get(), recordId, &doc)) {
+                    prefetchFoundStats.increment();
+                }
+            }
+        } catch (const ExceptionForCat<ErrorCategory::Interruption>&) {
+            return;
+        } catch (const DBException& ex) {
+            // The writer thread reports whatever prevents it from applying the operation.
+            LOGV2_DEBUG(5190952,
+                        2,
+                        "Failed to prefetch a document",
+                        "namespace"_attr = document.nssOrUUID.toString(),
+                        "error"_attr = redact(ex.toStatus()));
+        }
+        opCtx->recoveryUnit()->abandonSnapshot();
+
+        if (!prefetch->applyStarted.load()) {
+            prefetchReadyBeforeApplyStats.increment();
+        }
+    }
+}
+
 OplogApplierImpl::OplogApplierImpl(executor::TaskExecutor* executor,
                                    OplogBuffer* oplogBuffer,
                                    Observer* observer,
@@ -265,6 +390,11 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
             ? new ApplyBatchFinalizerForJournal(_replCoord)
             : new ApplyBatchFinalizer(_replCoord)};
 
+    // A batch taken from the batcher while the previous batch was being applied. Non-empty
+    // batches are kept in 'nextPartitionedBatch' instead if they could be partitioned ahead.
+    boost::optional<OplogBatch> nextBatch;
+    boost::optional<PartitionedBatch> nextPartitionedBatch;
+
     while (true) {  // Exits on message from OplogBatcher.
         // Use a new operation context each iteration, as otherwise we may appear to use a single
         // collection name to refer to collections with different UUIDs.
@@ -276,6 +406,9 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         // path only gets used on secondaries or on a node transitioning to primary.
         opCtx.setShouldParticipateInFlowControl(false);
 
+        // Nor should it queue for tickets behind the reads of the secondary.
+        opCtx.lockState()->setShouldUseInternalTicketLane(true);
+
         // For pausing replication in tests.
         if (MONGO_unlikely(rsSyncApplyStop.shouldFail())) {
             LOGV2(21229,
@@ -287,29 +420,39 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         // Transition to SECONDARY state, if possible.
         _replCoord->finishRecoveryIfEligible(&opCtx);
 
-        // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
-        // ready in time, we'll loop again so we can do the above checks periodically.
-        OplogBatch ops = _oplogBatcher->getNextBatch(Seconds(1));
-        if (ops.empty()) {
-            if (ops.mustShutdown()) {
-                // Shut down and exit oplog application loop.
-                return;
-            }
-            if (MONGO_unlikely(rsSyncApplyStop.shouldFail())) {
-                continue;
-            }
-            if (ops.termWhenExhausted()) {
-                // Signal drain complete if we're in Draining state and the buffer is empty.
-                // Since we check the states of batcher and oplog buffer without synchronization,
-                // they can be stale. We make sure the applier is still draining in the given term
-                // before and after the check, so that if the oplog buffer was exhausted, then
-                // it still will be.
-                _replCoord->signalDrainComplete(&opCtx, *ops.termWhenExhausted());
+        PartitionedBatch batch;
+        if (nextPartitionedBatch) {
+            batch = std::move(*nextPartitionedBatch);
+            nextPartitionedBatch.reset();
+        } else {
+            // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
+            // ready in time, we'll loop again so we can do the above checks periodically.
+            OplogBatch ops =
+                nextBatch ? std::move(*nextBatch) : _oplogBatcher->getNextBatch(Seconds(1));
+            nextBatch.reset();
+            if (ops.empty()) {
+                if (ops.mustShutdown()) {
+                    // Shut down and exit oplog application loop.
+                    return;
+                }
+                if (MONGO_unlikely(rsSyncApplyStop.shouldFail())) {
+                    continue;
+                }
+                if (ops.termWhenExhausted()) {
+                    // Signal drain complete if we're in Draining state and the buffer is empty.
+                    // Since we check the states of batcher and oplog buffer without
+                    // synchronization, they can be stale. We make sure the applier is still
+                    // draining in the given term before and after the check, so that if the oplog
+                    // buffer was exhausted, then it still will be.
+                    _replCoord->signalDrainComplete(&opCtx, *ops.termWhenExhausted());
+                }
+                continue;  // Try again.
             }
-            continue;  // Try again.
+            batch.ops = ops.releaseBatch();
         }
+        const auto& ops = batch.ops;
 
-        // Extract some info from ops that we'll need after releasing the batch below.
+        // Extract some info from ops that we'll need after applying the batch below.
         const auto firstOpTimeInBatch = ops.front().getOpTime();
         const auto lastOpInBatch = ops.back();
         const auto lastOpTimeInBatch = lastOpInBatch.getOpTime();
@@ -329,9 +472,34 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         // Don't allow the fsync+lock thread to see intermediate states of batch application.
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
-        // Apply the operations in this batch. '_applyOplogBatch' returns the optime of the
+        // While the writer threads apply this batch, take the next one from the batcher and
+        // partition it. This is only done when neither batch contains commands, as applying a
+        // command may change the collections that the next batch is partitioned against.
+        std::function<void(OperationContext*)> prepareNextBatch;
+        if (replPrepareNextBatchWhileApplying.load() && !containsCommand(ops)) {
+            prepareNextBatch = [&](OperationContext* batchOpCtx) {
+                auto next = _oplogBatcher->getNextBatch(Milliseconds(0));
+                if (next.empty()) {
+                    // Keep the signals to shut down or complete draining for the next iteration.
+                    if (next.mustShutdown() || next.termWhenExhausted()) {
+                        nextBatch = std::move(next);
+                    }
+                    return;
+                }
+                if (containsCommand(next.getBatch())) {
+                    nextBatch = std::move(next);
+                    return;
+                }
+                nextPartitionedBatch.emplace();
+                nextPartitionedBatch->ops = next.releaseBatch();
+                _partitionBatch(batchOpCtx, &*nextPartitionedBatch);
+                batchesPreparedAheadStats.increment();
+            };
+        }
+
+        // Apply the operations in this batch. '_applyPartitionedBatch' returns the optime of the
         // last op that was applied, which should be the last optime in the batch.
-        auto swLastOpTimeAppliedInBatch = _applyOplogBatch(&opCtx, ops.releaseBatch());
+        auto swLastOpTimeAppliedInBatch = _applyPartitionedBatch(&opCtx, &batch, prepareNextBatch);
         if (swLastOpTimeAppliedInBatch.getStatus().code() == ErrorCodes::InterruptedAtShutdown) {
             // If an operation was interrupted at shutdown, fail the batch without advancing
             // appliedThrough as if this were an unclean shutdown. This ensures the stable timestamp
@@ -345,6 +513,7 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
         // Update various things that care about our last applied optime. Tests rely on 1 happening
         // before 2 even though it isn't strictly necessary.
+        TimerHolder finalizeTimer(&finalizeStageStats);
 
         // 1. Persist our "applied through" optime to disk.
         _consistencyMarkers->setAppliedThrough(&opCtx, lastOpTimeInBatch);
@@ -386,6 +555,7 @@ void scheduleWritesToOplog(OperationContext* opCtx,
             // This code path is only executed on secondaries and initial syncing nodes, so it is
             // safe to exclude any writes from Flow Control.
             opCtx->setShouldParticipateInFlowControl(false);
+            opCtx->lockState()->setShouldUseInternalTicketLane(true);
 
             UnreplicatedWritesBlock uwb(opCtx.get());
             ShouldNotConflictWithSecondaryBatchApplicationBlock shouldNotConflictBlock(
@@ -431,6 +601,79 @@ void scheduleWritesToOplog(OperationContext* opCtx,
 
 StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                                                       std::vector<OplogEntry> ops) {
+    PartitionedBatch batch;
+    batch.ops = std::move(ops);
+    return _applyPartitionedBatch(opCtx, &batch, nullptr);
+}
+
+void OplogApplierImpl::_partitionBatch(OperationContext* opCtx, PartitionedBatch* batch) {
+    invariant(!batch->partitioned);
+    TimerHolder timer(&prepareStageStats);
+
+    batch->writerVectors.resize(_writerPool->getStats().numThreads);
+    fillWriterVectors(opCtx, &batch->ops, &batch->writerVectors, &batch->derivedOps);
+    batch->partitioned = true;
+
+    if (getOptions().mode == OplogApplication::Mode::kSecondary &&
+        replPrefetchBeforeApply.load()) {
+        _prefetchBatch(batch);
+    }
+}
+
+void OplogApplierImpl::_prefetchBatch(PartitionedBatch* batch) {
+    auto prefetch = std::make_shared<BatchPrefetch>();
+
+    // Takes the n-th operation of every writer thread before the (n+1)-th of any, so that the
+    // documents which the writer threads look up first are read first.
+    const auto& writerVectors = batch->writerVectors;
+    size_t longestWriterVector = 0;
+    for (const auto& writerVector : writerVectors) {
+        longestWriterVector = std::max(longestWriterVector, writerVector.size());
+    }
+    for (size_t n = 0; n < longestWriterVector; ++n) {
+        for (const auto& writerVector : writerVectors) {
+            if (n >= writerVector.size()) {
+                continue;
+            }
+            const auto& op = *writerVector[n];
+            const auto opType = op.getOpType();
+            if ((opType != OpTypeEnum::kUpdate && opType != OpTypeEnum::kDelete) ||
+                !op.getUuid()) {
+                continue;
+            }
+            auto id = op.getIdElement();
+            if (id.eoo()) {
+                continue;
+            }
+            prefetch->documents.push_back(
+                {NamespaceStringOrUUID(op.getNss().db().toString(), *op.getUuid()), id.wrap()});
+        }
+    }
+    if (prefetch->documents.empty()) {
+        return;
+    }
+
+    if (!_prefetchPool) {
+        _prefetchPool = makeReplWriterPool(replPrefetchThreadCount, "ReplPrefetchWorker"_sd);
+    }
+    prefetchDocumentsStats.increment(prefetch->documents.size());
+    const auto numTasks = std::min(prefetch->documents.size(),
+                                   static_cast<size_t>(_prefetchPool->getStats().numThreads));
+    for (size_t i = 0; i < numTasks; ++i) {
+        _prefetchPool->schedule([prefetch](auto status) {
+            if (status.isOK()) {
+                _prefetchDocuments(prefetch);
+            }
+        });
+    }
+    batch->prefetch = std::move(prefetch);
+}
+
+StatusWith<OpTime> OplogApplierImpl::_applyPartitionedBatch(
+    OperationContext* opCtx,
+    PartitionedBatch* batch,
+    const std::function<void(OperationContext*)>& whileApplying) {
+    const auto& ops = batch->ops;
     invariant(!ops.empty());
 
     LOGV2_DEBUG(21230,
@@ -453,6 +696,13 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
     // Increment the batch size stat.
     oplogApplicationBatchSize.increment(ops.size());
 
+    // The documents of the batch which are not being read by then are no longer worth reading.
+    ON_BLOCK_EXIT([&] {
+        if (batch->prefetch) {
+            batch->prefetch->batchApplied.store(true);
+        }
+    });
+
     std::vector<WorkerMultikeyPathInfo> multikeyVector(_writerPool->getStats().numThreads);
     {
         // Each node records cumulative batch application stats for itself using this timer.
@@ -463,27 +713,23 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
         ON_BLOCK_EXIT([&] { _writerPool->waitForIdle(); });
 
         // Write batch of ops into oplog.
+        Timer writeOplogTimer;
         if (!getOptions().skipWritesToOplog) {
             _consistencyMarkers->setOplogTruncateAfterPoint(
                 opCtx, _replCoord->getMyLastAppliedOpTime().getTimestamp());
             scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
         }
 
-        // Holds 'pseudo operations' generated by secondaries to aid in replication.
-        // Keep in scope until all operations in 'ops' and 'derivedOps' have been applied.
-        // Pseudo operations include:
-        // - applyOps operations expanded to individual ops.
-        // - ops to update config.transactions. Normal writes to config.transactions in the
-        //   primary don't create an oplog entry, so extract info from writes with transactions
-        //   and create a pseudo oplog.
-        std::vector<std::vector<OplogEntry>> derivedOps;
-
-        std::vector<std::vector<const OplogEntry*>> writerVectors(
-            _writerPool->getStats().numThreads);
-        fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
+        // Partition the batch while its oplog entries are written, unless it was partitioned
+        // while the previous batch was being applied.
+        if (!batch->partitioned) {
+            _partitionBatch(opCtx, batch);
+        }
+        auto& writerVectors = batch->writerVectors;
 
         // Wait for writes to finish before applying ops.
         _writerPool->waitForIdle();
+        writeOplogStageStats.record(writeOplogTimer);
 
         // Use this fail point to hold the PBWM lock after we have written the oplog entries but
         // before we have applied them.
@@ -505,7 +751,11 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 
             // Doles out all the work to the writer pool threads. writerVectors is not modified,
             // but  applyOplogBatchPerWorker will modify the vectors that it contains.
+            Timer applyTimer;
             invariant(writerVectors.size() == statusVector.size());
+            if (batch->prefetch) {
+                batch->prefetch->applyStarted.store(true);
+            }
             for (size_t i = 0; i < writerVectors.size(); i++) {
                 if (writerVectors[i].empty())
                     continue;
@@ -529,7 +779,12 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                     });
             }
 
+            if (whileApplying) {
+                whileApplying(opCtx);
+            }
+
             _writerPool->waitForIdle();
+            applyStageStats.record(applyTimer);
 
             // If any of the statuses is not ok, return error.
             for (auto it = statusVector.cbegin(); it != statusVector.cend(); ++it) {
@@ -780,6 +1035,7 @@ Status OplogApplierImpl::applyOplogBatchPerWorker(OperationContext* opCtx,
     // ShouldNotConflictWithSecondaryBatchApplicationBlock will touch the locker that has been
     // destroyed by unstash in its destructor. Thus we set the flag explicitly.
     opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+    opCtx->lockState()->setShouldUseInternalTicketLane(true);
 
     // Ensure future transactions read without a timestamp.
     invariant(RecoveryUnit::ReadSource::kNoTimestamp ==
@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "mongo/db/commands/fsync.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/replication_state_transition_lock_guard.h"
@@ -76,10 +78,46 @@ public:
 
 
 private:
+    /**
+     * The documents which the updates and deletes of a batch look up by _id, read by the prefetch
+     * threads ahead of the writer threads. Defined in oplog_applier_impl.cpp.
+     */
+    struct BatchPrefetch;
+
+    /**
+     * A batch of oplog entries along with its partition among the writer threads, which may be
+     * computed before the batch is applied.
+     */
+    struct PartitionedBatch {
+        std::vector<OplogEntry> ops;
+
+        // Set of operations for each writer thread to apply. These point into 'ops' and
+        // 'derivedOps', which must not be modified once the batch is partitioned.
+        std::vector<std::vector<const OplogEntry*>> writerVectors;
+
+        // Holds 'pseudo operations' generated by secondaries to aid in replication. Pseudo
+        // operations include:
+        // - applyOps operations expanded to individual ops.
+        // - ops to update config.transactions. Normal writes to config.transactions in the
+        //   primary don't create an oplog entry, so extract info from writes with transactions
+        //   and create a pseudo oplog.
+        std::vector<std::vector<OplogEntry>> derivedOps;
+
+        bool partitioned = false;
+
+        // Set once the batch is partitioned if its documents are prefetched. Shared with the
+        // prefetch threads, which may still be reading when the batch has been applied.
+        std::shared_ptr<BatchPrefetch> prefetch;
+    };
+
     /**
      * Runs oplog application in a loop until shutdown() is called.
      * Retrieves operations from the OplogBuffer in batches that will be applied in parallel using
      * applyOplogBatch().
+     *
+     * While the writer threads apply a batch, takes the next batch from the batcher and, if
+     * neither batch contains commands, partitions it among the writer threads, so that it is
+     * ready to be applied as soon as the current batch completes.
      */
     void _run(OplogBuffer* oplogBuffer) override;
 
@@ -98,6 +136,38 @@ private:
      */
     StatusWith<OpTime> _applyOplogBatch(OperationContext* opCtx, std::vector<OplogEntry> ops);
 
+    /**
+     * Applies 'batch' like _applyOplogBatch(), partitioning it first unless this was already done.
+     * Once the writer threads have been handed the operations of the batch, calls 'whileApplying'
+     * with 'opCtx', if provided, before waiting for them to complete.
+     */
+    StatusWith<OpTime> _applyPartitionedBatch(
+        OperationContext* opCtx,
+        PartitionedBatch* batch,
+        const std::function<void(OperationContext*)>& whileApplying);
+
+    /**
+     * Partitions the operations of 'batch' among the writer threads. On a secondary with
+     * 'replPrefetchBeforeApply' enabled, then starts reading the documents which the batch will
+     * look up by _id, see _prefetchBatch().
+     */
+    void _partitionBatch(OperationContext* opCtx, PartitionedBatch* batch);
+
+    /**
+     * Has the prefetch threads look up, by _id, the documents which the updates and deletes of the
+     * partitioned 'batch' modify, so that the pages of the _id index and of the collection which
+     * hold them are in the storage engine cache by the time the writer threads apply the batch.
+     * The documents are read in the order in which the writer threads reach them. Lookups which
+     * have not started when the batch has been applied are skipped.
+     */
+    void _prefetchBatch(PartitionedBatch* batch);
+
+    /**
+     * Reads the documents of 'prefetch' until every one of them has been claimed by a prefetch
+     * thread. Runs on the threads of the prefetch pool.
+     */
+    static void _prefetchDocuments(const std::shared_ptr<BatchPrefetch>& prefetch);
+
     void _deriveOpsAndFillWriterVectors(OperationContext* opCtx,
                                         std::vector<OplogEntry>* ops,
                                         std::vector<std::vector<const OplogEntry*>>* writerVectors,
@@ -111,6 +181,10 @@ private:
     // Not owned by us.
     ThreadPool* const _writerPool;
 
+    // Pool of threads reading the documents of the batches ahead of the writer threads. Started
+    // by the first batch which is prefetched.
+    std::unique_ptr<ThreadPool> _prefetchPool;
+
     StorageInterface* _storageInterface;
 
     ReplicationConsistencyMarkers* const _consistencyMarkers;
@@ -47,7 +47,7 @@ OplogBatcher::~OplogBatcher() {
     invariant(!_thread);
 }
 
-OplogBatch OplogBatcher::getNextBatch(Seconds maxWaitTime) {
+OplogBatch OplogBatcher::getNextBatch(Milliseconds maxWaitTime) {
     stdx::unique_lock<Latch> lk(_mutex);
     // _ops can indicate the following cases:
     // 1. A new batch is ready to consume.
@@ -148,8 +148,9 @@ public:
 
     /**
      * Returns the batch of oplog entries and clears _ops so the batcher can store a new batch.
+     * Waits up to 'maxWaitTime' for a batch to be ready, and returns an empty batch on timeout.
      */
-    OplogBatch getNextBatch(Seconds maxWaitTime);
+    OplogBatch getNextBatch(Milliseconds maxWaitTime);
 
     /**
      * Starts up a thread to continuously pull from the OplogBuffer into the OplogBatcher's oplog
@@ -38,8 +38,10 @@
 #include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/client.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/logv2/log.h"
+#include "mongo/platform/mutex.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
 #include "mongo/s/resharding/resume_token_gen.h"
 #include "mongo/util/assert_util.h"
@@ -100,6 +102,50 @@ Counter64 readersCreatedStats;
 ServerStatusMetricField<Counter64> displayReadersCreated("repl.network.readersCreated",
                                                          &readersCreatedStats);
 
+// The batches received while the oplog fetcher processed the previous one
+Counter64 readAheadBatchesStats;
+ServerStatusMetricField<Counter64> displayReadAheadBatches("repl.network.readAheadBatches",
+                                                           &readAheadBatchesStats);
+
+/**
+ * The rate at which the oplog fetchers receive oplog entries from their sync source, measured over
+ * windows of at least a second.
+ */
+class FetchThroughputMetric : public ServerStatusMetric {
+public:
+    FetchThroughputMetric() : ServerStatusMetric("repl.network.throughputBytesPerSec") {}
+
+    void record(long long bytes) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _windowBytes += bytes;
+        _rollWindow(lk);
+    }
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        // A window in which nothing has been received reports a rate of zero.
+        _rollWindow(lk);
+        b.append(_leafName, _bytesPerSec);
+    }
+
+private:
+    void _rollWindow(WithLock) const {
+        const auto now = Date_t::now();
+        const auto elapsed = durationCount<Milliseconds>(now - _windowStart);
+        if (elapsed < 1000) {
+            return;
+        }
+        _bytesPerSec = _windowBytes * 1000 / elapsed;
+        _windowBytes = 0;
+        _windowStart = now;
+    }
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("FetchThroughputMetric::_mutex");
+    mutable Date_t _windowStart;
+    mutable long long _windowBytes = 0;
+    mutable long long _bytesPerSec = 0;
+} fetchThroughputMetric;
+
 const Milliseconds maximumAwaitDataTimeoutMS(30 * 1000);
 
 /**
@@ -309,6 +355,8 @@ Milliseconds OplogFetcher::_getRetriedFindMaxTime() const {
 
 void OplogFetcher::_finishCallback(Status status) {
     invariant(isActive());
+    _stopReadAhead();
+
     // If the oplog fetcher is shutting down, consolidate return code to CallbackCanceled.
     if (_isShuttingDown() && status != ErrorCodes::CallbackCanceled) {
         status = Status(ErrorCodes::CallbackCanceled,
@@ -383,7 +431,7 @@ void OplogFetcher::_runQuery(const executor::TaskExecutor::CallbackArgs& callbac
             return;
         }
 
-        auto batchResult = _getNextBatch();
+        auto batchResult = _readAheadResult ? _waitForReadAhead() : _getNextBatch();
         if (!batchResult.isOK()) {
             auto brStatus = batchResult.getStatus();
 
@@ -398,8 +446,13 @@ void OplogFetcher::_runQuery(const executor::TaskExecutor::CallbackArgs& callbac
             }
         }
 
+        const auto& batch = batchResult.getValue();
+        if (_shouldReadAhead(batch)) {
+            _startReadAhead();
+        }
+
         // This will advance our view of _lastFetched.
-        status = _onSuccessfulBatch(batchResult.getValue());
+        status = _onSuccessfulBatch(batch);
         if (!status.isOK()) {
             // The stopReplProducer fail point expects this to return successfully. If another fail
             // point wants this to return unsuccessfully, it should use a different error code.
@@ -412,7 +465,7 @@ void OplogFetcher::_runQuery(const executor::TaskExecutor::CallbackArgs& callbac
             return;
         }
 
-        if (_cursor->isDead()) {
+        if (batch.cursorExhausted) {
             // This means the sync source closes the tailable cursor with a returned cursorId of 0.
             // Any users of the oplog fetcher should create a new oplog fetcher if they see a
             // successful status and would like to continue fetching more oplog entries.
@@ -551,8 +604,8 @@ void OplogFetcher::_createNewCursor(bool initialFind) {
     readersCreatedStats.increment();
 }
 
-StatusWith<OplogFetcher::Documents> OplogFetcher::_getNextBatch() {
-    Documents batch;
+StatusWith<OplogFetcher::FetchedBatch> OplogFetcher::_getNextBatch() {
+    FetchedBatch batch;
     try {
         Timer timer;
         // If it is the first batch, we should initialize the cursor, which will run the find query.
@@ -593,12 +646,16 @@ StatusWith<OplogFetcher::Documents> OplogFetcher::_getNextBatch() {
         }
 
         while (_cursor->moreInCurrentBatch()) {
-            batch.emplace_back(_cursor->nextSafe());
+            batch.documents.emplace_back(_cursor->nextSafe());
         }
 
+        batch.metadata = _metadataObj;
+        batch.postBatchResumeToken = _cursor->getPostBatchResumeToken();
+        batch.cursorExhausted = _cursor->isDead();
+
         // This value is only used on a successful batch for metrics.repl.network.getmores. This
         // metric intentionally tracks the time taken by the initial find as well.
-        _lastBatchElapsedMS = timer.millis();
+        batch.elapsedMillis = timer.millis();
     } catch (const DBException& ex) {
         if (_cursor->connectionHasPendingReplies()) {
             // Close the connection because the connection cannot be used anymore as more data is on
@@ -612,9 +669,64 @@ StatusWith<OplogFetcher::Documents> OplogFetcher::_getNextBatch() {
     return batch;
 }
 
-Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
+bool OplogFetcher::_shouldReadAhead(const FetchedBatch& batch) const {
+    return _config.readAheadWhenLagging && oplogFetcherReadAhead.load() && !_firstBatch &&
+        !batch.cursorExhausted && _lagSecs >= oplogFetcherReadAheadMinLagSecs.load();
+}
+
+void OplogFetcher::_startReadAhead() {
+    invariant(!_readAheadResult);
+    if (!_readAheadPool) {
+        ThreadPool::Options options;
+        options.poolName = _config.name + "ReadAhead";
+        options.threadNamePrefix = _config.name + "ReadAhead-";
+        options.minThreads = 1;
+        options.maxThreads = 1;
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName);
+        };
+        _readAheadPool = std::make_unique<ThreadPool>(options);
+        _readAheadPool->startup();
+    }
+
+    auto pf = makePromiseFuture<FetchedBatch>();
+    _readAheadResult.emplace(std::move(pf.future));
+    _readAheadPool->schedule([this, promise = std::move(pf.promise)](Status status) mutable {
+        if (!status.isOK()) {
+            promise.setError(status);
+            return;
+        }
+        promise.setFrom(_getNextBatch());
+    });
+}
+
+StatusWith<OplogFetcher::FetchedBatch> OplogFetcher::_waitForReadAhead() {
+    auto result = std::move(*_readAheadResult).getNoThrow();
+    _readAheadResult.reset();
+    if (result.isOK()) {
+        readAheadBatchesStats.increment();
+    }
+    return result;
+}
+
+void OplogFetcher::_stopReadAhead() {
+    if (_readAheadResult) {
+        _conn->shutdown();
+        std::move(*_readAheadResult).getNoThrow().getStatus().ignore();
+        _readAheadResult.reset();
+    }
+    if (_readAheadPool) {
+        _readAheadPool->shutdown();
+        _readAheadPool->join();
+        _readAheadPool.reset();
+    }
+}
+
+Status OplogFetcher::_onSuccessfulBatch(const FetchedBatch& batch) {
     hangBeforeProcessingSuccessfulBatch.pauseWhileSet();
 
+    const auto& documents = batch.documents;
+
     if (_isShuttingDown()) {
         return Status(ErrorCodes::CallbackCanceled, "oplog fetcher shutting down");
     }
@@ -672,7 +784,7 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
         LOGV2_DEBUG(21271, 2, "Oplog fetcher read 0 operations from remote oplog");
     }
 
-    auto oqMetadataResult = rpc::OplogQueryMetadata::readFromMetadata(_metadataObj);
+    auto oqMetadataResult = rpc::OplogQueryMetadata::readFromMetadata(batch.metadata);
     if (!oqMetadataResult.isOK()) {
         LOGV2_ERROR(21278,
                     "invalid oplog query metadata from sync source {syncSource}: "
@@ -680,7 +792,7 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
                     "Invalid oplog query metadata from sync source",
                     "syncSource"_attr = _config.source,
                     "error"_attr = oqMetadataResult.getStatus(),
-                    "metadata"_attr = _metadataObj);
+                    "metadata"_attr = batch.metadata);
         return oqMetadataResult.getStatus();
     }
     auto oqMetadata = oqMetadataResult.getValue();
@@ -739,7 +851,7 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
     // Process replset metadata.  It is important that this happen after we've validated the
     // first batch, so we don't progress our knowledge of the commit point from a
     // response that triggers a rollback.
-    auto metadataResult = rpc::ReplSetMetadata::readFromMetadata(_metadataObj);
+    auto metadataResult = rpc::ReplSetMetadata::readFromMetadata(batch.metadata);
     if (!metadataResult.isOK()) {
         LOGV2_ERROR(21279,
                     "invalid replication metadata from sync source {syncSource}: "
@@ -747,7 +859,7 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
                     "Invalid replication metadata from sync source",
                     "syncSource"_attr = _config.source,
                     "error"_attr = metadataResult.getStatus(),
-                    "metadata"_attr = _metadataObj);
+                    "metadata"_attr = batch.metadata);
         return metadataResult.getStatus();
     }
     auto replSetMetadata = metadataResult.getValue();
@@ -774,13 +886,14 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
     // Increment stats. We read all of the docs in the query.
     opsReadStats.increment(info.networkDocumentCount);
     networkByteStats.increment(info.networkDocumentBytes);
+    fetchThroughputMetric.record(info.networkDocumentBytes);
 
-    oplogBatchStats.recordMillis(_lastBatchElapsedMS, documents.empty());
+    oplogBatchStats.recordMillis(batch.elapsedMillis, documents.empty());
 
-    if (_cursor->getPostBatchResumeToken()) {
+    if (batch.postBatchResumeToken) {
         auto pbrt = ResumeTokenOplogTimestamp::parse(
             IDLParserErrorContext("OplogFetcher PostBatchResumeToken"),
-            *_cursor->getPostBatchResumeToken());
+            *batch.postBatchResumeToken);
         info.resumeToken = pbrt.getTs();
     }
 
@@ -818,7 +931,13 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
         _lastFetched = lastDocOpTime;
     }
 
-    _firstBatch = false;
+    _lagSecs = static_cast<long long>(oqMetadata.getLastOpApplied().getSecs()) -
+        static_cast<long long>(lastDocOpTime.getSecs());
+
+    // The read ahead thread may be reading '_firstBatch', which is only written when it changes.
+    if (_firstBatch) {
+        _firstBatch = false;
+    }
     return Status::OK();
 }
 
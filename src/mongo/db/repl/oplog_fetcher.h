@@ -42,7 +42,9 @@
 #include "mongo/db/repl/repl_set_config.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/vector_clock_metadata_hook.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/future.h"
 
 namespace mongo {
 namespace repl {
@@ -220,6 +222,11 @@ public:
         // _enqueueDocumentsFn.
         bool requestResumeToken = false;
 
+        // Specifies if the oplog fetcher should receive the next batch from the sync source while
+        // the current one is processed, when it is behind the sync source by at least
+        // 'oplogFetcherReadAheadMinLagSecs'.
+        bool readAheadWhenLagging = false;
+
         std::string name = "oplog fetcher";
     };
 
@@ -314,6 +321,23 @@ protected:
     virtual OpTime _getLastOpTimeFetched() const;
 
 private:
+    /**
+     * A batch received from the sync source, along with what the cursor told about it.
+     */
+    struct FetchedBatch {
+        Documents documents;
+
+        // The metadata of the response which returned the documents.
+        BSONObj metadata;
+
+        boost::optional<BSONObj> postBatchResumeToken;
+
+        // Whether the sync source closed the cursor with this batch.
+        bool cursorExhausted = false;
+
+        int elapsedMillis = 0;
+    };
+
     // =============== AbstractAsyncComponent overrides ================
 
     /**
@@ -379,7 +403,27 @@ private:
      * shouldContinue function to see if it should create a new cursor and if so, calls
      * _createNewCursor.
      */
-    StatusWith<Documents> _getNextBatch();
+    StatusWith<FetchedBatch> _getNextBatch();
+
+    /**
+     * Returns true if the next batch should be received while 'batch' is processed: the sync
+     * source is far enough ahead for it to be available right away, and 'batch' is neither the
+     * first nor the last of the cursor.
+     */
+    bool _shouldReadAhead(const FetchedBatch& batch) const;
+
+    /**
+     * Receives the next batch on the read ahead thread, which _waitForReadAhead() returns.
+     */
+    void _startReadAhead();
+    StatusWith<FetchedBatch> _waitForReadAhead();
+
+    /**
+     * Discards the batch being received ahead, if any, and stops the read ahead thread. The
+     * connection is shut down to interrupt the receive, so this is only called when the oplog
+     * fetcher completes.
+     */
+    void _stopReadAhead();
 
     /**
      * Function called by the oplog fetcher when it gets a successful batch from the sync source.
@@ -387,7 +431,7 @@ private:
      *
      * On failure returns a status that will be passed to _finishCallback.
      */
-    Status _onSuccessfulBatch(const Documents& documents);
+    Status _onSuccessfulBatch(const FetchedBatch& batch);
 
     /**
      * Notifies caller that the oplog fetcher has completed processing operations from the remote
@@ -445,7 +489,8 @@ private:
     // the requiredRBID in the OplogFetcher::Config and passed to the onShutdown callback.
     int _receivedRBID;
 
-    // Indicates whether the current batch is the first received via this cursor.
+    // Indicates whether the current batch is the first received via this cursor. Only the batches
+    // after the first one are received ahead, so the read ahead thread never sees it change.
     bool _firstBatch = true;
 
     // In the case of an error, this will help decide if a new cursor should be created or the
@@ -461,7 +506,7 @@ private:
     // Logical time metadata handling hook for the DBClientConnection.
     std::unique_ptr<rpc::VectorClockMetadataHook> _vectorClockMetadataHook;
 
-    // Set by the ReplyMetadataReader upon receiving a new batch.
+    // Set by the ReplyMetadataReader upon receiving a new batch, and then moved to that batch.
     BSONObj _metadataObj;
 
     // Connection to the sync source whose oplog we will be querying. This connection should be
@@ -486,7 +531,17 @@ private:
     // Handle to currently scheduled _runQuery task.
     executor::TaskExecutor::CallbackHandle _runQueryHandle;
 
-    int _lastBatchElapsedMS = 0;
+    // How far, in seconds, the last batch processed was behind the last optime applied on the sync
+    // source.
+    long long _lagSecs = 0;
+
+    // The single thread receiving the next batch while the current one is processed. It is started
+    // by the first read ahead and lives until the oplog fetcher completes.
+    std::unique_ptr<ThreadPool> _readAheadPool;
+
+    // The batch being received ahead, if any. The cursor and the connection are only used by the
+    // read ahead thread until it is ready.
+    boost::optional<Future<FetchedBatch>> _readAheadResult;
 };
 
 class OplogFetcherFactory {
@@ -361,6 +361,9 @@ protected:
     // The last OpTime fetched by the oplog fetcher.
     OpTime lastFetched;
 
+    // Whether the oplog fetchers created by the test receive the next batch ahead when lagging.
+    bool readAheadWhenLagging = false;
+
     std::unique_ptr<MockRemoteDBServer> _mockServer;
 
 private:
@@ -471,6 +474,7 @@ std::unique_ptr<OplogFetcher> OplogFetcherTest::makeOplogFetcherWithDifferentExe
     oplogFetcherConfig.queryFilter = filter;
     oplogFetcherConfig.queryReadConcern = readConcern;
     oplogFetcherConfig.requestResumeToken = requestResumeToken;
+    oplogFetcherConfig.readAheadWhenLagging = readAheadWhenLagging;
     auto oplogFetcher = std::make_unique<OplogFetcher>(
         executor,
         std::make_unique<OplogFetcher::OplogFetcherRestartDecisionDefault>(numRestarts),
@@ -2382,6 +2386,59 @@ TEST_F(OplogFetcherTest, GetMoreEmptyBatch) {
     ASSERT_OK(shutdownState.getStatus());
 }
 
+TEST_F(OplogFetcherTest, OplogFetcherReceivesNextBatchWhileProcessingBatchWhenLagging) {
+    // The sync source has applied oplog entries far ahead of those of the batches below.
+    readAheadWhenLagging = true;
+    ShutdownState shutdownState;
+
+    // Create an oplog fetcher without any retries.
+    auto oplogFetcher = getOplogFetcherAfterConnectionCreated(std::ref(shutdownState));
+
+    CursorId cursorId = 22LL;
+    auto metadataObj = makeOplogBatchMetadata(replSetMetadata, oqMetadata);
+    auto conn = oplogFetcher->getDBClientConnection_forTest();
+
+    // The first batch is processed before the next one is received.
+    auto firstBatch = {makeNoopOplogEntry(lastFetched),
+                       makeNoopOplogEntry({{Seconds(456), 0}, lastFetched.getTerm()})};
+    processSingleRequestResponse(conn, makeFirstBatch(cursorId, firstBatch, metadataObj), true);
+
+    auto beforeProcessingBatch =
+        globalFailPointRegistry().find("hangBeforeProcessingSuccessfulBatch");
+    auto timesEntered = beforeProcessingBatch->setMode(FailPoint::alwaysOn);
+
+    auto secondBatch = {makeNoopOplogEntry({{Seconds(457), 0}, lastFetched.getTerm()}),
+                        makeNoopOplogEntry({{Seconds(458), 0}, lastFetched.getTerm()})};
+    processSingleRequestResponse(
+        conn, makeSubsequentBatch(cursorId, secondBatch, metadataObj, true /* moreToCome */));
+    beforeProcessingBatch->waitForTimesEntered(timesEntered + 1);
+
+    // The third batch is received from the exhaust stream while the second one waits to be
+    // processed.
+    auto thirdBatch = {makeNoopOplogEntry({{Seconds(789), 0}, lastFetched.getTerm()}),
+                       makeNoopOplogEntry({{Seconds(790), 0}, lastFetched.getTerm()})};
+    processSingleExhaustResponse(
+        conn, makeSubsequentBatch(cursorId, thirdBatch, metadataObj, false /* moreToCome */));
+    ASSERT_EQUALS(Timestamp(456, 0), oplogFetcher->getLastOpTimeFetched_forTest().getTimestamp());
+
+    beforeProcessingBatch->setMode(FailPoint::off);
+
+    // Wait up to 10 seconds for both batches to be processed.
+    for (auto i = 0; i < 100; i++) {
+        if (oplogFetcher->getLastOpTimeFetched_forTest().getTimestamp() == Timestamp(790, 0)) {
+            break;
+        }
+        mongo::sleepmillis(100);
+    }
+    lastFetched = oplogFetcher->getLastOpTimeFetched_forTest();
+    validateLastBatch(false /* skipFirstDoc */, thirdBatch, lastFetched);
+
+    oplogFetcher->shutdown();
+    oplogFetcher->join();
+
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled, shutdownState.getStatus());
+}
+
 TEST_F(OplogFetcherTest, HandleLogicalTimeMetaDataAndAdvanceClusterTime) {
     auto firstEntry = makeNoopOplogEntry(lastFetched);
 
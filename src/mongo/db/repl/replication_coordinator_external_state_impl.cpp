@@ -141,6 +141,21 @@ ServerStatusMetricField<Counter64> displayBufferSize("repl.buffer.sizeBytes", &b
 ServerStatusMetricField<Counter64> displayBufferMaxSize("repl.buffer.maxSizeBytes",
                                                         &bufferGauge.maxSize);
 
+/**
+ * The fraction of the buffer in use, which tells how far ahead of the oplog applier the oplog
+ * fetcher has read.
+ */
+class BufferOccupancyMetric : public ServerStatusMetric {
+public:
+    BufferOccupancyMetric() : ServerStatusMetric("repl.network.bufferOccupancy") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        const auto maxSize = bufferGauge.maxSize.get();
+        b.append(_leafName,
+                 maxSize ? static_cast<double>(bufferGauge.size.get()) / maxSize : 0.0);
+    }
+} bufferOccupancyMetric;
+
 /**
  * Returns new thread pool for thread pool task executor.
  */
@@ -481,6 +481,7 @@ void _reconstructPreparedTransaction(OperationContext* opCtx,
 
     // Snapshot transaction can never conflict with the PBWM lock.
     opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+    opCtx->lockState()->setShouldUseInternalTicketLane(true);
 
     // When querying indexes, we return the record matching the key if it exists, or an
     // adjacent document. This means that it is possible for us to hit a prepare conflict if
@@ -56,6 +56,8 @@
 #include "mongo/config.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/sorter/sorter_compression.h"
+#include "mongo/db/sorter/sorter_read_ahead.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
@@ -63,6 +65,7 @@
 #include "mongo/s/is_mongos.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/future.h"
 #include "mongo/util/str.h"
 #include "mongo/util/unowned_ptr.h"
 
@@ -70,6 +73,14 @@ namespace mongo {
 
 namespace {
 
+// Blocks of sorted data are written to disk after their size, which is negative if the block is
+// compressed with snappy. Blocks compressed with another compressor are preceded by this marker,
+// followed by the id of their compressor and their uncompressed size.
+constexpr int32_t kCompressedBlockMarker = std::numeric_limits<int32_t>::min();
+
+// The size of the reads of a FileIterator, which usually fetch several compressed blocks at once.
+constexpr std::streamsize kFileReadAheadBytes = 64 * 1024;
+
 /**
  * Calculates and returns a new murmur hash value based on the prior murmur hash and a new piece
  * of data.
@@ -211,7 +222,15 @@ public:
                 boost::filesystem::file_size(_fileFullPath) != 0);
     }
 
+    ~FileIterator() {
+        waitForReadAhead();
+    }
+
     void openSource() {
+        if (!_readAheadBuffer) {
+            _readAheadBuffer.reset(new char[kFileReadAheadBytes]);
+        }
+        _file.rdbuf()->pubsetbuf(_readAheadBuffer.get(), kFileReadAheadBytes);
         _file.open(_fileFullPath.c_str(), std::ios::in | std::ios::binary);
         uassert(16814,
                 str::stream() << "error opening file \"" << _fileFullPath
@@ -223,9 +242,15 @@ public:
                               << "' in file \"" << _fileFullPath
                               << "\": " << myErrnoWithDescription(),
                 _file.good());
+
+        // Starts reading the first block, so that the runs of a merge all read theirs at once.
+        if (!_bufferReader) {
+            scheduleReadAhead();
+        }
     }
 
     void closeSource() {
+        waitForReadAhead();
         _file.close();
         uassert(50969,
                 str::stream() << "error closing file \"" << _fileFullPath
@@ -279,6 +304,12 @@ public:
     }
 
 private:
+    // A block of sorted data read from disk, decrypted and decompressed.
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
     /**
      * Attempts to refill the _bufferReader if it is empty. Expects _done to be false.
      */
@@ -290,28 +321,90 @@ private:
     }
 
     /**
-     * Tries to read from disk and places any results in _bufferReader. If there is no more data to
-     * read, then _done is set to true and the function returns immediately.
+     * Replaces the buffer with the next block of the range, which was usually read ahead while the
+     * current one was consumed. If there is no more data to read, then _done is set to true and the
+     * function returns immediately.
      */
     void fillBufferFromDisk() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
-        if (_done)
+        boost::optional<Block> block;
+        if (_readAhead) {
+            auto readAhead = std::move(*_readAhead);
+            _readAhead.reset();
+            block = std::move(readAhead).get();
+        } else {
+            block = readBlock();
+        }
+
+        if (!block) {
+            _done = true;
             return;
+        }
+
+        _buffer = std::move(block->data);
+        _bufferReader.reset(new BufReader(_buffer.get(), block->size));
+        scheduleReadAhead();
+    }
+
+    /**
+     * Reads the next block of the range on the read-ahead executor. Only that task accesses the
+     * file until its result is consumed by fillBufferFromDisk() or waitForReadAhead().
+     */
+    void scheduleReadAhead() {
+        invariant(!_readAhead);
+        auto pf = makePromiseFuture<boost::optional<Block>>();
+        _readAhead.emplace(std::move(pf.future));
+
+        // Should the executor reject the task, it runs inline and reads the block all the same.
+        sorter::getReadAheadExecutor()->schedule(
+            [this, promise = std::move(pf.promise)](Status) mutable {
+                promise.setWith([&] { return readBlock(); });
+            });
+    }
+
+    /**
+     * Waits for the block being read ahead, if any, and discards it.
+     */
+    void waitForReadAhead() {
+        if (_readAhead) {
+            std::move(*_readAhead).getNoThrow().getStatus().ignore();
+            _readAhead.reset();
+        }
+    }
+
+    /**
+     * Reads the next block of the range from disk, then decrypts and decompresses it. Returns
+     * boost::none if there is no more data to read.
+     */
+    boost::optional<Block> readBlock() {
+        int32_t rawSize;
+        if (!read(&rawSize, sizeof(rawSize)))
+            return boost::none;
+
+        MessageCompressorBase* decompressor = nullptr;
+        int32_t decompressedBlockSize = 0;
+        if (rawSize == kCompressedBlockMarker) {
+            MessageCompressorId compressorId;
+            uassert(5190954,
+                    "file too short?",
+                    read(&compressorId, sizeof(compressorId)) &&
+                        read(&decompressedBlockSize, sizeof(decompressedBlockSize)) &&
+                        read(&rawSize, sizeof(rawSize)));
+            uassert(5190955, "invalid uncompressed block size", decompressedBlockSize >= 0);
+            decompressor = sorter::getSpillDecompressor(compressorId);
+        }
 
-        // negative size means compressed
+        // negative size means compressed with snappy
         const bool compressed = rawSize < 0;
         int32_t blockSize = std::abs(rawSize);
 
-        _buffer.reset(new char[blockSize]);
-        read(_buffer.get(), blockSize);
-        uassert(16816, "file too short?", !_done);
+        std::unique_ptr<char[]> buffer(new char[blockSize]);
+        uassert(16816, "file too short?", read(buffer.get(), blockSize));
 
         if (auto encryptionHooks = getEncryptionHooksIfEnabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
             size_t outLen;
             Status status =
-                encryptionHooks->unprotectTmpData(reinterpret_cast<const uint8_t*>(_buffer.get()),
+                encryptionHooks->unprotectTmpData(reinterpret_cast<const uint8_t*>(buffer.get()),
                                                   blockSize,
                                                   reinterpret_cast<uint8_t*>(out.get()),
                                                   blockSize,
@@ -321,37 +414,48 @@ private:
                     str::stream() << "Failed to unprotect data: " << status.toString(),
                     status.isOK());
             blockSize = outLen;
-            _buffer.swap(out);
+            buffer.swap(out);
+        }
+
+        if (decompressor) {
+            std::unique_ptr<char[]> decompressionBuffer(new char[decompressedBlockSize]);
+            auto decompressedSize = uassertStatusOK(decompressor->decompressData(
+                ConstDataRange(buffer.get(), blockSize),
+                DataRange(decompressionBuffer.get(), decompressedBlockSize)));
+            uassert(5190956,
+                    "decompression failed",
+                    decompressedSize == static_cast<size_t>(decompressedBlockSize));
+
+            return Block{std::move(decompressionBuffer), decompressedSize};
         }
 
         if (!compressed) {
-            _bufferReader.reset(new BufReader(_buffer.get(), blockSize));
-            return;
+            return Block{std::move(buffer), static_cast<size_t>(blockSize)};
         }
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+        dassert(snappy::IsValidCompressedBuffer(buffer.get(), blockSize));
 
         size_t uncompressedSize;
         uassert(17061,
                 "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                snappy::GetUncompressedLength(buffer.get(), blockSize, &uncompressedSize));
 
         std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
         uassert(17062,
                 "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+                snappy::RawUncompress(buffer.get(), blockSize, decompressionBuffer.get()));
 
         // hold on to decompressed data and throw out compressed data at block exit
-        _buffer.swap(decompressionBuffer);
-        _bufferReader.reset(new BufReader(_buffer.get(), uncompressedSize));
+        return Block{std::move(decompressionBuffer), uncompressedSize};
     }
 
     /**
-     * Attempts to read data from disk. Sets _done to true when file offset reaches _fileEndOffset.
+     * Attempts to read data from disk. Returns false, without reading anything, when the file
+     * offset reaches _fileEndOffset.
      *
      * Masserts on any file errors
      */
-    void read(void* out, size_t size) {
+    bool read(void* out, size_t size) {
         invariant(_file.is_open());
 
         const std::streampos offset = _file.tellg();
@@ -362,8 +466,7 @@ private:
 
         if (offset >= _fileEndOffset) {
             invariant(offset == _fileEndOffset);
-            _done = true;
-            return;
+            return false;
         }
 
         _file.read(reinterpret_cast<char*>(out), size);
@@ -372,8 +475,10 @@ private:
                               << "\": " << myErrnoWithDescription(),
                 _file.good());
         verify(_file.gcount() == static_cast<std::streamsize>(size));
+        return true;
     }
 
+
     const Settings _settings;
     bool _done;
 
@@ -382,9 +487,13 @@ private:
     std::string _fileFullPath;        // File containing the sorted data range.
     std::streampos _fileStartOffset;  // File offset at which the sorted data range starts.
     std::streampos _fileEndOffset;    // File offset at which the sorted data range ends.
+    std::unique_ptr<char[]> _readAheadBuffer;  // Must outlive _file, which reads into it.
     std::ifstream _file;
     boost::optional<std::string> _dbName;
 
+    // The next block of the range, while it is read ahead.
+    boost::optional<Future<boost::optional<Block>>> _readAhead;
+
     // Checksum value that is updated with each read of a data object from disk. We can compare
     // this value with _originalChecksum to check for data corruption if and only if the
     // FileIterator is exhausted.
@@ -400,6 +509,9 @@ private:
  * Merge-sorts results from 0 or more FileIterators, all of which should be iterating over sorted
  * ranges within the same file. This class is given the data source file name upon construction and
  * is responsible for deleting the data source file upon destruction.
+ *
+ * The inputs are merged with a tournament tree of losers, which takes a single comparison per level
+ * of the tree to replace the smallest result by the next one of its input, where a heap takes two.
  */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
@@ -413,39 +525,39 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _comp(comp) {
         for (size_t i = 0; i < iters.size(); i++) {
             iters[i]->openSource();
+        }
+        for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_unique<Stream>(i, iters[i]->next(), iters[i]));
             } else {
                 iters[i]->closeSource();
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numActiveStreams = _streams.size();
+        _tree.resize(_streams.size());
+        _tree[0] = _playMatches(1);
     }
 
     ~MergeIterator() {
         // Clear the remaining Stream objects to close the file handles. Some systems will error
         // closing the file if any file handles are still open.
-        _current.reset();
-        _heap.clear();
+        _streams.clear();
     }
 
     void openSource() {}
     void closeSource() {}
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _numActiveStreams > 1 || _winner().more()))
             return true;
 
         _remaining = 0;
@@ -459,21 +571,18 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
-        }
-
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        } else {
+            const size_t winner = _tree[0];
+            if (!_streams[winner]->advance()) {
+                verify(_numActiveStreams > 1);
+                _streams[winner].reset();
+                _numActiveStreams--;
+            }
+            _replayMatches(winner);
         }
 
-        return _current->current();
+        // The result of the winner is only compared again once its stream has advanced.
+        return _winner().takeCurrent();
     }
 
 
@@ -497,6 +606,9 @@ private:
         const Data& current() const {
             return _current;
         }
+        Data takeCurrent() {
+            return std::move(_current);
+        }
         bool more() {
             return _rest->more();
         }
@@ -515,30 +627,74 @@ private:
         std::shared_ptr<Input> _rest;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
-
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+    Stream& _winner() {
+        return *_streams[_tree[0]];
+    }
+
+    /**
+     * Returns whether the stream at index 'lhs' of '_streams' comes before the one at index 'rhs'.
+     * Exhausted streams come after all others.
+     */
+    bool _less(size_t lhs, size_t rhs) const {
+        const auto& lhsStream = _streams[lhs];
+        const auto& rhsStream = _streams[rhs];
+        if (!lhsStream || !rhsStream)
+            return !!lhsStream;
+
+        // first compare data
+        dassertCompIsSane(_comp, lhsStream->current(), rhsStream->current());
+        int ret = _comp(lhsStream->current(), rhsStream->current());
+        if (ret)
+            return ret < 0;
+
+        // then compare fileNums to ensure stability
+        return lhsStream->fileNum < rhsStream->fileNum;
+    }
+
+    /**
+     * Plays the matches of the subtree rooted at 'node' and returns the index of its winner. Node 1
+     * is the root of the tree, the children of node i are nodes 2i and 2i + 1, and the stream at
+     * index i of '_streams' is leaf n + i, where n is the number of streams.
+     */
+    size_t _playMatches(size_t node) {
+        if (node >= _streams.size())
+            return node - _streams.size();
+
+        const size_t left = _playMatches(2 * node);
+        const size_t right = _playMatches(2 * node + 1);
+        if (_less(right, left)) {
+            _tree[node] = left;
+            return right;
         }
+        _tree[node] = right;
+        return left;
+    }
 
-    private:
-        const Comparator _comp;
-    };
+    /**
+     * Replays the matches from the leaf of the stream at index 'stream' up to the root, once the
+     * stream has advanced.
+     */
+    void _replayMatches(size_t stream) {
+        size_t winner = stream;
+        for (size_t node = (stream + _streams.size()) / 2; node > 0; node /= 2) {
+            if (_less(_tree[node], winner))
+                std::swap(_tree[node], winner);
+        }
+        _tree[0] = winner;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    const Comparator _comp;
+
+    // The streams of the inputs, indexed by leaf. The streams of exhausted inputs are reset.
+    std::vector<std::unique_ptr<Stream>> _streams;
+    size_t _numActiveStreams = 0;
+
+    // _tree[0] is the index of the stream with the smallest result, and _tree[i] for i > 0 is the
+    // index of the stream which lost the match played at node i.
+    std::vector<size_t> _tree;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -625,6 +781,8 @@ public:
         }
 
         spill();
+        _nextSortedFileWriterOffset =
+            this->_mergeSpills(_comp, _settings, _nextSortedFileWriterOffset);
         return Iterator::merge(this->_iters, this->_opts, _comp);
     }
 
@@ -672,6 +830,8 @@ private:
         }
         Iterator* iteratorPtr = writer.done();
         _nextSortedFileWriterOffset = writer.getFileEndOffset();
+        this->_spilledDataSize += writer.getSpilledDataSize();
+        this->_spilledDataStorageSize += writer.getSpilledDataStorageSize();
 
         this->_iters.push_back(std::shared_ptr<Iterator>(iteratorPtr));
 
@@ -826,6 +986,8 @@ public:
         }
 
         spill();
+        _nextSortedFileWriterOffset =
+            this->_mergeSpills(_comp, _settings, _nextSortedFileWriterOffset);
         Iterator* iterator = Iterator::merge(this->_iters, this->_opts, _comp);
         _done = true;
         return iterator;
@@ -967,6 +1129,8 @@ private:
 
         Iterator* iteratorPtr = writer.done();
         _nextSortedFileWriterOffset = writer.getFileEndOffset();
+        this->_spilledDataSize += writer.getSpilledDataSize();
+        this->_spilledDataStorageSize += writer.getSpilledDataStorageSize();
         this->_iters.push_back(std::shared_ptr<Iterator>(iteratorPtr));
 
         _memUsed = 0;
@@ -1006,6 +1170,50 @@ Sorter<Key, Value>::Sorter(const SortOptions& opts, const std::string& fileName)
     invariant(!fileName.empty());
 }
 
+template <typename Key, typename Value>
+template <typename Comparator>
+std::streampos Sorter<Key, Value>::_mergeSpills(const Comparator& comp,
+                                                const Settings& settings,
+                                                std::streampos nextSortedFileWriterOffset) {
+    invariant(_opts.maxMergeFanIn > 1);
+
+    while (_iters.size() > _opts.maxMergeFanIn) {
+        std::vector<std::shared_ptr<Iterator>> mergedIters;
+        for (auto it = _iters.begin(); it != _iters.end();) {
+            const auto groupEnd =
+                it + std::min<size_t>(_opts.maxMergeFanIn, std::distance(it, _iters.end()));
+            if (std::distance(it, groupEnd) == 1) {
+                mergedIters.push_back(*it);
+                it = groupEnd;
+                continue;
+            }
+
+            // The groups are made of consecutive ranges, which keeps the merge stable.
+            SortedFileWriter<Key, Value> writer(
+                _opts, _fileFullPath, nextSortedFileWriterOffset, settings);
+            {
+                std::unique_ptr<Iterator> mergeIter(
+                    Iterator::merge(std::vector<std::shared_ptr<Iterator>>(it, groupEnd),
+                                    _opts,
+                                    comp));
+                while (mergeIter->more()) {
+                    auto next = mergeIter->next();
+                    writer.addAlreadySorted(next.first, next.second);
+                }
+            }
+
+            mergedIters.push_back(std::shared_ptr<Iterator>(writer.done()));
+            nextSortedFileWriterOffset = writer.getFileEndOffset();
+            _spilledDataSize += writer.getSpilledDataSize();
+            _spilledDataStorageSize += writer.getSpilledDataStorageSize();
+            it = groupEnd;
+        }
+        _iters = std::move(mergedIters);
+    }
+
+    return nextSortedFileWriterOffset;
+}
+
 template <typename Key, typename Value>
 typename Sorter<Key, Value>::PersistedState Sorter<Key, Value>::persistDataForShutdown() {
     spill();
@@ -1020,6 +1228,69 @@ typename Sorter<Key, Value>::PersistedState Sorter<Key, Value>::persistDataForSh
     return {_fileName, ranges};
 }
 
+template <typename Key, typename Value>
+void Sorter<Key, Value>::appendPersistedState(const SortOptions& opts,
+                                              PersistedState* state,
+                                              const PersistedState& other) {
+    invariant(!state->fileName.empty());
+    const auto fileFullPath = opts.tempDir + "/" + state->fileName;
+    const auto otherFileFullPath = opts.tempDir + "/" + other.fileName;
+    if (other.ranges.empty()) {
+        boost::filesystem::remove(otherFileFullPath);
+        return;
+    }
+
+    std::ifstream in(otherFileFullPath.c_str(), std::ios::in | std::ios::binary);
+    uassert(5190962,
+            str::stream() << "error opening file \"" << otherFileFullPath
+                          << "\": " << sorter::myErrnoWithDescription(),
+            in.good());
+
+    // The ranges are copied one after the other at the end of the file, which moves their offsets
+    // but neither their contents nor their checksums.
+    std::streamoff nextOffset = boost::filesystem::exists(fileFullPath)
+        ? boost::filesystem::file_size(fileFullPath)
+        : 0;
+    std::ofstream out(fileFullPath.c_str(), std::ios::binary | std::ios::app | std::ios::out);
+    uassert(5190963,
+            str::stream() << "error opening file \"" << fileFullPath
+                          << "\": " << sorter::myErrnoWithDescription(),
+            out.good());
+
+    const std::streamoff kCopyBufferSize = 1024 * 1024;
+    auto buffer = std::make_unique<char[]>(kCopyBufferSize);
+    for (const auto& range : other.ranges) {
+        in.seekg(range.getStartOffset());
+        for (std::streamoff remaining = range.getEndOffset() - range.getStartOffset();
+             remaining > 0;) {
+            const auto toCopy = std::min(remaining, kCopyBufferSize);
+            in.read(buffer.get(), toCopy);
+            uassert(5190964,
+                    str::stream() << "error reading file \"" << otherFileFullPath
+                                  << "\": " << sorter::myErrnoWithDescription(),
+                    in.good());
+            out.write(buffer.get(), toCopy);
+            uassert(5190965,
+                    str::stream() << "error writing to file \"" << fileFullPath
+                                  << "\": " << sorter::myErrnoWithDescription(),
+                    out.good());
+            remaining -= toCopy;
+        }
+
+        const auto length = range.getEndOffset() - range.getStartOffset();
+        state->ranges.push_back({nextOffset, nextOffset + length, range.getChecksum()});
+        nextOffset += length;
+    }
+
+    out.close();
+    uassert(5190966,
+            str::stream() << "error closing file \"" << fileFullPath
+                          << "\": " << sorter::myErrnoWithDescription(),
+            !out.fail());
+    in.close();
+    boost::filesystem::remove(otherFileFullPath);
+}
+
 //
 // SortedFileWriter
 //
@@ -1035,7 +1306,8 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
       // _file.tellp() is not initialized on all systems to reflect this. Therefore, we must also
       // pass in the expected offset to this constructor.
       _fileStartOffset(fileStartOffset),
-      _dbName(opts.dbName) {
+      _dbName(opts.dbName),
+      _compressor(sorter::getSpillCompressor()) {
 
     // This should be checked by consumers, but if we get here don't allow writes.
     uassert(
@@ -1087,14 +1359,23 @@ void SortedFileWriter<Key, Value>::spill() {
     if (size == 0)
         return;
 
-    std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
-    verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
-
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
-    if (shouldCompress) {
-        size = compressed.size();
-        outBuffer = const_cast<char*>(compressed.data());
+    _spilledDataSize += size;
+
+    std::unique_ptr<char[]> compressed;
+    bool shouldCompress = false;
+    if (_compressor) {
+        const size_t maxCompressedSize = _compressor->getMaxCompressedSize(size);
+        compressed.reset(new char[maxCompressedSize]);
+        const size_t compressedSize = uassertStatusOK(
+            _compressor->compressData(ConstDataRange(outBuffer, size),
+                                      DataRange(compressed.get(), maxCompressedSize)));
+        verify(compressedSize <= size_t(std::numeric_limits<int32_t>::max()));
+
+        shouldCompress = compressedSize < size_t(_buffer.len() / 10 * 9);
+        if (shouldCompress) {
+            size = compressedSize;
+            outBuffer = compressed.get();
+        }
     }
 
     std::unique_ptr<char[]> out;
@@ -1115,11 +1396,28 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
-    // negative size means compressed
-    size = shouldCompress ? -size : size;
+    // Snappy blocks are written as they always have been, so that the files of resumable index
+    // builds remain readable across versions. The others are preceded by their compressor.
+    const bool isSnappyBlock =
+        shouldCompress && _compressor->getId() == MessageCompressorId(MessageCompressor::kSnappy);
     try {
-        _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-        _file.write(outBuffer, std::abs(size));
+        if (shouldCompress && !isSnappyBlock) {
+            const int32_t marker = kCompressedBlockMarker;
+            const MessageCompressorId compressorId = _compressor->getId();
+            const int32_t uncompressedSize = _buffer.len();
+            _file.write(reinterpret_cast<const char*>(&marker), sizeof(marker));
+            _file.write(reinterpret_cast<const char*>(&compressorId), sizeof(compressorId));
+            _file.write(reinterpret_cast<const char*>(&uncompressedSize),
+                        sizeof(uncompressedSize));
+            _spilledDataStorageSize +=
+                sizeof(marker) + sizeof(compressorId) + sizeof(uncompressedSize);
+        }
+
+        // negative size means compressed with snappy
+        const int32_t rawSize = isSnappyBlock ? -size : size;
+        _file.write(reinterpret_cast<const char*>(&rawSize), sizeof(rawSize));
+        _file.write(outBuffer, size);
+        _spilledDataStorageSize += sizeof(rawSize) + size;
     } catch (const std::exception&) {
         msgasserted(16821,
                     str::stream() << "error writing to file \"" << _fileFullPath
@@ -40,6 +40,7 @@
 
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/sorter/sorter_gen.h"
+#include "mongo/transport/message_compressor_base.h"
 #include "mongo/util/bufreader.h"
 
 /**
@@ -114,7 +115,16 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // The maximum number of spilled ranges merged at once. When more ranges were spilled, they are
+    // first merged by groups into fewer, larger ranges, which bounds the number of files open and
+    // the memory used by the final merge.
+    size_t maxMergeFanIn;
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          maxMergeFanIn(256) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -142,6 +152,11 @@ struct SortOptions {
         dbName = std::move(newDbName);
         return *this;
     }
+
+    SortOptions& MaxMergeFanIn(size_t newMaxMergeFanIn) {
+        maxMergeFanIn = newMaxMergeFanIn;
+        return *this;
+    }
 };
 
 /**
@@ -281,16 +296,51 @@ public:
         return _totalDataSizeSorted;
     }
 
+    /**
+     * The size of the data spilled to disk, before and after it was compressed.
+     */
+    uint64_t spilledDataSize() const {
+        return _spilledDataSize;
+    }
+
+    uint64_t spilledDataStorageSize() const {
+        return _spilledDataStorageSize;
+    }
+
     PersistedState persistDataForShutdown();
 
+    /**
+     * Appends the ranges of 'other', persisted by another Sorter to a file of 'opts.tempDir', to
+     * the file of 'state', as they are and without reading them back, and removes the file of
+     * 'other'. The ranges of 'state' then refer to the data of both.
+     */
+    static void appendPersistedState(const SortOptions& opts,
+                                     PersistedState* state,
+                                     const PersistedState& other);
+
+    /**
+     * Writes the data held in memory to disk, which requires external sorting to be allowed.
+     */
+    virtual void spill() = 0;
+
 protected:
     Sorter() {}  // can only be constructed as a base
 
-    virtual void spill() = 0;
+    /**
+     * Merges the spilled ranges by groups of at most 'maxMergeFanIn' ranges, each into a single
+     * range appended to the file at 'nextSortedFileWriterOffset', until no more than
+     * 'maxMergeFanIn' ranges are left. Returns the offset at which the file now ends.
+     */
+    template <typename Comparator>
+    std::streampos _mergeSpills(const Comparator& comp,
+                                const Settings& settings,
+                                std::streampos nextSortedFileWriterOffset);
 
     size_t _numSpills = 0;  // Keeps track of the number of times data was spilled to disk.
     size_t _numSorted = 0;  // Keeps track of the number of keys sorted.
     uint64_t _totalDataSizeSorted = 0;  // Keeps track of the total size of data sorted.
+    uint64_t _spilledDataSize = 0;         // Size of the data spilled to disk, uncompressed.
+    uint64_t _spilledDataStorageSize = 0;  // Number of bytes written to disk by spills.
 
     // Whether the files written by this Sorter should be kept on destruction.
     bool _shouldKeepFilesOnDestruction = false;
@@ -344,6 +394,17 @@ public:
         return _fileEndOffset;
     }
 
+    /**
+     * The size of the data written so far, before and after it was compressed.
+     */
+    uint64_t getSpilledDataSize() const {
+        return _spilledDataSize;
+    }
+
+    uint64_t getSpilledDataStorageSize() const {
+        return _spilledDataStorageSize;
+    }
+
 private:
     void spill();
 
@@ -363,6 +424,12 @@ private:
     std::streampos _fileEndOffset;
 
     boost::optional<std::string> _dbName;
+
+    // Compresses the blocks written to disk. Might be NULL, owned elsewhere.
+    MessageCompressorBase* const _compressor;
+
+    uint64_t _spilledDataSize = 0;
+    uint64_t _spilledDataStorageSize = 0;
 };
 }  // namespace mongo
 
@@ -0,0 +1,205 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+#include <random>
+
+#include "mongo/db/sorter/sorter.h"
+#include "mongo/db/sorter/sorter_compression_gen.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+/**
+ * Generates a new file name on each call using a static, atomic and monotonically increasing
+ * number. See the comment of the same function in sorter_test.cpp.
+ */
+std::string nextFileName() {
+    static AtomicWord<unsigned> sorterBenchmarkFileCounter;
+    return "extsort-sorter-bm." + std::to_string(sorterBenchmarkFileCounter.fetchAndAdd(1));
+}
+
+}  // namespace mongo
+
+// Need access to internal classes
+#include "mongo/db/sorter/sorter.cpp"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+const int kNumKeys = 500 * 1000;
+const std::array<const char*, 4> kCompressorNames{"none", "snappy", "zlib", "zstd"};
+
+using KeyStringFileWriter = SortedFileWriter<KeyString::Value, NullValue>;
+using KeyStringSorter = Sorter<KeyString::Value, NullValue>;
+
+struct KeyStringComparator {
+    int operator()(const KeyStringSorter::Data& lhs, const KeyStringSorter::Data& rhs) const {
+        return lhs.first.compare(rhs.first);
+    }
+};
+
+/**
+ * A temporary directory for the files of the sorters, removed with its content on destruction.
+ */
+class TempDir {
+public:
+    TempDir()
+        : _path(boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path("sorter-bm-%%%%-%%%%-%%%%")) {
+        boost::filesystem::create_directories(_path);
+    }
+
+    ~TempDir() {
+        boost::filesystem::remove_all(_path);
+    }
+
+    std::string path() const {
+        return _path.string();
+    }
+
+private:
+    const boost::filesystem::path _path;
+};
+
+/**
+ * Makes the keys an index build on {customerId: 1, status: 1} inserts into its sorter, in order.
+ */
+std::vector<KeyString::Value> makeIndexKeys() {
+    const auto ordering = Ordering::make(BSONObj());
+    std::vector<KeyString::Value> keys;
+    keys.reserve(kNumKeys);
+    for (int i = 0; i < kNumKeys; ++i) {
+        const BSONObj key = BSON("" << i / 16 << ""
+                                    << (i % 16 < 12 ? "delivered" : "pending"));
+        keys.push_back(
+            KeyString::Builder(KeyString::Version::kLatestVersion, key, ordering, RecordId(i))
+                .getValueCopy());
+    }
+    return keys;
+}
+
+/**
+ * Spills the keys of an index build into a single sorted run with the compressor at index
+ * 'state.range(0)' of 'kCompressorNames', then reads the run back. Reports the ratio between the
+ * size of the spilled data and the number of bytes written to disk for it.
+ */
+void BM_SpillAndReadBackIndexKeys(benchmark::State& state) {
+    const auto compressorName = kCompressorNames[state.range(0)];
+    const auto originalCompressor = gSorterSpillCompressor;
+    gSorterSpillCompressor = compressorName;
+    ON_BLOCK_EXIT([&] { gSorterSpillCompressor = originalCompressor; });
+
+    const TempDir tempDir;
+    const auto keys = makeIndexKeys();
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+    const KeyStringFileWriter::Settings settings{{KeyString::Version::kLatestVersion}, {}};
+    uint64_t spilledDataSize = 0;
+    uint64_t spilledDataStorageSize = 0;
+    for (auto keepRunning : state) {
+        const std::string fileName = opts.tempDir + "/" + nextFileName();
+        KeyStringFileWriter writer(opts, fileName, 0, settings);
+        for (const auto& key : keys) {
+            writer.addAlreadySorted(key, {});
+        }
+
+        std::unique_ptr<KeyStringFileWriter::Iterator> iter(writer.done());
+        iter->openSource();
+        while (iter->more()) {
+            benchmark::DoNotOptimize(iter->next());
+        }
+        iter->closeSource();
+
+        spilledDataSize = writer.getSpilledDataSize();
+        spilledDataStorageSize = writer.getSpilledDataStorageSize();
+        boost::filesystem::remove(fileName);
+    }
+
+    state.SetLabel(compressorName);
+    state.SetItemsProcessed(state.iterations() * kNumKeys);
+    state.SetBytesProcessed(state.iterations() * spilledDataSize);
+    state.counters["spilledDataStorageSize"] = spilledDataStorageSize;
+    state.counters["compressionRatio"] =
+        static_cast<double>(spilledDataSize) / std::max<uint64_t>(spilledDataStorageSize, 1);
+}
+
+BENCHMARK(BM_SpillAndReadBackIndexKeys)->DenseRange(0, kCompressorNames.size() - 1);
+
+/**
+ * Sorts the keys of an index build, inserted in a random order, with as little memory as makes the
+ * sorter spill about 'state.range(0)' runs, and times the merge of the runs. Above the fan-in of
+ * the merge, the runs are first merged by groups into fewer runs.
+ */
+void BM_MergeSpilledRuns(benchmark::State& state) {
+    const TempDir tempDir;
+    auto keys = makeIndexKeys();
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+
+    size_t memUsage = 0;
+    for (const auto& key : keys) {
+        memUsage += key.memUsageForSorter();
+    }
+    const SortOptions opts = SortOptions()
+                                 .TempDir(tempDir.path())
+                                 .ExtSortAllowed()
+                                 .MaxMemoryUsageBytes(memUsage / state.range(0));
+    const KeyStringSorter::Settings settings{{KeyString::Version::kLatestVersion}, {}};
+
+    size_t numSpills = 0;
+    for (auto keepRunning : state) {
+        state.PauseTiming();
+        std::unique_ptr<KeyStringSorter> sorter(
+            KeyStringSorter::make(opts, KeyStringComparator(), settings));
+        for (const auto& key : keys) {
+            sorter->add(key, {});
+        }
+        state.ResumeTiming();
+
+        std::unique_ptr<KeyStringSorter::Iterator> iter(sorter->done());
+        while (iter->more()) {
+            benchmark::DoNotOptimize(iter->next());
+        }
+        numSpills = sorter->numSpills();
+    }
+
+    state.SetItemsProcessed(state.iterations() * kNumKeys);
+    state.counters["runs"] = numSpills;
+}
+
+BENCHMARK(BM_MergeSpilledRuns)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sorter
+}  // namespace mongo
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter_compression.h"
+
+#include <array>
+
+#include "mongo/db/sorter/sorter_compression_gen.h"
+#include "mongo/transport/message_compressor_snappy.h"
+#include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+constexpr auto kNoCompressorName = "none"_sd;
+
+// The compressors are stateless, so one instance of each is shared by all the sorters.
+const std::array<MessageCompressorBase*, 3>& getCompressors() {
+    static SnappyMessageCompressor snappyCompressor;
+    static ZlibMessageCompressor zlibCompressor;
+    static ZstdMessageCompressor zstdCompressor;
+    static const std::array<MessageCompressorBase*, 3> compressors{
+        &snappyCompressor, &zlibCompressor, &zstdCompressor};
+    return compressors;
+}
+
+MessageCompressorBase* findCompressor(StringData name) {
+    for (auto compressor : getCompressors()) {
+        if (compressor->getName() == name) {
+            return compressor;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+MessageCompressorBase* getSpillCompressor() {
+    if (gSorterSpillCompressor == kNoCompressorName) {
+        return nullptr;
+    }
+    auto compressor = findCompressor(gSorterSpillCompressor);
+    invariant(compressor);
+    return compressor;
+}
+
+MessageCompressorBase* getSpillDecompressor(MessageCompressorId id) {
+    for (auto compressor : getCompressors()) {
+        if (compressor->getId() == id) {
+            return compressor;
+        }
+    }
+    uasserted(5190953,
+              str::stream() << "Sorted data was compressed with an unknown compressor: "
+                            << static_cast<int>(id));
+}
+
+Status validateSpillCompressor(const std::string& name) {
+    if (name != kNoCompressorName && !findCompressor(name)) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Unknown compressor '" << name
+                              << "', expected one of 'snappy', 'zstd', 'zlib' or 'none'"};
+    }
+    return Status::OK();
+}
+
+}  // namespace sorter
+}  // namespace mongo
@@ -39,12 +39,15 @@
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/sorter/sorter_compression.h"
+#include "mongo/db/sorter/sorter_compression_gen.h"
 #include "mongo/logv2/log.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 
 namespace mongo {
@@ -359,6 +362,16 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 std::make_shared<LimitIterator>(10, std::make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test more inputs than a power of two
+            std::vector<std::shared_ptr<IWIterator>> iterators;
+            for (int i = 0; i < 100; i++) {
+                iterators.push_back(std::make_shared<IntIterator>(i, 10000, 100));
+            }
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(iterators, SortOptions(), IWComparator(ASC)));
+
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, std::make_shared<IntIterator>(0, 10000, 1));
+        }
     }
 };
 
@@ -649,6 +662,22 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+// Spills enough ranges for them to be merged in several passes before the final merge.
+template <bool Random = true>
+class LotsOfDataSmallMergeFanIn : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return Parent::adjustSortOptions(opts).MaxMergeFanIn(kMaxMergeFanIn);
+    }
+    size_t correctNumRanges() const override {
+        // Between 49 and 64 ranges are spilled, which two passes merge into 16 then 4 ranges.
+        MONGO_STATIC_ASSERT((Parent::NUM_ITEMS * sizeof(IWPair)) / Parent::MEM_LIMIT + 1 > 48);
+        MONGO_STATIC_ASSERT((Parent::NUM_ITEMS * sizeof(IWPair)) / Parent::MEM_LIMIT + 1 <= 64);
+        return kMaxMergeFanIn;
+    }
+    static constexpr size_t kMaxMergeFanIn = 4;
+};
 }  // namespace SorterTests
 
 class SorterSuite : public mongo::unittest::OldStyleSuiteSpecification {
@@ -667,6 +696,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataSmallMergeFanIn</*random=*/false>>();
+        add<SorterTests::LotsOfDataSmallMergeFanIn</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -864,6 +895,100 @@ TEST_F(SorterMakeFromExistingRangesTest, RoundTrip) {
     }
 }
 
+TEST_F(SorterMakeFromExistingRangesTest, AppendPersistedState) {
+    unittest::TempDir tempDir(_agent.getSuiteName() + "_" + _agent.getTestName());
+
+    auto opts = SortOptions()
+                    .ExtSortAllowed()
+                    .TempDir(tempDir.path())
+                    .MaxMemoryUsageBytes(sizeof(IWSorter::Data));
+
+    // Each Sorter spills several ranges, which interleave with those of the other one.
+    IWSorter::PersistedState state;
+    IWSorter::PersistedState otherState;
+    {
+        auto sorter = std::unique_ptr<IWSorter>(IWSorter::make(opts, IWComparator(ASC)));
+        auto otherSorter = std::unique_ptr<IWSorter>(IWSorter::make(opts, IWComparator(ASC)));
+        for (int i = 0; i < 10; ++i) {
+            sorter->add(2 * i, -2 * i);
+            otherSorter->add(2 * i + 1, -2 * i - 1);
+        }
+        state = sorter->persistDataForShutdown();
+        otherState = otherSorter->persistDataForShutdown();
+    }
+    ASSERT_GT(state.ranges.size(), 1U);
+    ASSERT_GT(otherState.ranges.size(), 1U);
+
+    const auto numRanges = state.ranges.size() + otherState.ranges.size();
+    IWSorter::appendPersistedState(opts, &state, otherState);
+    ASSERT_EQ(numRanges, state.ranges.size());
+    ASSERT_FALSE(boost::filesystem::exists(tempDir.path() + "/" + otherState.fileName));
+
+    auto sorter = std::unique_ptr<IWSorter>(
+        IWSorter::makeFromExistingRanges(state.fileName, state.ranges, opts, IWComparator(ASC)));
+    auto iter = std::unique_ptr<IWIterator>(sorter->done());
+    iter->openSource();
+    for (int i = 0; i < 20; ++i) {
+        ASSERT(iter->more());
+        auto pair = iter->next();
+        ASSERT_EQUALS(i, pair.first) << pair.first << "/" << pair.second;
+        ASSERT_EQUALS(-i, pair.second) << pair.first << "/" << pair.second;
+    }
+    ASSERT_FALSE(iter->more());
+    iter->closeSource();
+}
+
+TEST(SortedFileWriterCompressionTest, RoundTripWithEachCompressor) {
+    unittest::TempDir tempDir("sortedFileWriterCompressionTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+    const auto originalCompressor = gSorterSpillCompressor;
+    ON_BLOCK_EXIT([&] { gSorterSpillCompressor = originalCompressor; });
+
+    // Long runs of equal keys compress well with any compressor.
+    const int kNumPairs = 100 * 1000;
+    uint64_t uncompressedStorageSize = 0;
+    for (auto compressorName : {"none", "snappy", "zlib", "zstd"}) {
+        gSorterSpillCompressor = compressorName;
+        std::string fileName = opts.tempDir + "/" + nextFileName();
+        SortedFileWriter<IntWrapper, IntWrapper> writer(opts, fileName, 0);
+        for (int i = 0; i < kNumPairs; i++) {
+            writer.addAlreadySorted(i / 1000, 0);
+        }
+
+        std::unique_ptr<IWIterator> iter(writer.done());
+        iter->openSource();
+        for (int i = 0; i < kNumPairs; i++) {
+            ASSERT(iter->more()) << compressorName;
+            auto pair = iter->next();
+            ASSERT_EQ(i / 1000, pair.first) << compressorName;
+            ASSERT_EQ(0, pair.second) << compressorName;
+        }
+        ASSERT_FALSE(iter->more()) << compressorName;
+        iter->closeSource();
+
+        ASSERT_EQ(kNumPairs * 2 * sizeof(int), writer.getSpilledDataSize()) << compressorName;
+        ASSERT_EQ(boost::filesystem::file_size(fileName), writer.getSpilledDataStorageSize())
+            << compressorName;
+        if (!uncompressedStorageSize) {
+            uncompressedStorageSize = writer.getSpilledDataStorageSize();
+            ASSERT_GT(uncompressedStorageSize, writer.getSpilledDataSize());
+        } else {
+            ASSERT_LT(writer.getSpilledDataStorageSize(), uncompressedStorageSize / 10)
+                << compressorName;
+        }
+
+        ASSERT_TRUE(boost::filesystem::remove(fileName));
+    }
+}
+
+TEST(SortedFileWriterCompressionTest, UnknownCompressor) {
+    ASSERT_OK(validateSpillCompressor("zstd"));
+    ASSERT_OK(validateSpillCompressor("none"));
+    ASSERT_EQ(ErrorCodes::BadValue, validateSpillCompressor("noop"));
+    const auto noopId = static_cast<MessageCompressorId>(MessageCompressor::kNoop);
+    ASSERT_THROWS_CODE(getSpillDecompressor(noopId), DBException, 5190953);
+}
+
 }  // namespace
 }  // namespace sorter
 }  // namespace mongo
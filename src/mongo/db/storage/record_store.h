@@ -29,7 +29,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <boost/optional.hpp>
+#include <numeric>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -173,6 +176,40 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Seeks to the Records with the provided ids, returning them in the same order as 'ids', with
+     * boost::none for the ids which have no Record.
+     *
+     * The Records are looked up in increasing order of their ids rather than in the order of
+     * 'ids', so that the cursor moves forward through the record store and Records which are
+     * close to each other are read together. Since every lookup repositions the cursor, the data
+     * of the returned Records is always owned. The resulting position of the cursor is
+     * unspecified.
+     */
+    virtual std::vector<boost::optional<Record>> seekExactBatch(const std::vector<RecordId>& ids) {
+        std::vector<size_t> order(ids.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return ids[lhs] < ids[rhs];
+        });
+
+        std::vector<boost::optional<Record>> records(ids.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            auto& record = records[order[i]];
+            if (i > 0 && ids[order[i]] == ids[order[i - 1]]) {
+                // Only look up once an id which is in the batch several times.
+                record = records[order[i - 1]];
+                continue;
+            }
+
+            record = seekExact(ids[order[i]]);
+            if (record) {
+                record->data.makeOwned();
+            }
+        }
+        return records;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
@@ -304,6 +341,18 @@ public:
         return true;
     }
 
+    /**
+     * Looks up the Records with the provided ids, returning them in the same order as 'ids', with
+     * boost::none for the ids which have no Record. The data of the returned Records is owned.
+     *
+     * Prefer this to calling findRecord() for each id when looking up many Records at once, see
+     * SeekableRecordCursor::seekExactBatch().
+     */
+    std::vector<boost::optional<Record>> findRecords(OperationContext* opCtx,
+                                                     const std::vector<RecordId>& ids) const {
+        return getCursor(opCtx)->seekExactBatch(ids);
+    }
+
     virtual void deleteRecord(OperationContext* opCtx, const RecordId& dl) = 0;
 
     /**
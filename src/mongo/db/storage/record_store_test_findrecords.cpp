@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/record_store_test_harness.h"
+
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_data.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// Insert multiple records and verify that findRecords() returns them in the order of the
+// requested RecordIds, including ids which are requested several times or have no record.
+TEST(RecordStoreTestHarness, FindRecords) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    std::unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10;
+    RecordId locs[nToInsert];
+    for (int i = 0; i < nToInsert; i++) {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        std::string data = "record----" + std::to_string(i);
+
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res =
+            rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp());
+        ASSERT_OK(res.getStatus());
+        locs[i] = res.getValue();
+        uow.commit();
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        rs->deleteRecord(opCtx.get(), locs[5]);
+        uow.commit();
+    }
+
+    // The RecordIds are requested out of order, with a duplicate and a deleted record.
+    std::vector<int> indexes{7, 2, 9, 5, 0, 2, 4};
+    std::vector<RecordId> ids;
+    for (int i : indexes) {
+        ids.push_back(locs[i]);
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto records = rs->findRecords(opCtx.get(), ids);
+    ASSERT_EQUALS(ids.size(), records.size());
+    for (size_t i = 0; i < indexes.size(); i++) {
+        if (indexes[i] == 5) {
+            ASSERT_FALSE(records[i]);
+            continue;
+        }
+
+        std::string data = "record----" + std::to_string(indexes[i]);
+        ASSERT(records[i]);
+        ASSERT_EQUALS(ids[i], records[i]->id);
+        ASSERT(records[i]->data.isOwned());
+        ASSERT_EQUALS(data.size() + 1, static_cast<size_t>(records[i]->data.size()));
+        ASSERT_EQUALS(data, records[i]->data.data());
+    }
+
+    ASSERT(rs->findRecords(opCtx.get(), {}).empty());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -261,6 +261,126 @@ TicketHolder openWriteTransaction(128);
 TicketHolder openReadTransaction(128);
 }  // namespace
 
+/**
+ * Periodically adjusts the number of read and write tickets when
+ * 'wiredTigerConcurrentTransactionsAdaptiveSizing' is enabled. The number of tickets released per
+ * second is used as the measure of throughput, and the ticket count of each holder hill-climbs
+ * towards the value maximizing it: the count keeps moving in the same direction for as long as the
+ * throughput does not drop, and reverses direction otherwise.
+ *
+ * A ticket holder which is not saturated, i.e. which has tickets available and nobody waiting for
+ * them, is left alone, as its throughput is not limited by the number of tickets.
+ */
+class WiredTigerKVEngine::WiredTigerTicketSizer : public BackgroundJob {
+public:
+    WiredTigerTicketSizer() : BackgroundJob(false /* deleteSelf */) {}
+
+    virtual string name() const {
+        return "WTTicketSizer";
+    }
+
+    virtual void run() {
+        ThreadClient tc(name(), getGlobalServiceContext());
+        LOGV2_DEBUG(5190920, 1, "starting {name} thread", "name"_attr = name());
+
+        HolderState writeState(&openWriteTransaction);
+        HolderState readState(&openReadTransaction);
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<Latch> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _condvar.wait_for(lock, kInterval.toSystemDuration());
+            }
+
+            if (!gWiredTigerConcurrentTransactionsAdaptiveSizing.load()) {
+                writeState.reset();
+                readState.reset();
+                continue;
+            }
+            writeState.adjust();
+            readState.adjust();
+        }
+        LOGV2_DEBUG(5190921, 1, "stopping {name} thread", "name"_attr = name());
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        {
+            stdx::unique_lock<Latch> lock(_mutex);
+            _condvar.notify_one();
+        }
+        wait();
+    }
+
+private:
+    static constexpr Seconds kInterval{1};
+
+    // A drop in throughput smaller than this fraction is considered noise and does not reverse
+    // the direction in which the ticket count moves.
+    static constexpr double kThroughputTolerance = 0.05;
+
+    struct HolderState {
+        explicit HolderState(TicketHolder* holder) : holder(holder) {
+            reset();
+        }
+
+        void reset() {
+            lastReleased = holder->numReleased();
+            lastThroughput = 0;
+            direction = 1;
+        }
+
+        void adjust() {
+            auto released = holder->numReleased();
+            auto throughput = static_cast<double>(released - lastReleased);
+            lastReleased = released;
+
+            auto minTickets = gWiredTigerConcurrentTransactionsAdaptiveMin.load();
+            auto maxTickets =
+                std::max(minTickets, gWiredTigerConcurrentTransactionsAdaptiveMax.load());
+            auto current = holder->outof();
+            auto saturated = holder->numQueued() > 0 || holder->available() == 0;
+            if (!saturated && current >= minTickets && current <= maxTickets) {
+                lastThroughput = throughput;
+                return;
+            }
+
+            if (throughput < lastThroughput * (1 - kThroughputTolerance)) {
+                direction = -direction;
+            }
+            lastThroughput = throughput;
+
+            auto step = std::max(1, current / 8);
+            auto target = std::clamp(current + direction * step, minTickets, maxTickets);
+            if (target != current) {
+                LOGV2_DEBUG(5190922,
+                            2,
+                            "Adjusting the number of tickets",
+                            "from"_attr = current,
+                            "to"_attr = target,
+                            "throughput"_attr = throughput);
+                invariant(holder->resize(target));
+            }
+        }
+
+        TicketHolder* const holder;
+        long long lastReleased;
+        double lastThroughput;
+        int direction;
+    };
+
+    AtomicWord<bool> _shuttingDown{false};
+
+    Mutex _mutex = MONGO_MAKE_LATCH("WiredTigerTicketSizer::_mutex");  // protects _condvar
+    stdx::condition_variable _condvar;
+};
+
+Status WiredTigerKVEngine::onUpdateLongLaneRatio(const double& ratio) {
+    openWriteTransaction.setLongLaneRatio(ratio);
+    openReadTransaction.setLongLaneRatio(ratio);
+    return Status::OK();
+}
+
 OpenWriteTransactionParam::OpenWriteTransactionParam(StringData name, ServerParameterType spt)
     : ServerParameter(name, spt), _data(&openWriteTransaction) {}
 
@@ -510,6 +630,10 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sessionSweeper = std::make_unique<WiredTigerSessionSweeper>(_sessionCache.get());
     _sessionSweeper->go();
 
+    onUpdateLongLaneRatio(gWiredTigerConcurrentTransactionsLongLaneRatio.load()).ignore();
+    _ticketSizer = std::make_unique<WiredTigerTicketSizer>();
+    _ticketSizer->go();
+
     // Until the Replication layer installs a real callback, prevent truncating the oplog.
     setOldestActiveTransactionTimestampCallback(
         [](Timestamp) { return StatusWith(boost::make_optional(Timestamp::min())); });
@@ -593,6 +717,11 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        bbb.append("queued", openWriteTransaction.numQueued());
+        {
+            BSONObjBuilder lanes(bbb.subobjStart("lanes"));
+            openWriteTransaction.appendLaneStats(&lanes);
+        }
         bbb.done();
     }
     {
@@ -600,6 +729,11 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        bbb.append("queued", openReadTransaction.numQueued());
+        {
+            BSONObjBuilder lanes(bbb.subobjStart("lanes"));
+            openReadTransaction.appendLaneStats(&lanes);
+        }
         bbb.done();
     }
     bb.done();
@@ -712,6 +846,9 @@ void WiredTigerKVEngine::cleanShutdown() {
         _sessionSweeper->shutdown();
         LOGV2(22319, "Finished shutting down session sweeper thread");
     }
+    if (_ticketSizer) {
+        _ticketSizer->shutdown();
+    }
     LOGV2_FOR_RECOVERY(23988,
                        2,
                        "Shutdown timestamps.",
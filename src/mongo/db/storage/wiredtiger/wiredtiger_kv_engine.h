@@ -302,6 +302,12 @@ public:
 
     static void appendGlobalStats(BSONObjBuilder& b);
 
+    /**
+     * Applies a new value of 'wiredTigerConcurrentTransactionsLongLaneRatio' to the read and write
+     * ticket holders.
+     */
+    static Status onUpdateLongLaneRatio(const double& ratio);
+
     Timestamp getStableTimestamp() const override;
     Timestamp getOldestTimestamp() const override;
     Timestamp getCheckpointTimestamp() const override;
@@ -355,6 +361,7 @@ public:
 
 private:
     class WiredTigerSessionSweeper;
+    class WiredTigerTicketSizer;
 
     struct IdentToDrop {
         std::string uri;
@@ -449,6 +456,8 @@ private:
 
     std::unique_ptr<WiredTigerSessionSweeper> _sessionSweeper;
 
+    std::unique_ptr<WiredTigerTicketSizer> _ticketSizer;
+
     std::string _rsOptions;
     std::string _indexOptions;
 
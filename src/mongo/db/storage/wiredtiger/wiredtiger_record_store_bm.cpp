@@ -0,0 +1,189 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <random>
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/repl/replication_coordinator_mock.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/clock_source_mock.h"
+
+namespace mongo {
+namespace {
+
+const int kNumRecords = 100 * 1000;
+const int kRecordSize = 256;
+
+/**
+ * A WiredTiger record store holding 'kNumRecords' records of 'kRecordSize' bytes, in an engine
+ * whose cache is 'cacheSizeMB' large.
+ */
+class WiredTigerRecordStoreHelper : public ScopedGlobalServiceContextForTest {
+public:
+    explicit WiredTigerRecordStoreHelper(size_t cacheSizeMB)
+        : _dbpath("wt_test"),
+          _engine(kWiredTigerEngineName,
+                  _dbpath.path(),
+                  &_cs,
+                  "",
+                  cacheSizeMB,
+                  0,
+                  false,
+                  false,
+                  false,
+                  false) {
+        repl::ReplicationCoordinator::set(getServiceContext(),
+                                          std::make_unique<repl::ReplicationCoordinatorMock>(
+                                              getServiceContext(), repl::ReplSettings()));
+        _engine.notifyStartupComplete();
+
+        const std::string ns = "a.b";
+        auto opCtx = newOperationContext();
+        auto ru = checked_cast<WiredTigerRecoveryUnit*>(opCtx->recoveryUnit());
+        auto config = uassertStatusOK(WiredTigerRecordStore::generateCreateString(
+            kWiredTigerEngineName, ns, CollectionOptions(), ""));
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            WT_SESSION* s = ru->getSession()->getSession();
+            const auto uri = WiredTigerKVEngine::kTableUriPrefix + ns;
+            invariantWTOK(s->create(s, uri.c_str(), config.c_str()));
+            uow.commit();
+        }
+
+        WiredTigerRecordStore::Params params;
+        params.ns = ns;
+        params.ident = ns;
+        params.engineName = kWiredTigerEngineName;
+        params.isCapped = false;
+        params.isEphemeral = false;
+        params.cappedMaxSize = -1;
+        params.cappedMaxDocs = -1;
+        params.cappedCallback = nullptr;
+        params.sizeStorer = nullptr;
+        params.isReadOnly = false;
+        params.tracksSizeAdjustments = true;
+        auto rs = std::make_unique<StandardWiredTigerRecordStore>(&_engine, opCtx.get(), params);
+        rs->postConstructorInit(opCtx.get());
+        _rs = std::move(rs);
+
+        const std::string data(kRecordSize - 1, 'x');
+        const int kRecordsPerWrite = 1000;
+        for (int i = 0; i < kNumRecords; i += kRecordsPerWrite) {
+            WriteUnitOfWork uow(opCtx.get());
+            for (int j = 0; j < kRecordsPerWrite; ++j) {
+                _recordIds.push_back(uassertStatusOK(
+                    _rs->insertRecord(opCtx.get(), data.c_str(), kRecordSize, Timestamp())));
+            }
+            uow.commit();
+        }
+    }
+
+    std::unique_ptr<OperationContext> newOperationContext() {
+        return std::make_unique<OperationContextNoop>(_engine.newRecoveryUnit());
+    }
+
+    RecordStore* getRecordStore() const {
+        return _rs.get();
+    }
+
+    /**
+     * Returns the ids of the records, in the order of a secondary index on a field whose values are
+     * not correlated with the insertion order.
+     */
+    std::vector<RecordId> getShuffledRecordIds() const {
+        auto recordIds = _recordIds;
+        std::shuffle(recordIds.begin(), recordIds.end(), std::mt19937(1));
+        return recordIds;
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    ClockSourceMock _cs;
+    WiredTigerKVEngine _engine;
+    std::unique_ptr<RecordStore> _rs;
+    std::vector<RecordId> _recordIds;
+};
+
+/**
+ * Benchmarks looking up the records of a FETCH stage whose child returns the record ids of the
+ * whole collection in random order, with 'internalQueryFetchBatchSize' set to state.range(1), in
+ * an engine whose cache is state.range(0) MB large. A batch size of 1 looks up each record as soon
+ * as its id is returned, without copying it. A larger one looks up the records of a batch in
+ * record id order, and copies them.
+ */
+void BM_FetchRecords(benchmark::State& state) {
+    WiredTigerRecordStoreHelper helper(state.range(0));
+    const auto recordIds = helper.getShuffledRecordIds();
+    const size_t batchSize = state.range(1);
+
+    auto opCtx = helper.newOperationContext();
+    auto cursor = helper.getRecordStore()->getCursor(opCtx.get());
+    size_t nextRecordId = 0;
+    std::vector<RecordId> batch;
+    for (auto keepRunning : state) {
+        if (nextRecordId + batchSize > recordIds.size()) {
+            nextRecordId = 0;
+        }
+        if (batchSize == 1) {
+            benchmark::DoNotOptimize(cursor->seekExact(recordIds[nextRecordId]));
+        } else {
+            batch.assign(recordIds.begin() + nextRecordId,
+                         recordIds.begin() + nextRecordId + batchSize);
+            benchmark::DoNotOptimize(cursor->seekExactBatch(batch));
+        }
+        nextRecordId += batchSize;
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+
+void FetchRecordsArgs(benchmark::internal::Benchmark* b) {
+    // The collection is 25MB large, which fits in a cache of 256MB but not in one of 1MB.
+    for (int cacheSizeMB : {1, 256}) {
+        for (int batchSize : {1, 4, 16, 64, 256}) {
+            b->Args({cacheSizeMB, batchSize});
+        }
+    }
+}
+
+BENCHMARK(BM_FetchRecords)->Apply(FetchRecordsArgs);
+
+}  // namespace
+}  // namespace mongo
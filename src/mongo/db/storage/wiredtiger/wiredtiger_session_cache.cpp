@@ -374,9 +374,12 @@ void WiredTigerSessionCache::notifyPreparedUnitOfWorkHasCommittedOrAborted() {
 
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<Latch> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
+    for (auto& stripe : _stripes) {
+        stdx::lock_guard<Latch> lock(stripe.mutex);
+        _moveSlotSessionToList(lock, stripe);
+        for (auto session : stripe.sessions) {
+            session->closeAllCursors(uri);
+        }
     }
 }
 
@@ -384,15 +387,21 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<Latch> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
+    for (auto& stripe : _stripes) {
+        stdx::lock_guard<Latch> lock(stripe.mutex);
+        _moveSlotSessionToList(lock, stripe);
+        for (auto session : stripe.sessions) {
+            session->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
 size_t WiredTigerSessionCache::getIdleSessionsCount() {
-    stdx::lock_guard<Latch> lock(_cacheLock);
-    return _sessions.size();
+    size_t count = 0;
+    for (auto& stripe : _stripes) {
+        count += stripe.numSessions.load() + (stripe.slot.load() ? 1 : 0);
+    }
+    return count;
 }
 
 void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
@@ -404,19 +413,22 @@ void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
     auto cutoffTime = _clockSource->now() - Milliseconds(idleTimeMillis);
     SessionCache sessionsToClose;
 
-    {
-        stdx::lock_guard<Latch> lock(_cacheLock);
+    for (auto& stripe : _stripes) {
+        stdx::lock_guard<Latch> lock(stripe.mutex);
+        _moveSlotSessionToList(lock, stripe);
+
         // Discard all sessions that became idle before the cutoff time
-        for (auto it = _sessions.begin(); it != _sessions.end();) {
+        for (auto it = stripe.sessions.begin(); it != stripe.sessions.end();) {
             auto session = *it;
             invariant(session->getIdleExpireTime() != Date_t::min());
             if (session->getIdleExpireTime() < cutoffTime) {
-                it = _sessions.erase(it);
+                it = stripe.sessions.erase(it);
                 sessionsToClose.push_back(session);
             } else {
                 ++it;
             }
         }
+        stripe.numSessions.store(stripe.sessions.size());
     }
 
     // Closing expired idle sessions is expensive, so do it outside of the cache mutex. This helps
@@ -428,12 +440,18 @@ void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
 
 void WiredTigerSessionCache::closeAll() {
     // Increment the epoch as we are now closing all sessions with this epoch.
+    _epoch.fetchAndAdd(1);
+
     SessionCache swap;
+    for (auto& stripe : _stripes) {
+        if (auto session = stripe.slot.swap(nullptr)) {
+            swap.push_back(session);
+        }
 
-    {
-        stdx::lock_guard<Latch> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
+        stdx::lock_guard<Latch> lock(stripe.mutex);
+        swap.insert(swap.end(), stripe.sessions.begin(), stripe.sessions.end());
+        stripe.sessions.clear();
+        stripe.numSessions.store(0);
     }
 
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
@@ -450,13 +468,11 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<Latch> lock(_cacheLock);
-        if (!_sessions.empty()) {
-            // Get the most recently used session so that if we discard sessions, we're
-            // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
+    // Look for an idle session in the stripe of this thread first, then in the other stripes.
+    const size_t stripeIndex = _getStripeIndex();
+    for (size_t i = 0; i < kNumStripes; ++i) {
+        auto& stripe = _stripes[(stripeIndex + i) % kNumStripes];
+        if (auto cachedSession = _takeIdleSession(stripe)) {
             // Reset the idle time
             cachedSession->setIdleExpireTime(Date_t::min());
             return UniqueWiredTigerSession(cachedSession);
@@ -508,7 +524,6 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     if (session->_getCursorEpoch() != cursorEpoch)
         session->closeCursorsForQueuedDrops(_engine);
 
-    bool returnedToCache = false;
     uint64_t currentEpoch = _epoch.load();
     bool dropQueuedIdentsAtSessionEnd = session->isDropQueuedIdentsAtSessionEndAllowed();
 
@@ -517,22 +532,84 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     session->dropQueuedIdentsAtSessionEndAllowed(true);
     session->setIdleExpireTime(_clockSource->now());
 
-    if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<Latch> lock(_cacheLock);
-        if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
-            returnedToCache = true;
-            _sessions.push_back(session);
-        }
-    } else
+    if (session->_getEpoch() == currentEpoch) {
+        _cacheSession(session);
+    } else {
         invariant(session->_getEpoch() < currentEpoch);
-
-    if (!returnedToCache)
         delete session;
+    }
 
     if (dropQueuedIdentsAtSessionEnd && _engine && _engine->haveDropsQueued())
         _engine->dropSomeQueuedIdents();
 }
 
+size_t WiredTigerSessionCache::_getStripeIndex() {
+    // Threads are assigned to stripes round-robin the first time they use a session cache.
+    static AtomicWord<size_t> nextStripeIndex{0};
+    thread_local const size_t stripeIndex = nextStripeIndex.fetchAndAdd(1) % kNumStripes;
+    return stripeIndex;
+}
+
+WiredTigerSession* WiredTigerSessionCache::_takeIdleSession(Stripe& stripe) {
+    // The slot is read before it is exchanged, so that looking for idle sessions in other stripes
+    // does not take their cache lines away from their threads when there are none.
+    if (auto session = stripe.slot.load() ? stripe.slot.swap(nullptr) : nullptr) {
+        if (session->_getEpoch() == _epoch.load()) {
+            return session;
+        }
+
+        // The session was released into the slot right after closeAll() swept it.
+        delete session;
+    }
+
+    if (stripe.numSessions.load() == 0) {
+        return nullptr;
+    }
+
+    stdx::lock_guard<Latch> lock(stripe.mutex);
+    if (stripe.sessions.empty()) {
+        return nullptr;
+    }
+
+    // Get the most recently used session so that if we discard sessions, we're discarding older
+    // ones
+    WiredTigerSession* session = stripe.sessions.back();
+    stripe.sessions.pop_back();
+    stripe.numSessions.store(stripe.sessions.size());
+    return session;
+}
+
+void WiredTigerSessionCache::_cacheSession(WiredTigerSession* session) {
+    auto& stripe = _stripes[_getStripeIndex()];
+
+    // closeAll() may sweep the slot right before the session is released into it. The epoch of
+    // the session is then checked by whoever takes it out of the slot, which closes it.
+    WiredTigerSession* replaced = stripe.slot.swap(session);
+    if (!replaced) {
+        return;
+    }
+
+    {
+        stdx::lock_guard<Latch> lock(stripe.mutex);
+        if (replaced->_getEpoch() == _epoch.load()) {  // check inside the lock for correctness
+            stripe.sessions.push_back(replaced);
+            stripe.numSessions.store(stripe.sessions.size());
+            return;
+        }
+    }
+    delete replaced;
+}
+
+void WiredTigerSessionCache::_moveSlotSessionToList(WithLock, Stripe& stripe) {
+    if (auto session = stripe.slot.swap(nullptr)) {
+        if (session->_getEpoch() == _epoch.load()) {
+            stripe.sessions.push_back(session);
+            stripe.numSessions.store(stripe.sessions.size());
+        } else {
+            delete session;
+        }
+    }
+}
 
 void WiredTigerSessionCache::setJournalListener(JournalListener* jl) {
     stdx::unique_lock<Latch> lk(_journalListenerMutex);
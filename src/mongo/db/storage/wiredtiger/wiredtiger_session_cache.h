@@ -29,8 +29,10 @@
 
 #pragma once
 
+#include <array>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <wiredtiger.h>
 
@@ -38,7 +40,9 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/concurrency/with_lock.h"
 
 namespace mongo {
 
@@ -376,9 +380,56 @@ private:
     AtomicWord<unsigned> _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    Mutex _cacheLock = MONGO_MAKE_LATCH("WiredTigerSessionCache::_cacheLock");
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+
+    /**
+     * The idle sessions are spread over stripes, to which threads are assigned round-robin, so
+     * that a thread usually gets back the session it released last. A stripe keeps its most
+     * recently released session in a slot, which threads take from and release into with a single
+     * atomic exchange, and its other idle sessions in a list protected by its mutex. A thread
+     * whose stripe has no idle session takes one from another stripe before opening a new one.
+     *
+     * The sessions in the lists are always of the current epoch, as they are added after checking
+     * the epoch under the mutex of their stripe, and closeAll() empties the lists after bumping it.
+     * A session of an older epoch might only be released into a slot right after closeAll() swept
+     * it, in which case the next thread taking it out of the slot closes it.
+     */
+    struct alignas(stdx::hardware_destructive_interference_size) Stripe {
+        AtomicWord<WiredTigerSession*> slot{nullptr};
+
+        Mutex mutex = MONGO_MAKE_LATCH("WiredTigerSessionCache::Stripe::mutex");
+        SessionCache sessions;
+
+        // The size of 'sessions', which threads looking for an idle session check without the
+        // mutex.
+        AtomicWord<size_t> numSessions{0};
+    };
+
+    static constexpr size_t kNumStripes = 32;
+
+    /**
+     * Returns the index of the stripe of the calling thread.
+     */
+    static size_t _getStripeIndex();
+
+    /**
+     * Takes an idle session of the current epoch out of the given stripe, or returns nullptr if it
+     * has none.
+     */
+    WiredTigerSession* _takeIdleSession(Stripe& stripe);
+
+    /**
+     * Makes a released session of the current epoch the most recently released of the stripe of
+     * the calling thread, moving the session it replaces to the list of the stripe.
+     */
+    void _cacheSession(WiredTigerSession* session);
+
+    /**
+     * Moves the session in the slot of the given stripe, whose mutex must be held, to its list.
+     */
+    void _moveSlotSessionToList(WithLock, Stripe& stripe);
+
+    std::array<Stripe, kNumStripes> _stripes;
 
     // Bumped when all open sessions need to be closed
     AtomicWord<unsigned long long> _epoch;  // atomic so we can check it outside of the lock
@@ -31,11 +31,13 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/unittest/temp_dir.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/system_clock_source.h"
 
@@ -113,4 +115,73 @@ TEST(WiredTigerSessionCacheTest, CheckSessionCacheCleanup) {
     ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
 }
 
+TEST(WiredTigerSessionCacheTest, SessionReleasedByAnotherThreadIsReused) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+
+    // The session is cached in the stripe of the thread which releases it, and found by the
+    // threads of the other stripes.
+    WT_SESSION* wtSession = nullptr;
+    stdx::thread([&] {
+        UniqueWiredTigerSession session = sessionCache->getSession();
+        wtSession = session->getSession();
+    }).join();
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 1U);
+
+    UniqueWiredTigerSession session = sessionCache->getSession();
+    ASSERT_EQUALS(session->getSession(), wtSession);
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
+}
+
+TEST(WiredTigerSessionCacheTest, CloseAllClosesIdleAndReleasedSessions) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+    {
+        UniqueWiredTigerSession first = sessionCache->getSession();
+        UniqueWiredTigerSession second = sessionCache->getSession();
+    }
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 2U);
+
+    UniqueWiredTigerSession session = sessionCache->getSession();
+    sessionCache->closeAll();
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
+
+    // A session taken before closeAll is closed when released rather than cached.
+    session.reset();
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
+
+    {
+        UniqueWiredTigerSession newSession = sessionCache->getSession();
+    }
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 1U);
+}
+
+TEST(WiredTigerSessionCacheTest, ConcurrentGetReleaseAndCloseAll) {
+    const int kNumThreads = 8;
+    const int kNumIterations = 1000;
+
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < kNumIterations; ++j) {
+                UniqueWiredTigerSession session = sessionCache->getSession();
+                ASSERT(session->getSession());
+            }
+        });
+    }
+    for (int j = 0; j < kNumIterations / 10; ++j) {
+        sessionCache->closeAll();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_LTE(sessionCache->getIdleSessionsCount(), static_cast<size_t>(kNumThreads));
+    sessionCache->closeAll();
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
+}
+
 }  // namespace mongo
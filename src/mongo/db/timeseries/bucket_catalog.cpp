@@ -60,9 +60,15 @@ BucketCatalog& BucketCatalog::get(OperationContext* opCtx) {
 }
 
 BSONObj BucketCatalog::getMetadata(const OID& bucketId) const {
-    stdx::lock_guard lk(_mutex);
-    auto it = _buckets.find(bucketId);
-    if (it == _buckets.cend()) {
+    auto stripeIndex = _findStripeIndex(bucketId);
+    if (!stripeIndex) {
+        return {};
+    }
+
+    const auto& stripe = _stripes[*stripeIndex];
+    stdx::lock_guard lk(stripe.mutex);
+    auto it = stripe.buckets.find(bucketId);
+    if (it == stripe.buckets.cend()) {
         return {};
     }
     const auto& bucket = it->second;
@@ -72,14 +78,16 @@ BSONObj BucketCatalog::getMetadata(const OID& bucketId) const {
 BucketCatalog::InsertResult BucketCatalog::insert(OperationContext* opCtx,
                                                   const NamespaceString& ns,
                                                   const BSONObj& doc) {
-    stdx::lock_guard lk(_mutex);
-
     auto viewCatalog = DatabaseHolder::get(opCtx)->getViewCatalog(opCtx, ns.db());
     invariant(viewCatalog);
     auto viewDef = viewCatalog->lookup(opCtx, ns.ns());
     invariant(viewDef);
-    const auto& options = *viewDef->timeseries();
+    return insert(ns, *viewDef->timeseries(), doc);
+}
 
+BucketCatalog::InsertResult BucketCatalog::insert(const NamespaceString& ns,
+                                                  const TimeseriesOptions& options,
+                                                  const BSONObj& doc) {
     BSONObjBuilder metadata;
     if (auto metaField = options.getMetaField()) {
         if (auto elem = doc[*metaField]) {
@@ -90,26 +98,31 @@ BucketCatalog::InsertResult BucketCatalog::insert(OperationContext* opCtx,
     }
     auto key = std::make_pair(ns, BucketMetadata{metadata.obj()});
 
-    auto& stats = _executionStats[ns];
+    auto stripeIndex = _getStripeIndex(key);
+    auto& stripe = _stripes[stripeIndex];
+    stdx::lock_guard lk(stripe.mutex);
+
+    auto& stats = stripe.executionStats[ns];
 
     auto time = doc[options.getTimeField()].Date();
     auto createNewBucketId = [&] {
-        _expireIdleBuckets(&stats);
+        _expireIdleBuckets(lk, &stripe, &stats);
         auto bucketId = OID::gen();
         bucketId.setTimestamp(durationCount<Seconds>(time.toDurationSinceEpoch()));
+        _registerBucket(lk, bucketId, stripeIndex);
         return bucketId;
     };
 
-    auto it = _bucketIds.find(key);
-    if (it == _bucketIds.end()) {
+    auto it = stripe.bucketIds.find(key);
+    if (it == stripe.bucketIds.end()) {
         // A bucket for this namespace and metadata pair does not yet exist.
-        it = _bucketIds.insert({std::move(key), createNewBucketId()}).first;
-        _orderedBuckets.insert({ns, it->first.second, it->second});
+        it = stripe.bucketIds.insert({std::move(key), createNewBucketId()}).first;
+        stripe.orderedBuckets.insert({ns, it->first.second, it->second});
         stats.numBucketsOpenedDueToMetadata++;
     }
 
-    _idleBuckets.erase(it->second);
-    auto bucket = &_buckets[it->second];
+    stripe.idleBuckets.erase(it->second);
+    auto bucket = &stripe.buckets[it->second];
 
     StringSet newFieldNamesToBeInserted;
     uint32_t newFieldNamesSize = 0;
@@ -147,15 +160,15 @@ BucketCatalog::InsertResult BucketCatalog::insert(OperationContext* opCtx,
             bucket->numCommittedMeasurements == bucket->numMeasurements) {
             // The bucket does not contain any measurements that are yet to be committed, so we can
             // remove it now. Otherwise, we must keep the bucket around until it is committed.
-            _memoryUsage -= bucket->memoryUsage;
-            _buckets.erase(it->second);
-            _orderedBuckets.erase({it->first.first, it->first.second, it->second});
+            _closeBucket(it->second, bucket);
+            stripe.orderedBuckets.erase({it->first.first, it->first.second, it->second});
+            _removeBucket(lk, &stripe, stripe.buckets.find(it->second));
         } else {
             bucket->full = true;
         }
         it->second = createNewBucketId();
-        _orderedBuckets.insert({ns, it->first.second, it->second});
-        bucket = &_buckets[it->second];
+        stripe.orderedBuckets.insert({ns, it->first.second, it->second});
+        bucket = &stripe.buckets[it->second];
         bucket->calculateBucketFieldsAndSizeChange(doc,
                                                    options.getMetaField(),
                                                    &newFieldNamesToBeInserted,
@@ -181,31 +194,35 @@ BucketCatalog::InsertResult BucketCatalog::insert(OperationContext* opCtx,
         // The namespace and metadata only need to be set if this bucket was newly created.
         bucket->ns = ns;
         bucket->metadata = it->first.second;
+        bucket->compressOnClose = gTimeseriesCompressClosedBuckets.load();
 
-        // The namespace is stored three times: the bucket itself, _bucketIds, and _orderedBuckets.
-        // The metadata is stored three times: the bucket itself, _bucketIds, and _orderedBuckets.
-        // The bucketId is stored four times: _buckets, _bucketIds, _orderedBuckets, and
-        // _idleBuckets.
+        // The namespace is stored three times: the bucket itself, bucketIds, and orderedBuckets.
+        // The metadata is stored three times: the bucket itself, bucketIds, and orderedBuckets.
+        // The bucketId is stored five times: buckets, bucketIds, orderedBuckets, idleBuckets, and
+        // the bucket directory.
         bucket->memoryUsage +=
-            (ns.size() * 3) + (bucket->metadata.metadata.objsize() * 3) + (sizeof(OID) * 4);
+            (ns.size() * 3) + (bucket->metadata.metadata.objsize() * 3) + (sizeof(OID) * 5);
     } else {
-        _memoryUsage -= bucket->memoryUsage;
+        _memoryUsage.fetchAndSubtract(bucket->memoryUsage);
     }
     bucket->memoryUsage -= bucket->min.getMemoryUsage() + bucket->max.getMemoryUsage();
     bucket->min.update(doc, options.getMetaField(), std::less<>());
     bucket->max.update(doc, options.getMetaField(), std::greater<>());
     bucket->memoryUsage +=
         newFieldNamesSize + bucket->min.getMemoryUsage() + bucket->max.getMemoryUsage();
-    _memoryUsage += bucket->memoryUsage;
+    _memoryUsage.fetchAndAdd(bucket->memoryUsage);
 
     return {it->second, std::move(commitInfoFuture)};
 }
 
 BucketCatalog::CommitData BucketCatalog::commit(const OID& bucketId,
                                                 boost::optional<CommitInfo> previousCommitInfo) {
-    stdx::lock_guard lk(_mutex);
-    auto it = _buckets.find(bucketId);
-    invariant(it != _buckets.end());
+    auto stripeIndex = _findStripeIndex(bucketId);
+    invariant(stripeIndex);
+    auto& stripe = _stripes[*stripeIndex];
+    stdx::lock_guard lk(stripe.mutex);
+    auto it = stripe.buckets.find(bucketId);
+    invariant(it != stripe.buckets.end());
     auto& bucket = it->second;
 
     // The only case in which previousCommitInfo should not be provided is the first time a given
@@ -220,7 +237,26 @@ BucketCatalog::CommitData BucketCatalog::commit(const OID& bucketId,
     std::vector<BSONObj> measurements;
     bucket.measurementsToBeInserted.swap(measurements);
 
-    auto& stats = _executionStats[bucket.ns];
+    if (bucket.compressOnClose) {
+        if (previousCommitInfo && !previousCommitInfo->result.isOK()) {
+            // The bucket document may not hold all the measurements committed so far, so it can't
+            // be rewritten from them.
+            bucket.compressOnClose = false;
+            for (const auto& measurement : bucket.committedMeasurements) {
+                bucket.memoryUsage -= measurement.objsize();
+                _memoryUsage.fetchAndSubtract(measurement.objsize());
+            }
+            bucket.committedMeasurements.clear();
+        } else {
+            for (const auto& measurement : measurements) {
+                bucket.committedMeasurements.push_back(measurement.getOwned());
+                bucket.memoryUsage += measurement.objsize();
+                _memoryUsage.fetchAndAdd(measurement.objsize());
+            }
+        }
+    }
+
+    auto& stats = stripe.executionStats[bucket.ns];
     stats.numMeasurementsCommitted += measurements.size();
 
     // Inform waiters that their measurements have been committed.
@@ -255,12 +291,12 @@ BucketCatalog::CommitData BucketCatalog::commit(const OID& bucketId,
         if (bucket.full) {
             // Everything in the bucket has been committed, and nothing more will be added since the
             // bucket is full. Thus, we can remove it.
-            _memoryUsage -= bucket.memoryUsage;
-            _orderedBuckets.erase(
+            _closeBucket(bucketId, &bucket);
+            stripe.orderedBuckets.erase(
                 {std::move(it->second.ns), std::move(it->second.metadata), bucketId});
-            _buckets.erase(it);
+            _removeBucket(lk, &stripe, it);
         } else if (bucket.numWriters == 0) {
-            _idleBuckets.insert(bucketId);
+            stripe.idleBuckets.insert(bucketId);
         }
     } else {
         stats.numCommits++;
@@ -274,24 +310,63 @@ BucketCatalog::CommitData BucketCatalog::commit(const OID& bucketId,
     return data;
 }
 
-void BucketCatalog::clear(const NamespaceString& ns) {
-    stdx::lock_guard lk(_mutex);
+std::vector<BucketCatalog::ClosedBucket> BucketCatalog::takeClosedBuckets(
+    const NamespaceString& ns) {
+    if (_numClosedBuckets.load() == 0) {
+        return {};
+    }
 
+    stdx::lock_guard lk(_closedBucketsMutex);
+
+    auto it = _closedBuckets.find(ns);
+    if (it == _closedBuckets.end()) {
+        return {};
+    }
+
+    auto closedBuckets = std::move(it->second);
+    _closedBuckets.erase(it);
+    _numClosedBuckets.fetchAndSubtract(closedBuckets.size());
+    for (const auto& closedBucket : closedBuckets) {
+        for (const auto& measurement : closedBucket.measurements) {
+            _memoryUsage.fetchAndSubtract(measurement.objsize());
+        }
+    }
+    return closedBuckets;
+}
+
+void BucketCatalog::clear(const NamespaceString& ns) {
     auto shouldClear = [&ns](const NamespaceString& bucketNs) {
         return ns.coll().empty() ? ns.db() == bucketNs.db() : ns == bucketNs;
     };
 
-    for (auto it = _orderedBuckets.lower_bound({ns, {}, {}});
-         it != _orderedBuckets.end() && shouldClear(std::get<NamespaceString>(*it));
-         it = _orderedBuckets.erase(it)) {
-        const auto& bucketId = std::get<OID>(*it);
-        const auto& bucketNs = std::get<NamespaceString>(*it);
-        auto bucketIt = _buckets.find(bucketId);
-        _memoryUsage -= bucketIt->second.memoryUsage;
-        _buckets.erase(bucketIt);
-        _idleBuckets.erase(bucketId);
-        _bucketIds.erase({bucketNs, std::get<BucketMetadata>(*it)});
-        _executionStats.erase(bucketNs);
+    for (auto& stripe : _stripes) {
+        stdx::lock_guard lk(stripe.mutex);
+
+        for (auto it = stripe.orderedBuckets.lower_bound({ns, {}, {}});
+             it != stripe.orderedBuckets.end() && shouldClear(std::get<NamespaceString>(*it));
+             it = stripe.orderedBuckets.erase(it)) {
+            const auto& bucketId = std::get<OID>(*it);
+            const auto& bucketNs = std::get<NamespaceString>(*it);
+            stripe.idleBuckets.erase(bucketId);
+            stripe.bucketIds.erase({bucketNs, std::get<BucketMetadata>(*it)});
+            stripe.executionStats.erase(bucketNs);
+            _removeBucket(lk, &stripe, stripe.buckets.find(bucketId));
+        }
+    }
+
+    stdx::lock_guard lk(_closedBucketsMutex);
+    for (auto it = _closedBuckets.begin(); it != _closedBuckets.end();) {
+        if (shouldClear(it->first)) {
+            _numClosedBuckets.fetchAndSubtract(it->second.size());
+            for (const auto& closedBucket : it->second) {
+                for (const auto& measurement : closedBucket.measurements) {
+                    _memoryUsage.fetchAndSubtract(measurement.objsize());
+                }
+            }
+            _closedBuckets.erase(it++);
+        } else {
+            ++it;
+        }
     }
 }
 
@@ -300,10 +375,29 @@ void BucketCatalog::clear(StringData dbName) {
 }
 
 void BucketCatalog::appendExecutionStats(const NamespaceString& ns, BSONObjBuilder* builder) const {
-    stdx::lock_guard lk(_mutex);
+    // The buckets of a collection are spread across all the stripes, so their stats are summed.
+    ExecutionStats stats;
+    for (const auto& stripe : _stripes) {
+        stdx::lock_guard lk(stripe.mutex);
 
-    auto it = _executionStats.find(ns);
-    const auto& stats = it == _executionStats.end() ? ExecutionStats() : it->second;
+        auto it = stripe.executionStats.find(ns);
+        if (it == stripe.executionStats.end()) {
+            continue;
+        }
+        const auto& stripeStats = it->second;
+        stats.numBucketInserts += stripeStats.numBucketInserts;
+        stats.numBucketUpdates += stripeStats.numBucketUpdates;
+        stats.numBucketsOpenedDueToMetadata += stripeStats.numBucketsOpenedDueToMetadata;
+        stats.numBucketsClosedDueToCount += stripeStats.numBucketsClosedDueToCount;
+        stats.numBucketsClosedDueToSize += stripeStats.numBucketsClosedDueToSize;
+        stats.numBucketsClosedDueToTimeForward += stripeStats.numBucketsClosedDueToTimeForward;
+        stats.numBucketsClosedDueToTimeBackward += stripeStats.numBucketsClosedDueToTimeBackward;
+        stats.numBucketsClosedDueToMemoryThreshold +=
+            stripeStats.numBucketsClosedDueToMemoryThreshold;
+        stats.numCommits += stripeStats.numCommits;
+        stats.numWaits += stripeStats.numWaits;
+        stats.numMeasurementsCommitted += stripeStats.numMeasurementsCommitted;
+    }
 
     builder->appendNumber("numBucketInserts", stats.numBucketInserts);
     builder->appendNumber("numBucketUpdates", stats.numBucketUpdates);
@@ -325,18 +419,95 @@ void BucketCatalog::appendExecutionStats(const NamespaceString& ns, BSONObjBuild
     }
 }
 
-void BucketCatalog::_expireIdleBuckets(ExecutionStats* stats) {
-    while (!_idleBuckets.empty() && _memoryUsage > kIdleBucketExpiryMemoryUsageThreshold) {
-        auto it = _buckets.find(*_idleBuckets.begin());
-        _memoryUsage -= it->second.memoryUsage;
-        _idleBuckets.erase(_idleBuckets.begin());
-        _bucketIds.erase({it->second.ns, it->second.metadata});
-        _orderedBuckets.erase({it->second.ns, it->second.metadata, it->first});
-        _buckets.erase(it);
+size_t BucketCatalog::_getStripeIndex(const std::pair<NamespaceString, BucketMetadata>& key) {
+    // The low bits of the hash are used by the hash tables within the stripe, so the stripe is
+    // picked using the high bits instead.
+    return (absl::Hash<std::pair<NamespaceString, BucketMetadata>>()(key) >> 32) % kNumStripes;
+}
+
+size_t BucketCatalog::_getDirectoryPartitionIndex(const OID& bucketId) {
+    // Bucket ids are generated from a process-wide counter, whose lowest byte spreads them evenly
+    // across the partitions.
+    return bucketId.getIncrement().bytes[OID::kIncrementSize - 1] % kNumStripes;
+}
+
+boost::optional<size_t> BucketCatalog::_findStripeIndex(const OID& bucketId) const {
+    const auto& partition = _bucketDirectory[_getDirectoryPartitionIndex(bucketId)];
+    stdx::lock_guard lk(partition.mutex);
+    auto it = partition.stripes.find(bucketId);
+    if (it == partition.stripes.end()) {
+        return boost::none;
+    }
+    return it->second;
+}
+
+void BucketCatalog::_registerBucket(WithLock, const OID& bucketId, size_t stripeIndex) {
+    auto& partition = _bucketDirectory[_getDirectoryPartitionIndex(bucketId)];
+    stdx::lock_guard lk(partition.mutex);
+    partition.stripes.emplace(bucketId, stripeIndex);
+}
+
+void BucketCatalog::_removeBucket(WithLock,
+                                  Stripe* stripe,
+                                  stdx::unordered_map<OID, Bucket, OID::Hasher>::iterator it) {
+    {
+        auto& partition = _bucketDirectory[_getDirectoryPartitionIndex(it->first)];
+        stdx::lock_guard lk(partition.mutex);
+        partition.stripes.erase(it->first);
+    }
+    _memoryUsage.fetchAndSubtract(it->second.memoryUsage);
+    stripe->buckets.erase(it);
+}
+
+void BucketCatalog::_expireIdleBuckets(WithLock lk, Stripe* stripe, ExecutionStats* stats) {
+    if (_memoryUsage.load() > kIdleBucketExpiryMemoryUsageThreshold &&
+        _numClosedBuckets.load() > 0) {
+        // Compressing closed buckets is only an optimization, so their measurements are the first
+        // to be dropped when the catalog grows too large.
+        stdx::lock_guard closedBucketsLk(_closedBucketsMutex);
+        for (const auto& [ns, closedBuckets] : _closedBuckets) {
+            for (const auto& closedBucket : closedBuckets) {
+                for (const auto& measurement : closedBucket.measurements) {
+                    _memoryUsage.fetchAndSubtract(measurement.objsize());
+                }
+            }
+        }
+        _closedBuckets.clear();
+        _numClosedBuckets.store(0);
+    }
+
+    // Only the idle buckets of the given stripe are expired, as the others can't be accessed
+    // without locking their stripe. Each stripe expires its own idle buckets as new buckets are
+    // opened in it.
+    while (!stripe->idleBuckets.empty() &&
+           _memoryUsage.load() > kIdleBucketExpiryMemoryUsageThreshold) {
+        auto it = stripe->buckets.find(*stripe->idleBuckets.begin());
+        stripe->idleBuckets.erase(stripe->idleBuckets.begin());
+        stripe->bucketIds.erase({it->second.ns, it->second.metadata});
+        stripe->orderedBuckets.erase({it->second.ns, it->second.metadata, it->first});
+        _removeBucket(lk, stripe, it);
         stats->numBucketsClosedDueToMemoryThreshold++;
     }
 }
 
+void BucketCatalog::_closeBucket(const OID& bucketId, Bucket* bucket) {
+    if (!bucket->compressOnClose || bucket->committedMeasurements.empty()) {
+        return;
+    }
+
+    // The measurements are moved out of the bucket, so their memory usage is now accounted for by
+    // the closed bucket instead.
+    for (const auto& measurement : bucket->committedMeasurements) {
+        bucket->memoryUsage -= measurement.objsize();
+    }
+
+    stdx::lock_guard lk(_closedBucketsMutex);
+    _closedBuckets[bucket->ns].push_back(
+        {bucketId, bucket->metadata.metadata, std::move(bucket->committedMeasurements)});
+    _numClosedBuckets.fetchAndAdd(1);
+    bucket->committedMeasurements.clear();
+}
+
 bool BucketCatalog::BucketMetadata::operator<(const BucketMetadata& other) const {
     auto size = metadata.objsize();
     auto otherSize = other.metadata.objsize();
@@ -603,13 +774,23 @@ public:
 
     BSONObj generateSection(OperationContext* opCtx, const BSONElement&) const override {
         const auto& bucketCatalog = BucketCatalog::get(opCtx);
-        stdx::lock_guard lk(bucketCatalog._mutex);
+
+        long long numBuckets = 0;
+        long long numOpenBuckets = 0;
+        long long numIdleBuckets = 0;
+        for (const auto& stripe : bucketCatalog._stripes) {
+            stdx::lock_guard lk(stripe.mutex);
+            numBuckets += stripe.buckets.size();
+            numOpenBuckets += stripe.bucketIds.size();
+            numIdleBuckets += stripe.idleBuckets.size();
+        }
 
         BSONObjBuilder builder;
-        builder.appendNumber("numBuckets", bucketCatalog._buckets.size());
-        builder.appendNumber("numOpenBuckets", bucketCatalog._bucketIds.size());
-        builder.appendNumber("numIdleBuckets", bucketCatalog._idleBuckets.size());
-        builder.appendNumber("memoryUsage", static_cast<long long>(bucketCatalog._memoryUsage));
+        builder.appendNumber("numBuckets", numBuckets);
+        builder.appendNumber("numOpenBuckets", numOpenBuckets);
+        builder.appendNumber("numIdleBuckets", numIdleBuckets);
+        builder.appendNumber("memoryUsage",
+                             static_cast<long long>(bucketCatalog._memoryUsage.load()));
         return builder.obj();
     }
 } bucketCatalogServerStatus;
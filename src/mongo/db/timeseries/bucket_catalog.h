@@ -33,8 +33,12 @@
 #include "mongo/db/ops/single_write_result_gen.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/timeseries/timeseries_gen.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/string_map.h"
 
+#include <array>
 #include <queue>
 
 namespace mongo {
@@ -66,6 +70,12 @@ public:
         BSONObj toBSON() const;
     };
 
+    struct ClosedBucket {
+        OID bucketId;
+        BSONObj metadata;
+        std::vector<BSONObj> measurements;  // All the measurements of the bucket, in order.
+    };
+
     static BucketCatalog& get(ServiceContext* svcCtx);
     static BucketCatalog& get(OperationContext* opCtx);
 
@@ -91,6 +101,14 @@ public:
      */
     InsertResult insert(OperationContext* opCtx, const NamespaceString& ns, const BSONObj& doc);
 
+    /**
+     * Same as above, for a caller which has already looked up the options of the time-series
+     * collection.
+     */
+    InsertResult insert(const NamespaceString& ns,
+                        const TimeseriesOptions& options,
+                        const BSONObj& doc);
+
     /**
      * Returns the uncommitted measurements and the number of measurements that have already been
      * committed for the given bucket. This should be called continuously by the committer until
@@ -99,6 +117,14 @@ public:
     CommitData commit(const OID& bucketId,
                       boost::optional<CommitInfo> previousCommitInfo = boost::none);
 
+    /**
+     * Returns the buckets of the given namespace which were closed since the previous call, along
+     * with their measurements, so that the caller can rewrite them in the compressed format. Only
+     * buckets opened while 'timeseriesCompressClosedBuckets' was enabled, and whose commits all
+     * succeeded, are returned.
+     */
+    std::vector<ClosedBucket> takeClosedBuckets(const NamespaceString& ns);
+
     /**
      * Clears the buckets for the given namespace.
      */
@@ -201,6 +227,14 @@ private:
         // Measurements to be inserted into the bucket.
         std::vector<BSONObj> measurementsToBeInserted;
 
+        // Owned copies of the measurements committed to the bucket, which are only retained if the
+        // bucket is to be compressed once it is closed.
+        std::vector<BSONObj> committedMeasurements;
+
+        // Whether the bucket is to be compressed once it is closed. This is cleared if any of its
+        // commits fails, since its measurements may then no longer match the bucket document.
+        bool compressOnClose = false;
+
         // New top-level field names of the measurements to be inserted.
         StringSet newFieldNamesToBeInserted;
 
@@ -267,31 +301,96 @@ private:
         long long numMeasurementsCommitted = 0;
     };
 
+    /**
+     * The buckets of the catalog are partitioned into stripes by the hash of their namespace and
+     * metadata, so that inserts of measurements with different metadata don't contend on the same
+     * mutex. A stripe holds all the buckets of the namespace and metadata pairs which hash to it.
+     */
+    struct Stripe {
+        mutable Mutex mutex = MONGO_MAKE_LATCH("BucketCatalog::Stripe::mutex");
+
+        // All buckets currently in the stripe, including buckets which are full but not yet
+        // committed.
+        stdx::unordered_map<OID, Bucket, OID::Hasher> buckets;
+
+        // The _id of the current bucket for each namespace and metadata pair.
+        stdx::unordered_map<std::pair<NamespaceString, BucketMetadata>, OID> bucketIds;
+
+        // All namespace, metadata, and _id tuples which currently have a bucket in the stripe.
+        std::set<std::tuple<NamespaceString, BucketMetadata, OID>> orderedBuckets;
+
+        // Buckets that do not have any writers.
+        std::set<OID> idleBuckets;
+
+        // Per-collection execution stats for the buckets of the stripe.
+        stdx::unordered_map<NamespaceString, ExecutionStats> executionStats;
+    };
+
+    /**
+     * Maps the _id of each bucket in the catalog to the stripe holding it, for the operations which
+     * only know the bucket's _id. It is itself partitioned by the hash of the _id.
+     */
+    struct BucketDirectoryPartition {
+        mutable Mutex mutex = MONGO_MAKE_LATCH("BucketCatalog::BucketDirectoryPartition::mutex");
+        stdx::unordered_map<OID, size_t, OID::Hasher> stripes;
+    };
+
+    static constexpr size_t kNumStripes = 32;
+
     class ServerStatus;
 
     /**
-     * Expires idle buckets until the bucket catalog's memory usage is below the expiry threshold.
+     * Returns the index of the stripe holding the buckets of the given namespace and metadata.
+     */
+    static size_t _getStripeIndex(const std::pair<NamespaceString, BucketMetadata>& key);
+
+    static size_t _getDirectoryPartitionIndex(const OID& bucketId);
+
+    /**
+     * Returns the index of the stripe holding the given bucket, if it is in the catalog.
+     */
+    boost::optional<size_t> _findStripeIndex(const OID& bucketId) const;
+
+    /**
+     * Records that a new bucket belongs to the given stripe, whose mutex must be held.
+     */
+    void _registerBucket(WithLock, const OID& bucketId, size_t stripeIndex);
+
+    /**
+     * Removes a bucket from the given stripe, whose mutex must be held, and from the directory,
+     * releasing its memory usage. The other structures referencing the bucket must be updated by
+     * the caller.
      */
-    void _expireIdleBuckets(ExecutionStats* stats);
+    void _removeBucket(WithLock,
+                       Stripe* stripe,
+                       stdx::unordered_map<OID, Bucket, OID::Hasher>::iterator it);
 
-    mutable Mutex _mutex = MONGO_MAKE_LATCH("BucketCatalog");
+    /**
+     * Expires idle buckets of the given stripe until the bucket catalog's memory usage is below
+     * the expiry threshold.
+     */
+    void _expireIdleBuckets(WithLock, Stripe* stripe, ExecutionStats* stats);
+
+    /**
+     * Hands the measurements of the given bucket, which is about to be removed from the catalog
+     * because it is full, over to the next call to takeClosedBuckets() if it is to be compressed.
+     */
+    void _closeBucket(const OID& bucketId, Bucket* bucket);
 
-    // All buckets currently in the catalog, including buckets which are full but not yet committed.
-    stdx::unordered_map<OID, Bucket, OID::Hasher> _buckets;
+    std::array<Stripe, kNumStripes> _stripes;
 
-    // The _id of the current bucket for each namespace and metadata pair.
-    stdx::unordered_map<std::pair<NamespaceString, BucketMetadata>, OID> _bucketIds;
+    std::array<BucketDirectoryPartition, kNumStripes> _bucketDirectory;
 
-    // All namespace, metadata, and _id tuples which currently have a bucket in the catalog.
-    std::set<std::tuple<NamespaceString, BucketMetadata, OID>> _orderedBuckets;
+    Mutex _closedBucketsMutex = MONGO_MAKE_LATCH("BucketCatalog::_closedBucketsMutex");
 
-    // Buckets that do not have any writers.
-    std::set<OID> _idleBuckets;
+    // Per-collection buckets which were closed and are waiting to be compressed.
+    stdx::unordered_map<NamespaceString, std::vector<ClosedBucket>> _closedBuckets;
 
-    // Per-collection execution stats.
-    stdx::unordered_map<NamespaceString, ExecutionStats> _executionStats;
+    // The total number of closed buckets, which lets takeClosedBuckets() return early without
+    // locking the mutex when there are none.
+    AtomicWord<size_t> _numClosedBuckets{0};
 
     // Approximate memory usage of the bucket catalog.
-    uint64_t _memoryUsage = 0;
+    AtomicWord<uint64_t> _memoryUsage{0};
 };
 }  // namespace mongo
@@ -0,0 +1,85 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace {
+const NamespaceString kNss("bucket_catalog_bm", "t");
+const int kNumMetadataValuesPerThread = 16;
+
+/**
+ * Benchmarks inserting measurements into the bucket catalog and committing them, as done by the
+ * insert command for a time-series collection, without writing the buckets.
+ *
+ * All threads share the same bucket catalog but insert measurements with distinct metadata values,
+ * as with separate ingest connections for different sensors, to identify synchronization costs
+ * inside the catalog.
+ */
+void BM_InsertAndCommit(benchmark::State& state) {
+    static std::unique_ptr<BucketCatalog> bucketCatalog;
+    if (state.thread_index == 0) {
+        bucketCatalog = std::make_unique<BucketCatalog>();
+    }
+
+    TimeseriesOptions options("time");
+    options.setMetaField("meta"_sd);
+    BucketCatalog::CommitInfo commitInfo{StatusWith<SingleWriteResult>(SingleWriteResult{})};
+
+    std::vector<BSONObj> docs;
+    for (int i = 0; i < kNumMetadataValuesPerThread; ++i) {
+        docs.push_back(BSON("time" << Date_t::now() << "meta"
+                                   << state.thread_index * kNumMetadataValuesPerThread + i
+                                   << "value" << i));
+    }
+
+    size_t i = 0;
+    for (auto keepRunning : state) {
+        auto result = bucketCatalog->insert(kNss, options, docs[i++ % docs.size()]);
+        invariant(!result.commitInfo);
+        benchmark::DoNotOptimize(bucketCatalog->commit(result.bucketId));
+        benchmark::DoNotOptimize(bucketCatalog->commit(result.bucketId, commitInfo));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index == 0) {
+        bucketCatalog.reset();
+    }
+}
+
+BENCHMARK(BM_InsertAndCommit)->ThreadRange(1, ProcessInfo::getNumAvailableCores());
+}  // namespace
+}  // namespace mongo
@@ -159,6 +159,35 @@ TEST_F(BucketCatalogTest, InsertIntoDifferentBuckets) {
     }
 }
 
+TEST_F(BucketCatalogTest, InsertIntoBucketsAcrossStripes) {
+    // Enough metadata values for the buckets to be spread across several stripes of the catalog.
+    std::vector<OID> bucketIds;
+    for (int i = 0; i < 100; ++i) {
+        auto result = _bucketCatalog->insert(
+            _opCtx, _ns1, BSON(_timeField << Date_t::now() << _metaField << i));
+        ASSERT(!result.commitInfo);
+        bucketIds.push_back(result.bucketId);
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_BSONOBJ_EQ(BSON(_metaField << i), _bucketCatalog->getMetadata(bucketIds[i]));
+        _commit(bucketIds[i], 0);
+    }
+
+    // The execution stats of the namespace cover the buckets of all the stripes.
+    BSONObjBuilder builder;
+    _bucketCatalog->appendExecutionStats(_ns1, &builder);
+    auto stats = builder.obj();
+    ASSERT_EQ(100, stats["numBucketsOpenedDueToMetadata"].numberLong());
+    ASSERT_EQ(100, stats["numBucketInserts"].numberLong());
+    ASSERT_EQ(100, stats["numMeasurementsCommitted"].numberLong());
+
+    _bucketCatalog->clear(_ns1);
+    for (const auto& bucketId : bucketIds) {
+        ASSERT_BSONOBJ_EQ(BSONObj(), _bucketCatalog->getMetadata(bucketId));
+    }
+}
+
 TEST_F(BucketCatalogTest, NumCommittedMeasurementsAccumulates) {
     // The numCommittedMeasurements returned when committing should accumulate as more entries in
     // the bucket are committed.
@@ -0,0 +1,389 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_compression.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/overflow_arithmetic.h"
+#include "mongo/util/decimal_counter.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+namespace timeseries {
+namespace {
+/**
+ * A compressed column starts with a format version byte, followed by a sequence of instructions
+ * which each produce the values of one or more consecutive measurements.
+ */
+constexpr uint8_t kColumnFormatVersion = 1;
+
+enum class ColumnOp : uint8_t {
+    // <count>: the next <count> measurements don't have the field.
+    kSkip = 1,
+    // <type> <'\0'> <value>: the next measurement holds the given BSON value.
+    kLiteral = 2,
+    // <count>: the next <count> measurements hold the previous value.
+    kRepeat = 3,
+    // <count> <dod>...: the next <count> measurements hold integers of the same type as the
+    // previous value. Each one is encoded as the difference between its delta to the previous value
+    // and the delta of the previous value, which is zero after a literal or a repeat.
+    kDelta = 4,
+};
+
+bool isDeltaEncodable(BSONType type) {
+    return type == NumberInt || type == NumberLong || type == Date;
+}
+
+int64_t getIntegralValue(const BSONElement& elem) {
+    switch (elem.type()) {
+        case NumberInt:
+            return elem._numberInt();
+        case NumberLong:
+            return elem._numberLong();
+        case Date:
+            return elem.date().toMillisSinceEpoch();
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+uint64_t zigZagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t zigZagDecode(uint64_t value) {
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+void appendVarUInt(BufBuilder* buf, uint64_t value) {
+    while (value >= 0x80) {
+        buf->appendChar(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buf->appendChar(static_cast<char>(value));
+}
+
+/**
+ * Encodes the values of a single field, given in increasing order of measurement index.
+ */
+class ColumnEncoder {
+public:
+    ColumnEncoder() {
+        _buf.appendChar(static_cast<char>(kColumnFormatVersion));
+    }
+
+    void append(uint32_t index, const BSONElement& elem) {
+        if (index < _nextIndex) {
+            // Only the first occurrence of a duplicate field name in a measurement is kept.
+            return;
+        }
+
+        if (index > _nextIndex) {
+            _flushRun();
+            _buf.appendChar(static_cast<char>(ColumnOp::kSkip));
+            appendVarUInt(&_buf, index - _nextIndex);
+        }
+        _nextIndex = index + 1;
+
+        if (_runOp == ColumnOp::kDelta) {
+            if (auto dod = _advanceDelta(elem)) {
+                _dods.push_back(*dod);
+                return;
+            }
+        }
+
+        if (!_last.eoo() && elem.binaryEqualValues(_last)) {
+            if (_runOp != ColumnOp::kRepeat) {
+                _flushRun();
+                _runOp = ColumnOp::kRepeat;
+            }
+            _runCount++;
+            _lastDelta = 0;
+            return;
+        }
+
+        if (auto dod = _advanceDelta(elem)) {
+            _flushRun();
+            _runOp = ColumnOp::kDelta;
+            _dods.push_back(*dod);
+            return;
+        }
+
+        _flushRun();
+        _buf.appendChar(static_cast<char>(ColumnOp::kLiteral));
+        _buf.appendChar(static_cast<char>(elem.type()));
+        _buf.appendChar('\0');
+        _buf.appendBuf(elem.value(), elem.valuesize());
+
+        _last = elem;
+        _lastInt = isDeltaEncodable(elem.type()) ? getIntegralValue(elem) : 0;
+        _lastDelta = 0;
+    }
+
+    void appendTo(BSONObjBuilder* builder, StringData fieldName) {
+        _flushRun();
+        builder->appendBinData(fieldName, _buf.len(), BinDataGeneral, _buf.buf());
+    }
+
+private:
+    /**
+     * Returns the delta-of-delta encoding of 'elem' if it can be encoded relative to the previous
+     * value, in which case it becomes the previous value.
+     */
+    boost::optional<int64_t> _advanceDelta(const BSONElement& elem) {
+        if (_last.eoo() || elem.type() != _last.type() || !isDeltaEncodable(elem.type())) {
+            return boost::none;
+        }
+
+        auto value = getIntegralValue(elem);
+        int64_t delta;
+        int64_t dod;
+        if (overflow::sub(value, _lastInt, &delta) || overflow::sub(delta, _lastDelta, &dod)) {
+            return boost::none;
+        }
+
+        _last = elem;
+        _lastInt = value;
+        _lastDelta = delta;
+        return dod;
+    }
+
+    void _flushRun() {
+        if (!_runOp) {
+            return;
+        }
+
+        _buf.appendChar(static_cast<char>(*_runOp));
+        if (*_runOp == ColumnOp::kDelta) {
+            appendVarUInt(&_buf, _dods.size());
+            for (auto dod : _dods) {
+                appendVarUInt(&_buf, zigZagEncode(dod));
+            }
+            _dods.clear();
+        } else {
+            appendVarUInt(&_buf, _runCount);
+            _runCount = 0;
+        }
+        _runOp = boost::none;
+    }
+
+    BufBuilder _buf;
+    uint32_t _nextIndex = 0;
+
+    // The previous value, which points into the measurement it comes from.
+    BSONElement _last;
+    int64_t _lastInt = 0;
+    int64_t _lastDelta = 0;
+
+    // The run of repeats or deltas being built, if any.
+    boost::optional<ColumnOp> _runOp;
+    uint64_t _runCount = 0;
+    std::vector<int64_t> _dods;
+};
+
+/**
+ * Reads the instructions of a compressed column, checking that they don't run past its end.
+ */
+class ColumnReader {
+public:
+    ColumnReader(const char* data, int size) : _it(data), _end(data + size) {}
+
+    bool done() const {
+        return _it == _end;
+    }
+
+    uint8_t readByte() {
+        uassert(5190900, "Truncated time-series column", _it < _end);
+        return static_cast<uint8_t>(*_it++);
+    }
+
+    uint64_t readVarUInt() {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uassert(5190901, "Invalid integer in time-series column", shift < 64);
+            auto byte = readByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    BSONElement readElement() {
+        uassert(5190902, "Truncated time-series column", _end - _it >= 2 && _it[1] == '\0');
+        BSONElement elem(_it);
+        uassert(5190903, "Truncated time-series column", elem.size() <= _end - _it);
+        _it += elem.size();
+        return elem;
+    }
+
+private:
+    const char* _it;
+    const char* const _end;
+};
+}  // namespace
+
+BSONObj compressBucketData(const std::vector<BSONObj>& measurements,
+                           boost::optional<StringData> metaField) {
+    // The columns are kept in the order in which their fields are first seen.
+    std::vector<std::pair<StringData, std::unique_ptr<ColumnEncoder>>> columns;
+    StringDataMap<size_t> columnIndexes;
+
+    for (uint32_t index = 0; index < measurements.size(); ++index) {
+        for (auto&& elem : measurements[index]) {
+            auto fieldName = elem.fieldNameStringData();
+            if (metaField && fieldName == *metaField) {
+                continue;
+            }
+
+            auto it = columnIndexes.find(fieldName);
+            if (it == columnIndexes.end()) {
+                it = columnIndexes.emplace(fieldName.toString(), columns.size()).first;
+                columns.emplace_back(fieldName, std::make_unique<ColumnEncoder>());
+            }
+            columns[it->second].second->append(index, elem);
+        }
+    }
+
+    BSONObjBuilder builder;
+    for (auto& [fieldName, encoder] : columns) {
+        encoder->appendTo(&builder, fieldName);
+    }
+    return builder.obj();
+}
+
+BSONObj decompressColumn(BSONElement column) {
+    uassert(5190904,
+            str::stream() << "Compressed time-series column must be BinData, got: "
+                          << column.type(),
+            column.type() == BinData);
+
+    int size;
+    auto data = column.binData(size);
+    ColumnReader reader(data, size);
+    uassert(5190905,
+            "Unsupported time-series column format",
+            reader.readByte() == kColumnFormatVersion);
+
+    BSONObjBuilder builder;
+    DecimalCounter<uint32_t> index;
+
+    BSONElement last;
+    uint64_t lastInt = 0;
+    uint64_t lastDelta = 0;
+
+    auto appendLast = [&] {
+        if (!isDeltaEncodable(last.type())) {
+            builder.appendAs(last, index);
+            return;
+        }
+
+        // Integers are rebuilt from their current value, which may come from a delta.
+        switch (last.type()) {
+            case NumberInt:
+                builder.append(index, static_cast<int32_t>(lastInt));
+                break;
+            case NumberLong:
+                builder.append(index, static_cast<long long>(lastInt));
+                break;
+            case Date:
+                builder.appendDate(index,
+                                   Date_t::fromMillisSinceEpoch(static_cast<long long>(lastInt)));
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    };
+
+    while (!reader.done()) {
+        auto op = static_cast<ColumnOp>(reader.readByte());
+        switch (op) {
+            case ColumnOp::kSkip: {
+                auto count = reader.readVarUInt();
+                uassert(5190906,
+                        "Invalid skip in time-series column",
+                        count <= std::numeric_limits<uint32_t>::max() - index);
+                for (uint64_t i = 0; i < count; ++i) {
+                    ++index;
+                }
+                break;
+            }
+            case ColumnOp::kLiteral:
+                last = reader.readElement();
+                lastInt = isDeltaEncodable(last.type()) ? getIntegralValue(last) : 0;
+                lastDelta = 0;
+                appendLast();
+                ++index;
+                break;
+            case ColumnOp::kRepeat: {
+                uassert(5190907, "Repeat without a value in time-series column", !last.eoo());
+                auto count = reader.readVarUInt();
+                for (uint64_t i = 0; i < count; ++i) {
+                    appendLast();
+                    ++index;
+                }
+                lastDelta = 0;
+                break;
+            }
+            case ColumnOp::kDelta: {
+                uassert(5190908,
+                        "Delta without an integer value in time-series column",
+                        !last.eoo() && isDeltaEncodable(last.type()));
+                auto count = reader.readVarUInt();
+                for (uint64_t i = 0; i < count; ++i) {
+                    // The arithmetic is unsigned so that corrupt deltas can't overflow.
+                    lastDelta += static_cast<uint64_t>(zigZagDecode(reader.readVarUInt()));
+                    lastInt += lastDelta;
+                    appendLast();
+                    ++index;
+                }
+                break;
+            }
+            default:
+                uasserted(5190909,
+                          str::stream() << "Invalid instruction in time-series column: "
+                                        << static_cast<int>(op));
+        }
+    }
+
+    return builder.obj();
+}
+
+BSONObj decompressBucketData(const BSONObj& data) {
+    BSONObjBuilder builder;
+    for (auto&& column : data) {
+        builder.append(column.fieldNameStringData(), decompressColumn(column));
+    }
+    return builder.obj();
+}
+}  // namespace timeseries
+}  // namespace mongo
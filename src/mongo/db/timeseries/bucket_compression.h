@@ -0,0 +1,70 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+namespace timeseries {
+/**
+ * Buckets whose 'control.version' is kCompressedBucketControlVersion store each field of their
+ * 'data' region as a compressed column rather than as an object keyed by measurement index.
+ */
+constexpr int kUncompressedBucketControlVersion = 1;
+constexpr int kCompressedBucketControlVersion = 2;
+
+/**
+ * Builds the compressed 'data' region of a bucket holding 'measurements', in insertion order. The
+ * 'metaField', if any, is left out since it is stored once for the whole bucket.
+ *
+ * Each top-level field of the measurements becomes a BinData column, in which runs of equal values
+ * are run-length encoded, runs of integers and dates of the same type are delta-of-delta encoded,
+ * and the other values are stored as BSON values without their field names. Measurements missing
+ * the field are encoded as skipped indexes.
+ */
+BSONObj compressBucketData(const std::vector<BSONObj>& measurements,
+                           boost::optional<StringData> metaField);
+
+/**
+ * Decompresses a column produced by compressBucketData() back into the uncompressed format, i.e.
+ * an object mapping the index of each measurement which has the field to its value.
+ */
+BSONObj decompressColumn(BSONElement column);
+
+/**
+ * Decompresses the 'data' region of a compressed bucket back into the uncompressed format.
+ */
+BSONObj decompressBucketData(const BSONObj& data);
+}  // namespace timeseries
+}  // namespace mongo
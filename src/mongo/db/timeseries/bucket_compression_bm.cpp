@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+#include "mongo/db/timeseries/bucket_compression.h"
+
+namespace mongo {
+namespace timeseries {
+namespace {
+const int kNumMeasurements = 1000;
+
+/**
+ * Makes the measurements of a typical full bucket: evenly spaced timestamps, a slowly changing
+ * counter, a gauge which is often repeated and a double reading.
+ */
+std::vector<BSONObj> makeMeasurements() {
+    std::vector<BSONObj> measurements;
+    for (int i = 0; i < kNumMeasurements; ++i) {
+        measurements.push_back(BSON("time" << Date_t::fromMillisSinceEpoch(1600000000000 + i * 1000)
+                                           << "meta" << BSON("sensor" << 1) << "counter"
+                                           << static_cast<long long>(i * 7) << "gauge" << i / 100
+                                           << "reading" << 20.0 + (i % 17) * 0.25));
+    }
+    return measurements;
+}
+
+BSONObj makeUncompressedData(const std::vector<BSONObj>& measurements) {
+    std::map<std::string, BSONObjBuilder> columns;
+    for (int i = 0; i < kNumMeasurements; ++i) {
+        for (auto&& elem : measurements[i]) {
+            if (elem.fieldNameStringData() != "meta"_sd) {
+                columns[elem.fieldName()].appendAs(elem, std::to_string(i));
+            }
+        }
+    }
+
+    BSONObjBuilder builder;
+    for (auto& [fieldName, column] : columns) {
+        builder.append(fieldName, column.obj());
+    }
+    return builder.obj();
+}
+
+Document makeBucket(const BSONObj& data, int version) {
+    return Document{{"_id", OID::gen()},
+                    {"control", Document{{"version", version}}},
+                    {"meta", Document{{"sensor", 1}}},
+                    {"data", data}};
+}
+
+void BM_CompressBucket(benchmark::State& state) {
+    auto measurements = makeMeasurements();
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(compressBucketData(measurements, "meta"_sd));
+    }
+    state.SetItemsProcessed(state.iterations() * kNumMeasurements);
+}
+
+/**
+ * Unpacks all the measurements of a bucket, reporting the size of its data region.
+ */
+void runUnpack(benchmark::State& state, const BSONObj& data, int version) {
+    BucketUnpacker unpacker(BucketSpec{"time", std::string("meta"), {}},
+                            BucketUnpacker::Behavior::kExclude,
+                            true,
+                            true);
+    for (auto keepRunning : state) {
+        unpacker.reset(makeBucket(data, version));
+        while (unpacker.hasNext()) {
+            benchmark::DoNotOptimize(unpacker.getNext());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kNumMeasurements);
+    state.counters["dataBytes"] = data.objsize();
+}
+
+void BM_UnpackUncompressedBucket(benchmark::State& state) {
+    runUnpack(state, makeUncompressedData(makeMeasurements()), kUncompressedBucketControlVersion);
+}
+
+void BM_UnpackCompressedBucket(benchmark::State& state) {
+    runUnpack(state,
+              compressBucketData(makeMeasurements(), "meta"_sd),
+              kCompressedBucketControlVersion);
+}
+
+BENCHMARK(BM_CompressBucket);
+BENCHMARK(BM_UnpackUncompressedBucket);
+BENCHMARK(BM_UnpackCompressedBucket);
+}  // namespace
+}  // namespace timeseries
+}  // namespace mongo
@@ -0,0 +1,211 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_compression.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/bson_test_util.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace timeseries {
+namespace {
+/**
+ * Builds the uncompressed 'data' region of a bucket holding 'measurements', in the format written
+ * by the insert path.
+ */
+BSONObj makeUncompressedData(const std::vector<BSONObj>& measurements,
+                             boost::optional<StringData> metaField = boost::none) {
+    std::vector<std::string> fieldNames;
+    StringMap<BSONObjBuilder> columns;
+    for (size_t index = 0; index < measurements.size(); ++index) {
+        for (auto&& elem : measurements[index]) {
+            auto fieldName = elem.fieldName();
+            if (metaField && elem.fieldNameStringData() == *metaField) {
+                continue;
+            }
+            if (!columns.count(fieldName)) {
+                fieldNames.push_back(fieldName);
+            }
+            columns[fieldName].appendAs(elem, std::to_string(index));
+        }
+    }
+
+    BSONObjBuilder builder;
+    for (const auto& fieldName : fieldNames) {
+        builder.append(fieldName, columns[fieldName].obj());
+    }
+    return builder.obj();
+}
+
+void assertRoundTrip(const std::vector<BSONObj>& measurements,
+                     boost::optional<StringData> metaField = boost::none) {
+    auto compressed = compressBucketData(measurements, metaField);
+    for (auto&& column : compressed) {
+        ASSERT_EQ(BinData, column.type());
+    }
+    ASSERT_BSONOBJ_BINARY_EQ(makeUncompressedData(measurements, metaField),
+                             decompressBucketData(compressed));
+}
+
+BSONElement compressColumn(const std::vector<BSONObj>& measurements, BSONObj* holder) {
+    *holder = compressBucketData(measurements, boost::none);
+    return holder->firstElement();
+}
+
+TEST(BucketCompressionTest, Empty) {
+    ASSERT_BSONOBJ_EQ(BSONObj(), compressBucketData({}, boost::none));
+    ASSERT_BSONOBJ_EQ(BSONObj(), decompressBucketData(BSONObj()));
+}
+
+TEST(BucketCompressionTest, EvenlySpacedDatesAreDeltaEncoded) {
+    std::vector<BSONObj> measurements;
+    for (int i = 0; i < 1000; ++i) {
+        measurements.push_back(
+            BSON("time" << Date_t::fromMillisSinceEpoch(1600000000000 + i * 1000)));
+    }
+    assertRoundTrip(measurements);
+
+    BSONObj holder;
+    int size;
+    compressColumn(measurements, &holder).binData(size);
+    // A literal followed by a single delta run of zeroes, which take a byte each.
+    ASSERT_LT(size, 1100);
+}
+
+TEST(BucketCompressionTest, IntegersAreDeltaEncoded) {
+    std::vector<BSONObj> measurements;
+    for (int i = 0; i < 100; ++i) {
+        measurements.push_back(BSON("i" << i * i << "l" << static_cast<long long>(-i * 3)));
+    }
+    assertRoundTrip(measurements);
+}
+
+TEST(BucketCompressionTest, RepeatedValuesAreRunLengthEncoded) {
+    std::vector<BSONObj> measurements;
+    for (int i = 0; i < 1000; ++i) {
+        measurements.push_back(BSON("s"
+                                    << "constant"
+                                    << "d" << 1.5 << "o" << BSON("a" << 1)));
+    }
+    assertRoundTrip(measurements);
+
+    BSONObj holder;
+    int size;
+    compressColumn(measurements, &holder).binData(size);
+    ASSERT_LT(size, 32);
+}
+
+TEST(BucketCompressionTest, RepeatsAndDeltasInterleave) {
+    std::vector<BSONObj> measurements;
+    for (int i = 0; i < 100; ++i) {
+        measurements.push_back(BSON("a" << (i / 10) * 10 + (i % 2)));
+    }
+    assertRoundTrip(measurements);
+}
+
+TEST(BucketCompressionTest, MissingFieldsAreSkipped) {
+    std::vector<BSONObj> measurements;
+    for (int i = 0; i < 50; ++i) {
+        BSONObjBuilder builder;
+        builder.append("time", Date_t::fromMillisSinceEpoch(i));
+        if (i % 3 == 0) {
+            builder.append("a", i);
+        }
+        if (i >= 40) {
+            builder.append("b", "late");
+        }
+        measurements.push_back(builder.obj());
+    }
+    assertRoundTrip(measurements);
+}
+
+TEST(BucketCompressionTest, MixedTypes) {
+    assertRoundTrip({BSON("a" << 1),
+                     BSON("a" << 2LL),
+                     BSON("a" << 3LL),
+                     BSON("a" << 3.5),
+                     BSON("a"
+                          << "str"),
+                     BSON("a" << BSONNULL),
+                     BSON("a" << BSON_ARRAY(1 << 2)),
+                     BSON("a" << Date_t::fromMillisSinceEpoch(5)),
+                     BSON("a" << 6),
+                     BSON("a" << 7)});
+}
+
+TEST(BucketCompressionTest, IntegerOverflowFallsBackToLiterals) {
+    assertRoundTrip({BSON("a" << std::numeric_limits<long long>::min()),
+                     BSON("a" << std::numeric_limits<long long>::max()),
+                     BSON("a" << std::numeric_limits<long long>::min()),
+                     BSON("a" << 0LL),
+                     BSON("a" << std::numeric_limits<int>::max()),
+                     BSON("a" << std::numeric_limits<int>::min()),
+                     BSON("a" << std::numeric_limits<int>::max())});
+}
+
+TEST(BucketCompressionTest, MetaFieldIsExcluded) {
+    std::vector<BSONObj> measurements;
+    for (int i = 0; i < 10; ++i) {
+        measurements.push_back(BSON("time" << Date_t::fromMillisSinceEpoch(i) << "meta"
+                                           << BSON("sensor" << 1) << "value" << i));
+    }
+    assertRoundTrip(measurements, StringData("meta"));
+    ASSERT_FALSE(compressBucketData(measurements, StringData("meta")).hasField("meta"));
+}
+
+TEST(BucketCompressionTest, DecompressRejectsNonBinData) {
+    ASSERT_THROWS_CODE(decompressBucketData(BSON("a" << BSON("0" << 1))), DBException, 5190904);
+}
+
+TEST(BucketCompressionTest, DecompressRejectsCorruptColumns) {
+    auto decompress = [](std::vector<char> bytes) {
+        BSONObjBuilder builder;
+        builder.appendBinData("a", bytes.size(), BinDataGeneral, bytes.data());
+        return decompressColumn(builder.obj().firstElement());
+    };
+
+    // Unknown format version.
+    ASSERT_THROWS_CODE(decompress({2}), DBException, 5190905);
+    // Unknown instruction.
+    ASSERT_THROWS_CODE(decompress({1, 42}), DBException, 5190909);
+    // Truncated count.
+    ASSERT_THROWS_CODE(decompress({1, 1, '\x80'}), DBException, 5190900);
+    // Truncated literal.
+    ASSERT_THROWS_CODE(decompress({1, 2, NumberInt, 0, 1}), DBException, 5190903);
+    // Repeat and delta runs without a preceding literal.
+    ASSERT_THROWS_CODE(decompress({1, 3, 1}), DBException, 5190907);
+    ASSERT_THROWS_CODE(decompress({1, 4, 1, 0}), DBException, 5190908);
+}
+}  // namespace
+}  // namespace timeseries
+}  // namespace mongo
@@ -120,6 +120,23 @@ std::unique_ptr<mongo::DBClientCursor> MockDBClientConnection::query(
                                                      batchSize,
                                                      readConcernObj));
 
+        // A simple mock implementation of the bounds of a scan of the _id index, where '$min' is
+        // inclusive and '$max' is exclusive.
+        auto minId = query.obj["$min"];
+        auto maxId = query.obj["$max"];
+        if (minId.isABSONObj() || maxId.isABSONObj()) {
+            BSONArrayBuilder builder;
+            for (auto&& elem : result) {
+                auto id = elem.Obj()["_id"].wrap();
+                if ((minId.isABSONObj() && id.woCompare(minId.Obj()) < 0) ||
+                    (maxId.isABSONObj() && id.woCompare(maxId.Obj()) >= 0)) {
+                    continue;
+                }
+                builder.append(elem.Obj());
+            }
+            result = BSONArray(builder.obj());
+        }
+
         BSONArray resultsInCursor;
 
         // A simple mock implementation of a resumable query, where we skip the first 'n' fields
@@ -46,7 +46,9 @@
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageFetch {
 
@@ -226,6 +228,146 @@ public:
     }
 };
 
+//
+// Test that the records of a batch are fetched together and returned in the order of the child.
+//
+class FetchStageBatched : public QueryStageFetchBase {
+public:
+    void run() {
+        internalQueryFetchBatchSize.store(4);
+        ON_BLOCK_EXIT([] { internalQueryFetchBatchSize.store(1); });
+
+        dbtests::WriteContextForTests ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        CollectionPtr coll =
+            CollectionCatalog::get(&_opCtx)->lookupCollectionByNamespace(&_opCtx, nss());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, nss());
+            wuow.commit();
+        }
+
+        WorkingSet ws;
+
+        const int kNumDocs = 10;
+        for (int i = 0; i < kNumDocs; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(kNumDocs), recordIds.size());
+
+        // The record of the document with foo == 3 no longer exists when it is fetched.
+        remove(BSON("foo" << 3));
+
+        // Create a mock stage that returns the RecordIds in reverse order, along with a WSM which
+        // already has an obj.
+        auto mockStage = std::make_unique<QueuedDataStage>(_expCtx.get(), &ws);
+        for (auto it = recordIds.rbegin(); it != recordIds.rend(); ++it) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = *it;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+
+            if (std::distance(recordIds.rbegin(), it) == 5) {
+                WorkingSetID ownedId = ws.allocate();
+                WorkingSetMember* ownedMember = ws.get(ownedId);
+                ownedMember->doc = {SnapshotId(), Document{BSON("foo" << kNumDocs)}};
+                ownedMember->transitionToOwnedObj();
+                mockStage->pushBack(ownedId);
+            }
+        }
+
+        auto fetchStage =
+            std::make_unique<FetchStage>(_expCtx.get(), &ws, std::move(mockStage), nullptr, coll);
+
+        std::vector<int> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state;
+        while ((state = fetchStage->work(&id)) != PlanStage::IS_EOF) {
+            if (state == PlanStage::ADVANCED) {
+                results.push_back(ws.get(id)->doc.value()["foo"].getInt());
+            }
+        }
+
+        std::vector<int> expectedResults{9, 8, 7, 6, 5, 4, kNumDocs, 2, 1, 0};
+        ASSERT(results == expectedResults);
+
+        auto stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_EQUALS(size_t(1), stats->alreadyHasObj);
+        ASSERT_EQUALS(expectedResults.size(), stats->docsExamined);
+    }
+};
+
+//
+// Test that a batch never holds more results of the child than are left to reach the limit.
+//
+class FetchStageBatchedUnderLimit : public QueryStageFetchBase {
+public:
+    void run() {
+        internalQueryFetchBatchSize.store(8);
+        ON_BLOCK_EXIT([] { internalQueryFetchBatchSize.store(1); });
+
+        dbtests::WriteContextForTests ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        CollectionPtr coll =
+            CollectionCatalog::get(&_opCtx)->lookupCollectionByNamespace(&_opCtx, nss());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, nss());
+            wuow.commit();
+        }
+
+        WorkingSet ws;
+
+        const int kNumDocs = 10;
+        for (int i = 0; i < kNumDocs; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(kNumDocs), recordIds.size());
+
+        auto mockStage = std::make_unique<QueuedDataStage>(_expCtx.get(), &ws);
+        for (const auto& recordId : recordIds) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = recordId;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+        }
+        auto mockStagePtr = mockStage.get();
+
+        // The filter rejects the document with foo == 1.
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(BSON("foo" << BSON("$ne" << 1)), _expCtx);
+        verify(statusWithMatcher.isOK());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        const long long kLimit = 3;
+        auto fetchStage = std::make_unique<FetchStage>(
+            _expCtx.get(), &ws, std::move(mockStage), filterExpr.get(), coll, kLimit);
+
+        std::vector<int> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        while (results.size() < size_t(kLimit)) {
+            auto state = fetchStage->work(&id);
+            ASSERT_NOT_EQUALS(PlanStage::IS_EOF, state);
+            if (state == PlanStage::ADVANCED) {
+                results.push_back(ws.get(id)->doc.value()["foo"].getInt());
+            }
+        }
+
+        std::vector<int> expectedResults{0, 2, 3};
+        ASSERT(results == expectedResults);
+
+        // The first batch holds the first 3 results of the child, of which 2 are returned, and the
+        // second one the next result only, as would be the case one record at a time.
+        ASSERT_EQUALS(size_t(4), mockStagePtr->getCommonStats()->advanced);
+    }
+};
+
 class All : public OldStyleSuiteSpecification {
 public:
     All() : OldStyleSuiteSpecification("query_stage_fetch") {}
@@ -233,6 +375,8 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageBatched>();
+        add<FetchStageBatchedUnderLimit>();
     }
 };
 
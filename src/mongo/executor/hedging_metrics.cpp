@@ -67,12 +67,30 @@ void HedgingMetrics::incrementNumAdvantageouslyHedgedOperations() {
     _numAdvantageouslyHedgedOperations.fetchAndAdd(1);
 }
 
+long long HedgingMetrics::getNumTotalHedgedGetMores() const {
+    return _numTotalHedgedGetMores.load();
+}
+
+void HedgingMetrics::incrementNumTotalHedgedGetMores() {
+    _numTotalHedgedGetMores.fetchAndAdd(1);
+}
+
+long long HedgingMetrics::getNumAdvantageouslyHedgedGetMores() const {
+    return _numAdvantageouslyHedgedGetMores.load();
+}
+
+void HedgingMetrics::incrementNumAdvantageouslyHedgedGetMores() {
+    _numAdvantageouslyHedgedGetMores.fetchAndAdd(1);
+}
+
 BSONObj HedgingMetrics::toBSON() const {
     BSONObjBuilder builder;
 
     builder.append("numTotalOperations", _numTotalOperations.load());
     builder.append("numTotalHedgedOperations", _numTotalHedgedOperations.load());
     builder.append("numAdvantageouslyHedgedOperations", _numAdvantageouslyHedgedOperations.load());
+    builder.append("numTotalHedgedGetMores", _numTotalHedgedGetMores.load());
+    builder.append("numAdvantageouslyHedgedGetMores", _numAdvantageouslyHedgedGetMores.load());
 
     return builder.obj();
 }
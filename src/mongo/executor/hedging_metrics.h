@@ -56,6 +56,12 @@ public:
     long long getNumAdvantageouslyHedgedOperations() const;
     void incrementNumAdvantageouslyHedgedOperations();
 
+    long long getNumTotalHedgedGetMores() const;
+    void incrementNumTotalHedgedGetMores();
+
+    long long getNumAdvantageouslyHedgedGetMores() const;
+    void incrementNumAdvantageouslyHedgedGetMores();
+
     BSONObj toBSON() const;
 
 private:
@@ -68,6 +74,14 @@ private:
     // The number of all operations where a rpc other than the first one fulfilled the client
     // request.
     AtomicWord<long long> _numAdvantageouslyHedgedOperations{0};
+
+    // The number of getMores for which a cursor was re-established on another host of the shard
+    // because the getMore took longer than most.
+    AtomicWord<long long> _numTotalHedgedGetMores{0};
+
+    // The number of hedged getMores where the re-established cursor returned its first batch
+    // before the getMore completed.
+    AtomicWord<long long> _numAdvantageouslyHedgedGetMores{0};
 };
 
 }  // namespace mongo
@@ -33,6 +33,10 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <algorithm>
+#include <numeric>
+
+#include "mongo/base/data_view.h"
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
@@ -45,6 +49,7 @@
 #include "mongo/s/chunk_writes_tracker.h"
 #include "mongo/s/mongod_and_mongos_server_parameters_gen.h"
 #include "mongo/s/shard_invalidated_for_targeting_exception.h"
+#include "mongo/stdx/unordered_set.h"
 
 namespace mongo {
 namespace {
@@ -64,6 +69,37 @@ void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
             allElementsAreOfType(type, o));
 }
 
+/**
+ * Checks that 'next' starts where 'last', the chunk before it in the routing table, ends.
+ */
+void checkContinuity(const ChunkInfo& last, const ChunkInfo& next) {
+    const auto& lastMax = last.getMax();
+    const auto& nextMin = next.getMin();
+    if (SimpleBSONObjComparator::kInstance.evaluate(lastMax == nextMin))
+        return;
+
+    if (SimpleBSONObjComparator::kInstance.evaluate(lastMax < nextMin))
+        uasserted(ErrorCodes::ConflictingOperationInProgress,
+                  str::stream() << "Gap exists in the routing table between chunks "
+                                << last.getRange().toString() << " and "
+                                << next.getRange().toString());
+    else
+        uasserted(ErrorCodes::ConflictingOperationInProgress,
+                  str::stream() << "Overlap exists in the routing table between chunks "
+                                << last.getRange().toString() << " and "
+                                << next.getRange().toString());
+}
+
+/**
+ * Returns the first eight bytes of 'keyString' as a big endian integer, padded with zeros. The
+ * prefixes of two KeyStrings compare in the same order as the KeyStrings, unless they are equal.
+ */
+uint64_t makeKeyStringPrefix(StringData keyString) {
+    char buf[sizeof(uint64_t)] = {};
+    std::memcpy(buf, keyString.rawData(), std::min(keyString.size(), sizeof(buf)));
+    return ConstDataView(buf).read<BigEndian<uint64_t>>();
+}
+
 void appendChunkTo(std::vector<std::shared_ptr<ChunkInfo>>& chunks,
                    const std::shared_ptr<ChunkInfo>& chunk) {
     if (!chunks.empty() && chunk->getRange().overlaps(chunks.back()->getRange())) {
@@ -115,94 +151,55 @@ std::vector<std::shared_ptr<ChunkInfo>> flatten(const std::vector<ChunkType>& ch
 
 ShardVersionMap ChunkMap::constructShardVersionMap() const {
     ShardVersionMap shardVersions;
-    ChunkVector::const_iterator current = _chunkMap.cbegin();
-
-    boost::optional<BSONObj> firstMin = boost::none;
-    boost::optional<BSONObj> lastMax = boost::none;
-
-    while (current != _chunkMap.cend()) {
-        const auto& firstChunkInRange = *current;
-        const auto& currentRangeShardId = firstChunkInRange->getShardIdAt(boost::none);
-
-        // Tracks the max shard version for the shard on which the current range will reside
-        auto shardVersionIt = shardVersions.find(currentRangeShardId);
-        if (shardVersionIt == shardVersions.end()) {
-            shardVersionIt = shardVersions
-                                 .emplace(std::piecewise_construct,
-                                          std::forward_as_tuple(currentRangeShardId),
-                                          std::forward_as_tuple(_collectionVersion.epoch(),
-                                                                _collectionVersion.getTimestamp()))
-                                 .first;
-        }
-
-        auto& maxShardVersion = shardVersionIt->second.shardVersion;
-
-        current =
-            std::find_if(current,
-                         _chunkMap.cend(),
-                         [&currentRangeShardId, &maxShardVersion](const auto& currentChunk) {
-                             if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
-                                 return true;
-
-                             if (maxShardVersion.isOlderThan(currentChunk->getLastmod()))
-                                 maxShardVersion = currentChunk->getLastmod();
 
-                             return false;
-                         });
-
-        const auto rangeLast = *std::prev(current);
+    // The continuity of the chunks inside each segment was checked when it was built, which only
+    // leaves the bounds between segments to check.
+    const ChunkInfo* lastChunk = nullptr;
+    for (const auto& segment : _segments) {
+        // Tracks the max shard version for each shard on which the segment has chunks
+        for (const auto& [shardIdIndex, segmentShardVersion] : segment->shardVersions) {
+            const auto& shardId = _shardIds[shardIdIndex];
+            auto shardVersionIt = shardVersions.find(shardId);
+            if (shardVersionIt == shardVersions.end()) {
+                shardVersionIt =
+                    shardVersions
+                        .emplace(std::piecewise_construct,
+                                 std::forward_as_tuple(shardId),
+                                 std::forward_as_tuple(_collectionVersion.epoch(),
+                                                       _collectionVersion.getTimestamp()))
+                        .first;
+            }
 
-        const auto& rangeMin = firstChunkInRange->getMin();
-        const auto& rangeMax = rangeLast->getMax();
+            auto& maxShardVersion = shardVersionIt->second.shardVersion;
+            if (maxShardVersion.isOlderThan(segmentShardVersion))
+                maxShardVersion = segmentShardVersion;
 
-        // Check the continuity of the chunks map
-        if (lastMax && !SimpleBSONObjComparator::kInstance.evaluate(*lastMax == rangeMin)) {
-            if (SimpleBSONObjComparator::kInstance.evaluate(*lastMax < rangeMin))
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream() << "Gap exists in the routing table between chunks "
-                                        << findIntersectingChunk(*lastMax)->getRange().toString()
-                                        << " and " << rangeLast->getRange().toString());
-            else
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream() << "Overlap exists in the routing table between chunks "
-                                        << findIntersectingChunk(*lastMax)->getRange().toString()
-                                        << " and " << rangeLast->getRange().toString());
+            // If a shard has chunks it must have a shard version, otherwise we have an invalid
+            // chunk somewhere, which should have been caught at chunk load time
+            invariant(maxShardVersion.isSet());
         }
 
-        if (!firstMin)
-            firstMin = rangeMin;
-
-        lastMax = rangeMax;
+        if (lastChunk)
+            checkContinuity(*lastChunk, *segment->chunks.front());
 
-        // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
-        // somewhere, which should have been caught at chunk load time
-        invariant(maxShardVersion.isSet());
+        lastChunk = segment->chunks.back().get();
     }
 
-    if (!_chunkMap.empty()) {
+    if (!_segments.empty()) {
         invariant(!shardVersions.empty());
-        invariant(firstMin.is_initialized());
-        invariant(lastMax.is_initialized());
 
-        checkAllElementsAreOfType(MinKey, firstMin.get());
-        checkAllElementsAreOfType(MaxKey, lastMax.get());
+        checkAllElementsAreOfType(MinKey, _segments.front()->chunks.front()->getMin());
+        checkAllElementsAreOfType(MaxKey, _segments.back()->chunks.back()->getMax());
     }
 
     return shardVersions;
 }
 
-void ChunkMap::appendChunk(const std::shared_ptr<ChunkInfo>& chunk) {
-    appendChunkTo(_chunkMap, chunk);
-
-    if (_collectionVersion.isOlderThan(chunk->getLastmod()))
-        _collectionVersion = chunk->getLastmod();
-}
-
 std::shared_ptr<ChunkInfo> ChunkMap::findIntersectingChunk(const BSONObj& shardKey) const {
-    const auto it = _findIntersectingChunk(shardKey);
+    const auto pos = _findIntersectingChunk(ShardKeyPattern::toKeyString(shardKey));
 
-    if (it != _chunkMap.end())
-        return *it;
+    if (pos != _end())
+        return _getChunk(pos);
 
     return std::shared_ptr<ChunkInfo>();
 }
@@ -218,90 +215,331 @@ void validateChunk(const std::shared_ptr<ChunkInfo>& chunk, const ChunkVersion&
 
 ChunkMap ChunkMap::createMerged(
     const std::vector<std::shared_ptr<ChunkInfo>>& changedChunks) const {
-    size_t chunkMapIndex = 0;
-    size_t changedChunkIndex = 0;
+    ChunkMap updatedChunkMap(getVersion().epoch(), getVersion().getTimestamp());
+
+    // Share the shard ids of this map, so that the segments which no changed chunk overlaps can be
+    // shared as they are. Every changed chunk is at least as recent as this map.
+    updatedChunkMap._shardIds = _shardIds;
+    updatedChunkMap._shardIdToIndex = _shardIdToIndex;
+    updatedChunkMap._collectionVersion = _collectionVersion;
+
+    // The chunks of the segments which the changed chunks overlap are collected in 'run', along
+    // with the changed chunks, and are indexed into new segments. Each changed chunk only costs the
+    // lookup of the chunks it replaces and the rebuild of the segments which hold them.
+    ChunkVector run;
+    auto pos = _begin();
+    for (const auto& changedChunk : changedChunks) {
+        validateChunk(changedChunk, getVersion());
+
+        // The chunks which overlap the changed chunk are those from the first one ending after its
+        // min bound, to the first one ending at or after its max bound.
+        const auto firstOverlapping =
+            _findIntersectingChunk(ShardKeyPattern::toKeyString(changedChunk->getMin()));
+
+        if (pos < firstOverlapping) {
+            updatedChunkMap._appendRange(*this, pos, firstOverlapping, run);
+            pos = firstOverlapping;
+        }
 
-    ChunkMap updatedChunkMap(
-        getVersion().epoch(), getVersion().getTimestamp(), _chunkMap.size() + changedChunks.size());
+        if (firstOverlapping != _end()) {
+            auto bytesInReplacedChunk =
+                _getChunk(firstOverlapping)->getWritesTracker()->getBytesWritten();
+            changedChunk->getWritesTracker()->addBytesWritten(bytesInReplacedChunk);
 
-    while (chunkMapIndex < _chunkMap.size() || changedChunkIndex < changedChunks.size()) {
-        if (chunkMapIndex >= _chunkMap.size()) {
-            validateChunk(changedChunks[changedChunkIndex], getVersion());
-            updatedChunkMap.appendChunk(changedChunks[changedChunkIndex++]);
-            continue;
-        }
+            auto lastOverlapping = _findIntersectingChunk(changedChunk->getMaxKeyString(), false);
+            if (lastOverlapping == _end()) {
+                lastOverlapping = {_segments.size() - 1, _segments.back()->size() - 1};
+            }
 
-        if (changedChunkIndex >= changedChunks.size()) {
-            updatedChunkMap.appendChunk(_chunkMap[chunkMapIndex++]);
-            continue;
+            pos = std::max(pos, _next(lastOverlapping));
         }
 
-        auto overlap = _chunkMap[chunkMapIndex]->getRange().overlaps(
-            changedChunks[changedChunkIndex]->getRange());
+        appendChunkTo(run, changedChunk);
 
-        if (overlap) {
-            auto& changedChunk = changedChunks[changedChunkIndex++];
-            auto& chunkInfo = _chunkMap[chunkMapIndex];
+        if (updatedChunkMap._collectionVersion.isOlderThan(changedChunk->getLastmod()))
+            updatedChunkMap._collectionVersion = changedChunk->getLastmod();
+    }
 
-            auto bytesInReplacedChunk = chunkInfo->getWritesTracker()->getBytesWritten();
-            changedChunk->getWritesTracker()->addBytesWritten(bytesInReplacedChunk);
+    updatedChunkMap._appendRange(*this, pos, _end(), run);
+    updatedChunkMap._appendRun(run);
 
-            validateChunk(changedChunk, getVersion());
-            updatedChunkMap.appendChunk(changedChunk);
-        } else {
-            updatedChunkMap.appendChunk(_chunkMap[chunkMapIndex++]);
-        }
+    return updatedChunkMap;
+}
+
+size_t ChunkMap::numSharedSegments(const ChunkMap& other) const {
+    stdx::unordered_set<const Segment*> otherSegments;
+    for (const auto& segment : other._segments) {
+        otherSegments.insert(segment.get());
     }
 
-    return updatedChunkMap;
+    return std::count_if(_segments.begin(), _segments.end(), [&](const auto& segment) {
+        return otherSegments.count(segment.get()) > 0;
+    });
 }
 
 BSONObj ChunkMap::toBSON() const {
     BSONObjBuilder builder;
 
     builder.append("startingVersion"_sd, getVersion().toBSON());
-    builder.append("chunkCount", static_cast<int64_t>(_chunkMap.size()));
+    builder.append("chunkCount", static_cast<int64_t>(_size));
 
     {
         BSONArrayBuilder arrayBuilder(builder.subarrayStart("chunks"_sd));
-        for (const auto& chunk : _chunkMap) {
+        forEach([&](const auto& chunk) {
             arrayBuilder.append(chunk->toString());
-        }
+            return true;
+        });
     }
 
     return builder.obj();
 }
 
-ChunkMap::ChunkVector::const_iterator ChunkMap::_findIntersectingChunk(const BSONObj& shardKey,
-                                                                       bool isMaxInclusive) const {
-    auto shardKeyString = ShardKeyPattern::toKeyString(shardKey);
+int ChunkMap::Segment::compareMaxKeyString(size_t offset,
+                                           uint64_t prefix,
+                                           StringData keyString) const {
+    const auto maxKeyPrefix = maxKeyPrefixes[offset];
+    if (maxKeyPrefix != prefix) {
+        return maxKeyPrefix < prefix ? -1 : 1;
+    }
+    return getMaxKeyString(offset).compare(keyString);
+}
 
-    if (!isMaxInclusive) {
-        return std::lower_bound(_chunkMap.begin(),
-                                _chunkMap.end(),
-                                shardKey,
-                                [&shardKeyString](const auto& chunkInfo, const BSONObj& shardKey) {
-                                    return chunkInfo->getMaxKeyString() < shardKeyString;
-                                });
-    } else {
-        return std::upper_bound(_chunkMap.begin(),
-                                _chunkMap.end(),
-                                shardKey,
-                                [&shardKeyString](const BSONObj& shardKey, const auto& chunkInfo) {
-                                    return shardKeyString < chunkInfo->getMaxKeyString();
-                                });
+size_t ChunkMap::Segment::search(
+    size_t low, size_t count, uint64_t prefix, StringData keyString, bool isMaxInclusive) const {
+    // Binary search for the first chunk whose max bound is greater than the key, or greater than or
+    // equal to it if the max bound is not inclusive.
+    while (count > 0) {
+        const size_t step = count / 2;
+        const size_t mid = low + step;
+        const int cmp = compareMaxKeyString(mid, prefix, keyString);
+        if (isMaxInclusive ? cmp <= 0 : cmp < 0) {
+            low = mid + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return low;
+}
+
+size_t ChunkMap::Segment::gallop(size_t begin, uint64_t prefix, StringData keyString) const {
+    // Doubles the step until it reaches a chunk whose max bound is greater than the key, which
+    // leaves the result between the last two chunks probed. The last chunk of the segment is
+    // always such a chunk.
+    size_t low = begin;
+    size_t step = 1;
+    while (true) {
+        const size_t probe = std::min(low + step - 1, size() - 1);
+        if (compareMaxKeyString(probe, prefix, keyString) > 0) {
+            return search(low, probe - low, prefix, keyString, true);
+        }
+        low = probe + 1;
+        step *= 2;
+    }
+}
+
+ChunkMap::Position ChunkMap::_findIntersectingChunk(StringData keyString,
+                                                    bool isMaxInclusive) const {
+    const auto prefix = makeKeyStringPrefix(keyString);
+
+    // Binary search for the first segment whose last chunk satisfies the lookup, and then for the
+    // chunk in that segment.
+    size_t low = 0;
+    size_t count = _segments.size();
+    while (count > 0) {
+        const size_t step = count / 2;
+        const size_t mid = low + step;
+        const int cmp = _compareSegmentMaxKeyString(mid, prefix, keyString);
+        if (isMaxInclusive ? cmp <= 0 : cmp < 0) {
+            low = mid + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+
+    if (low == _segments.size())
+        return _end();
+
+    const auto& segment = *_segments[low];
+    return {low, segment.search(0, segment.size() - 1, prefix, keyString, isMaxInclusive)};
+}
+
+ChunkMap::Position ChunkMap::_findIntersectingChunkFrom(Position begin,
+                                                        StringData keyString) const {
+    if (begin == _end())
+        return _end();
+
+    const auto prefix = makeKeyStringPrefix(keyString);
+
+    if (_compareSegmentMaxKeyString(begin.segment, prefix, keyString) > 0) {
+        return {begin.segment, _segments[begin.segment]->gallop(begin.offset, prefix, keyString)};
     }
+
+    // The chunk is in one of the later segments, which are galloped over the same way as the
+    // chunks of a segment.
+    size_t low = begin.segment + 1;
+    size_t step = 1;
+    while (low < _segments.size()) {
+        const size_t probe = std::min(low + step - 1, _segments.size() - 1);
+        if (_compareSegmentMaxKeyString(probe, prefix, keyString) > 0) {
+            size_t count = probe - low;
+            while (count > 0) {
+                const size_t half = count / 2;
+                const size_t mid = low + half;
+                if (_compareSegmentMaxKeyString(mid, prefix, keyString) <= 0) {
+                    low = mid + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+
+            const auto& segment = *_segments[low];
+            return {low, segment.search(0, segment.size() - 1, prefix, keyString, true)};
+        }
+        low = probe + 1;
+        step *= 2;
+    }
+    return _end();
+}
+
+int ChunkMap::_compareSegmentMaxKeyString(size_t idx,
+                                          uint64_t prefix,
+                                          StringData keyString) const {
+    const auto maxKeyPrefix = _segmentMaxKeyPrefixes[idx];
+    if (maxKeyPrefix != prefix) {
+        return maxKeyPrefix < prefix ? -1 : 1;
+    }
+    const auto& segment = *_segments[idx];
+    return segment.getMaxKeyString(segment.size() - 1).compare(keyString);
 }
 
-std::pair<ChunkMap::ChunkVector::const_iterator, ChunkMap::ChunkVector::const_iterator>
-ChunkMap::_overlappingBounds(const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
-    const auto itMin = _findIntersectingChunk(min);
-    const auto itMax = [&]() {
-        auto it = _findIntersectingChunk(max, isMaxInclusive);
-        return it == _chunkMap.end() ? it : ++it;
+std::pair<ChunkMap::Position, ChunkMap::Position> ChunkMap::_overlappingBounds(
+    const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
+    const auto posMin = _findIntersectingChunk(ShardKeyPattern::toKeyString(min));
+    const auto posMax = [&]() {
+        auto pos = _findIntersectingChunk(ShardKeyPattern::toKeyString(max), isMaxInclusive);
+        return pos == _end() ? pos : _next(pos);
     }();
 
-    return {itMin, itMax};
+    return {posMin, posMax};
+}
+
+void ChunkMap::_appendRange(const ChunkMap& other,
+                            Position begin,
+                            Position end,
+                            ChunkVector& run) {
+    invariant(_shardIds.size() >= other._shardIds.size());
+
+    for (auto pos = begin; pos < end; pos = {pos.segment + 1, 0}) {
+        const auto& segment = other._segments[pos.segment];
+        if (pos.offset == 0 && pos.segment < end.segment) {
+            _appendRun(run);
+            _pushSegment(segment);
+            continue;
+        }
+
+        const auto segmentEnd = pos.segment == end.segment ? end.offset : segment->size();
+        run.insert(run.end(),
+                   segment->chunks.begin() + pos.offset,
+                   segment->chunks.begin() + segmentEnd);
+    }
+}
+
+void ChunkMap::_appendRun(ChunkVector& run) {
+    if (run.empty())
+        return;
+
+    // A short run is merged with the segment before it, so that successive refreshes do not leave
+    // the map split into many small segments.
+    if (run.size() < kMaxSegmentSize / 2 && !_segments.empty()) {
+        const auto& lastChunks = _segments.back()->chunks;
+        run.insert(run.begin(), lastChunks.begin(), lastChunks.end());
+        _popSegment();
+    }
+
+    // The chunks are spread evenly over as few segments as can hold them.
+    const size_t numSegments = (run.size() + kMaxSegmentSize - 1) / kMaxSegmentSize;
+    for (size_t i = 0; i < numSegments; ++i) {
+        _pushSegment(_makeSegment(run.begin() + run.size() * i / numSegments,
+                                  run.begin() + run.size() * (i + 1) / numSegments));
+    }
+
+    run.clear();
+}
+
+std::shared_ptr<const ChunkMap::Segment> ChunkMap::_makeSegment(ChunkVector::const_iterator begin,
+                                                                ChunkVector::const_iterator end) {
+    auto segment = std::make_shared<Segment>();
+    const auto numChunks = std::distance(begin, end);
+    segment->chunks.reserve(numChunks);
+    segment->maxKeyPrefixes.reserve(numChunks);
+    segment->maxKeyStringOffsets.reserve(numChunks + 1);
+    segment->shardIdIndexes.reserve(numChunks);
+
+    for (auto it = begin; it != end; ++it) {
+        const auto& chunk = *it;
+        const auto& maxKeyString = chunk->getMaxKeyString();
+        uassert(5190935,
+                "The routing table is too large to be indexed",
+                segment->maxKeyStrings.size() + maxKeyString.size() <=
+                    std::numeric_limits<uint32_t>::max());
+
+        const auto shardIdIndex = _getShardIdIndex(chunk->getShardIdAt(boost::none));
+
+        // Check the continuity of the chunks where the shard which owns them changes
+        if (!segment->chunks.empty() && segment->shardIdIndexes.back() != shardIdIndex) {
+            checkContinuity(*segment->chunks.back(), *chunk);
+        }
+
+        // Tracks the max shard version for the shard on which the chunk resides
+        auto shardVersionIt = std::find_if(
+            segment->shardVersions.begin(),
+            segment->shardVersions.end(),
+            [&](const auto& shardVersion) { return shardVersion.first == shardIdIndex; });
+        if (shardVersionIt == segment->shardVersions.end()) {
+            segment->shardVersions.emplace_back(shardIdIndex, chunk->getLastmod());
+        } else if (shardVersionIt->second.isOlderThan(chunk->getLastmod())) {
+            shardVersionIt->second = chunk->getLastmod();
+        }
+
+        segment->shardIdIndexes.push_back(shardIdIndex);
+        segment->chunks.push_back(chunk);
+        segment->maxKeyPrefixes.push_back(makeKeyStringPrefix(maxKeyString));
+        segment->maxKeyStrings.append(maxKeyString);
+        segment->maxKeyStringOffsets.push_back(segment->maxKeyStrings.size());
+    }
+
+    return segment;
+}
+
+void ChunkMap::_pushSegment(std::shared_ptr<const Segment> segment) {
+    invariant(segment->size() > 0);
+    _segmentMaxKeyPrefixes.push_back(segment->maxKeyPrefixes.back());
+    _size += segment->size();
+    _segments.push_back(std::move(segment));
+}
+
+void ChunkMap::_popSegment() {
+    _size -= _segments.back()->size();
+    _segmentMaxKeyPrefixes.pop_back();
+    _segments.pop_back();
+}
+
+ChunkMap::ShardIdIndex ChunkMap::_getShardIdIndex(const ShardId& shardId) {
+    auto it = _shardIdToIndex.find(shardId);
+    if (it != _shardIdToIndex.end()) {
+        return it->second;
+    }
+
+    uassert(5190937,
+            "The routing table references too many shards",
+            _shardIds.size() <= std::numeric_limits<ShardIdIndex>::max());
+    const auto index = static_cast<ShardIdIndex>(_shardIds.size());
+    _shardIds.push_back(shardId);
+    _shardIdToIndex.emplace(shardId, index);
+    return index;
 }
 
 ShardVersionTargetingInfo::ShardVersionTargetingInfo(const OID& epoch,
@@ -367,6 +605,45 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
     return Chunk(*chunkInfo, _clusterTime);
 }
 
+std::vector<Chunk> ChunkManager::findIntersectingChunksWithSimpleCollation(
+    const std::vector<BSONObj>& shardKeys) const {
+    std::vector<std::string> keyStrings;
+    keyStrings.reserve(shardKeys.size());
+    for (const auto& shardKey : shardKeys) {
+        keyStrings.push_back(ShardKeyPattern::toKeyString(shardKey));
+    }
+
+    // The keys are looked up in ascending order, so that the lookups walk the routing table once.
+    std::vector<size_t> order(shardKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return keyStrings[lhs] < keyStrings[rhs];
+    });
+
+    std::vector<StringData> sortedKeyStrings;
+    sortedKeyStrings.reserve(order.size());
+    for (auto pos : order) {
+        sortedKeyStrings.push_back(keyStrings[pos]);
+    }
+
+    std::vector<ChunkInfo*> chunkInfos(shardKeys.size());
+    _rt->optRt->forEachIntersectingChunk(sortedKeyStrings, [&](size_t i, ChunkInfo* chunkInfo) {
+        const auto& shardKey = shardKeys[order[i]];
+        uassert(ErrorCodes::ShardKeyNotFound,
+                str::stream() << "Cannot target single shard using key " << shardKey
+                              << " for namespace " << _rt->optRt->nss(),
+                chunkInfo && chunkInfo->containsKey(shardKey));
+        chunkInfos[order[i]] = chunkInfo;
+    });
+
+    std::vector<Chunk> chunks;
+    chunks.reserve(chunkInfos.size());
+    for (auto chunkInfo : chunkInfos) {
+        chunks.emplace_back(*chunkInfo, _clusterTime);
+    }
+    return chunks;
+}
+
 bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const {
     if (shardKey.isEmpty())
         return false;
@@ -469,18 +746,26 @@ void ChunkManager::getShardIdsForRange(const BSONObj& min,
         return;
     }
 
-    _rt->optRt->forEachOverlappingChunk(min, max, true, [&](auto& chunkInfo) {
-        shardIds->insert(chunkInfo->getShardIdAt(_clusterTime));
+    // The latest owner of each chunk is available from the flat index of the routing table, which
+    // avoids visiting the chunks themselves.
+    if (!_clusterTime) {
+        _rt->optRt->forEachOverlappingShardId(min, max, true, [&](const ShardId& shardId) {
+            shardIds->insert(shardId);
 
-        // No need to iterate through the rest of the ranges, because we already know we need to use
-        // all shards. However, this optimization does not apply when we are reading from a snapshot
-        // because _shardVersions contains shards with chunks and is built based on the last
-        // refresh. Therefore, it is possible for _shardVersions to have fewer entries if a shard
-        // no longer owns chunks when it used to at _clusterTime.
-        if (!_clusterTime && shardIds->size() == _rt->optRt->_shardVersions.size()) {
-            return false;
-        }
+            // No need to iterate through the rest of the ranges, because we already know we need to
+            // use all shards.
+            return shardIds->size() != _rt->optRt->_shardVersions.size();
+        });
+        return;
+    }
 
+    // This is a read from a snapshot, so the shards owning the chunks at '_clusterTime' have to be
+    // looked up in their history. Note that the optimization above to stop iterating once all the
+    // shards have been found does not apply here, because _shardVersions contains shards with
+    // chunks and is built based on the last refresh. Therefore, it is possible for _shardVersions
+    // to have fewer entries if a shard no longer owns chunks when it used to at _clusterTime.
+    _rt->optRt->forEachOverlappingChunk(min, max, true, [&](auto& chunkInfo) {
+        shardIds->insert(chunkInfo->getShardIdAt(_clusterTime));
         return true;
     });
 }
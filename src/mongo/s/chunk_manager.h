@@ -70,21 +70,26 @@ using ShardVersionMap = stdx::unordered_map<ShardId, ShardVersionTargetingInfo,
  * This class serves as a Facade around how the mapping of ranges to chunks is represented. It also
  * provides a simpler, high-level interface for domain specific operations without exposing the
  * underlying implementation.
+ *
+ * The chunks are held in immutable segments of consecutive chunks, which the maps created from one
+ * another by createMerged() share for as long as none of their chunks changes. A refresh therefore
+ * only rebuilds the segments which its changed chunks overlap, along with the top level vector of
+ * segments.
  */
 class ChunkMap {
     // Vector of chunks ordered by max key.
     using ChunkVector = std::vector<std::shared_ptr<ChunkInfo>>;
 
 public:
-    explicit ChunkMap(OID epoch,
-                      const boost::optional<Timestamp>& timestamp,
-                      size_t initialCapacity = 0)
-        : _collectionVersion(0, 0, epoch, timestamp) {
-        _chunkMap.reserve(initialCapacity);
-    }
+    // The most chunks which a segment holds. Segments which are rebuilt with fewer than half as
+    // many chunks are merged with the segment before them.
+    static constexpr size_t kMaxSegmentSize = 1024;
+
+    explicit ChunkMap(OID epoch, const boost::optional<Timestamp>& timestamp)
+        : _collectionVersion(0, 0, epoch, timestamp) {}
 
     size_t size() const {
-        return _chunkMap.size();
+        return _size;
     }
 
     ChunkVersion getVersion() const {
@@ -93,12 +98,13 @@ public:
 
     template <typename Callable>
     void forEach(Callable&& handler, const BSONObj& shardKey = BSONObj()) const {
-        auto it = shardKey.isEmpty() ? _chunkMap.begin() : _findIntersectingChunk(shardKey);
+        const auto begin = shardKey.isEmpty()
+            ? _begin()
+            : _findIntersectingChunk(ShardKeyPattern::toKeyString(shardKey));
 
-        for (; it != _chunkMap.end(); ++it) {
-            if (!handler(*it))
-                break;
-        }
+        _forEachInRange(begin, _end(), [&](const Segment& segment, size_t offset) {
+            return handler(segment.chunks[offset]);
+        });
     }
 
     template <typename Callable>
@@ -108,28 +114,228 @@ public:
                                  Callable&& handler) const {
         const auto bounds = _overlappingBounds(min, max, isMaxInclusive);
 
-        for (auto it = bounds.first; it != bounds.second; ++it) {
-            if (!handler(*it))
-                break;
+        _forEachInRange(bounds.first, bounds.second, [&](const Segment& segment, size_t offset) {
+            return handler(segment.chunks[offset]);
+        });
+    }
+
+    /**
+     * Same as forEachOverlappingChunk(), but only passes to 'handler' the shard which owns each
+     * chunk at the latest version, which is read from the flat index without touching the chunks.
+     */
+    template <typename Callable>
+    void forEachOverlappingShardId(const BSONObj& min,
+                                   const BSONObj& max,
+                                   bool isMaxInclusive,
+                                   Callable&& handler) const {
+        const auto bounds = _overlappingBounds(min, max, isMaxInclusive);
+
+        _forEachInRange(bounds.first, bounds.second, [&](const Segment& segment, size_t offset) {
+            return handler(_shardIds[segment.shardIdIndexes[offset]]);
+        });
+    }
+
+    /**
+     * Passes to 'handler' the position of each of 'sortedKeyStrings', which must be the KeyStrings
+     * of shard keys in ascending order, along with the chunk which contains it, or nullptr if there
+     * is no such chunk. Because the keys are sorted, each lookup resumes where the previous one
+     * ended, so that a batch of keys is located with a single pass over the routing table.
+     */
+    template <typename Callable>
+    void forEachIntersectingChunk(const std::vector<StringData>& sortedKeyStrings,
+                                  Callable&& handler) const {
+        auto pos = _begin();
+        for (size_t i = 0; i < sortedKeyStrings.size(); ++i) {
+            pos = _findIntersectingChunkFrom(pos, sortedKeyStrings[i]);
+            handler(i, pos != _end() ? _getChunk(pos).get() : nullptr);
         }
     }
 
     ShardVersionMap constructShardVersionMap() const;
     std::shared_ptr<ChunkInfo> findIntersectingChunk(const BSONObj& shardKey) const;
 
-    void appendChunk(const std::shared_ptr<ChunkInfo>& chunk);
-
     ChunkMap createMerged(const std::vector<std::shared_ptr<ChunkInfo>>& changedChunks) const;
 
+    /**
+     * Returns the number of the segments of this map which are shared with 'other'.
+     */
+    size_t numSharedSegments(const ChunkMap& other) const;
+
     BSONObj toBSON() const;
 
 private:
-    ChunkVector::const_iterator _findIntersectingChunk(const BSONObj& shardKey,
-                                                       bool isMaxInclusive = true) const;
-    std::pair<ChunkVector::const_iterator, ChunkVector::const_iterator> _overlappingBounds(
-        const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const;
+    using ShardIdIndex = uint16_t;
+
+    /**
+     * An immutable run of consecutive chunks of the map, along with the flat index which the
+     * lookups of the routing table run over. Entry 'i' of each of the vectors below describes
+     * 'chunks[i]'.
+     *
+     * The max bounds of the chunks are stored as KeyStrings, which compare with memcmp, one after
+     * another in 'maxKeyStrings'. The max bound of chunk 'i' spans the bytes from
+     * 'maxKeyStringOffsets[i]' to 'maxKeyStringOffsets[i + 1]', so there is one more offset than
+     * there are chunks. 'maxKeyPrefixes' holds the first eight bytes of each KeyString as a big
+     * endian integer, padded with zeros, which orders most of the bounds without going to the
+     * buffer.
+     */
+    struct Segment {
+        size_t size() const {
+            return chunks.size();
+        }
+
+        StringData getMaxKeyString(size_t offset) const {
+            return StringData(maxKeyStrings.data() + maxKeyStringOffsets[offset],
+                              maxKeyStringOffsets[offset + 1] - maxKeyStringOffsets[offset]);
+        }
+
+        /**
+         * Compares the max bound of the chunk at 'offset' with 'keyString', whose prefix is
+         * 'prefix', with the same semantics as memcmp.
+         */
+        int compareMaxKeyString(size_t offset, uint64_t prefix, StringData keyString) const;
+
+        /**
+         * Binary searches the 'count' chunks starting at 'low' for the first one whose max bound
+         * is greater than 'keyString', or greater than or equal to it if 'isMaxInclusive' is false.
+         */
+        size_t search(size_t low,
+                      size_t count,
+                      uint64_t prefix,
+                      StringData keyString,
+                      bool isMaxInclusive) const;
+
+        /**
+         * Same as search() with an inclusive max bound, but gallops forward from 'begin', so that
+         * it takes time logarithmic in the distance from 'begin' to the result. The max bound of
+         * the last chunk of the segment must be greater than 'keyString'.
+         */
+        size_t gallop(size_t begin, uint64_t prefix, StringData keyString) const;
+
+        ChunkVector chunks;
+        std::vector<uint64_t> maxKeyPrefixes;
+        std::vector<uint32_t> maxKeyStringOffsets{0};
+        std::string maxKeyStrings;
+
+        // The shard which owns each chunk at the latest version, as an index into the '_shardIds'
+        // of the map.
+        std::vector<ShardIdIndex> shardIdIndexes;
+
+        // The max version of the chunks of each shard which owns chunks in the segment.
+        std::vector<std::pair<ShardIdIndex, ChunkVersion>> shardVersions;
+    };
+
+    /**
+     * The position of a chunk in the map, as the index of the segment which holds it and its
+     * offset in that segment. The position past the last chunk is {_segments.size(), 0}.
+     */
+    struct Position {
+        bool operator==(const Position& other) const {
+            return segment == other.segment && offset == other.offset;
+        }
+        bool operator!=(const Position& other) const {
+            return !(*this == other);
+        }
+        bool operator<(const Position& other) const {
+            return segment < other.segment || (segment == other.segment && offset < other.offset);
+        }
+
+        size_t segment;
+        size_t offset;
+    };
+
+    Position _begin() const {
+        return {0, 0};
+    }
+
+    Position _end() const {
+        return {_segments.size(), 0};
+    }
+
+    Position _next(Position pos) const {
+        if (pos.offset + 1 < _segments[pos.segment]->size())
+            return {pos.segment, pos.offset + 1};
+        return {pos.segment + 1, 0};
+    }
+
+    const std::shared_ptr<ChunkInfo>& _getChunk(Position pos) const {
+        return _segments[pos.segment]->chunks[pos.offset];
+    }
 
-    ChunkVector _chunkMap;
+    /**
+     * Passes to 'handler' the segment and offset of each chunk from 'begin' up to but excluding
+     * 'end', until 'handler' returns false.
+     */
+    template <typename Callable>
+    void _forEachInRange(Position begin, Position end, Callable&& handler) const {
+        for (auto pos = begin; pos < end; pos = {pos.segment + 1, 0}) {
+            const auto& segment = *_segments[pos.segment];
+            const auto segmentEnd = pos.segment == end.segment ? end.offset : segment.size();
+            for (; pos.offset < segmentEnd; ++pos.offset) {
+                if (!handler(segment, pos.offset))
+                    return;
+            }
+        }
+    }
+
+    /**
+     * Returns the position of the first chunk whose max bound is greater than 'keyString', or
+     * greater than or equal to it if 'isMaxInclusive' is false. Returns _end() if there is no such
+     * chunk.
+     */
+    Position _findIntersectingChunk(StringData keyString, bool isMaxInclusive = true) const;
+
+    /**
+     * Same as _findIntersectingChunk(), but only looks at the chunks from position 'begin' onwards.
+     * Gallops forward from 'begin' before it searches, so that it takes time logarithmic in the
+     * distance from 'begin' to the result rather than in the number of chunks.
+     */
+    Position _findIntersectingChunkFrom(Position begin, StringData keyString) const;
+
+    /**
+     * Compares the max bound of the last chunk of the segment at 'idx' with 'keyString', whose
+     * prefix is 'prefix', with the same semantics as memcmp.
+     */
+    int _compareSegmentMaxKeyString(size_t idx, uint64_t prefix, StringData keyString) const;
+
+    std::pair<Position, Position> _overlappingBounds(const BSONObj& min,
+                                                     const BSONObj& max,
+                                                     bool isMaxInclusive) const;
+
+    /**
+     * Appends the chunks of 'other' from 'begin' up to but excluding 'end'. The segments of
+     * 'other' which lie entirely in the range are shared after 'run' is appended, and the chunks
+     * of the others are added to 'run'. 'other' must have been created with the same shard ids as
+     * this map.
+     */
+    void _appendRange(const ChunkMap& other, Position begin, Position end, ChunkVector& run);
+
+    /**
+     * Appends the chunks of 'run' in new segments of at most kMaxSegmentSize chunks each, and
+     * clears it.
+     */
+    void _appendRun(ChunkVector& run);
+
+    std::shared_ptr<const Segment> _makeSegment(ChunkVector::const_iterator begin,
+                                                ChunkVector::const_iterator end);
+    void _pushSegment(std::shared_ptr<const Segment> segment);
+    void _popSegment();
+
+    ShardIdIndex _getShardIdIndex(const ShardId& shardId);
+
+    // The segments of the map, in the order of their chunks.
+    std::vector<std::shared_ptr<const Segment>> _segments;
+
+    // The 'maxKeyPrefixes' of the last chunk of each of '_segments', which the lookups compare
+    // with before they descend into a segment.
+    std::vector<uint64_t> _segmentMaxKeyPrefixes;
+
+    // The number of chunks across all segments.
+    size_t _size{0};
+
+    // The shards which own chunks at the latest version. A map created from this one only ever
+    // appends to them, so that the 'shardIdIndexes' of the segments it shares remain valid.
+    std::vector<ShardId> _shardIds;
+    stdx::unordered_map<ShardId, ShardIdIndex, ShardId::Hasher> _shardIdToIndex;
 
     // Max version across all chunks
     ChunkVersion _collectionVersion;
@@ -253,10 +459,25 @@ public:
             min, max, isMaxInclusive, std::forward<Callable>(handler));
     }
 
+    template <typename Callable>
+    void forEachOverlappingShardId(const BSONObj& min,
+                                   const BSONObj& max,
+                                   bool isMaxInclusive,
+                                   Callable&& handler) const {
+        _chunkMap.forEachOverlappingShardId(
+            min, max, isMaxInclusive, std::forward<Callable>(handler));
+    }
+
     std::shared_ptr<ChunkInfo> findIntersectingChunk(const BSONObj& shardKey) const {
         return _chunkMap.findIntersectingChunk(shardKey);
     }
 
+    template <typename Callable>
+    void forEachIntersectingChunk(const std::vector<StringData>& sortedKeyStrings,
+                                  Callable&& handler) const {
+        _chunkMap.forEachIntersectingChunk(sortedKeyStrings, std::forward<Callable>(handler));
+    }
+
     /**
      * Returns the ids of all shards on which the collection has any chunks.
      */
@@ -596,6 +817,17 @@ public:
         return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
     }
 
+    /**
+     * Same as findIntersectingChunkWithSimpleCollation, but for a batch of shard keys, which are
+     * located with a single pass over the routing table. The chunk at position 'i' of the result
+     * contains 'shardKeys[i]'.
+     *
+     * Throws a DBException with the ShardKeyNotFound code if any of the keys does not match the
+     * shard key pattern.
+     */
+    std::vector<Chunk> findIntersectingChunksWithSimpleCollation(
+        const std::vector<BSONObj>& shardKeys) const;
+
     /**
      * Finds the shard id of the shard that owns the chunk minKey belongs to, assuming the simple
      * collation because shard keys do not support non-simple collations.
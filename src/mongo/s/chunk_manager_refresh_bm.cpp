@@ -147,7 +147,66 @@ void BM_IncrementalRefreshOfPessimalBalancedDistribution(benchmark::State& state
 BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)
     ->Args({2, 50000})
     ->Args({2, 250000})
-    ->Args({2, 500000});
+    ->Args({2, 500000})
+    ->Args({2, 1000000});
+
+void BM_IncrementalRefreshOfOptimalBalancedDistribution(benchmark::State& state) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+    auto metadata = makeChunkManagerWithOptimalBalancedDistribution(nShards, nChunks);
+
+    // Splits a chunk in the middle of the table and moves one of the halves to another shard, which
+    // leaves the long runs of chunks on the same shard before and after it unchanged.
+    const auto splitChunk = getRangeForChunk(nChunks / 2, nChunks);
+    const auto splitPoint = BSON("_id" << splitChunk.getMin()["_id"].numberLong() + 50);
+    auto postMoveVersion = metadata.getChunkManager()->getVersion();
+    std::vector<ChunkType> newChunks;
+    postMoveVersion.incMinor();
+    newChunks.emplace_back(kNss,
+                           ChunkRange(splitChunk.getMin(), splitPoint),
+                           postMoveVersion,
+                           optimalShardSelector(nChunks / 2, nShards, nChunks));
+    postMoveVersion.incMajor();
+    newChunks.emplace_back(
+        kNss, ChunkRange(splitPoint, splitChunk.getMax()), postMoveVersion, ShardId("shard0"));
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(runIncrementalUpdate(metadata, newChunks));
+    }
+}
+
+BENCHMARK(BM_IncrementalRefreshOfOptimalBalancedDistribution)
+    ->Args({2, 50000})
+    ->Args({10, 250000})
+    ->Args({10, 1000000});
+
+void BM_SuccessiveIncrementalRefreshes(benchmark::State& state) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+    auto metadata = makeChunkManagerWithOptimalBalancedDistribution(nShards, nChunks);
+
+    // Each refresh splits a chunk of the routing table produced by the refresh before it, the way
+    // the routing table of a mongos changes over time, so that the segments which the refreshes do
+    // not share accumulate across iterations.
+    PseudoRandom rand(12345);
+    auto version = metadata.getChunkManager()->getVersion();
+    for (auto keepRunning : state) {
+        state.PauseTiming();
+        const auto splitChunk = getRangeForChunk(1 + rand.nextInt32(nChunks - 2), nChunks);
+        const auto splitPoint = BSON("_id" << splitChunk.getMin()["_id"].numberLong() + 50);
+        std::vector<ChunkType> newChunks;
+        version.incMajor();
+        newChunks.emplace_back(
+            kNss, ChunkRange(splitChunk.getMin(), splitPoint), version, ShardId("shard0"));
+        newChunks.emplace_back(
+            kNss, ChunkRange(splitPoint, splitChunk.getMax()), version, ShardId("shard1"));
+        state.ResumeTiming();
+
+        metadata = runIncrementalUpdate(metadata, newChunks);
+    }
+}
+
+BENCHMARK(BM_SuccessiveIncrementalRefreshes)->Args({10, 250000})->Args({10, 1000000});
 
 template <typename ShardSelectorFn>
 auto BM_FullBuildOfChunkManager(benchmark::State& state, ShardSelectorFn selectShard) {
@@ -284,6 +343,35 @@ void BM_FindIntersectingChunk(benchmark::State& state,
     state.SetItemsProcessed(state.iterations());
 }
 
+template <typename CollectionMetadataBuilderFn>
+void BM_FindIntersectingChunks(benchmark::State& state,
+                               CollectionMetadataBuilderFn makeCollectionMetadata) {
+    // The number of shard keys located together, as for the documents of a bulk insert.
+    constexpr size_t kBatchSize = 1000;
+
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+
+    auto metadata = makeCollectionMetadata(nShards, nChunks);
+    auto keys = makeKeys(nChunks);
+    auto keysIter = makeCircularIterator(keys);
+
+    std::vector<BSONObj> batch(kBatchSize);
+    for (auto keepRunning : state) {
+        state.PauseTiming();
+        for (auto& key : batch) {
+            key = *keysIter;
+            ++keysIter;
+        }
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(
+            metadata.getChunkManager()->findIntersectingChunksWithSimpleCollation(batch));
+    }
+
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
 template <typename CollectionMetadataBuilderFn>
 void BM_GetShardIdsForRange(benchmark::State& state,
                             CollectionMetadataBuilderFn makeCollectionMetadata) {
@@ -384,6 +472,10 @@ MONGO_INITIALIZER(RegisterBenchmarks)(InitializerContext* context) {
             BM_FindIntersectingChunk, Pessimal, makeChunkManagerWithPessimalBalancedDistribution),
         REGISTER_BENCHMARK_CAPTURE(
             BM_FindIntersectingChunk, Optimal, makeChunkManagerWithOptimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(
+            BM_FindIntersectingChunks, Pessimal, makeChunkManagerWithPessimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(
+            BM_FindIntersectingChunks, Optimal, makeChunkManagerWithOptimalBalancedDistribution),
         REGISTER_BENCHMARK_CAPTURE(
             BM_GetShardIdsForRange, Pessimal, makeChunkManagerWithPessimalBalancedDistribution),
         REGISTER_BENCHMARK_CAPTURE(
@@ -409,6 +501,7 @@ MONGO_INITIALIZER(RegisterBenchmarks)(InitializerContext* context) {
             ->Args({10, 50000})
             ->Args({100, 50000})
             ->Args({1000, 50000})
+            ->Args({10, 1000000})
             ->Args({2, 2});
     }
 }
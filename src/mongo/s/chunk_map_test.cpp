@@ -30,6 +30,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/s/chunk_manager.h"
+#include "mongo/s/chunk_writes_tracker.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -132,6 +133,52 @@ TEST_F(ChunkMapTest, TestIntersectingChunk) {
                                                        BSON("a" << 100)));
 }
 
+TEST_F(ChunkMapTest, TestIntersectingChunksOfSortedKeys) {
+    const OID epoch = OID::gen();
+    ChunkMap chunkMap{epoch, boost::none /* timestamp */};
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+
+    std::vector<BSONObj> bounds{getShardKeyPattern().globalMin()};
+    for (int i = 0; i < 100; ++i) {
+        bounds.push_back(BSON("a" << i * 10));
+    }
+    bounds.push_back(getShardKeyPattern().globalMax());
+
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        chunks.push_back(std::make_shared<ChunkInfo>(
+            ChunkType{kNss, ChunkRange{bounds[i], bounds[i + 1]}, version, kThisShard}));
+    }
+    auto newChunkMap = chunkMap.createMerged(chunks);
+
+    // The keys fall in neighbouring chunks, in the same chunk and in chunks far apart, so that the
+    // lookups resume from the previous result by both short and long distances.
+    const std::vector<BSONObj> shardKeys{BSON("a" << -5),
+                                         BSON("a" << 0),
+                                         BSON("a" << 0),
+                                         BSON("a" << 3),
+                                         BSON("a" << 10),
+                                         BSON("a" << 25),
+                                         BSON("a" << 640),
+                                         BSON("a" << 647),
+                                         BSON("a" << 990),
+                                         BSON("a" << 5000)};
+    std::vector<std::string> keyStrings;
+    for (const auto& shardKey : shardKeys) {
+        keyStrings.push_back(ShardKeyPattern::toKeyString(shardKey));
+    }
+    const std::vector<StringData> sortedKeyStrings(keyStrings.begin(), keyStrings.end());
+
+    size_t count = 0;
+    newChunkMap.forEachIntersectingChunk(sortedKeyStrings, [&](size_t i, ChunkInfo* chunk) {
+        ASSERT_EQ(count++, i);
+        ASSERT(chunk);
+        ASSERT_EQ(newChunkMap.findIntersectingChunk(shardKeys[i]).get(), chunk);
+        ASSERT(chunk->containsKey(shardKeys[i]));
+    });
+    ASSERT_EQ(shardKeys.size(), count);
+}
+
 TEST_F(ChunkMapTest, TestEnumerateOverlappingChunks) {
     const OID epoch = OID::gen();
     ChunkMap chunkMap{epoch, boost::none /* timestamp */};
@@ -165,4 +212,184 @@ TEST_F(ChunkMapTest, TestEnumerateOverlappingChunks) {
     ASSERT_EQ(count, 3);
 }
 
-}  // namespace mongo
\ No newline at end of file
+TEST_F(ChunkMapTest, TestIntersectingChunkWithCommonKeyPrefixes) {
+    const OID epoch = OID::gen();
+    ChunkMap chunkMap{epoch, boost::none /* timestamp */};
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+
+    // The bounds share a prefix longer than the one held by the flat index, so that the lookups
+    // have to compare the full KeyStrings.
+    const std::vector<BSONObj> bounds{getShardKeyPattern().globalMin(),
+                                      BSON("a"
+                                           << "commonprefix_b"),
+                                      BSON("a"
+                                           << "commonprefix_d"),
+                                      BSON("a"
+                                           << "commonprefix_f"),
+                                      getShardKeyPattern().globalMax()};
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        chunks.push_back(std::make_shared<ChunkInfo>(
+            ChunkType{kNss, ChunkRange{bounds[i], bounds[i + 1]}, version, kThisShard}));
+    }
+    auto newChunkMap = chunkMap.createMerged(chunks);
+
+    auto assertIntersectingChunkMin = [&](const BSONObj& shardKey, const BSONObj& expectedMin) {
+        auto intersectingChunk = newChunkMap.findIntersectingChunk(shardKey);
+        ASSERT(intersectingChunk);
+        ASSERT_BSONOBJ_EQ(expectedMin, intersectingChunk->getMin());
+    };
+
+    assertIntersectingChunkMin(BSON("a"
+                                    << "commonprefix_a"),
+                               bounds[0]);
+    assertIntersectingChunkMin(BSON("a"
+                                    << "commonprefix"),
+                               bounds[0]);
+    assertIntersectingChunkMin(BSON("a"
+                                    << "commonprefix_b"),
+                               bounds[1]);
+    assertIntersectingChunkMin(BSON("a"
+                                    << "commonprefix_c"),
+                               bounds[1]);
+    assertIntersectingChunkMin(BSON("a"
+                                    << "commonprefix_e"),
+                               bounds[2]);
+    assertIntersectingChunkMin(BSON("a"
+                                    << "commonprefix_fa"),
+                               bounds[3]);
+    assertIntersectingChunkMin(BSON("a" << 10), bounds[0]);
+}
+
+TEST_F(ChunkMapTest, TestMergeSplitAndMovedChunks) {
+    const OID epoch = OID::gen();
+    const ShardId kOtherShard("otherShard");
+    ChunkMap chunkMap{epoch, boost::none /* timestamp */};
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+
+    auto makeChunk = [&](const BSONObj& min, const BSONObj& max, const ShardId& shard) {
+        return std::make_shared<ChunkInfo>(ChunkType{kNss, ChunkRange{min, max}, version, shard});
+    };
+
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    chunks.push_back(makeChunk(getShardKeyPattern().globalMin(), BSON("a" << 0), kThisShard));
+    for (int i = 0; i < 10; ++i) {
+        chunks.push_back(makeChunk(BSON("a" << i * 10), BSON("a" << (i + 1) * 10), kThisShard));
+    }
+    chunks.push_back(makeChunk(BSON("a" << 100), getShardKeyPattern().globalMax(), kThisShard));
+    auto initialChunkMap = chunkMap.createMerged(chunks);
+    ASSERT_EQ(12, initialChunkMap.size());
+
+    initialChunkMap.findIntersectingChunk(BSON("a" << 25))->getWritesTracker()->addBytesWritten(7);
+
+    // Split [20, 30) in two and move [50, 60) to the other shard.
+    version.incMajor();
+    auto splitLow = makeChunk(BSON("a" << 20), BSON("a" << 25), kThisShard);
+    version.incMinor();
+    auto splitHigh = makeChunk(BSON("a" << 25), BSON("a" << 30), kThisShard);
+    version.incMajor();
+    auto moved = makeChunk(BSON("a" << 50), BSON("a" << 60), kOtherShard);
+
+    auto updatedChunkMap = initialChunkMap.createMerged({splitLow, splitHigh, moved});
+    ASSERT_EQ(13, updatedChunkMap.size());
+    ASSERT_EQ(version, updatedChunkMap.getVersion());
+    ASSERT_EQ(7, splitLow->getWritesTracker()->getBytesWritten());
+    ASSERT_EQ(7, splitHigh->getWritesTracker()->getBytesWritten());
+
+    ASSERT_EQ(splitLow, updatedChunkMap.findIntersectingChunk(BSON("a" << 20)));
+    ASSERT_EQ(splitHigh, updatedChunkMap.findIntersectingChunk(BSON("a" << 29)));
+    ASSERT_EQ(moved, updatedChunkMap.findIntersectingChunk(BSON("a" << 55)));
+    ASSERT_EQ(initialChunkMap.findIntersectingChunk(BSON("a" << 95)),
+              updatedChunkMap.findIntersectingChunk(BSON("a" << 95)));
+
+    // The chunks are still ordered and contiguous.
+    BSONObj lastMax = getShardKeyPattern().globalMin();
+    updatedChunkMap.forEach([&](const auto& chunk) {
+        ASSERT_BSONOBJ_EQ(lastMax, chunk->getMin());
+        lastMax = chunk->getMax();
+        return true;
+    });
+    ASSERT_BSONOBJ_EQ(getShardKeyPattern().globalMax(), lastMax);
+
+    auto shardVersions = updatedChunkMap.constructShardVersionMap();
+    ASSERT_EQ(2, shardVersions.size());
+    ASSERT_EQ(version, shardVersions.at(kOtherShard).shardVersion);
+
+    std::vector<ShardId> shardIds;
+    updatedChunkMap.forEachOverlappingShardId(
+        BSON("a" << 45), BSON("a" << 65), true, [&](const ShardId& shardId) {
+            shardIds.push_back(shardId);
+            return true;
+        });
+    ASSERT(shardIds == (std::vector<ShardId>{kThisShard, kOtherShard, kThisShard}));
+}
+
+TEST_F(ChunkMapTest, TestRefreshesShareUnchangedSegments) {
+    const OID epoch = OID::gen();
+    ChunkMap chunkMap{epoch, boost::none /* timestamp */};
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+    const ShardId kOtherShard("otherShard");
+
+    auto makeChunk = [&](const BSONObj& min, const BSONObj& max, const ShardId& shard) {
+        return std::make_shared<ChunkInfo>(ChunkType{kNss, ChunkRange{min, max}, version, shard});
+    };
+
+    // Enough chunks for the map to be split into several segments.
+    const int kNumChunks = 5 * ChunkMap::kMaxSegmentSize;
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    chunks.push_back(makeChunk(getShardKeyPattern().globalMin(), BSON("a" << 0), kThisShard));
+    for (int i = 0; i < kNumChunks - 2; ++i) {
+        chunks.push_back(makeChunk(BSON("a" << i * 100), BSON("a" << (i + 1) * 100), kThisShard));
+    }
+    chunks.push_back(makeChunk(
+        BSON("a" << (kNumChunks - 2) * 100), getShardKeyPattern().globalMax(), kThisShard));
+    auto initialChunkMap = chunkMap.createMerged(chunks);
+    ASSERT_EQ(kNumChunks, initialChunkMap.size());
+    const auto numSegments = initialChunkMap.numSharedSegments(initialChunkMap);
+    ASSERT_EQ(5, numSegments);
+
+    // Splitting a chunk in the middle of the map only rebuilds the segment which holds it.
+    version.incMajor();
+    auto splitLow = makeChunk(BSON("a" << 250000), BSON("a" << 250050), kThisShard);
+    version.incMajor();
+    auto splitHigh = makeChunk(BSON("a" << 250050), BSON("a" << 250100), kOtherShard);
+    auto updatedChunkMap = initialChunkMap.createMerged({splitLow, splitHigh});
+    ASSERT_EQ(kNumChunks + 1, updatedChunkMap.size());
+    ASSERT_EQ(numSegments - 1, updatedChunkMap.numSharedSegments(initialChunkMap));
+    ASSERT_EQ(splitLow, updatedChunkMap.findIntersectingChunk(BSON("a" << 250000)));
+    ASSERT_EQ(splitHigh, updatedChunkMap.findIntersectingChunk(BSON("a" << 250099)));
+    ASSERT_EQ(initialChunkMap.findIntersectingChunk(BSON("a" << 1000)),
+              updatedChunkMap.findIntersectingChunk(BSON("a" << 1000)));
+
+    // Successive refreshes, each of which builds on the one before it, keep sharing most of the
+    // segments and leave the chunks ordered and contiguous.
+    for (int i = 0; i < 100; ++i) {
+        const int splitMin = ((i * 37) % (kNumChunks - 2)) * 100;
+        auto previousChunkMap = updatedChunkMap;
+        version.incMajor();
+        updatedChunkMap = previousChunkMap.createMerged(
+            {makeChunk(BSON("a" << splitMin), BSON("a" << splitMin + 50), kThisShard),
+             makeChunk(BSON("a" << splitMin + 50), BSON("a" << splitMin + 100), kOtherShard)});
+        ASSERT_EQ(previousChunkMap.size() + 1, updatedChunkMap.size());
+        ASSERT_GTE(updatedChunkMap.numSharedSegments(previousChunkMap) + 2,
+                   previousChunkMap.numSharedSegments(previousChunkMap));
+    }
+
+    BSONObj lastMax = getShardKeyPattern().globalMin();
+    size_t count = 0;
+    updatedChunkMap.forEach([&](const auto& chunk) {
+        ASSERT_BSONOBJ_EQ(lastMax, chunk->getMin());
+        ASSERT_EQ(chunk, updatedChunkMap.findIntersectingChunk(chunk->getMin()));
+        lastMax = chunk->getMax();
+        ++count;
+        return true;
+    });
+    ASSERT_BSONOBJ_EQ(getShardKeyPattern().globalMax(), lastMax);
+    ASSERT_EQ(updatedChunkMap.size(), count);
+
+    auto shardVersions = updatedChunkMap.constructShardVersionMap();
+    ASSERT_EQ(2, shardVersions.size());
+    ASSERT_EQ(version, shardVersions.at(kOtherShard).shardVersion);
+}
+
+}  // namespace mongo
@@ -34,15 +34,20 @@
 #include "mongo/s/query/async_results_merger.h"
 
 #include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/client/read_preference.h"
 #include "mongo/client/remote_command_targeter.h"
 #include "mongo/db/pipeline/change_stream_constants.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/kill_cursors_gen.h"
+#include "mongo/executor/hedging_metrics.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/s/catalog/type_shard.h"
+#include "mongo/s/client/shard_registry.h"
+#include "mongo/s/grid.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/cancelation.h"
 
 namespace mongo {
 
@@ -93,6 +98,81 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, rules);
 }
 
+/**
+ * The latencies of the most recent getMores of non-tailable cursors, from which the time after
+ * which a getMore is hedged is computed.
+ */
+class GetMoreLatencies {
+public:
+    void record(Milliseconds latency) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_samples.size() < kMaxSamples) {
+            _samples.push_back(latency);
+        } else {
+            _samples[_next] = latency;
+            _next = (_next + 1) % kMaxSamples;
+        }
+    }
+
+    /**
+     * Returns the 'getMoreHedgingPercentile' of the recorded latencies, or
+     * 'getMoreHedgingMinDelayMS' if greater.
+     */
+    Milliseconds hedgingDelay() const {
+        const Milliseconds minDelay(gGetMoreHedgingMinDelayMS.load());
+        std::vector<Milliseconds> samples;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            samples = _samples;
+        }
+        if (samples.empty()) {
+            return minDelay;
+        }
+        const auto rank = (samples.size() - 1) * gGetMoreHedgingPercentile.load() / 100;
+        std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+        return std::max(minDelay, samples[rank]);
+    }
+
+private:
+    static constexpr size_t kMaxSamples = 1000;
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("GetMoreLatencies::_mutex");
+    std::vector<Milliseconds> _samples;
+    size_t _next = 0;
+} getMoreLatencies;
+
+/**
+ * Returns 'establishingCommand', a find sorted by _id alone, amended to return the documents which
+ * sort after the one whose sort key is 'lastSortKey'. The bound is set on the _id index rather
+ * than in the filter, as index bounds order values of different types the way the sort does.
+ */
+BSONObj makeResumedFindCommand(const BSONObj& establishingCommand,
+                               const BSONObj& sort,
+                               const BSONObj& lastSortKey) {
+    if (lastSortKey.isEmpty()) {
+        return establishingCommand;
+    }
+    const auto lastId = lastSortKey.firstElement();
+    const bool ascending = sort.firstElement().numberInt() >= 0;
+
+    BSONObjBuilder cmdBuilder;
+    for (auto&& elem : establishingCommand) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName != "filter"_sd && fieldName != "hint"_sd) {
+            cmdBuilder.append(elem);
+        }
+    }
+
+    // The 'min' bound is inclusive, so the document last received is excluded by the filter.
+    const auto filter = establishingCommand["filter"];
+    cmdBuilder.append("filter",
+                      BSON("$and" << BSON_ARRAY((filter.isABSONObj() ? filter.Obj() : BSONObj())
+                                                << BSON("_id" << BSON("$ne" << lastId)))));
+    cmdBuilder.append("hint", BSON("_id" << 1));
+    cmdBuilder.append(ascending ? "min" : "max", BSON("_id" << lastId));
+    return cmdBuilder.obj();
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -107,7 +187,8 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       _params(std::move(params)),
       _mergeQueue(MergingComparator(
           _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey())),
-      _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))) {
+      _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))),
+      _createdDate(_executor->now()) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
     }
@@ -118,6 +199,10 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId(),
                               remote.getCursorResponse().getPartialResultsReturned());
+        _remotes.back().shardId = ShardId(remote.getShardId().toString());
+        if (auto establishingCommand = remote.getEstablishingCommand()) {
+            _remotes.back().establishingCommand = establishingCommand->getOwned();
+        }
 
         // A remote cannot be flagged as 'partialResultsReturned' if 'allowPartialResults' is false.
         invariant(!(_remotes.back().partialResultsReturned && !_params.getAllowPartialResults()));
@@ -149,7 +234,14 @@ void AsyncResultsMerger::_setInitialHighWaterMark() {
 }
 
 AsyncResultsMerger::~AsyncResultsMerger() {
-    stdx::lock_guard<Latch> lk(_mutex);
+    stdx::unique_lock<Latch> lk(_mutex);
+
+    // The hedging callbacks which have not run yet refer to this merger.
+    for (auto& remote : _remotes) {
+        _cancelHedging(lk, remote);
+    }
+    _hedgingCallbacksDone.wait(lk, [&] { return _numHedgingCallbacks == 0; });
+
     invariant(_remotesExhausted(lk) || _lifecycleState == kKillComplete);
 }
 
@@ -244,6 +336,17 @@ std::size_t AsyncResultsMerger::getNumRemotes() const {
     });
 }
 
+RouterExecStage::MergeStats AsyncResultsMerger::getMergeStats() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    RouterExecStage::MergeStats stats;
+    stats.bufferedBytes = _bufferedBytes;
+    const auto elapsed = _executor->now() - _createdDate;
+    if (elapsed > Milliseconds(0)) {
+        stats.docsPerSec = _numReturned * 1000.0 / durationCount<Milliseconds>(elapsed);
+    }
+    return stats;
+}
+
 BSONObj AsyncResultsMerger::getHighWaterMark() {
     stdx::lock_guard<Latch> lk(_mutex);
     // At this point, the high water mark may be the resume token of the last document we returned.
@@ -355,7 +458,7 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return _params.getSort() ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
@@ -369,8 +472,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _popNextResult(lk, smallestRemote);
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
@@ -389,15 +491,14 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popNextResult(lk, _gettingFromRemote);
 
             if (_tailableMode == TailableModeEnum::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -420,7 +521,19 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
-Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
+ClusterQueryResult AsyncResultsMerger::_popNextResult(WithLock, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+
+    const auto resultBytes = front.getResult() ? front.getResult()->objsize() : 0;
+    remote.bufferedBytes -= resultBytes;
+    _bufferedBytes -= resultBytes;
+    ++_numReturned;
+    return front;
+}
+
+Status AsyncResultsMerger::_askForNextBatch(WithLock lk, size_t remoteIndex) {
     invariant(_opCtx, "Cannot schedule a getMore without an OperationContext");
     auto& remote = _remotes[remoteIndex];
 
@@ -435,6 +548,23 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
         adjustedBatchSize = *_params.getBatchSize() - remote.fetchedCount;
     }
 
+    // Bounds the size of the next batch by the average size of the results of the previous one, so
+    // that merging over many remotes does not buffer a full batch of each of them. The batches of
+    // tailable cursors are returned to the client as they are received, and are left as they are.
+    const auto maxBufferedBytes = gMergeMaxBufferedBytesPerRemote.load();
+    if (maxBufferedBytes > 0 && remote.avgResultBytes > 0 &&
+        _tailableMode == TailableModeEnum::kNormal) {
+        const std::int64_t maxResults =
+            std::max<long long>(1, maxBufferedBytes / remote.avgResultBytes);
+        adjustedBatchSize = std::min(adjustedBatchSize.value_or(maxResults), maxResults);
+    }
+
+    // Even if all of the results still to be returned come from this remote, it need not send more.
+    if (_params.getLimit()) {
+        const std::int64_t remaining = std::max<long long>(1, *_params.getLimit() - _numReturned);
+        adjustedBatchSize = std::min(adjustedBatchSize.value_or(remaining), remaining);
+    }
+
     BSONObj cmdObj = GetMoreRequest(remote.cursorNss,
                                     remote.cursorId,
                                     adjustedBatchSize,
@@ -442,25 +572,7 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
                                     boost::none,
                                     boost::none)
                          .toBSON();
-
-    if (_params.getSessionId()) {
-        BSONObjBuilder newCmdBob(std::move(cmdObj));
-
-        BSONObjBuilder lsidBob(newCmdBob.subobjStart(OperationSessionInfo::kSessionIdFieldName));
-        _params.getSessionId()->serialize(&lsidBob);
-        lsidBob.doneFast();
-
-        if (_params.getTxnNumber()) {
-            newCmdBob.append(OperationSessionInfo::kTxnNumberFieldName, *_params.getTxnNumber());
-        }
-
-        if (_params.getAutocommit()) {
-            newCmdBob.append(OperationSessionInfoFromClient::kAutocommitFieldName,
-                             *_params.getAutocommit());
-        }
-
-        cmdObj = newCmdBob.obj();
-    }
+    cmdObj = _appendSessionInfo(lk, std::move(cmdObj));
 
     // Never pass API parameters with getMore.
     IgnoreAPIParametersBlock ignoreApiParametersBlock(_opCtx);
@@ -468,9 +580,15 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
         remote.getTargetHost(), remote.cursorNss.db().toString(), cmdObj, _opCtx);
     ignoreApiParametersBlock.release();
 
-    auto callbackStatus =
-        _executor->scheduleRemoteCommand(request, [this, remoteIndex](auto const& cbData) {
+    const auto getMoreGeneration = ++remote.getMoreGeneration;
+    auto callbackStatus = _executor->scheduleRemoteCommand(
+        request, [this, remoteIndex, getMoreGeneration](auto const& cbData) {
             stdx::lock_guard<Latch> lk(this->_mutex);
+            if (getMoreGeneration != this->_remotes[remoteIndex].getMoreGeneration) {
+                // A hedge won the race against this getMore, which was abandoned.
+                this->_onHedgingCallbackDone(lk);
+                return;
+            }
             this->_handleBatchResponse(lk, cbData, remoteIndex);
         });
 
@@ -479,9 +597,192 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+
+    if (_canHedgeGetMores(lk, remote)) {
+        auto timerStatus = _executor->scheduleWorkAt(
+            _executor->now() + getMoreLatencies.hedgingDelay(),
+            [this, remoteIndex, getMoreGeneration](auto const& args) {
+                stdx::lock_guard<Latch> lk(this->_mutex);
+                if (args.status.isOK()) {
+                    this->_hedgeGetMore(lk, remoteIndex, getMoreGeneration);
+                }
+                this->_onHedgingCallbackDone(lk);
+            });
+        if (timerStatus.isOK()) {
+            remote.hedgeTimerHandle = timerStatus.getValue();
+            ++_numHedgingCallbacks;
+        }
+    }
     return Status::OK();
 }
 
+BSONObj AsyncResultsMerger::_appendSessionInfo(WithLock, BSONObj cmdObj) const {
+    if (!_params.getSessionId()) {
+        return cmdObj;
+    }
+
+    BSONObjBuilder newCmdBob(std::move(cmdObj));
+
+    BSONObjBuilder lsidBob(newCmdBob.subobjStart(OperationSessionInfo::kSessionIdFieldName));
+    _params.getSessionId()->serialize(&lsidBob);
+    lsidBob.doneFast();
+
+    if (_params.getTxnNumber()) {
+        newCmdBob.append(OperationSessionInfo::kTxnNumberFieldName, *_params.getTxnNumber());
+    }
+
+    if (_params.getAutocommit()) {
+        newCmdBob.append(OperationSessionInfoFromClient::kAutocommitFieldName,
+                         *_params.getAutocommit());
+    }
+
+    return newCmdBob.obj();
+}
+
+bool AsyncResultsMerger::_canHedgeGetMores(WithLock, const RemoteCursorData& remote) const {
+    // The sort keys of the results are what a re-established cursor resumes after.
+    return remote.establishingCommand && _tailableMode == TailableModeEnum::kNormal &&
+        _params.getSort();
+}
+
+void AsyncResultsMerger::_hedgeGetMore(WithLock lk,
+                                       size_t remoteIndex,
+                                       uint64_t getMoreGeneration) {
+    auto& remote = _remotes[remoteIndex];
+    if (_lifecycleState != kAlive || getMoreGeneration != remote.getMoreGeneration ||
+        !remote.cbHandle.isValid()) {
+        return;
+    }
+    remote.hedgeTimerHandle = executor::TaskExecutor::CallbackHandle();
+
+    const auto& establishingCommand = *remote.establishingCommand;
+    auto readPref = ReadPreferenceSetting::fromContainingBSON(establishingCommand);
+    auto shardRegistry = Grid::get(getGlobalServiceContext())->shardRegistry();
+    auto shard = shardRegistry ? shardRegistry->getShardNoReload(remote.shardId) : nullptr;
+    if (!readPref.isOK() || !shard) {
+        return;
+    }
+
+    // The merger must not block, so only the hosts already known to be eligible are considered.
+    auto hostsFuture =
+        shard->getTargeter()->findHosts(readPref.getValue(), CancelationToken::uncancelable());
+    if (!hostsFuture.isReady()) {
+        return;
+    }
+    auto swHosts = std::move(hostsFuture).getNoThrow();
+    if (!swHosts.isOK()) {
+        return;
+    }
+    const auto& hosts = swHosts.getValue();
+    auto host = std::find_if(hosts.begin(), hosts.end(), [&](const HostAndPort& candidate) {
+        return candidate != remote.shardHostAndPort;
+    });
+    if (host == hosts.end()) {
+        return;
+    }
+
+    auto cmdObj = _appendSessionInfo(
+        lk, makeResumedFindCommand(establishingCommand, *_params.getSort(), remote.lastSortKey));
+    executor::RemoteCommandRequest request(
+        *host, remote.cursorNss.db().toString(), cmdObj, _opCtx);
+
+    auto callbackStatus = _executor->scheduleRemoteCommand(
+        request, [this, remoteIndex, getMoreGeneration](auto const& cbData) {
+            stdx::lock_guard<Latch> lk(this->_mutex);
+            this->_handleHedgeResponse(lk, cbData, remoteIndex, getMoreGeneration);
+            this->_onHedgingCallbackDone(lk);
+        });
+    if (!callbackStatus.isOK()) {
+        return;
+    }
+
+    remote.hedgeHandle = callbackStatus.getValue();
+    ++_numHedgingCallbacks;
+    HedgingMetrics::get(getGlobalServiceContext())->incrementNumTotalHedgedGetMores();
+}
+
+void AsyncResultsMerger::_handleHedgeResponse(WithLock lk,
+                                              CbData const& cbData,
+                                              size_t remoteIndex,
+                                              uint64_t getMoreGeneration) {
+    auto& remote = _remotes[remoteIndex];
+
+    // The hedge is canceled once the getMore it races against completes.
+    const bool isRacing = getMoreGeneration == remote.getMoreGeneration &&
+        remote.hedgeHandle.isValid() && remote.cbHandle.isValid();
+    if (getMoreGeneration == remote.getMoreGeneration) {
+        remote.hedgeHandle = executor::TaskExecutor::CallbackHandle();
+    }
+
+    auto swCursorResponse = cbData.response.isOK()
+        ? CursorResponse::parseFromBSON(cbData.response.data)
+        : StatusWith<CursorResponse>(cbData.response.status);
+    if (!isRacing || _lifecycleState != kAlive) {
+        if (swCursorResponse.isOK()) {
+            _killAbandonedCursor(lk,
+                                 cbData.request.target,
+                                 swCursorResponse.getValue().getNSS(),
+                                 swCursorResponse.getValue().getCursorId());
+        }
+        return;
+    }
+    if (!swCursorResponse.isOK()) {
+        // The hedged getMore may still complete.
+        return;
+    }
+    HedgingMetrics::get(getGlobalServiceContext())->incrementNumAdvantageouslyHedgedGetMores();
+
+    // Abandons the hedged getMore, whose callback then finds that the generation has changed.
+    _executor->cancel(remote.cbHandle);
+    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    ++remote.getMoreGeneration;
+    ++_numHedgingCallbacks;
+    _killAbandonedCursor(lk, remote.shardHostAndPort, remote.cursorNss, remote.cursorId);
+
+    // Continues on the re-established cursor, starting with its first batch.
+    remote.shardHostAndPort = cbData.request.target;
+    remote.cursorId = swCursorResponse.getValue().getCursorId();
+    try {
+        _processBatchResults(lk, cbData.response, remoteIndex);
+    } catch (DBException const& e) {
+        remote.status = e.toStatus();
+    }
+    _signalCurrentEventIfReady(lk);
+}
+
+void AsyncResultsMerger::_cancelHedging(WithLock, RemoteCursorData& remote) {
+    for (auto handle : {&remote.hedgeTimerHandle, &remote.hedgeHandle}) {
+        if (handle->isValid()) {
+            _executor->cancel(*handle);
+            *handle = executor::TaskExecutor::CallbackHandle();
+        }
+    }
+}
+
+void AsyncResultsMerger::_onHedgingCallbackDone(WithLock lk) {
+    invariant(_numHedgingCallbacks > 0);
+    if (--_numHedgingCallbacks == 0) {
+        _hedgingCallbacksDone.notify_all();
+    }
+    if (_lifecycleState == kKillStarted) {
+        _cleanUpKilledBatch(lk);
+    }
+}
+
+void AsyncResultsMerger::_killAbandonedCursor(WithLock,
+                                              const HostAndPort& host,
+                                              const NamespaceString& cursorNss,
+                                              CursorId cursorId) {
+    if (!cursorId) {
+        return;
+    }
+    BSONObj cmdObj = KillCursorsRequest(cursorNss, {cursorId}).toBSON(BSONObj{});
+    executor::RemoteCommandRequest request(host, cursorNss.db().toString(), cmdObj, nullptr);
+
+    // Send kill request; discard callback handle, if any, or failure report, if not.
+    _executor->scheduleRemoteCommand(request, [](auto const&) {}).getStatus().ignore();
+}
+
 Status AsyncResultsMerger::scheduleGetMores() {
     stdx::lock_guard<Latch> lk(_mutex);
     return _scheduleGetMores(lk);
@@ -665,7 +966,13 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
                                               CbData const& cbData,
                                               size_t remoteIndex) {
     // Got a response from remote, so indicate we are no longer waiting for one.
-    _remotes[remoteIndex].cbHandle = executor::TaskExecutor::CallbackHandle();
+    auto& remote = _remotes[remoteIndex];
+    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    _cancelHedging(lk, remote);
+    if (cbData.response.isOK() && cbData.response.elapsed &&
+        _tailableMode == TailableModeEnum::kNormal) {
+        getMoreLatencies.record(duration_cast<Milliseconds>(*cbData.response.elapsed));
+    }
 
     //  On shutdown, there is no need to process the response.
     if (_lifecycleState != kAlive) {
@@ -676,7 +983,7 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
     try {
         _processBatchResults(lk, cbData.response, remoteIndex);
     } catch (DBException const& e) {
-        _remotes[remoteIndex].status = e.toStatus();
+        remote.status = e.toStatus();
     }
     _signalCurrentEventIfReady(lk);  // Wake up anyone waiting on '_currentEvent'.
 }
@@ -709,6 +1016,8 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         remote.partialResultsReturned = (remote.status != ErrorCodes::ExchangePassthrough);
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        _bufferedBytes -= remote.bufferedBytes;
+        remote.bufferedBytes = 0;
         remote.status = Status::OK();
         remote.cursorId = 0;
     }
@@ -764,6 +1073,7 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     _updateRemoteMetadata(lk, remoteIndex, response);
+    long long batchBytes = 0;
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (_params.getSort()) {
@@ -786,6 +1096,19 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
+        remote.bufferedBytes += obj.objsize();
+        _bufferedBytes += obj.objsize();
+        batchBytes += obj.objsize();
+    }
+
+    if (!response.getBatch().empty()) {
+        remote.avgResultBytes = batchBytes / static_cast<long long>(response.getBatch().size());
+    }
+
+    if (remote.establishingCommand && _params.getSort() && !response.getBatch().empty()) {
+        remote.lastSortKey =
+            extractSortKey(response.getBatch().back(), _params.getCompareWholeSortKey())
+                .getOwned();
     }
 
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
@@ -806,6 +1129,10 @@ void AsyncResultsMerger::_signalCurrentEventIfReady(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_haveOutstandingBatchRequests(WithLock) {
+    if (_numHedgingCallbacks > 0) {
+        return true;
+    }
+
     for (const auto& remote : _remotes) {
         if (remote.cbHandle.isValid()) {
             return true;
@@ -857,10 +1184,11 @@ stdx::shared_future<void> AsyncResultsMerger::kill(OperationContext* opCtx) {
     }
 
     // Cancel all of our callbacks. Once they all complete, the event will be signaled.
-    for (const auto& remote : _remotes) {
+    for (auto& remote : _remotes) {
         if (remote.cbHandle.isValid()) {
             _executor->cancel(remote.cbHandle);
         }
+        _cancelHedging(lk, remote);
     }
     return _killCompleteInfo->getFuture();
 }
@@ -40,6 +40,8 @@
 #include "mongo/platform/mutex.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
 #include "mongo/s/query/cluster_query_result.h"
+#include "mongo/s/query/router_exec_stage.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/future.h"
 #include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
@@ -68,6 +70,11 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * If a remote carries the command which established its cursor, a getMore which takes longer than
+ * the 'getMoreHedgingPercentile' of recent getMores is hedged: the cursor is re-established on
+ * another host of the shard, resuming after the last sort key received from the remote, and the
+ * merger continues with whichever of the two responds first.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -222,6 +229,12 @@ public:
      */
     std::size_t getNumRemotes() const;
 
+    /**
+     * Returns the size of the results buffered for the remotes and the rate at which results have
+     * been returned since the merger was created.
+     */
+    RouterExecStage::MergeStats getMergeStats() const;
+
     /**
      * For sorted tailable cursors, returns the most recent available sort key. This guarantees that
      * we will never return any future results which precede this key. If no results are ready to be
@@ -316,6 +329,26 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // The total size of the results in 'docBuffer', and the average size of the results of the
+        // last non-empty batch, by which the batch size of the next getMore is bounded.
+        long long bufferedBytes = 0;
+        long long avgResultBytes = 0;
+
+        // The find command which established the cursor, if the getMores of this remote may be
+        // hedged, and the sort key of the last result received from the remote, after which a
+        // re-established cursor resumes.
+        boost::optional<BSONObj> establishingCommand;
+        BSONObj lastSortKey;
+
+        // Incremented for every getMore sent to this remote, and when a hedge wins the race against
+        // the outstanding getMore, so that the callbacks of earlier getMores are recognized.
+        uint64_t getMoreGeneration = 0;
+
+        // Valid while the timer which hedges the outstanding getMore is pending, and while the
+        // request which re-establishes the cursor is outstanding, respectively.
+        executor::TaskExecutor::CallbackHandle hedgeTimerHandle;
+        executor::TaskExecutor::CallbackHandle hedgeHandle;
     };
 
     class MergingComparator {
@@ -391,6 +424,11 @@ private:
     ClusterQueryResult _nextReadySorted(WithLock);
     ClusterQueryResult _nextReadyUnsorted(WithLock);
 
+    /**
+     * Removes the next buffered result of the remote at 'remoteIndex' and returns it.
+     */
+    ClusterQueryResult _popNextResult(WithLock, size_t remoteIndex);
+
     using CbData = executor::TaskExecutor::RemoteCommandCallbackArgs;
     using CbResponse = executor::TaskExecutor::ResponseStatus;
 
@@ -403,6 +441,52 @@ private:
      */
     void _handleBatchResponse(WithLock, CbData const&, size_t remoteIndex);
 
+    /**
+     * Adds the session information of the merger, if any, to a command sent to a remote.
+     */
+    BSONObj _appendSessionInfo(WithLock, BSONObj cmdObj) const;
+
+    /**
+     * Returns whether the getMores of the given remote may be hedged.
+     */
+    bool _canHedgeGetMores(WithLock, const RemoteCursorData& remote) const;
+
+    /**
+     * Called when the getMore of generation 'getMoreGeneration' of the given remote has been
+     * outstanding for longer than the hedging delay. If the getMore is still outstanding, sends the
+     * establishing command of the remote, amended to resume after the last sort key received, to
+     * another host of the shard eligible for the read preference of the command.
+     */
+    void _hedgeGetMore(WithLock, size_t remoteIndex, uint64_t getMoreGeneration);
+
+    /**
+     * Handles the response to a re-established cursor. If it arrives before the response to the
+     * hedged getMore, the remote continues on the new cursor and the former one is killed.
+     * Otherwise, the new cursor is killed.
+     */
+    void _handleHedgeResponse(WithLock,
+                              CbData const&,
+                              size_t remoteIndex,
+                              uint64_t getMoreGeneration);
+
+    /**
+     * Cancels the pending hedging timer and hedging request of the given remote, if any.
+     */
+    void _cancelHedging(WithLock, RemoteCursorData& remote);
+
+    /**
+     * Must be called at the end of every callback counted in '_numHedgingCallbacks'.
+     */
+    void _onHedgingCallbackDone(WithLock);
+
+    /**
+     * Kills a cursor which the merger no longer reads from, without waiting for the response.
+     */
+    void _killAbandonedCursor(WithLock,
+                              const HostAndPort& host,
+                              const NamespaceString& cursorNss,
+                              CursorId cursorId);
+
     /**
      * Cleans up if the remote cursor was killed while waiting for a response.
      */
@@ -509,6 +593,17 @@ private:
     // For sorted tailable cursors, records the current high-water-mark sort key. Empty otherwise.
     BSONObj _highWaterMark;
 
+    // The number of results returned by nextReady() and the total size of the results buffered
+    // for all of the remotes.
+    long long _numReturned = 0;
+    long long _bufferedBytes = 0;
+    const Date_t _createdDate;
+
+    // Number of hedging timers, hedging requests and abandoned getMores whose callbacks have not
+    // run yet. The callbacks refer to the merger, which waits for them on destruction.
+    int _numHedgingCallbacks = 0;
+    stdx::condition_variable _hedgingCallbacksDone;
+
     //
     // Killing
     //
@@ -33,18 +33,22 @@
 
 #include <memory>
 
+#include "mongo/client/remote_command_targeter_mock.h"
 #include "mongo/db/json.h"
 #include "mongo/db/pipeline/change_stream_constants.h"
 #include "mongo/db/pipeline/resume_token.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/query_request.h"
+#include "mongo/executor/hedging_metrics.h"
+#include "mongo/executor/network_interface_mock.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/query/results_merger_test_fixture.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -2034,5 +2038,181 @@ TEST_F(AsyncResultsMergerTest, ShouldNotScheduleGetMoresWithoutAnOperationContex
     killFuture.wait();
 }
 
+TEST_F(AsyncResultsMergerTest, SlowGetMoreIsHedgedByResumingTheFindOnAnotherHost) {
+    const HostAndPort kOtherHost("FakeShard1HostSecondary", 12345);
+    RemoteCommandTargeterMock::get(
+        shardRegistry()->getShardNoReload(kTestShardIds[0])->getTargeter())
+        ->setFindHostsReturnValue(std::vector<HostAndPort>{kTestShardHosts[0], kOtherHost});
+    auto hedgingMetrics = HedgingMetrics::get(operationContext());
+    const auto numHedgedGetMores = hedgingMetrics->getNumTotalHedgedGetMores();
+    const auto numAdvantageouslyHedgedGetMores =
+        hedgingMetrics->getNumAdvantageouslyHedgedGetMores();
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0],
+        kTestShardHosts[0],
+        CursorResponse(kTestNss, 5, {fromjson("{_id: 1, $sortKey: [1]}")})));
+    cursors.back().setEstablishingCommand(
+        fromjson("{find: 'testcoll', filter: {x: 1}, sort: {_id: 1}, "
+                 "$readPreference: {mode: 'nearest', hedge: {enabled: true}}}"));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1],
+        kTestShardHosts[1],
+        CursorResponse(kTestNss, 6, {fromjson("{_id: 2, $sortKey: [2]}")})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1, $sortKey: [1]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    // The getMore on the first shard does not complete before the hedging delay elapses, so the
+    // find is resumed after the last _id received on the other eligible host.
+    executor::NetworkInterfaceMock* net = network();
+    net->enterNetwork();
+    net->runUntil(net->now() + Seconds(1));
+    while (net->hasReadyRequests()) {
+        auto noi = net->getNextReadyRequest();
+        const auto& request = noi->getRequest();
+        if (request.target != kOtherHost) {
+            ASSERT(request.cmdObj["getMore"]);
+            net->blackHole(noi);
+            continue;
+        }
+        ASSERT_BSONOBJ_EQ(request.cmdObj["filter"].Obj(),
+                          fromjson("{$and: [{x: 1}, {_id: {$ne: 1}}]}"));
+        ASSERT_BSONOBJ_EQ(request.cmdObj["hint"].Obj(), BSON("_id" << 1));
+        ASSERT_BSONOBJ_EQ(request.cmdObj["min"].Obj(), BSON("_id" << 1));
+
+        std::vector<BSONObj> batch = {fromjson("{_id: 3, $sortKey: [3]}")};
+        auto response = CursorResponse(kTestNss, CursorId(7), batch)
+                            .toBSON(CursorResponse::ResponseType::InitialResponse);
+        net->scheduleResponse(noi,
+                              net->now(),
+                              executor::TaskExecutor::ResponseStatus(
+                                  executor::RemoteCommandResponse(response, Milliseconds(1))));
+    }
+    net->runReadyNetworkOperations();
+    net->exitNetwork();
+
+    ASSERT_EQ(numHedgedGetMores + 1, hedgingMetrics->getNumTotalHedgedGetMores());
+    ASSERT_EQ(numAdvantageouslyHedgedGetMores + 1,
+              hedgingMetrics->getNumAdvantageouslyHedgedGetMores());
+
+    // The cursor which the hedge won against is killed.
+    assertKillCusorsCmdHasCursorId(getNthPendingRequest(0u).cmdObj, 5);
+    blackHoleNextRequest();
+
+    executor()->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2, $sortKey: [2]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 4, $sortKey: [4]}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3, $sortKey: [3]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    // The first shard is now read through the cursor established by the hedge.
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    auto request = getNthPendingRequest(0u);
+    ASSERT_EQ(request.target, kOtherHost);
+    ASSERT_EQ(request.cmdObj["getMore"].numberLong(), 7);
+    responses.clear();
+    responses.emplace_back(kTestNss, CursorId(0), std::vector<BSONObj>{});
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 4, $sortKey: [4]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->remotesExhausted());
+}
+
+TEST_F(AsyncResultsMergerTest, GetMoreBatchSizeIsBoundedByMaxBufferedBytesPerRemote) {
+    const auto maxBufferedBytes = gMergeMaxBufferedBytesPerRemote.load();
+    ON_BLOCK_EXIT([&] { gMergeMaxBufferedBytesPerRemote.store(maxBufferedBytes); });
+    gMergeMaxBufferedBytesPerRemote.store(100);
+
+    // Each of these results is 52 bytes, so no more than one of them fits in 100 bytes.
+    const std::string padding(30, 'x');
+    std::vector<BSONObj> batch = {BSON("_id" << 1 << "s" << padding),
+                                  BSON("_id" << 2 << "s" << padding)};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 1, batch)));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+    ASSERT_EQ(arm->getMergeStats().bufferedBytes, 104);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(batch[0], *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(batch[1], *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_EQ(arm->getMergeStats().bufferedBytes, 0);
+    ASSERT_FALSE(arm->ready());
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    auto request = GetMoreRequest::parseFromBSON("anydbname", getNthPendingRequest(0).cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(*request.getValue().batchSize, 1LL);
+
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(kTestNss, CursorId(0), std::vector<BSONObj>{});
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->remotesExhausted());
+}
+
+TEST_F(AsyncResultsMergerTest, GetMoreBatchSizeIsBoundedByResultsLeftToReturn) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0],
+        kTestShardHosts[0],
+        CursorResponse(kTestNss,
+                       1,
+                       {fromjson("{_id: 1, $sortKey: [1]}"), fromjson("{_id: 3, $sortKey: [3]}")})));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1],
+        kTestShardHosts[1],
+        CursorResponse(kTestNss, 2, {fromjson("{_id: 2, $sortKey: [2]}")})));
+    auto params = makeARMParamsFromExistingCursors(std::move(cursors), findCmd);
+    params.setLimit(5);
+    auto arm =
+        std::make_unique<AsyncResultsMerger>(operationContext(), executor(), std::move(params));
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1, $sortKey: [1]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2, $sortKey: [2]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    // Three results are left to return, all of which may come from the second shard.
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    auto request = GetMoreRequest::parseFromBSON("anydbname", getNthPendingRequest(0).cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(request.getValue().cursorid, 2LL);
+    ASSERT_EQ(*request.getValue().batchSize, 3LL);
+
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(kTestNss, CursorId(0), std::vector<BSONObj>{});
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+
+    auto killFuture = arm->kill(operationContext());
+    killFuture.wait();
+}
+
 }  // namespace
 }  // namespace mongo
@@ -76,6 +76,10 @@ public:
         return _arm.getNumRemotes();
     }
 
+    RouterExecStage::MergeStats getMergeStats() const {
+        return _arm.getMergeStats();
+    }
+
     BSONObj getHighWaterMark() {
         return _arm.getHighWaterMark();
     }
@@ -130,6 +130,11 @@ public:
      */
     virtual std::size_t getNumRemotes() const = 0;
 
+    /**
+     * Returns the statistics of the merge of the remote cursors, if this cursor merges any.
+     */
+    virtual boost::optional<RouterExecStage::MergeStats> getMergeStats() const = 0;
+
     /**
      * Returns the current most-recent resume token for this cursor, or an empty object if this is
      * not a $changeStream cursor.
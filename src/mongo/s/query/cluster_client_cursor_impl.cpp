@@ -167,6 +167,10 @@ std::size_t ClusterClientCursorImpl::getNumRemotes() const {
     return _root->getNumRemotes();
 }
 
+boost::optional<RouterExecStage::MergeStats> ClusterClientCursorImpl::getMergeStats() const {
+    return _root->getMergeStats();
+}
+
 BSONObj ClusterClientCursorImpl::getPostBatchResumeToken() const {
     return _root->getPostBatchResumeToken();
 }
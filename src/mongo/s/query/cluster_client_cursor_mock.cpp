@@ -82,6 +82,10 @@ std::size_t ClusterClientCursorMock::getNumRemotes() const {
     MONGO_UNREACHABLE;
 }
 
+boost::optional<RouterExecStage::MergeStats> ClusterClientCursorMock::getMergeStats() const {
+    return boost::none;
+}
+
 BSONObj ClusterClientCursorMock::getPostBatchResumeToken() const {
     MONGO_UNREACHABLE;
 }
@@ -78,6 +78,8 @@ public:
 
     std::size_t getNumRemotes() const final;
 
+    boost::optional<RouterExecStage::MergeStats> getMergeStats() const final;
+
     BSONObj getPostBatchResumeToken() const final;
 
     long long getNumReturnedSoFar() const final;
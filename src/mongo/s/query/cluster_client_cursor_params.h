@@ -94,6 +94,10 @@ struct ClusterClientCursorParams {
         armParams.setRemotes(std::move(remotes));
         armParams.setTailableMode(tailableMode);
         armParams.setBatchSize(batchSize);
+        if (limit) {
+            // The results skipped on the router are also returned by the merger.
+            armParams.setLimit(*limit + skipToApplyOnRouter.value_or(0));
+        }
         armParams.setNss(nsString);
         armParams.setAllowPartialResults(isAllowPartialResults);
 
@@ -137,6 +137,10 @@ GenericCursor ClusterCursorManager::PinnedCursor::toGenericCursor() const {
     gc.setLastAccessDate(_cursor->getLastUseDate());
     gc.setCreatedDate(_cursor->getCreatedDate());
     gc.setNBatchesReturned(_cursor->getNBatches());
+    if (auto mergeStats = _cursor->getMergeStats()) {
+        gc.setMergeBufferedBytes(mergeStats->bufferedBytes);
+        gc.setMergeDocsPerSec(mergeStats->docsPerSec);
+    }
     return gc;
 }
 
@@ -579,6 +583,10 @@ GenericCursor ClusterCursorManager::CursorEntry::cursorToGenericCursor(
     gc.setOriginatingCommand(_cursor->getOriginatingCommand());
     gc.setNoCursorTimeout(getLifetimeType() == CursorLifetime::Immortal);
     gc.setNBatchesReturned(_cursor->getNBatches());
+    if (auto mergeStats = _cursor->getMergeStats()) {
+        gc.setMergeBufferedBytes(mergeStats->bufferedBytes);
+        gc.setMergeDocsPerSec(mergeStats->docsPerSec);
+    }
     return gc;
 }
 
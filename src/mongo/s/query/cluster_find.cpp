@@ -57,6 +57,7 @@
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/cluster_commands_helpers.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/hedge_options_util.h"
 #include "mongo/s/query/async_results_merger.h"
 #include "mongo/s/query/cluster_client_cursor_impl.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
@@ -219,6 +220,38 @@ std::vector<std::pair<ShardId, BSONObj>> constructRequestsForShards(
     return requests;
 }
 
+/**
+ * Returns whether the getMores of the cursors established by 'requests' for a query which targets
+ * several shards may be hedged, see AsyncResultsMerger. This requires hedged reads to be enabled
+ * for the read preference, and the query to be sorted by _id alone under the simple collation, so
+ * that a cursor re-established on another host can resume after the last _id received.
+ */
+bool canHedgeGetMores(OperationContext* opCtx,
+                      const CanonicalQuery& query,
+                      const ReadPreferenceSetting& readPref,
+                      const ChunkManager& cm,
+                      const std::vector<std::pair<ShardId, BSONObj>>& requests) {
+    const auto& qr = query.getQueryRequest();
+    if (requests.empty() || qr.isTailable() || TransactionRouter::get(opCtx) ||
+        !qr.getHint().isEmpty() || !qr.getMin().isEmpty() || !qr.getMax().isEmpty() ||
+        qr.returnKey()) {
+        return false;
+    }
+
+    const auto& sort = qr.getSort();
+    if (sort.nFields() != 1 || sort.firstElementFieldNameStringData() != "_id"_sd ||
+        !sort.firstElement().isNumber()) {
+        return false;
+    }
+
+    if (query.getCollator() ||
+        (qr.getCollation().isEmpty() && cm.isSharded() && cm.getDefaultCollator())) {
+        return false;
+    }
+
+    return extractHedgeOptions(requests.front().second, readPref).has_value();
+}
+
 void updateNumHostsTargetedMetrics(OperationContext* opCtx,
                                    const ChunkManager& cm,
                                    int nTargetedShards) {
@@ -332,6 +365,19 @@ CursorId runQueryWithoutRetrying(OperationContext* opCtx,
         params.limit = qr.getLimit();
         params.sortToApplyOnRouter = sortComparatorObj;
         params.compareWholeSortKeyOnRouter = compareWholeSortKeyOnRouter;
+
+        if (canHedgeGetMores(opCtx, query, readPref, cm, requests)) {
+            for (auto& remote : params.remotes) {
+                auto request = std::find_if(requests.begin(), requests.end(), [&](const auto& r) {
+                    return r.first == remote.getShardId();
+                });
+                if (request != requests.end()) {
+                    BSONObjBuilder cmdBuilder(request->second);
+                    readPref.toContainingBSON(&cmdBuilder);
+                    remote.setEstablishingCommand(cmdBuilder.obj());
+                }
+            }
+        }
     }
 
     // Transfer the established cursors to a ClusterClientCursor.
@@ -61,6 +61,13 @@ std::size_t DocumentSourceMergeCursors::getNumRemotes() const {
     return _blockingResultsMerger->getNumRemotes();
 }
 
+boost::optional<RouterExecStage::MergeStats> DocumentSourceMergeCursors::getMergeStats() const {
+    if (!_blockingResultsMerger) {
+        return boost::none;
+    }
+    return _blockingResultsMerger->getMergeStats();
+}
+
 BSONObj DocumentSourceMergeCursors::getHighWaterMark() {
     if (!_blockingResultsMerger) {
         populateMerger();
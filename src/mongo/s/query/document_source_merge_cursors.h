@@ -102,6 +102,12 @@ public:
 
     std::size_t getNumRemotes() const;
 
+    /**
+     * Returns the statistics of the merge, once the underlying BlockingResultsMerger has been
+     * populated.
+     */
+    boost::optional<RouterExecStage::MergeStats> getMergeStats() const;
+
     /**
      * Returns the high water mark sort key for the given cursor, if it exists; otherwise, returns
      * an empty BSONObj. Calling this method causes the underlying BlockingResultsMerger to be
@@ -59,6 +59,17 @@ public:
         kGetMoreWithAtLeastOneResultInBatch,
     };
 
+    /**
+     * Statistics about the merge of the results of the remote cursors, reported in $currentOp.
+     */
+    struct MergeStats {
+        // The total size of the results received from the remotes which were not returned yet.
+        long long bufferedBytes = 0;
+
+        // The number of results returned per second since the merge started.
+        double docsPerSec = 0;
+    };
+
     RouterExecStage(OperationContext* opCtx) : _opCtx(opCtx) {}
     RouterExecStage(OperationContext* opCtx, std::unique_ptr<RouterExecStage> child)
         : _opCtx(opCtx), _child(std::move(child)) {}
@@ -105,6 +116,14 @@ public:
         return _child->getNumRemotes();
     }
 
+    /**
+     * Returns the statistics of the merge of the remote cursors, if this plan merges any. Default
+     * implementation forwards to the stage's child.
+     */
+    virtual boost::optional<MergeStats> getMergeStats() const {
+        return _child ? _child->getMergeStats() : boost::none;
+    }
+
     /**
      * Returns whether or not all the remote cursors are exhausted.
      */
@@ -71,6 +71,10 @@ public:
         return _resultsMerger.getNumRemotes();
     }
 
+    boost::optional<MergeStats> getMergeStats() const final {
+        return _resultsMerger.getMergeStats();
+    }
+
 protected:
     Status doSetAwaitDataTimeout(Milliseconds awaitDataTimeout) final {
         return _resultsMerger.setAwaitDataTimeout(awaitDataTimeout);
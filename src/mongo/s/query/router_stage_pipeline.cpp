@@ -86,6 +86,10 @@ std::size_t RouterStagePipeline::getNumRemotes() const {
     return 0;
 }
 
+boost::optional<RouterExecStage::MergeStats> RouterStagePipeline::getMergeStats() const {
+    return _mergeCursorsStage ? _mergeCursorsStage->getMergeStats() : boost::none;
+}
+
 BSONObj RouterStagePipeline::getPostBatchResumeToken() const {
     return _mergeCursorsStage ? _mergeCursorsStage->getHighWaterMark() : BSONObj();
 }
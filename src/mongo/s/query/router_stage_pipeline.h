@@ -53,6 +53,8 @@ public:
 
     std::size_t getNumRemotes() const final;
 
+    boost::optional<MergeStats> getMergeStats() const final;
+
     BSONObj getPostBatchResumeToken() const final;
 
 protected:
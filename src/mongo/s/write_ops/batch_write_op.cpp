@@ -66,6 +66,10 @@ struct WriteErrorDetailComp {
 const int kEstUpdateOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 const int kEstDeleteOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 
+// The number of inserts whose documents are targeted together at first. Each subsequent window of
+// inserts of the same batch is twice as large as the one before it.
+const size_t kInitialInsertTargetingWindowSize = 64;
+
 /**
  * Returns a new write concern that has the copy of every field from the original
  * document but with a w set to 1. This is intended for upgrading { w: 0 } write
@@ -301,6 +305,14 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
 
+    // The documents of inserts are targeted in windows of _Ready ops, so that the targeter locates
+    // their shard keys together. The windows double in size, which keeps an ordered batch that
+    // stops early from targeting all of its documents.
+    const bool isInsert = _clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert;
+    std::vector<StatusWith<ShardEndpoint>> insertEndpoints;
+    size_t nextInsertEndpoint = 0;
+    size_t insertWindowSize = kInitialInsertTargetingWindowSize;
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -308,6 +320,18 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         if (writeOp.getWriteState() != WriteOpState_Ready)
             continue;
 
+        if (isInsert && nextInsertEndpoint == insertEndpoints.size()) {
+            std::vector<BSONObj> docs;
+            for (size_t j = i; j < numWriteOps && docs.size() < insertWindowSize; ++j) {
+                if (_writeOps[j].getWriteState() == WriteOpState_Ready)
+                    docs.push_back(_writeOps[j].getWriteItem().getDocument());
+            }
+
+            insertEndpoints = targeter.targetInserts(_opCtx, docs);
+            nextInsertEndpoint = 0;
+            insertWindowSize *= 2;
+        }
+
         //
         // Get TargetedWrites from the targeter for the write operation
         //
@@ -318,7 +342,12 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
         Status targetStatus = Status::OK();
         try {
-            writeOp.targetWrites(_opCtx, targeter, &writes);
+            if (isInsert) {
+                auto& endpoint = insertEndpoints[nextInsertEndpoint++];
+                writeOp.targetInsert(_opCtx, uassertStatusOK(std::move(endpoint)), &writes);
+            } else {
+                writeOp.targetWrites(_opCtx, targeter, &writes);
+            }
         } catch (const DBException& ex) {
             targetStatus = ex.toStatus();
         }
@@ -379,6 +379,57 @@ ShardEndpoint ChunkManagerTargeter::targetInsert(OperationContext* opCtx,
         _nss.isOnInternalDb() ? boost::optional<DatabaseVersion>() : _cm->dbVersion());
 }
 
+std::vector<StatusWith<ShardEndpoint>> ChunkManagerTargeter::targetInserts(
+    OperationContext* opCtx, const std::vector<BSONObj>& docs) const {
+    if (!_cm->isSharded()) {
+        return NSTargeter::targetInserts(opCtx, docs);
+    }
+
+    // The documents whose shard key cannot be extracted keep the error below, and the shard keys of
+    // the others are located together.
+    std::vector<StatusWith<ShardEndpoint>> endpoints(
+        docs.size(),
+        Status(ErrorCodes::ShardKeyNotFound,
+               "Shard key cannot contain array values or array descendants."));
+
+    std::vector<size_t> positions;
+    std::vector<BSONObj> shardKeys;
+    positions.reserve(docs.size());
+    shardKeys.reserve(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        auto shardKey = _cm->getShardKeyPattern().extractShardKeyFromDoc(docs[i]);
+        if (!shardKey.isEmpty()) {
+            positions.push_back(i);
+            shardKeys.push_back(std::move(shardKey));
+        }
+    }
+
+    auto chunks = [&]() -> boost::optional<std::vector<Chunk>> {
+        try {
+            return _cm->findIntersectingChunksWithSimpleCollation(shardKeys);
+        } catch (const ExceptionFor<ErrorCodes::ShardKeyNotFound>&) {
+            return boost::none;
+        }
+    }();
+
+    // One of the keys cannot be targeted, so the documents are targeted one by one in order to tell
+    // which of them fail.
+    if (!chunks) {
+        return NSTargeter::targetInserts(opCtx, docs);
+    }
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto& shardId = (*chunks)[i].getShardId();
+        try {
+            endpoints[positions[i]] = ShardEndpoint(shardId, _cm->getVersion(shardId), boost::none);
+        } catch (const DBException& ex) {
+            endpoints[positions[i]] = ex.toStatus();
+        }
+    }
+
+    return endpoints;
+}
+
 std::vector<ShardEndpoint> ChunkManagerTargeter::targetUpdate(OperationContext* opCtx,
                                                               const BatchItemRef& itemRef) const {
     // If the update is replacement-style:
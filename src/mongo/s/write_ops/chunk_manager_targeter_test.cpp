@@ -117,6 +117,51 @@ TEST_F(ChunkManagerTargeterTest, TargetInsertWithRangePrefixHashedShardKey) {
                        ErrorCodes::ShardKeyNotFound);
 }
 
+TEST_F(ChunkManagerTargeterTest, TargetInsertsInBatchWithRangePrefixHashedShardKey) {
+    // Same chunks and shards as in the test above.
+    std::vector<BSONObj> splitPoints = {
+        BSON("a.b" << BSONNULL), BSON("a.b" << -100), BSON("a.b" << 0), BSON("a.b" << 100)};
+    auto cmTargeter = prepare(BSON("a.b" << 1 << "c.d"
+                                         << "hashed"),
+                              splitPoints);
+
+    // The documents are not in shard key order, and the ones with arrays along the shard key path
+    // fail without failing the rest of the batch.
+    const std::vector<BSONObj> docs{fromjson("{a: {b: 1000}, c: null, d: {}}"),
+                                    fromjson("{a: [1,2]}"),
+                                    fromjson("{a: {b: -111}, c: {d: '1'}}"),
+                                    fromjson("{a: {b: 0}, c: {d: 4}}"),
+                                    fromjson("{a: {b: -10}}"),
+                                    fromjson("{c: {d: [1,2]}}"),
+                                    BSONObj(),
+                                    fromjson("{a: {b: -10}}")};
+    auto endpoints = cmTargeter.targetInserts(operationContext(), docs);
+    ASSERT_EQ(docs.size(), endpoints.size());
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        const auto expected = [&]() -> StatusWith<ShardEndpoint> {
+            try {
+                return cmTargeter.targetInsert(operationContext(), docs[i]);
+            } catch (const DBException& ex) {
+                return ex.toStatus();
+            }
+        }();
+        ASSERT_EQ(expected.getStatus().code(), endpoints[i].getStatus().code());
+        if (expected.isOK()) {
+            ASSERT_EQ(expected.getValue().shardName, endpoints[i].getValue().shardName);
+        }
+    }
+
+    ASSERT_EQ(ErrorCodes::ShardKeyNotFound, endpoints[1].getStatus());
+    ASSERT_EQ(ErrorCodes::ShardKeyNotFound, endpoints[5].getStatus());
+    ASSERT_EQ("4", endpoints[0].getValue().shardName);
+    ASSERT_EQ("1", endpoints[2].getValue().shardName);
+    ASSERT_EQ("3", endpoints[3].getValue().shardName);
+    ASSERT_EQ("2", endpoints[4].getValue().shardName);
+    ASSERT_EQ("1", endpoints[6].getValue().shardName);
+    ASSERT_EQ("2", endpoints[7].getValue().shardName);
+}
+
 TEST_F(ChunkManagerTargeterTest, TargetInsertsWithVaryingHashedPrefixAndConstantRangedSuffix) {
     // Create 4 chunks and 4 shards such that shardId '0' has chunk [MinKey, -2^62), '1' has chunk
     // [-2^62, 0), '2' has chunk ['0', 2^62) and '3' has chunk [2^62, MaxKey).
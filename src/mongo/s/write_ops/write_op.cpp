@@ -76,6 +76,20 @@ void WriteOp::targetWrites(OperationContext* opCtx,
         endpoints = targeter.targetAllShards(opCtx);
     }
 
+    _targetEndpoints(opCtx, std::move(endpoints), targetedWrites);
+}
+
+void WriteOp::targetInsert(OperationContext* opCtx,
+                           ShardEndpoint endpoint,
+                           std::vector<TargetedWrite*>* targetedWrites) {
+    invariant(_itemRef.getOpType() == BatchedCommandRequest::BatchType_Insert);
+    _targetEndpoints(opCtx, std::vector{std::move(endpoint)}, targetedWrites);
+}
+
+void WriteOp::_targetEndpoints(OperationContext* opCtx,
+                               std::vector<ShardEndpoint> endpoints,
+                               std::vector<TargetedWrite*>* targetedWrites) {
+    const bool inTransaction = bool(TransactionRouter::get(opCtx));
     for (auto&& endpoint : endpoints) {
         // If the operation was already successfull on that shard, do not repeat it
         if (_successfulShardSet.count(endpoint.shardName))
@@ -123,6 +123,14 @@ public:
                       const NSTargeter& targeter,
                       std::vector<TargetedWrite*>* targetedWrites);
 
+    /**
+     * Same as targetWrites(), but for an insert whose 'endpoint' was already obtained from the
+     * targeter, along with the endpoints of the other inserts of its batch.
+     */
+    void targetInsert(OperationContext* opCtx,
+                      ShardEndpoint endpoint,
+                      std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Returns the number of child writes that were last targeted.
      */
@@ -166,6 +174,14 @@ private:
      */
     void _updateOpState();
 
+    /**
+     * Creates a child write op and a TargetedWrite for each of 'endpoints' on which the write has
+     * not already succeeded.
+     */
+    void _targetEndpoints(OperationContext* opCtx,
+                          std::vector<ShardEndpoint> endpoints,
+                          std::vector<TargetedWrite*>* targetedWrites);
+
     // Owned elsewhere, reference to a batch with a write item
     const BatchItemRef _itemRef;
 
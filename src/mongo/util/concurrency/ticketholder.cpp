@@ -33,230 +33,200 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
+#include <cmath>
 
-#include "mongo/logv2/log.h"
+#if defined(__linux__)
+#include <semaphore.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
-#if defined(__linux__)
-namespace {
-
-/**
- * Accepts an errno code, prints its error message, and exits.
- */
-void failWithErrno(int err) {
-    LOGV2_FATAL(28604,
-                "error in Ticketholder: {errnoWithDescription_err}",
-                "errnoWithDescription_err"_attr = errnoWithDescription(err));
+StringData TicketHolder::laneName(Lane lane) {
+    switch (lane) {
+        case Lane::kInternal:
+            return "internal"_sd;
+        case Lane::kShort:
+            return "short"_sd;
+        case Lane::kLong:
+            return "long"_sd;
+    }
+    MONGO_UNREACHABLE;
 }
 
-/*
- * Checks the return value from a Linux semaphore function call, and fails with the set errno if the
- * call was unsucessful.
- */
-void check(int ret) {
-    if (ret == 0)
-        return;
-    failWithErrno(errno);
-}
+TicketHolder::TicketHolder(int num) : _available(num), _outof(num), _longLaneLimit(num) {}
 
-/**
- * Takes a Date_t deadline and sets the appropriate values in a timespec structure.
- */
-void tsFromDate(const Date_t& deadline, struct timespec& ts) {
-    ts.tv_sec = deadline.toTimeT();
-    ts.tv_nsec = (deadline.toMillisSinceEpoch() % 1000) * 1'000'000;
-}
-}  // namespace
+TicketHolder::~TicketHolder() = default;
 
-TicketHolder::TicketHolder(int num) : _outof(num) {
-    check(sem_init(&_sem, 0, num));
+bool TicketHolder::tryAcquire(Lane lane) {
+    // Waiters are served first, so that they can't be starved by callers polling for tickets.
+    if (_numQueued.load() > 0) {
+        return false;
+    }
+    return _tryAcquireTicket(lane);
 }
 
-TicketHolder::~TicketHolder() {
-    check(sem_destroy(&_sem));
-}
+bool TicketHolder::_tryAcquireTicket(Lane lane) {
+    auto& laneState = _lane(lane);
+    if (lane == Lane::kLong && laneState.out.addAndFetch(1) > _longLaneLimit.load()) {
+        laneState.out.subtractAndFetch(1);
+        return false;
+    }
+
+    auto available = _available.load();
+    while (available > 0) {
+        if (_available.compareAndSwap(&available, available - 1)) {
+            if (lane != Lane::kLong) {
+                laneState.out.addAndFetch(1);
+            }
+            return true;
+        }
+    }
 
-bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        if (errno == EAGAIN)
-            return false;
-        if (errno != EINTR)
-            failWithErrno(errno);
+    if (lane == Lane::kLong) {
+        laneState.out.subtractAndFetch(1);
     }
-    return true;
+    return false;
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    waitForTicketUntil(opCtx, Date_t::max());
+void TicketHolder::waitForTicket(OperationContext* opCtx, Lane lane) {
+    invariant(waitForTicketUntil(opCtx, Date_t::max(), lane));
 }
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
+bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until, Lane lane) {
     // Attempt to get a ticket without waiting in order to avoid expensive time calculations.
-    if (sem_trywait(&_sem) == 0) {
+    if (tryAcquire(lane)) {
         return true;
     }
 
-    const Milliseconds intervalMs(500);
-    struct timespec ts;
-
-    // To support interrupting ticket acquisition while still benefiting from semaphores, we do a
-    // timed wait on an interval to periodically check for interrupts.
-    // The wait period interval is the smaller of the default interval and the provided
-    // deadline.
-    Date_t deadline = std::min(until, Date_t::now() + intervalMs);
-    tsFromDate(deadline, ts);
-
-    while (0 != sem_timedwait(&_sem, &ts)) {
-        if (errno == ETIMEDOUT) {
-            // If we reached the deadline without being interrupted, we have completely timed out.
-            if (deadline == until)
-                return false;
-
-            deadline = std::min(until, Date_t::now() + intervalMs);
-            tsFromDate(deadline, ts);
-        } else if (errno != EINTR) {
-            failWithErrno(errno);
+    auto& laneState = _lane(lane);
+    Timer timer;
+    Waiter waiter;
+
+    stdx::unique_lock<Latch> lk(_mutex);
+    auto it = laneState.waiters.insert(laneState.waiters.end(), &waiter);
+    _numQueued.addAndFetch(1);
+    laneState.numWaits.addAndFetch(1);
+
+    // Tickets may have been released since the attempt above, without waking up anybody since
+    // this thread was not queued yet.
+    _grantTickets(lk);
+
+    auto dequeueGuard = makeGuard([&] {
+        laneState.totalTimeQueuedMicros.addAndFetch(timer.micros());
+        if (!waiter.granted) {
+            laneState.waiters.erase(it);
+            _numQueued.subtractAndFetch(1);
         }
+    });
+
+    try {
+        if (opCtx) {
+            opCtx->waitForConditionOrInterruptUntil(
+                waiter.cv, lk, until, [&] { return waiter.granted; });
+        } else if (until == Date_t::max()) {
+            waiter.cv.wait(lk, [&] { return waiter.granted; });
+        } else {
+            waiter.cv.wait_until(lk, until.toSystemTimePoint(), [&] { return waiter.granted; });
+        }
+    } catch (...) {
+        if (waiter.granted) {
+            // The ticket was handed to this thread just as it was interrupted, so it must be given
+            // back since the caller won't hold it.
+            lk.unlock();
+            release(lane);
+            lk.lock();
+        }
+        throw;
+    }
 
-        // To correctly handle errors from sem_timedwait, we should check for interrupts last.
-        // It is possible to unset 'errno' after a call to checkForInterrupt().
-        if (opCtx)
-            opCtx->checkForInterrupt();
+    return waiter.granted;
+}
+
+void TicketHolder::release(Lane lane) {
+    _lane(lane).out.subtractAndFetch(1);
+    _numReleased.addAndFetch(1);
+    _available.addAndFetch(1);
+
+    // A thread queueing up concurrently either sees the ticket released above when it attempts to
+    // grant tickets to itself, or is seen here.
+    if (_numQueued.load() > 0) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _grantTickets(lk);
     }
-    return true;
 }
 
-void TicketHolder::release() {
-    check(sem_post(&_sem));
+void TicketHolder::_grantTickets(WithLock) {
+    for (auto& laneState : _lanes) {
+        auto lane = static_cast<Lane>(&laneState - _lanes.data());
+        while (!laneState.waiters.empty() && _tryAcquireTicket(lane)) {
+            auto waiter = laneState.waiters.front();
+            laneState.waiters.pop_front();
+            _numQueued.subtractAndFetch(1);
+            waiter->granted = true;
+            waiter->cv.notify_one();
+        }
+        if (_available.load() <= 0) {
+            return;
+        }
+    }
 }
 
 Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<Latch> lk(_resizeMutex);
-
     if (newSize < 5)
         return Status(ErrorCodes::BadValue,
                       str::stream() << "Minimum value for semaphore is 5; given " << newSize);
 
+#if defined(__linux__)
+    // The number of tickets used to be bounded by the maximum value of a semaphore, which the
+    // server parameters setting it have always been validated against.
     if (newSize > SEM_VALUE_MAX)
         return Status(ErrorCodes::BadValue,
                       str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
                                     << "; given " << newSize);
+#endif
 
-    while (_outof.load() < newSize) {
-        release();
-        _outof.fetchAndAdd(1);
-    }
-
-    while (_outof.load() > newSize) {
-        waitForTicket();
-        _outof.subtractAndFetch(1);
-    }
-
-    invariant(_outof.load() == newSize);
-    return Status::OK();
-}
-
-int TicketHolder::available() const {
-    int val = 0;
-    check(sem_getvalue(&_sem, &val));
-    return val;
-}
-
-int TicketHolder::used() const {
-    return outof() - available();
-}
-
-int TicketHolder::outof() const {
-    return _outof.load();
-}
-
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
-
-TicketHolder::~TicketHolder() = default;
-
-bool TicketHolder::tryAcquire() {
     stdx::lock_guard<Latch> lk(_mutex);
-    return _tryAcquire();
-}
-
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    stdx::unique_lock<Latch> lk(_mutex);
-
-    if (opCtx) {
-        opCtx->waitForConditionOrInterrupt(_newTicket, lk, [this] { return _tryAcquire(); });
-    } else {
-        _newTicket.wait(lk, [this] { return _tryAcquire(); });
-    }
-}
-
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    stdx::unique_lock<Latch> lk(_mutex);
-
-    if (opCtx) {
-        return opCtx->waitForConditionOrInterruptUntil(
-            _newTicket, lk, until, [this] { return _tryAcquire(); });
-    } else {
-        return _newTicket.wait_until(
-            lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
-    }
+    auto delta = newSize - _outof.load();
+    _outof.store(newSize);
+    _longLaneLimit.store(static_cast<int>(std::ceil(newSize * _longLaneRatio)));
+    _available.addAndFetch(delta);
+    _grantTickets(lk);
+    return Status::OK();
 }
 
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<Latch> lk(_mutex);
-        _num++;
-    }
-    _newTicket.notify_one();
-}
+void TicketHolder::setLongLaneRatio(double ratio) {
+    invariant(ratio > 0 && ratio <= 1);
 
-Status TicketHolder::resize(int newSize) {
     stdx::lock_guard<Latch> lk(_mutex);
-
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
-
-        std::string errmsg = ss.str();
-        LOGV2(23120, "{errmsg}", "errmsg"_attr = errmsg);
-        return Status(ErrorCodes::BadValue, errmsg);
-    }
-
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
-    return Status::OK();
+    _longLaneRatio = ratio;
+    _longLaneLimit.store(static_cast<int>(std::ceil(_outof.load() * ratio)));
+    _grantTickets(lk);
 }
 
 int TicketHolder::available() const {
-    return _num;
+    return std::max(_available.load(), 0);
 }
 
 int TicketHolder::used() const {
-    return outof() - _num;
+    return outof() - _available.load();
 }
 
 int TicketHolder::outof() const {
     return _outof.load();
 }
 
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
-        return false;
+void TicketHolder::appendLaneStats(BSONObjBuilder* builder) const {
+    for (auto& laneState : _lanes) {
+        auto lane = static_cast<Lane>(&laneState - _lanes.data());
+        BSONObjBuilder laneBuilder(builder->subobjStart(laneName(lane)));
+        laneBuilder.append("out", laneState.out.load());
+        laneBuilder.append("totalWaits", laneState.numWaits.load());
+        laneBuilder.append("totalTimeQueuedMicros", laneState.totalTimeQueuedMicros.load());
     }
-    _num--;
-    return true;
 }
-#endif
 }  // namespace mongo
@@ -28,35 +28,60 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <array>
+#include <list>
 
 #include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/hierarchical_acquisition.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * Admits a bounded number of concurrent holders of a ticket.
+ *
+ * Tickets are requested through one of several lanes, which let short operations get ahead of long
+ * running ones. When tickets are released while there are waiters, they are handed out to the
+ * waiters of the highest priority lane first, and in FIFO order within a lane. The long lane may
+ * also be limited to a fraction of the tickets, so that long running operations can never hold all
+ * of them. As long as nobody is waiting, tickets are acquired and released with atomic operations
+ * only.
+ */
 class TicketHolder {
     TicketHolder(const TicketHolder&) = delete;
     TicketHolder& operator=(const TicketHolder&) = delete;
 
 public:
+    /**
+     * The admission lanes, in decreasing order of priority.
+     */
+    enum class Lane {
+        kInternal,  // Operations replication depends on, such as oplog application.
+        kShort,     // User operations, until they are found to be long running.
+        kLong,      // User operations which have already run for a while, such as large scans.
+    };
+    static constexpr size_t kNumLanes = 3;
+
+    static StringData laneName(Lane lane);
+
     explicit TicketHolder(int num);
     ~TicketHolder();
 
-    bool tryAcquire();
+    bool tryAcquire(Lane lane = Lane::kShort);
 
     /**
      * Attempts to acquire a ticket. Blocks until a ticket is acquired or the OperationContext
      * 'opCtx' is killed, throwing an AssertionException.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
      */
-    void waitForTicket(OperationContext* opCtx);
+    void waitForTicket(OperationContext* opCtx, Lane lane = Lane::kShort);
     void waitForTicket() {
         waitForTicket(nullptr);
     }
@@ -68,36 +93,101 @@ public:
      * proceed.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
      */
-    bool waitForTicketUntil(OperationContext* opCtx, Date_t until);
+    bool waitForTicketUntil(OperationContext* opCtx, Date_t until, Lane lane = Lane::kShort);
     bool waitForTicketUntil(Date_t until) {
         return waitForTicketUntil(nullptr, until);
     }
-    void release();
 
+    /**
+     * Releases a ticket acquired through the given lane.
+     */
+    void release(Lane lane = Lane::kShort);
+
+    /**
+     * Changes the number of tickets, which must be at least 5, and no more than SEM_VALUE_MAX on
+     * Linux. When shrinking, the tickets in use above the new size are reclaimed as they are
+     * released.
+     */
     Status resize(int newSize);
 
+    /**
+     * Limits the number of tickets held through the long lane to the given fraction of the total,
+     * rounded up. A ratio of 1 disables the limit.
+     */
+    void setLongLaneRatio(double ratio);
+
     int available() const;
 
     int used() const;
 
     int outof() const;
 
+    /**
+     * Returns the total number of tickets released so far, which is the number of operations
+     * which completed their work under a ticket.
+     */
+    long long numReleased() const {
+        return _numReleased.load();
+    }
+
+    /**
+     * Returns the number of threads currently waiting for a ticket, across all lanes.
+     */
+    int numQueued() const {
+        return _numQueued.load();
+    }
+
+    /**
+     * Appends, for each lane, the number of tickets in use as well as the number and cumulative
+     * duration of the waits for a ticket.
+     */
+    void appendLaneStats(BSONObjBuilder* builder) const;
+
 private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    struct Waiter {
+        stdx::condition_variable cv;
+        bool granted = false;
+    };
 
-    // You can read _outof without a lock, but have to hold _resizeMutex to change.
-    AtomicWord<int> _outof;
-    Mutex _resizeMutex =
-        MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0), "TicketHolder::_resizeMutex");
-#else
-    bool _tryAcquire();
+    struct LaneState {
+        // Waiters of this lane, in FIFO order. Guarded by _mutex.
+        std::list<Waiter*> waiters;
+
+        AtomicWord<int> out{0};
+        AtomicWord<long long> numWaits{0};
+        AtomicWord<long long> totalTimeQueuedMicros{0};
+    };
+
+    /**
+     * Attempts to take a ticket for the given lane without waiting.
+     */
+    bool _tryAcquireTicket(Lane lane);
+
+    /**
+     * Hands out the available tickets to the waiters, by order of priority.
+     */
+    void _grantTickets(WithLock);
+
+    LaneState& _lane(Lane lane) {
+        return _lanes[static_cast<size_t>(lane)];
+    }
 
+    // The number of tickets which are not in use. This may be negative after the holder is shrunk,
+    // until enough tickets are released.
+    AtomicWord<int> _available;
     AtomicWord<int> _outof;
-    int _num;
+
+    // The maximum number of tickets which can be held through the long lane.
+    AtomicWord<int> _longLaneLimit;
+    double _longLaneRatio = 1.0;
+
+    AtomicWord<int> _numQueued{0};
+    AtomicWord<long long> _numReleased{0};
+
+    std::array<LaneState, kNumLanes> _lanes;
+
+    // Guards the lists of waiters, and serializes resizes.
     Mutex _mutex = MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0), "TicketHolder::_mutex");
-    stdx::condition_variable _newTicket;
-#endif
 };
 
 class ScopedTicket {
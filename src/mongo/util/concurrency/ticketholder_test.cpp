@@ -32,6 +32,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -72,4 +74,117 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, ReleasedTicketsGoToHigherPriorityLanesFirst) {
+    TicketHolder holder(1);
+    ASSERT(holder.tryAcquire());
+
+    auto mutex = MONGO_MAKE_LATCH();
+    std::vector<TicketHolder::Lane> order;
+    std::vector<stdx::thread> threads;
+    for (auto lane :
+         {TicketHolder::Lane::kLong, TicketHolder::Lane::kShort, TicketHolder::Lane::kInternal}) {
+        auto numQueued = holder.numQueued();
+        threads.emplace_back([&, lane] {
+            holder.waitForTicket(nullptr, lane);
+            {
+                stdx::lock_guard<Latch> lk(mutex);
+                order.push_back(lane);
+            }
+            holder.release(lane);
+        });
+        while (holder.numQueued() == numQueued) {
+            stdx::this_thread::yield();
+        }
+    }
+
+    // Each waiter releases its ticket once granted, which hands it to the next waiter.
+    holder.release();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(3U, order.size());
+    ASSERT(order[0] == TicketHolder::Lane::kInternal);
+    ASSERT(order[1] == TicketHolder::Lane::kShort);
+    ASSERT(order[2] == TicketHolder::Lane::kLong);
+    ASSERT_EQ(holder.used(), 0);
+}
+
+TEST(TicketholderTest, LongLaneIsLimitedToItsRatio) {
+    TicketHolder holder(4);
+    holder.setLongLaneRatio(0.5);
+
+    ASSERT(holder.tryAcquire(TicketHolder::Lane::kLong));
+    ASSERT(holder.tryAcquire(TicketHolder::Lane::kLong));
+    ASSERT_FALSE(holder.tryAcquire(TicketHolder::Lane::kLong));
+    ASSERT_FALSE(
+        holder.waitForTicketUntil(nullptr, Date_t::now(), TicketHolder::Lane::kLong));
+
+    // The remaining tickets are still available to the other lanes.
+    ASSERT(holder.tryAcquire(TicketHolder::Lane::kShort));
+    ASSERT_EQ(holder.available(), 1);
+
+    holder.release(TicketHolder::Lane::kLong);
+    ASSERT(holder.tryAcquire(TicketHolder::Lane::kLong));
+
+    BSONObjBuilder builder;
+    holder.appendLaneStats(&builder);
+    auto stats = builder.obj();
+    ASSERT_EQ(2, stats["long"]["out"].numberInt());
+    ASSERT_EQ(1, stats["long"]["totalWaits"].numberLong());
+    ASSERT_EQ(1, stats["short"]["out"].numberInt());
+    ASSERT_EQ(0, stats["internal"]["out"].numberInt());
+}
+
+TEST(TicketholderTest, ShrinkingReclaimsTicketsAsTheyAreReleased) {
+    TicketHolder holder(6);
+    for (int i = 0; i < 6; ++i) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 6);
+    ASSERT_EQ(holder.available(), 0);
+
+    holder.release();
+    ASSERT_EQ(holder.used(), 5);
+    ASSERT_FALSE(holder.tryAcquire());
+
+    holder.release();
+    ASSERT_EQ(holder.used(), 4);
+    ASSERT_EQ(holder.available(), 1);
+    ASSERT_EQ(holder.numReleased(), 2);
+}
+
+TEST(TicketholderTest, ResizeRejectsInvalidSizes) {
+    TicketHolder holder(5);
+    ASSERT_NOT_OK(holder.resize(0));
+    ASSERT_NOT_OK(holder.resize(4));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.available(), 5);
+}
+
+TEST(TicketholderTest, GrowingWakesUpWaiters) {
+    TicketHolder holder(5);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    stdx::thread waiter([&] {
+        holder.waitForTicket();
+        holder.release();
+    });
+    while (holder.numQueued() == 0) {
+        stdx::this_thread::yield();
+    }
+
+    ASSERT_OK(holder.resize(6));
+    waiter.join();
+    for (int i = 0; i < 5; ++i) {
+        holder.release();
+    }
+    ASSERT_EQ(holder.used(), 0);
+}
 }  // namespace
@@ -46,6 +46,7 @@ void ProgressMeter::reset(unsigned long long total, int secondsBetween, int chec
     _done = 0;
     _hits = 0;
     _lastTime = (int)time(nullptr);
+    _startTime = Date_t::now();
 
     _active = true;
 }
@@ -85,6 +86,14 @@ bool ProgressMeter::hit(int n) {
     return true;
 }
 
+double ProgressMeter::ratePerSecond() const {
+    const auto elapsedMillis = durationCount<Milliseconds>(Date_t::now() - _startTime);
+    if (elapsedMillis <= 0) {
+        return 0;
+    }
+    return static_cast<double>(_done) * 1000 / elapsedMillis;
+}
+
 std::string ProgressMeter::toString() const {
     if (!_active)
         return "";
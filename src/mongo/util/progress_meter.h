@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/util/thread_safe_string.h"
+#include "mongo/util/time_support.h"
 
 #include <string>
 
@@ -100,6 +101,11 @@ public:
         return _total;
     }
 
+    /**
+     * Returns the average number of units done per second since the last reset().
+     */
+    double ratePerSecond() const;
+
     void showTotal(bool doShow) {
         _showTotal = doShow;
     }
@@ -121,6 +127,7 @@ private:
     unsigned long long _done;
     unsigned long long _hits;
     int _lastTime;
+    Date_t _startTime;
 
     std::string _units;
     ThreadSafeString _name;